@@ -0,0 +1,405 @@
+#include "async_client.h"
+#include <algorithm>
+#include <iostream>
+#include <utility>
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+// epoll事件的data：节点用下标，唤醒用的eventfd用这个值
+const uint64_t kWakeToken = ~0ULL;
+const size_t kReadChunk = 64 * 1024;
+const int kMaxEvents = 64;
+
+}  // namespace
+
+const int AsyncClient::kConnectTimeoutMs;
+
+AsyncClient::AsyncClient()
+    : table_(ClusterConfig::getInstance().snapshot()), epoll_fd_(-1), wake_fd_(-1), stopping_(false),
+      read_chunk_(kReadChunk) {
+    for (const NodeInfo& info : table_->nodes) {
+        std::unique_ptr<Node> node(new Node());
+        node->info = info;
+        nodes_.push_back(std::move(node));
+    }
+
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd_ < 0 || wake_fd_ < 0) {
+        throw std::runtime_error("创建事件循环失败");
+    }
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.u64 = kWakeToken;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &event);
+
+    loop_thread_ = std::thread(&AsyncClient::loop, this);
+    std::cout << "[AsyncClient] 异步客户端初始化完成，" << nodes_.size() << " 个节点" << std::endl;
+}
+
+AsyncClient::~AsyncClient() {
+    stopping_ = true;
+    uint64_t one = 1;
+    ssize_t ignored = write(wake_fd_, &one, sizeof(one));
+    (void)ignored;
+    loop_thread_.join();
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        failNode(i, "Client closed");
+    }
+    close(wake_fd_);
+    close(epoll_fd_);
+}
+
+RespReply AsyncClient::errorReply(const std::string& message) {
+    RespReply reply;
+    reply.type = RespReply::ERROR;
+    reply.str = message;
+    return reply;
+}
+
+void AsyncClient::complete(Pending* pending, RespReply* reply) {
+    if (pending->promise) {
+        pending->promise->set_value(std::move(*reply));
+    } else if (pending->callback) {
+        pending->callback(*reply);
+    }
+}
+
+void AsyncClient::submit(const std::string& key, std::initializer_list<std::string_view> args, Pending pending) {
+    size_t index;
+    try {
+        index = table_->ownerIndex(key);
+    } catch (const std::exception& e) {
+        RespReply reply = errorReply(e.what());
+        complete(&pending, &reply);
+        return;
+    }
+
+    Node& node = *nodes_[index];
+    bool wake = false;
+    bool closed = false;
+    {
+        std::lock_guard<std::mutex> lock(node.mutex);
+        // 析构函数先设置stopping_，再在锁内取走所有等待中的请求；
+        // 在锁内检查，请求要么会被析构函数取走，要么在这里被拒绝，不会无人完成
+        if (stopping_) {
+            closed = true;
+        } else {
+            ProtocolParser::AppendRespCommand(args, &node.outbox);
+            node.pending.push_back(std::move(pending));
+            // 事件循环还没处理上一次唤醒时，这条命令会和之前的一起写出
+            if (!node.flush_scheduled) {
+                node.flush_scheduled = true;
+                wake = true;
+            }
+        }
+    }
+    if (closed) {
+        RespReply reply = errorReply("Client closed");
+        complete(&pending, &reply);
+        return;
+    }
+    if (wake) {
+        uint64_t one = 1;
+        ssize_t ignored = write(wake_fd_, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+std::future<RespReply> AsyncClient::submitFuture(const std::string& key,
+                                                 std::initializer_list<std::string_view> args) {
+    Pending pending;
+    pending.promise.emplace();
+    std::future<RespReply> future = pending.promise->get_future();
+    submit(key, args, std::move(pending));
+    return future;
+}
+
+std::future<RespReply> AsyncClient::getAsync(const std::string& key) {
+    return submitFuture(key, {"GET", key});
+}
+
+std::future<RespReply> AsyncClient::putAsync(const std::string& key, const std::string& value) {
+    // 服务器没有PUT命令，写入用SET
+    return submitFuture(key, {"SET", key, value});
+}
+
+std::future<RespReply> AsyncClient::delAsync(const std::string& key) {
+    return submitFuture(key, {"DEL", key});
+}
+
+void AsyncClient::getAsync(const std::string& key, Callback callback) {
+    Pending pending;
+    pending.callback = std::move(callback);
+    submit(key, {"GET", key}, std::move(pending));
+}
+
+void AsyncClient::putAsync(const std::string& key, const std::string& value, Callback callback) {
+    Pending pending;
+    pending.callback = std::move(callback);
+    submit(key, {"SET", key, value}, std::move(pending));
+}
+
+void AsyncClient::delAsync(const std::string& key, Callback callback) {
+    Pending pending;
+    pending.callback = std::move(callback);
+    submit(key, {"DEL", key}, std::move(pending));
+}
+
+void AsyncClient::loop() {
+    struct epoll_event events[kMaxEvents];
+    while (!stopping_) {
+        int n = epoll_wait(epoll_fd_, events, kMaxEvents, expireConnects());
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "[AsyncClient] epoll_wait失败: " << strerror(errno) << std::endl;
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            if (events[i].data.u64 == kWakeToken) {
+                uint64_t count;
+                ssize_t ignored = read(wake_fd_, &count, sizeof(count));
+                (void)ignored;
+                for (size_t index = 0; index < nodes_.size(); ++index) {
+                    flushNode(index);
+                }
+                continue;
+            }
+            size_t index = static_cast<size_t>(events[i].data.u64);
+            if (!nodes_[index]->connection) {
+                continue;  // 本轮前面的事件已经关闭了这个连接
+            }
+            if (nodes_[index]->connecting) {
+                // 连接完成（成功或失败）时socket变为可写，失败时还会带上EPOLLERR/EPOLLHUP
+                if ((events[i].events & (EPOLLOUT | EPOLLHUP | EPOLLERR)) && finishConnectNode(index)) {
+                    writeNode(index);
+                }
+                continue;
+            }
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                readNode(index);
+            }
+            if (nodes_[index]->connection && (events[i].events & EPOLLOUT)) {
+                writeNode(index);
+            }
+        }
+    }
+}
+
+void AsyncClient::flushNode(size_t index) {
+    Node& node = *nodes_[index];
+    {
+        std::lock_guard<std::mutex> lock(node.mutex);
+        if (!node.flush_scheduled) {
+            return;
+        }
+        node.flush_scheduled = false;
+        if (node.sending_offset == node.sending.size()) {
+            // 上一批已经写完，交换缓冲，两边的容量都留着下次用
+            node.sending.clear();
+            node.sending_offset = 0;
+            node.sending.swap(node.outbox);
+        } else {
+            node.sending.append(node.outbox);
+            node.outbox.clear();
+        }
+    }
+    if (!node.connection && !connectNode(index)) {
+        return;
+    }
+    // 正在连接或已经在等EPOLLOUT时由可写事件继续写
+    if (!node.want_write) {
+        writeNode(index);
+    }
+}
+
+bool AsyncClient::connectNode(size_t index) {
+    // 不能用阻塞的Connection::connect：一个连不上的节点会让事件循环卡住，耽误所有节点的响应
+    Node& node = *nodes_[index];
+    std::unique_ptr<Connection> connection(new Connection(node.info.host, node.info.port));
+    bool in_progress = false;
+    if (!connection->startConnect(&in_progress)) {
+        failNode(index, "Connection failed");
+        return false;
+    }
+
+    struct epoll_event event;
+    event.events = in_progress ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+    event.data.u64 = index;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, connection->fd(), &event) < 0) {
+        failNode(index, "Connection failed");
+        return false;
+    }
+    node.connection = std::move(connection);
+    node.connecting = in_progress;
+    node.want_write = in_progress;
+    node.connect_deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(kConnectTimeoutMs);
+    return true;
+}
+
+int AsyncClient::expireConnects() {
+    auto now = std::chrono::steady_clock::now();
+    int timeout = -1;
+    for (size_t index = 0; index < nodes_.size(); ++index) {
+        Node& node = *nodes_[index];
+        if (!node.connecting) {
+            continue;
+        }
+        if (node.connect_deadline <= now) {
+            failNode(index, "Connection timed out");
+            continue;
+        }
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(node.connect_deadline - now);
+        int ms = static_cast<int>(remaining.count()) + 1;
+        timeout = timeout < 0 ? ms : std::min(timeout, ms);
+    }
+    return timeout;
+}
+
+bool AsyncClient::finishConnectNode(size_t index) {
+    Node& node = *nodes_[index];
+    if (!node.connection->finishConnect()) {
+        failNode(index, "Connection failed");
+        return false;
+    }
+    node.connecting = false;
+    return true;
+}
+
+void AsyncClient::setWriteInterest(size_t index, bool enable) {
+    Node& node = *nodes_[index];
+    if (node.want_write == enable) {
+        return;
+    }
+    struct epoll_event event;
+    event.events = enable ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+    event.data.u64 = index;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, node.connection->fd(), &event);
+    node.want_write = enable;
+}
+
+void AsyncClient::writeNode(size_t index) {
+    Node& node = *nodes_[index];
+    while (node.sending_offset < node.sending.size()) {
+        ssize_t n = send(node.connection->fd(), node.sending.data() + node.sending_offset,
+                         node.sending.size() - node.sending_offset, MSG_NOSIGNAL);
+        if (n > 0) {
+            node.sending_offset += static_cast<size_t>(n);
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            setWriteInterest(index, true);
+            return;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            failNode(index, "Send failed");
+            return;
+        }
+    }
+    setWriteInterest(index, false);
+}
+
+void AsyncClient::readNode(size_t index) {
+    Node& node = *nodes_[index];
+    // 对端关闭或出错时，先把已经收到的响应交付，再让剩下的请求失败
+    const char* closed = nullptr;
+    for (;;) {
+        ssize_t n = recv(node.connection->fd(), read_chunk_.data(), read_chunk_.size(), 0);
+        if (n > 0) {
+            node.read_buffer.append(read_chunk_.data(), static_cast<size_t>(n));
+            if (static_cast<size_t>(n) < read_chunk_.size()) {
+                break;
+            }
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            closed = n == 0 ? "Connection closed" : "Receive failed";
+            break;
+        }
+    }
+
+    size_t pos = 0;
+    for (;;) {
+        RespReply reply;
+        size_t consumed = 0;
+        int ret = ProtocolParser::ParseRespReply(node.read_buffer.data() + pos, node.read_buffer.size() - pos,
+                                                 &reply, &consumed);
+        if (ret == 0) {
+            break;
+        }
+        if (ret < 0) {
+            replies_.clear();
+            failNode(index, "Protocol error");
+            return;
+        }
+        replies_.push_back(std::move(reply));
+        pos += consumed;
+    }
+    node.read_buffer.erase(0, pos);
+    if (replies_.empty()) {
+        if (closed) {
+            failNode(index, closed);
+        }
+        return;
+    }
+
+    bool desync = false;
+    {
+        std::lock_guard<std::mutex> lock(node.mutex);
+        desync = replies_.size() > node.pending.size();
+        if (!desync) {
+            for (size_t i = 0; i < replies_.size(); ++i) {
+                completing_.push_back(std::move(node.pending.front()));
+                node.pending.pop_front();
+            }
+        }
+    }
+    if (desync) {
+        // 收到了没有对应请求的响应，连接上的顺序已经不可信
+        replies_.clear();
+        failNode(index, "Unexpected reply");
+        return;
+    }
+    // 在锁外完成，回调里可以继续提交新的请求
+    for (size_t i = 0; i < completing_.size(); ++i) {
+        complete(&completing_[i], &replies_[i]);
+    }
+    completing_.clear();
+    replies_.clear();
+    if (closed) {
+        failNode(index, closed);
+    }
+}
+
+void AsyncClient::failNode(size_t index, const std::string& message) {
+    Node& node = *nodes_[index];
+    if (node.connection) {
+        // close会把fd从epoll中移除
+        node.connection.reset();
+    }
+    node.want_write = false;
+    node.connecting = false;
+    node.sending.clear();
+    node.sending_offset = 0;
+    node.read_buffer.clear();
+
+    std::deque<Pending> failed;
+    {
+        std::lock_guard<std::mutex> lock(node.mutex);
+        failed.swap(node.pending);
+        node.outbox.clear();
+        node.flush_scheduled = false;
+    }
+    for (Pending& pending : failed) {
+        RespReply reply = errorReply(message);
+        complete(&pending, &reply);
+    }
+}
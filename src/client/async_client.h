@@ -0,0 +1,113 @@
+#ifndef ASYNC_CLIENT_H
+#define ASYNC_CLIENT_H
+
+#include "connection.h"
+#include "cluster_config.h"
+#include "common/protocol.h"
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <future>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// 异步流水线客户端：每个节点一条连接，同一条连接上可以有任意多个未完成的请求。
+// 调用线程只把命令编码进节点的发送缓冲并登记到等待队列，由后台事件循环线程统一写出和读取；
+// 服务器按请求顺序响应，事件循环按先进先出把响应交给对应的future或回调。
+// 事件循环处理上一批时新提交的命令会攒在发送缓冲里，下一次一起写出，不需要手动flush。
+//
+// 与KVClient不同，这里不重试：连接失败或断开时，该节点上所有未完成的请求都以ERROR响应结束，
+// 下一次提交时重新连接。未完成请求的数量没有上限，调用者需要自己控制在途请求数
+class AsyncClient {
+public:
+    // 回调在事件循环线程中执行，不能阻塞，也不能等待同一个客户端上其他请求的结果
+    using Callback = std::function<void(const RespReply&)>;
+
+    // 与Connection的阻塞连接超时一致，超时后该节点上的请求以ERROR结束
+    static const int kConnectTimeoutMs = 3000;
+
+    // 节点列表取自创建时ClusterConfig的节点表，之后不再变化
+    AsyncClient();
+    // 等待中的请求以ERROR响应结束
+    ~AsyncClient();
+
+    AsyncClient(const AsyncClient&) = delete;
+    AsyncClient& operator=(const AsyncClient&) = delete;
+
+    std::future<RespReply> getAsync(const std::string& key);
+    std::future<RespReply> putAsync(const std::string& key, const std::string& value);
+    std::future<RespReply> delAsync(const std::string& key);
+
+    void getAsync(const std::string& key, Callback callback);
+    void putAsync(const std::string& key, const std::string& value, Callback callback);
+    void delAsync(const std::string& key, Callback callback);
+
+private:
+    // 每个请求对应一项，future和回调二选一
+    struct Pending {
+        std::optional<std::promise<RespReply>> promise;
+        Callback callback;
+    };
+
+    struct Node {
+        NodeInfo info;
+
+        // 调用线程和事件循环共用，受mutex保护
+        std::mutex mutex;
+        std::string outbox;               // 还没交给事件循环的命令
+        std::deque<Pending> pending;      // 已提交、还没收到响应的请求，按提交顺序
+        bool flush_scheduled = false;     // 已经唤醒过事件循环，还没处理
+
+        // 以下只由事件循环线程访问
+        std::unique_ptr<Connection> connection;
+        std::string sending;              // 正在写出的命令，与outbox交替使用
+        size_t sending_offset = 0;
+        std::string read_buffer;
+        bool want_write = false;          // 是否注册了EPOLLOUT
+        bool connecting = false;          // 非阻塞连接还没完成，等EPOLLOUT
+        std::chrono::steady_clock::time_point connect_deadline;
+    };
+
+    // 编码命令并登记pending；key决定节点。析构开始后提交的请求直接以ERROR结束
+    void submit(const std::string& key, std::initializer_list<std::string_view> args, Pending pending);
+    std::future<RespReply> submitFuture(const std::string& key, std::initializer_list<std::string_view> args);
+
+    void loop();
+    // 以下只在事件循环线程中调用
+    void flushNode(size_t index);
+    // 发起非阻塞连接，连接结果在可写时由finishConnectNode确认
+    bool connectNode(size_t index);
+    bool finishConnectNode(size_t index);
+    // 让连接超时的节点失败，返回距离最近一个连接超时的毫秒数，没有正在连接的节点时返回-1
+    int expireConnects();
+    void writeNode(size_t index);
+    void readNode(size_t index);
+    // 关闭连接，该节点上所有等待中的请求以message结束
+    void failNode(size_t index, const std::string& message);
+    void setWriteInterest(size_t index, bool enable);
+
+    static void complete(Pending* pending, RespReply* reply);
+    static RespReply errorReply(const std::string& message);
+
+    // 创建时的节点表，节点下标与nodes_一致，之后重新加载配置不影响本客户端
+    std::shared_ptr<const ClusterConfig::Table> table_;
+    std::vector<std::unique_ptr<Node>> nodes_;
+    int epoll_fd_;
+    int wake_fd_;
+    std::atomic<bool> stopping_;
+    std::thread loop_thread_;
+
+    // 事件循环线程复用的缓冲
+    std::vector<char> read_chunk_;
+    std::vector<RespReply> replies_;
+    std::vector<Pending> completing_;
+};
+
+#endif
@@ -1,10 +1,71 @@
 #include "cluster_config.h"
+#include "../common/utils.h"
 #include <fstream>
 #include <sstream>
-#include <functional>
 #include <iostream>
 #include <cstdlib>
 #include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <climits>
+#include <stdexcept>
+
+namespace {
+
+int64_t NowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void PrintNodes(const std::vector<NodeInfo>& nodes) {
+    for (const auto& node : nodes) {
+        std::cout << "[Cluster]   " << node.id << " 在 " << node.address() 
+                  << " (分片: " << node.shard_id << ")" << std::endl;
+    }
+}
+
+// 在text中查找"field": value，取出去掉引号和空白的value；找不到时返回false
+bool findField(const std::string& text, const std::string& field, std::string* value) {
+    size_t pos = text.find("\"" + field + "\"");
+    if (pos == std::string::npos) {
+        return false;
+    }
+    size_t colon = text.find(':', pos);
+    if (colon == std::string::npos) {
+        return false;
+    }
+    size_t end = text.find_first_of(",}", colon);
+    if (end == std::string::npos) {
+        end = text.size();
+    }
+    std::string raw = text.substr(colon + 1, end - colon - 1);
+    raw.erase(std::remove_if(raw.begin(), raw.end(),
+              [](unsigned char c){ return std::isspace(c) || c == '"'; }), raw.end());
+    *value = raw;
+    return !raw.empty();
+}
+
+// 读取整数字段。字段不存在时*value不变；不是整数或不在[min, max]内时输出错误并返回false
+bool findIntField(const std::string& text, const std::string& field, int min, int max, int* value) {
+    std::string raw;
+    if (!findField(text, field, &raw)) {
+        return true;
+    }
+    int parsed = 0;
+    std::from_chars_result result = std::from_chars(raw.data(), raw.data() + raw.size(), parsed);
+    if (result.ec != std::errc() || result.ptr != raw.data() + raw.size() || parsed < min || parsed > max) {
+        std::cerr << "[Cluster] 无效的" << field << ": " << raw << std::endl;
+        return false;
+    }
+    *value = parsed;
+    return true;
+}
+
+}  // namespace
+
+const int64_t ClusterConfig::kUnhealthyRetryMs;
+const int ClusterConfig::kMaxNodeWeight;
+const int ClusterConfig::kMaxVirtualNodes;
 
 ClusterConfig::ClusterConfig() {
     // 构造函数中尝试加载配置
@@ -47,8 +108,8 @@ bool ClusterConfig::loadFromFile(const std::string& config_file) {
 bool ClusterConfig::loadFromJson(const std::string& json_str) {
     std::cout << "[Cluster] 加载集群配置..." << std::endl;
     
-    // 清空现有节点
-    nodes_.clear();
+    // 在新表上解析，成功后才替换当前的表
+    std::shared_ptr<Table> table = std::make_shared<Table>();
     
     // 简单解析JSON（为了毕业设计，这里简化处理）
     // 查找nodes数组
@@ -69,55 +130,79 @@ bool ClusterConfig::loadFromJson(const std::string& json_str) {
     
     std::string nodes_str = json_str.substr(start + 1, end - start - 1);
     
-    // 简单解析：查找每个节点的port字段
+    // 简单解析：逐个取出{...}节点对象，port必须有，其余字段缺省时使用默认值
     size_t node_start = 0;
     int node_count = 0;
     
-    while ((node_start = nodes_str.find("\"port\"", node_start)) != std::string::npos) {
-        size_t colon = nodes_str.find(':', node_start);
-        size_t comma = nodes_str.find(',', colon);
-        if (comma == std::string::npos) {
-            comma = nodes_str.find('}', colon);
+    while ((node_start = nodes_str.find('{', node_start)) != std::string::npos) {
+        size_t node_end = nodes_str.find('}', node_start);
+        if (node_end == std::string::npos) {
+            break;
         }
+        std::string node_str = nodes_str.substr(node_start, node_end - node_start + 1);
+        node_start = node_end;
         
-        std::string port_str = nodes_str.substr(colon + 1, comma - colon - 1);
-        port_str.erase(std::remove_if(port_str.begin(), port_str.end(), 
-                      [](unsigned char c){ return std::isspace(c); }), port_str.end());
-        
-        int port = std::stoi(port_str);
+        std::string port_str;
+        if (!findField(node_str, "port", &port_str)) {
+            continue;
+        }
         
+        // 数值字段有错时整个配置作废，保留原来的节点表
         NodeInfo node;
-        node.id = "server-" + std::to_string(node_count + 1);
-        node.host = "127.0.0.1";
-        node.port = port;
-        node.role = "master";
-        node.is_healthy = true;
         node.shard_id = node_count;
+        if (!findIntField(node_str, "port", 1, 65535, &node.port) ||
+            !findIntField(node_str, "shard_id", INT_MIN, INT_MAX, &node.shard_id) ||
+            !findIntField(node_str, "weight", INT_MIN, INT_MAX, &node.weight)) {
+            return false;
+        }
+        node.weight = std::min(std::max(node.weight, 1), kMaxNodeWeight);
+        if (!findField(node_str, "id", &node.id)) {
+            node.id = "server-" + std::to_string(node_count + 1);
+        }
+        if (!findField(node_str, "host", &node.host)) {
+            node.host = "127.0.0.1";
+        }
+        if (!findField(node_str, "role", &node.role)) {
+            node.role = "master";
+        }
+        node.is_healthy = true;
         
-        nodes_.push_back(node);
+        table->nodes.push_back(node);
         node_count++;
-        node_start = comma;
     }
     
-    if (nodes_.empty()) {
-        std::cerr << "[Cluster] 未找到有效节点配置" << std::endl;
+    // 分片策略：simple_hash为哈希取模（缺省），consistent_hash为带虚拟节点的一致性哈希
+    std::string strategy;
+    if (findField(json_str, "hash_strategy", &strategy)) {
+        if (strategy == "consistent_hash") {
+            table->hash_strategy = HASH_CONSISTENT;
+        } else if (strategy != "simple_hash") {
+            std::cerr << "[Cluster] 未知的hash_strategy: " << strategy << "，使用simple_hash" << std::endl;
+        }
+    }
+    // 非正数时HashRing使用默认值
+    int virtual_nodes = HashRing::kDefaultVirtualNodes;
+    if (!findIntField(json_str, "virtual_nodes", INT_MIN, INT_MAX, &virtual_nodes)) {
         return false;
     }
+    virtual_nodes = std::min(virtual_nodes, kMaxVirtualNodes);
     
-    config_loaded_ = true;
-    
-    std::cout << "[Cluster] 成功加载 " << nodes_.size() << " 个节点:" << std::endl;
-    for (const auto& node : nodes_) {
-        std::cout << "[Cluster]   " << node.id << " 在 " << node.address() 
-                  << " (分片: " << node.shard_id << ")" << std::endl;
+    if (table->nodes.empty()) {
+        std::cerr << "[Cluster] 未找到有效节点配置" << std::endl;
+        return false;
     }
     
+    std::cout << "[Cluster] 成功加载 " << table->nodes.size() << " 个节点 ("
+              << (table->hash_strategy == HASH_CONSISTENT ? "consistent_hash" : "simple_hash") << "):" << std::endl;
+    PrintNodes(table->nodes);
+    
+    publish(std::move(table), virtual_nodes);
     return true;
 }
 
 void ClusterConfig::initDefaultConfig() {
     // 默认的3节点配置 - 使用旧的初始化方式
-    nodes_.clear();  // 清空向量
+    std::shared_ptr<Table> table = std::make_shared<Table>();
     
     // 逐个添加节点
     NodeInfo node1;
@@ -127,7 +212,7 @@ void ClusterConfig::initDefaultConfig() {
     node1.role = "master";
     node1.is_healthy = true;
     node1.shard_id = 0;
-    nodes_.push_back(node1);
+    table->nodes.push_back(node1);
     
     NodeInfo node2;
     node2.id = "server-2";
@@ -136,7 +221,7 @@ void ClusterConfig::initDefaultConfig() {
     node2.role = "master";
     node2.is_healthy = true;
     node2.shard_id = 1;
-    nodes_.push_back(node2);
+    table->nodes.push_back(node2);
     
     NodeInfo node3;
     node3.id = "server-3";
@@ -145,51 +230,119 @@ void ClusterConfig::initDefaultConfig() {
     node3.role = "master";
     node3.is_healthy = true;
     node3.shard_id = 2;
-    nodes_.push_back(node3);
+    table->nodes.push_back(node3);
     
-    config_loaded_ = true;
+    // 与configs/cluster_3nodes.json一致
+    table->hash_strategy = HASH_CONSISTENT;
     
     std::cout << "[Cluster] 使用默认3节点配置:" << std::endl;
-    for (const auto& node : nodes_) {
-        std::cout << "[Cluster]   " << node.id << " 在 " << node.address() 
-                  << " (分片: " << node.shard_id << ")" << std::endl;
-    }
+    PrintNodes(table->nodes);
+    
+    publish(std::move(table), HashRing::kDefaultVirtualNodes);
 }
 
-NodeInfo ClusterConfig::getNodeByKey(const std::string& key) {
-    if (!config_loaded_) {
-        initDefaultConfig();
+void ClusterConfig::publish(std::shared_ptr<Table> table, int virtual_nodes) {
+    std::vector<std::pair<std::string, int>> members;
+    for (const auto& node : table->nodes) {
+        members.emplace_back(node.id, node.weight);
     }
+    table->ring.build(members, virtual_nodes);
     
-    if (nodes_.empty()) {
+    std::lock_guard<std::mutex> lock(load_mutex_);
+    for (const auto& node : table->nodes) {
+        std::shared_ptr<std::atomic<int64_t>>& flag = health_[node.id];
+        if (!flag) {
+            flag = std::make_shared<std::atomic<int64_t>>(0);
+        }
+        table->unhealthy_until.push_back(flag);
+    }
+    std::atomic_store(&table_, std::shared_ptr<const Table>(std::move(table)));
+}
+
+std::shared_ptr<const ClusterConfig::Table> ClusterConfig::snapshot() const {
+    return std::atomic_load(&table_);
+}
+
+size_t ClusterConfig::Table::ownerIndex(std::string_view key) const {
+    if (nodes.empty()) {
         throw std::runtime_error("集群中没有可用节点");
     }
     
+    // 两种策略用同一个稳定哈希，结果不依赖标准库实现，不同平台编译的客户端路由一致
+    uint64_t key_hash = utils::KeyHash(key);
+    if (hash_strategy == HASH_CONSISTENT) {
+        return ring.nodeIndexForHash(key_hash);
+    }
+    
     // 哈希取模分片
-    std::hash<std::string> hash_fn;
-    size_t hash_value = hash_fn(key);
-    size_t node_index = hash_value % nodes_.size();
+    return static_cast<size_t>(key_hash % nodes.size());
+}
+
+size_t ClusterConfig::Table::routeIndex(std::string_view key) const {
+    if (nodes.empty()) {
+        throw std::runtime_error("集群中没有可用节点");
+    }
     
-    NodeInfo target_node = nodes_[node_index];
-    std::cout << "[Cluster] 键 '" << key << "' -> " 
-              << target_node.id << " (" << target_node.address() 
-              << ", 分片: " << target_node.shard_id << ")" << std::endl;
+    uint64_t key_hash = utils::KeyHash(key);
+    size_t owner = hash_strategy == HASH_CONSISTENT ? ring.nodeIndexForHash(key_hash)
+                                                    : static_cast<size_t>(key_hash % nodes.size());
+    if (isHealthy(owner)) {
+        return owner;
+    }
     
-    return target_node;
+    // 所属节点不可用，避免重试时又回到同一个节点
+    if (hash_strategy == HASH_CONSISTENT) {
+        return ring.nodeIndexForHash(key_hash, [this](size_t index) { return isHealthy(index); });
+    }
+    for (size_t i = 1; i < nodes.size(); i++) {
+        size_t index = (owner + i) % nodes.size();
+        if (isHealthy(index)) {
+            return index;
+        }
+    }
+    return owner;
+}
+
+bool ClusterConfig::Table::isHealthy(size_t index) const {
+    // 健康时只有一次原子读，不读时钟
+    int64_t until = unhealthy_until[index]->load(std::memory_order_relaxed);
+    return until == 0 || until <= NowMs();
+}
+
+NodeInfo ClusterConfig::getNodeByKey(std::string_view key) const {
+    std::shared_ptr<const Table> table = snapshot();
+    size_t index = table->routeIndex(key);
+    NodeInfo node = table->nodes[index];
+    node.is_healthy = table->isHealthy(index);
+    return node;
+}
+
+size_t ClusterConfig::getNodeIndex(std::string_view key) const {
+    return snapshot()->ownerIndex(key);
+}
+
+ClusterConfig::HashStrategy ClusterConfig::getHashStrategy() const {
+    return snapshot()->hash_strategy;
 }
 
 std::vector<NodeInfo> ClusterConfig::getAllNodes() const {
-    return nodes_;
+    std::shared_ptr<const Table> table = snapshot();
+    std::vector<NodeInfo> nodes = table->nodes;
+    for (size_t i = 0; i < nodes.size(); i++) {
+        nodes[i].is_healthy = table->isHealthy(i);
+    }
+    return nodes;
 }
 
 size_t ClusterConfig::getNodeCount() const {
-    return nodes_.size();
+    return snapshot()->nodes.size();
 }
 
 void ClusterConfig::markNodeUnhealthy(const std::string& node_id) {
-    for (auto& node : nodes_) {
-        if (node.id == node_id) {
-            node.is_healthy = false;
+    std::shared_ptr<const Table> table = snapshot();
+    for (size_t i = 0; i < table->nodes.size(); i++) {
+        if (table->nodes[i].id == node_id) {
+            table->unhealthy_until[i]->store(NowMs() + kUnhealthyRetryMs, std::memory_order_relaxed);
             std::cout << "[Cluster] 标记节点 " << node_id << " 为不健康" << std::endl;
             break;
         }
@@ -197,9 +350,10 @@ void ClusterConfig::markNodeUnhealthy(const std::string& node_id) {
 }
 
 void ClusterConfig::markNodeHealthy(const std::string& node_id) {
-    for (auto& node : nodes_) {
-        if (node.id == node_id) {
-            node.is_healthy = true;
+    std::shared_ptr<const Table> table = snapshot();
+    for (size_t i = 0; i < table->nodes.size(); i++) {
+        if (table->nodes[i].id == node_id) {
+            table->unhealthy_until[i]->store(0, std::memory_order_relaxed);
             std::cout << "[Cluster] 标记节点 " << node_id << " 为健康" << std::endl;
             break;
         }
@@ -1,7 +1,13 @@
 #ifndef CLUSTER_CONFIG_H
 #define CLUSTER_CONFIG_H
 
+#include "hash_ring.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 #include <memory>
 
@@ -12,8 +18,10 @@ struct NodeInfo {
     std::string role;
     bool is_healthy;
     int shard_id;
+    // 一致性哈希时的相对权重，虚拟节点数按它缩放
+    int weight;
     
-    NodeInfo() : port(0), is_healthy(true), shard_id(-1) {}
+    NodeInfo() : port(0), is_healthy(true), shard_id(-1), weight(1) {}
     
     std::string address() const {
         return host + ":" + std::to_string(port);
@@ -22,24 +30,60 @@ struct NodeInfo {
 
 class ClusterConfig {
 public:
+    // 配置文件中的hash_strategy：simple_hash（哈希取模）或consistent_hash（一致性哈希）
+    enum HashStrategy { HASH_MODULO, HASH_CONSISTENT };
+    
+    // 标记为不健康的节点在这段时间内不参与路由，之后重新尝试
+    static const int64_t kUnhealthyRetryMs = 1000;
+    // 配置中weight和virtual_nodes的上限，超过时按上限处理，哈希环的大小因此有界
+    static const int kMaxNodeWeight = 100;
+    static const int kMaxVirtualNodes = 1000;
+    
+    // 一次加载得到的节点表，发布后不再修改。重新加载配置时构建新表整体替换，
+    // 已经取得旧表的读者可以继续使用它，不会看到修改到一半的节点列表
+    struct Table {
+        std::vector<NodeInfo> nodes;
+        HashStrategy hash_strategy = HASH_MODULO;
+        HashRing ring;
+        // unhealthy_until[i]是nodes[i]恢复参与路由的时间（毫秒，steady_clock），0表示健康。
+        // 按节点id在各版本的表之间共享，重新加载配置后健康状态保留
+        std::vector<std::shared_ptr<std::atomic<int64_t>>> unhealthy_until;
+        
+        // key所属节点在nodes中的下标，不考虑健康状态。key只哈希一次，不分配内存
+        size_t ownerIndex(std::string_view key) const;
+        // key路由到的节点下标：所属节点不健康时，一致性哈希沿环顺时针、哈希取模按下标顺序
+        // 找下一个健康节点；所有节点都不健康时返回所属节点。不分配内存
+        size_t routeIndex(std::string_view key) const;
+        bool isHealthy(size_t index) const;
+    };
+    
     static ClusterConfig& getInstance();
     
     // 从文件加载配置
     bool loadFromFile(const std::string& config_file);
     
-    // 从JSON字符串加载
+    // 从JSON字符串加载。失败时保留原来的节点表
     bool loadFromJson(const std::string& json_str);
     
-    // 获取节点（根据key哈希）
-    NodeInfo getNodeByKey(const std::string& key);
+    // 当前节点表，线程安全。高频路径取一次后在同一张表上完成路由
+    std::shared_ptr<const Table> snapshot() const;
     
-    // 获取所有节点
+    // 获取key路由到的节点（跳过不健康的节点）
+    NodeInfo getNodeByKey(std::string_view key) const;
+    
+    // key所属节点在getAllNodes()中的下标，不考虑健康状态。两次调用之间配置可能被重新加载，
+    // 需要下标与节点列表一致时用snapshot()
+    size_t getNodeIndex(std::string_view key) const;
+    
+    // 获取所有节点，is_healthy为当前的健康状态
     std::vector<NodeInfo> getAllNodes() const;
     
     // 获取节点数量
     size_t getNodeCount() const;
     
-    // 标记节点状态
+    HashStrategy getHashStrategy() const;
+    
+    // 标记节点状态，只修改节点的健康标志，可以与路由并发
     void markNodeUnhealthy(const std::string& node_id);
     void markNodeHealthy(const std::string& node_id);
     
@@ -50,11 +94,15 @@ private:
     // 初始化默认配置
     void initDefaultConfig();
     
-    // 解析JSON配置
-    bool parseJsonConfig(const std::string& json_str);
+    // 为节点表填上健康标志、构建哈希环后发布
+    void publish(std::shared_ptr<Table> table, int virtual_nodes);
     
-    std::vector<NodeInfo> nodes_;
-    bool config_loaded_ = false;
+    // 只能用std::atomic_load/std::atomic_store访问
+    std::shared_ptr<const Table> table_;
+    // 串行化配置加载，保护health_
+    std::mutex load_mutex_;
+    // 节点id到健康标志，节点从配置中移除后仍保留，重新加入时沿用
+    std::unordered_map<std::string, std::shared_ptr<std::atomic<int64_t>>> health_;
     std::string config_file_;
 };
 
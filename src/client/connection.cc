@@ -2,6 +2,7 @@
 #include <iostream>
 #include <unistd.h>
 #include <fcntl.h>
+#include <netinet/tcp.h>
 #include <sys/select.h>
 
 Connection::Connection(const std::string& host, int port) 
@@ -42,6 +43,7 @@ bool Connection::connect() {
     if (inet_pton(AF_INET, host_.c_str(), &server_addr.sin_addr) <= 0) {
         std::cerr << "[Connection] 无效的地址: " << host_ << std::endl;
         close(sockfd_);
+        sockfd_ = -1;
         return false;
     }
     
@@ -53,6 +55,10 @@ bool Connection::connect() {
     setsockopt(sockfd_, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
     setsockopt(sockfd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
     
+    // 命令都很小，关闭Nagle算法，避免小包等待前一个包的ACK
+    int nodelay = 1;
+    setsockopt(sockfd_, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+    
     std::cout << "[Connection] 连接到 " << host_ << ":" << port_ << "..." << std::endl;
     
     if (::connect(sockfd_, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
@@ -67,7 +73,61 @@ bool Connection::connect() {
     return true;
 }
 
+bool Connection::startConnect(bool* in_progress) {
+    *in_progress = false;
+    if (connected_) {
+        return true;
+    }
+    
+    struct sockaddr_in server_addr;
+    memset(&server_addr, 0, sizeof(server_addr));
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_port = htons(port_);
+    if (inet_pton(AF_INET, host_.c_str(), &server_addr.sin_addr) <= 0) {
+        return false;
+    }
+    
+    sockfd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (sockfd_ < 0) {
+        return false;
+    }
+    int nodelay = 1;
+    setsockopt(sockfd_, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+    
+    if (::connect(sockfd_, (struct sockaddr*)&server_addr, sizeof(server_addr)) == 0) {
+        connected_ = true;
+        return true;
+    }
+    if (errno == EINPROGRESS) {
+        *in_progress = true;
+        return true;
+    }
+    close(sockfd_);
+    sockfd_ = -1;
+    return false;
+}
+
+bool Connection::finishConnect() {
+    if (connected_) {
+        return true;
+    }
+    if (sockfd_ < 0) {
+        return false;
+    }
+    int error = 0;
+    socklen_t len = sizeof(error);
+    if (getsockopt(sockfd_, SOL_SOCKET, SO_ERROR, &error, &len) < 0 || error != 0) {
+        close(sockfd_);
+        sockfd_ = -1;
+        return false;
+    }
+    connected_ = true;
+    return true;
+}
+
 void Connection::disconnect() {
+    read_buffer_.clear();
+    scanner_.Reset();
     if (sockfd_ >= 0) {
         close(sockfd_);
         sockfd_ = -1;
@@ -83,7 +143,11 @@ bool Connection::send(const std::string& data) {
     
     size_t total_sent = 0;
     while (total_sent < data.length()) {
-        ssize_t sent = write(sockfd_, data.c_str() + total_sent, data.length() - total_sent);
+        // 连接池中的连接可能早已被服务器关闭，MSG_NOSIGNAL让写入返回EPIPE而不是触发SIGPIPE杀死进程
+        ssize_t sent = ::send(sockfd_, data.c_str() + total_sent, data.length() - total_sent, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
         if (sent < 0) {
             std::cerr << "[Connection] 发送失败: " << strerror(errno) << std::endl;
             disconnect();
@@ -132,6 +196,72 @@ std::string Connection::receive() {
     return result;
 }
 
+bool Connection::sendCommand(const std::vector<std::string>& args) {
+    return send(ProtocolParser::EncodeRespCommand(args));
+}
+
+bool Connection::receiveReply(RespReply* reply) {
+    if (!connected_) {
+        throw std::runtime_error("未连接");
+    }
+    
+    char buffer[4096];
+    for (;;) {
+        // 先确认响应已经收全，再完整解析一次
+        size_t length = 0;
+        int ret = scanner_.Scan(read_buffer_.data(), read_buffer_.size(), &length);
+        if (ret > 0) {
+            size_t consumed = 0;
+            ret = ProtocolParser::ParseRespReply(read_buffer_.data(), length, reply, &consumed) > 0 ? 1 : -1;
+        }
+        if (ret > 0) {
+            read_buffer_.erase(0, length);
+            return true;
+        }
+        if (ret < 0) {
+            std::cerr << "[Connection] 响应格式错误" << std::endl;
+            disconnect();
+            return false;
+        }
+        
+        // 数据不完整，继续读取（socket已设置接收超时）
+        ssize_t received = read(sockfd_, buffer, sizeof(buffer));
+        if (received > 0) {
+            read_buffer_.append(buffer, static_cast<size_t>(received));
+        } else if (received == 0) {
+            disconnect();  // 连接关闭
+            return false;
+        } else {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                std::cout << "[Connection] 接收超时" << std::endl;
+            } else {
+                std::cerr << "[Connection] 接收失败: " << strerror(errno) << std::endl;
+            }
+            disconnect();
+            return false;
+        }
+    }
+}
+
 bool Connection::isConnected() const {
     return connected_;
 }
+
+bool Connection::isAlive() {
+    if (!connected_) {
+        return false;
+    }
+    if (!read_buffer_.empty()) {
+        // 有上一条命令残留的数据，后续响应会错位
+        disconnect();
+        return false;
+    }
+    
+    char byte;
+    ssize_t n = recv(sockfd_, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return true;
+    }
+    disconnect();
+    return false;
+}
@@ -1,7 +1,9 @@
 #ifndef CONNECTION_H
 #define CONNECTION_H
 
+#include "common/protocol.h"
 #include <string>
+#include <vector>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
@@ -17,6 +19,12 @@ public:
     // 连接服务器
     bool connect();
     
+    // 非阻塞地发起连接，供事件循环使用：立即返回，socket保持非阻塞。
+    // 连接仍在进行时*in_progress为true，等socket可写后调用finishConnect确认结果
+    bool startConnect(bool* in_progress);
+    // 检查非阻塞连接的结果（SO_ERROR），失败时关闭socket
+    bool finishConnect();
+    
     // 断开连接
     void disconnect();
     
@@ -26,14 +34,31 @@ public:
     // 接收数据
     std::string receive();
     
+    // 以RESP格式发送一条命令，参数可以包含任意字节
+    bool sendCommand(const std::vector<std::string>& args);
+    
+    // 接收一个完整的RESP响应，超时或连接出错时返回false
+    bool receiveReply(RespReply* reply);
+    
     // 是否已连接
     bool isConnected() const;
     
+    // 底层socket，未连接时为-1；异步客户端连接成功后改为非阻塞，由事件循环直接读写
+    int fd() const { return sockfd_; }
+    
+    // 复用空闲连接前的健康检查：不阻塞地看一眼socket，对端已关闭、出错，
+    // 或者收到了不属于任何请求的数据时返回false
+    bool isAlive();
+    
 private:
     std::string host_;
     int port_;
     int sockfd_;
     bool connected_;
+    // 已收到但还没解析完的响应数据
+    std::string read_buffer_;
+    // 大响应分多次收到时记住已检查的位置，不必每次从头重新解析
+    RespScanner scanner_;
     
     // 创建socket
     bool createSocket();
@@ -0,0 +1,137 @@
+#include "connection_pool.h"
+#include <utility>
+
+ConnectionPool::Lease::Lease(Lease&& other) noexcept
+    : pool_(other.pool_), address_(std::move(other.address_)),
+      connection_(std::move(other.connection_)), reusable_(other.reusable_) {
+    other.pool_ = nullptr;
+}
+
+ConnectionPool::Lease& ConnectionPool::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        release();
+        pool_ = other.pool_;
+        address_ = std::move(other.address_);
+        connection_ = std::move(other.connection_);
+        reusable_ = other.reusable_;
+        other.pool_ = nullptr;
+    }
+    return *this;
+}
+
+ConnectionPool::Lease::~Lease() {
+    release();
+}
+
+void ConnectionPool::Lease::release() {
+    if (pool_ && connection_) {
+        pool_->release(address_, std::move(connection_), reusable_);
+    }
+    pool_ = nullptr;
+}
+
+ConnectionPool::ConnectionPool(const PoolOptions& options) : options_(options) {
+    if (options_.max_per_node == 0) {
+        options_.max_per_node = 1;
+    }
+}
+
+void ConnectionPool::dropExpiredLocked(NodePool* pool, std::deque<IdleConnection>* expired) {
+    Clock::time_point deadline = Clock::now() - std::chrono::milliseconds(options_.idle_timeout_ms);
+    while (!pool->idle.empty() && pool->idle.front().released <= deadline) {
+        expired->push_back(std::move(pool->idle.front()));
+        pool->idle.pop_front();
+        stats_.dropped++;
+    }
+}
+
+ConnectionPool::Lease ConnectionPool::acquire(const NodeInfo& node) {
+    const std::string address = node.address();
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(options_.acquire_timeout_ms);
+    std::unique_lock<std::mutex> lock(mutex_);
+    // unordered_map的rehash不会使元素的引用失效
+    NodePool& pool = nodes_[address];
+    for (;;) {
+        std::deque<IdleConnection> expired;
+        dropExpiredLocked(&pool, &expired);
+        if (!pool.idle.empty()) {
+            std::unique_ptr<Connection> connection = std::move(pool.idle.back().connection);
+            pool.idle.pop_back();
+            pool.in_use++;
+            lock.unlock();
+            expired.clear();
+            // 服务器重启或关闭了空闲连接时，在发命令之前就发现，而不是等到读响应失败
+            if (connection->isAlive()) {
+                std::lock_guard<std::mutex> stats_lock(mutex_);
+                stats_.reused++;
+                return Lease(this, address, std::move(connection));
+            }
+            connection.reset();
+            lock.lock();
+            pool.in_use--;
+            stats_.dropped++;
+            continue;
+        }
+        if (pool.in_use < options_.max_per_node) {
+            pool.in_use++;
+            lock.unlock();
+            expired.clear();
+            std::unique_ptr<Connection> connection(new Connection(node.host, node.port));
+            bool connected = connection->connect();
+            lock.lock();
+            if (connected) {
+                stats_.created++;
+                lock.unlock();
+                return Lease(this, address, std::move(connection));
+            }
+            pool.in_use--;
+            available_.notify_all();
+            return Lease();
+        }
+        // 连接数已满，等其他调用者归还
+        if (available_.wait_until(lock, deadline) == std::cv_status::timeout &&
+            pool.idle.empty() && pool.in_use >= options_.max_per_node) {
+            return Lease();
+        }
+    }
+}
+
+void ConnectionPool::release(const std::string& address, std::unique_ptr<Connection> connection, bool reusable) {
+    std::deque<IdleConnection> expired;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        NodePool& pool = nodes_[address];
+        pool.in_use--;
+        if (reusable && connection->isConnected()) {
+            pool.idle.push_back(IdleConnection{std::move(connection), Clock::now()});
+        }
+        dropExpiredLocked(&pool, &expired);
+    }
+    available_.notify_all();
+    // 不再复用的连接在这里（锁外）关闭
+}
+
+void ConnectionPool::clear() {
+    std::deque<IdleConnection> closing;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& entry : nodes_) {
+            for (auto& idle : entry.second.idle) {
+                closing.push_back(std::move(idle));
+            }
+            entry.second.idle.clear();
+        }
+    }
+    available_.notify_all();
+}
+
+size_t ConnectionPool::idleCount(const std::string& address) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = nodes_.find(address);
+    return it == nodes_.end() ? 0 : it->second.idle.size();
+}
+
+PoolStats ConnectionPool::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
@@ -0,0 +1,102 @@
+#ifndef CONNECTION_POOL_H
+#define CONNECTION_POOL_H
+
+#include "connection.h"
+#include "cluster_config.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+struct PoolOptions {
+    // 每个节点最多同时打开的连接数（借出的加空闲的）
+    size_t max_per_node = 8;
+    // 空闲超过这个时间的连接在下次访问该节点时关闭
+    int idle_timeout_ms = 60000;
+    // 连接数已满时等待其他线程归还的最长时间
+    int acquire_timeout_ms = 3000;
+};
+
+struct PoolStats {
+    size_t created = 0;   // 新建立的连接
+    size_t reused = 0;    // 复用空闲连接的次数
+    size_t dropped = 0;   // 因空闲超时或健康检查失败关闭的空闲连接
+};
+
+// 按节点地址缓存已建立的连接，命令之间、线程之间复用，避免每条命令都重新握手。
+// 可以被多个线程、多个KVClient共享；借出的连接同一时刻只属于一个调用者
+class ConnectionPool {
+public:
+    // 借出的连接，析构时归还给连接池。命令执行失败、连接状态不确定时
+    // 调用invalidate()，归还时直接关闭而不放回空闲列表。不能比连接池活得更久
+    class Lease {
+    public:
+        Lease() : pool_(nullptr), reusable_(false) {}
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        ~Lease();
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        explicit operator bool() const { return connection_ != nullptr; }
+        Connection* operator->() const { return connection_.get(); }
+        Connection* get() const { return connection_.get(); }
+
+        void invalidate() { reusable_ = false; }
+
+    private:
+        friend class ConnectionPool;
+        Lease(ConnectionPool* pool, const std::string& address, std::unique_ptr<Connection> connection)
+            : pool_(pool), address_(address), connection_(std::move(connection)), reusable_(true) {}
+
+        void release();
+
+        ConnectionPool* pool_;
+        std::string address_;
+        std::unique_ptr<Connection> connection_;
+        bool reusable_;
+    };
+
+    explicit ConnectionPool(const PoolOptions& options = PoolOptions());
+
+    // 取一个到node的连接：优先复用最近归还的空闲连接（复用前检查对端是否已关闭），
+    // 没有时在上限内新建；连接失败或等待超时返回空的Lease
+    Lease acquire(const NodeInfo& node);
+
+    // 关闭所有空闲连接，借出的连接归还时照常处理
+    void clear();
+
+    size_t idleCount(const std::string& address) const;
+    PoolStats getStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct IdleConnection {
+        std::unique_ptr<Connection> connection;
+        Clock::time_point released;
+    };
+
+    struct NodePool {
+        // 按归还时间排序，队尾最新；借出时取队尾，让少数连接保持活跃，多余的自然超时
+        std::deque<IdleConnection> idle;
+        size_t in_use = 0;
+    };
+
+    void release(const std::string& address, std::unique_ptr<Connection> connection, bool reusable);
+    // 把超时的空闲连接移到expired，由调用者在释放锁之后关闭
+    void dropExpiredLocked(NodePool* pool, std::deque<IdleConnection>* expired);
+
+    PoolOptions options_;
+    mutable std::mutex mutex_;
+    std::condition_variable available_;
+    std::unordered_map<std::string, NodePool> nodes_;
+    PoolStats stats_;
+};
+
+#endif
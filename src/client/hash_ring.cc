@@ -0,0 +1,48 @@
+#include "hash_ring.h"
+#include "../common/utils.h"
+#include <algorithm>
+
+const int HashRing::kDefaultVirtualNodes;
+
+uint64_t HashRing::hash(std::string_view data) {
+    return utils::KeyHash(data);
+}
+
+void HashRing::build(const std::vector<std::pair<std::string, int>>& members, int virtual_nodes) {
+    if (virtual_nodes <= 0) {
+        virtual_nodes = kDefaultVirtualNodes;
+    }
+    std::vector<std::pair<uint64_t, uint32_t>> points;
+    for (size_t m = 0; m < members.size(); m++) {
+        int count = virtual_nodes * std::max(members[m].second, 1);
+        for (int i = 0; i < count; i++) {
+            points.emplace_back(hash(members[m].first + "#" + std::to_string(i)), static_cast<uint32_t>(m));
+        }
+    }
+    // 哈希值相同时按成员下标排序，保证结果确定
+    std::sort(points.begin(), points.end());
+
+    points_.clear();
+    owners_.clear();
+    points_.reserve(points.size());
+    owners_.reserve(points.size());
+    for (const auto& point : points) {
+        points_.push_back(point.first);
+        owners_.push_back(point.second);
+    }
+}
+
+size_t HashRing::pointForHash(uint64_t key_hash) const {
+    auto it = std::lower_bound(points_.begin(), points_.end(), key_hash);
+    if (it == points_.end()) {
+        it = points_.begin();  // 回绕到环的起点
+    }
+    return static_cast<size_t>(it - points_.begin());
+}
+
+size_t HashRing::nodeIndexForHash(uint64_t key_hash) const {
+    if (points_.empty()) {
+        return 0;
+    }
+    return owners_[pointForHash(key_hash)];
+}
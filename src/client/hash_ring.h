@@ -0,0 +1,63 @@
+#ifndef HASH_RING_H
+#define HASH_RING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// 一致性哈希环：每个节点按权重在环上放若干个虚拟节点，key归属顺时针方向的第一个虚拟节点。
+// 增加或删除一个节点时，只有落在它的虚拟节点上的key改变归属，约占1/N，
+// 而哈希取模会让大约(N-1)/N的key换节点。
+// 环存成按哈希值排序的连续数组，查找是一次二分查找
+class HashRing {
+public:
+    static const int kDefaultVirtualNodes = 160;
+
+    // members: (节点id, 权重)，虚拟节点数为virtual_nodes * 权重。虚拟节点的位置只由节点id决定，
+    // 与成员顺序无关，各客户端按相同的成员列表构建出相同的环。nodeIndex返回成员在members中的下标
+    void build(const std::vector<std::pair<std::string, int>>& members, int virtual_nodes);
+
+    // 环为空时返回0，调用者需要先确认有节点
+    size_t nodeIndex(std::string_view key) const { return nodeIndexForHash(hash(key)); }
+    // 已经算好hash(key)时直接用哈希值查找，避免重复哈希
+    size_t nodeIndexForHash(uint64_t key_hash) const;
+    // 从key_hash的位置顺时针找第一个usable(成员下标)为true的虚拟节点，返回它所属的成员下标；
+    // 没有这样的虚拟节点时返回nodeIndexForHash(key_hash)
+    template <typename Usable>
+    size_t nodeIndexForHash(uint64_t key_hash, Usable usable) const;
+
+    bool empty() const { return points_.empty(); }
+    size_t pointCount() const { return points_.size(); }
+
+    // 即utils::KeyHash，各客户端、各进程对同一个key得到相同的位置
+    static uint64_t hash(std::string_view data);
+
+private:
+    // key_hash顺时针方向第一个虚拟节点在points_中的下标，环不能为空
+    size_t pointForHash(uint64_t key_hash) const;
+
+    // points_[i]是第i个虚拟节点的哈希值（升序），owners_[i]是它所属的成员下标。
+    // 分开存放，二分查找只访问紧凑的哈希数组
+    std::vector<uint64_t> points_;
+    std::vector<uint32_t> owners_;
+};
+
+template <typename Usable>
+size_t HashRing::nodeIndexForHash(uint64_t key_hash, Usable usable) const {
+    if (points_.empty()) {
+        return 0;
+    }
+    size_t start = pointForHash(key_hash);
+    for (size_t i = 0; i < points_.size(); i++) {
+        size_t point = start + i < points_.size() ? start + i : start + i - points_.size();
+        if (usable(static_cast<size_t>(owners_[point]))) {
+            return owners_[point];
+        }
+    }
+    return owners_[start];
+}
+
+#endif
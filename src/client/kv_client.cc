@@ -1,49 +1,71 @@
 #include "kv_client.h"
+#include "../common/logger.h"
 #include <iostream>
 #include <sstream>
+#include <utility>
 #include <vector>
 
-KVClient::KVClient() {
+KVClient::KVClient(std::shared_ptr<ConnectionPool> pool) : pool_(std::move(pool)) {
     router_.reset(new Router());  // 使用 new 而不是 make_unique
+    if (!pool_) {
+        pool_ = std::make_shared<ConnectionPool>();
+    }
     std::cout << "[KVClient] 客户端初始化完成" << std::endl;
 }
 
-KVClient::~KVClient() {
-    if (current_connection_ && current_connection_->isConnected()) {
-        current_connection_->disconnect();
-    }
+KVClient::~KVClient() {}
+
+namespace {
+
+RespReply ErrorReply(const std::string& message) {
+    RespReply reply;
+    reply.type = RespReply::ERROR;
+    reply.str = message;
+    return reply;
 }
 
-bool KVClient::connectToNode(const NodeInfo& node) {
-    if (current_connection_ && current_connection_->isConnected()) {
-        current_connection_->disconnect();
+// 用于日志输出
+std::string describeReply(const RespReply& reply) {
+    switch (reply.type) {
+        case RespReply::STATUS: return reply.str;
+        case RespReply::ERROR: return "(error) " + reply.str;
+        case RespReply::INTEGER: return "(integer) " + std::to_string(reply.integer);
+        case RespReply::BULK: return "\"" + reply.str + "\"";
+        case RespReply::NIL: return "(nil)";
+        case RespReply::ARRAY: return "(array of " + std::to_string(reply.elements.size()) + ")";
     }
-    
-    current_connection_.reset(new Connection(node.host, node.port));
-    return current_connection_->connect();
+    return "";
 }
 
-std::string KVClient::executeCommand(const std::string& command) {
-    if (!current_connection_ || !current_connection_->isConnected()) {
+}  // namespace
+
+RespReply KVClient::executeCommand(Connection* connection, const std::vector<std::string>& args) {
+    if (!connection || !connection->isConnected()) {
         throw std::runtime_error("未连接到服务器");
     }
     
-    if (!current_connection_->send(command + "\n")) {
+    if (!connection->sendCommand(args)) {
         throw std::runtime_error("发送命令失败");
     }
     
-    std::string response = current_connection_->receive();
-    return response;
+    RespReply reply;
+    if (!connection->receiveReply(&reply)) {
+        throw std::runtime_error("接收响应失败");
+    }
+    return reply;
 }
 
-std::string KVClient::executeWithRetry(const std::string& command, const std::string& key, int max_retries) {
+RespReply KVClient::executeWithRetry(const std::vector<std::string>& args, const std::string& key, int max_retries) {
     for (int attempt = 1; attempt <= max_retries; attempt++) {
+        ConnectionPool::Lease connection;
         try {
             // 获取目标节点
-            NodeInfo target_node = router_->route(key);
+            std::shared_ptr<const NodeInfo> target = router_->route(key);
+            const NodeInfo& target_node = *target;
             
-            // 连接到节点
-            if (!connectToNode(target_node)) {
+            // 从连接池取一个到该节点的连接，没有空闲连接时才新建
+            connection = pool_->acquire(target_node);
+            if (!connection) {
                 std::cerr << "[KVClient] 第 " << attempt << " 次尝试: 连接失败" << std::endl;
                 
                 // 标记节点为不健康
@@ -53,15 +75,17 @@ std::string KVClient::executeWithRetry(const std::string& command, const std::st
                 if (attempt < max_retries) {
                     continue;
                 }
-                return "ERROR Connection failed";
+                return ErrorReply("Connection failed");
             }
             
             // 执行命令
-            std::string response = executeCommand(command);
-            std::cout << "[KVClient] 服务器响应: " << response << std::endl;
-            return response;
+            RespReply reply = executeCommand(connection.get(), args);
+            LOG_DEBUG("[KVClient] 服务器响应: " + describeReply(reply));
+            return reply;
             
         } catch (const std::exception& e) {
+            // 请求可能已经发出一半，连接上的数据不再可信，不放回连接池
+            connection.invalidate();
             std::cerr << "[KVClient] 第 " << attempt << " 次尝试失败: " << e.what() << std::endl;
             
             if (attempt < max_retries) {
@@ -70,64 +94,268 @@ std::string KVClient::executeWithRetry(const std::string& command, const std::st
         }
     }
     
-    return "ERROR Max retries exceeded";
+    return ErrorReply("Max retries exceeded");
 }
 
 bool KVClient::put(const std::string& key, const std::string& value) {
-    std::string command = "PUT " + key + " " + value;
-    std::string response = executeWithRetry(command, key);
+    // 服务器没有PUT命令，写入用SET
+    RespReply reply = executeWithRetry({"SET", key, value}, key);
     
-    if (response.find("OK") != std::string::npos || 
-        response.find("SUCCESS") != std::string::npos) {
-        std::cout << "✅ SET 成功: " << key << " = " << value << std::endl;
+    if (reply.type == RespReply::STATUS) {
+        LOG_DEBUG("[KVClient] SET 成功: " + key);
         return true;
     } else {
-        std::cout << "❌ SET 失败" << std::endl;
+        LOG_DEBUG("[KVClient] SET 失败: " + key);
         return false;
     }
 }
 
 std::string KVClient::get(const std::string& key) {
-    std::string command = "GET " + key;
-    std::string response = executeWithRetry(command, key);
+    RespReply reply = executeWithRetry({"GET", key}, key);
     
-    if (response.find("ERROR") != std::string::npos) {
-        std::cout << "键 '" << key << "' 不存在" << std::endl;
+    if (reply.type != RespReply::BULK) {
+        LOG_DEBUG("[KVClient] 键 '" + key + "' 不存在");
         return "";
     }
     
-    // 解析响应，提取值
-    size_t space_pos = response.find(' ');
-    if (space_pos != std::string::npos) {
-        return response.substr(space_pos + 1);
-    }
-    
-    return response;
+    return reply.str;
 }
 
 bool KVClient::del(const std::string& key) {
-    std::string command = "DEL " + key;
-    std::string response = executeWithRetry(command, key);
+    RespReply reply = executeWithRetry({"DEL", key}, key);
     
-    if (response.find("OK") != std::string::npos || 
-        response.find("SUCCESS") != std::string::npos) {
-        std::cout << "✅ DELETE 成功: " << key << std::endl;
+    if (reply.type == RespReply::INTEGER && reply.integer > 0) {
+        LOG_DEBUG("[KVClient] DELETE 成功: " + key);
         return true;
     } else {
-        std::cout << "❌ DELETE 失败" << std::endl;
+        LOG_DEBUG("[KVClient] DELETE 失败: " + key);
         return false;
     }
 }
 
-bool KVClient::batchPut(const std::vector<std::pair<std::string, std::string>>& kvs) {
-    bool all_success = true;
+void KVClient::scatterGather(const std::vector<NodeInfo>& nodes, const std::vector<std::string>& requests,
+                             const std::vector<size_t>& reply_counts, std::vector<std::vector<RespReply>>* replies,
+                             std::vector<std::string>* errors) {
+    replies->assign(nodes.size(), std::vector<RespReply>());
+    errors->assign(nodes.size(), std::string());
+    std::vector<ConnectionPool::Lease> connections(nodes.size());
+    
+    // 先把所有节点的请求都发出去，各节点同时处理，总耗时接近最慢的一个节点的一次往返
+    for (size_t n = 0; n < nodes.size(); n++) {
+        if (requests[n].empty()) {
+            continue;
+        }
+        connections[n] = pool_->acquire(nodes[n]);
+        if (!connections[n]) {
+            (*errors)[n] = "Connection failed";
+            router_->markNodeUnhealthy(nodes[n].id);
+        } else if (!connections[n]->send(requests[n])) {
+            (*errors)[n] = "Send failed";
+            connections[n].invalidate();
+        }
+    }
     
-    for (const auto& kv : kvs) {
-        if (!put(kv.first, kv.second)) {
-            all_success = false;
+    for (size_t n = 0; n < nodes.size(); n++) {
+        if (requests[n].empty() || !(*errors)[n].empty()) {
+            continue;
+        }
+        (*replies)[n].resize(reply_counts[n]);
+        for (RespReply& reply : (*replies)[n]) {
+            if (!connections[n]->receiveReply(&reply)) {
+                (*errors)[n] = "Receive failed";
+                connections[n].invalidate();
+                break;
+            }
+        }
+    }
+}
+
+template <typename KeyAt>
+bool KVClient::groupByNode(const ClusterConfig::Table& table, size_t count, KeyAt key_at,
+                           std::vector<std::vector<size_t>>* groups) {
+    groups->assign(table.nodes.size(), std::vector<size_t>());
+    try {
+        for (size_t i = 0; i < count; i++) {
+            (*groups)[table.routeIndex(key_at(i))].push_back(i);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "[KVClient] 路由失败: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+namespace {
+
+void failKeys(const std::vector<size_t>& indices, const std::string& error, std::vector<KeyResult>* results) {
+    for (size_t i : indices) {
+        (*results)[i].ok = false;
+        (*results)[i].error = error;
+    }
+}
+
+}  // namespace
+
+std::vector<KeyResult> KVClient::batchGet(const std::vector<std::string>& keys) {
+    std::vector<KeyResult> results(keys.size());
+    // 整批只取一次节点表，分组用的下标和发送的节点出自同一张表
+    std::shared_ptr<const ClusterConfig::Table> table = router_->snapshot();
+    const std::vector<NodeInfo>& nodes = table->nodes;
+    std::vector<std::vector<size_t>> groups;
+    if (!groupByNode(*table, keys.size(), [&keys](size_t i) -> const std::string& { return keys[i]; }, &groups)) {
+        for (KeyResult& result : results) {
+            result.error = "No node for key";
+        }
+        return results;
+    }
+    
+    // 每个节点一条MGET
+    std::vector<std::string> requests(nodes.size());
+    std::vector<size_t> reply_counts(nodes.size(), 1);
+    for (size_t n = 0; n < nodes.size(); n++) {
+        if (groups[n].empty()) {
+            continue;
+        }
+        std::vector<std::string> args;
+        args.reserve(groups[n].size() + 1);
+        args.push_back("MGET");
+        for (size_t i : groups[n]) {
+            args.push_back(keys[i]);
         }
+        requests[n] = ProtocolParser::EncodeRespCommand(args);
     }
+    std::vector<std::vector<RespReply>> replies;
+    std::vector<std::string> errors;
+    scatterGather(nodes, requests, reply_counts, &replies, &errors);
     
+    // 拒绝MGET的节点（如分片模式的服务器）改为逐条GET，一次写出整组
+    std::vector<std::string> fallback(nodes.size());
+    for (size_t n = 0; n < nodes.size(); n++) {
+        if (groups[n].empty()) {
+            continue;
+        }
+        if (!errors[n].empty()) {
+            failKeys(groups[n], errors[n], &results);
+            continue;
+        }
+        RespReply& reply = replies[n][0];
+        if (reply.type == RespReply::ARRAY && reply.elements.size() == groups[n].size()) {
+            for (size_t j = 0; j < groups[n].size(); j++) {
+                KeyResult& result = results[groups[n][j]];
+                result.ok = true;
+                result.found = reply.elements[j].type == RespReply::BULK;
+                result.value = std::move(reply.elements[j].str);
+            }
+        } else if (reply.type == RespReply::ERROR) {
+            for (size_t i : groups[n]) {
+                ProtocolParser::AppendRespCommand({"GET", keys[i]}, &fallback[n]);
+            }
+            reply_counts[n] = groups[n].size();
+        } else {
+            failKeys(groups[n], "Unexpected reply", &results);
+        }
+    }
+    scatterGather(nodes, fallback, reply_counts, &replies, &errors);
+    for (size_t n = 0; n < nodes.size(); n++) {
+        if (fallback[n].empty()) {
+            continue;
+        }
+        if (!errors[n].empty()) {
+            failKeys(groups[n], errors[n], &results);
+            continue;
+        }
+        for (size_t j = 0; j < groups[n].size(); j++) {
+            RespReply& reply = replies[n][j];
+            KeyResult& result = results[groups[n][j]];
+            result.ok = reply.type == RespReply::BULK || reply.type == RespReply::NIL;
+            result.found = reply.type == RespReply::BULK;
+            (result.ok ? result.value : result.error) = std::move(reply.str);
+        }
+    }
+    
+    LOG_DEBUG("[KVClient] 批量GET " + std::to_string(keys.size()) + " 个键");
+    return results;
+}
+
+bool KVClient::batchPut(const std::vector<std::pair<std::string, std::string>>& kvs,
+                        std::vector<KeyResult>* results) {
+    std::vector<KeyResult> local;
+    if (!results) {
+        results = &local;
+    }
+    results->assign(kvs.size(), KeyResult());
+    std::shared_ptr<const ClusterConfig::Table> table = router_->snapshot();
+    const std::vector<NodeInfo>& nodes = table->nodes;
+    std::vector<std::vector<size_t>> groups;
+    if (!groupByNode(*table, kvs.size(), [&kvs](size_t i) -> const std::string& { return kvs[i].first; },
+                     &groups)) {
+        for (KeyResult& result : *results) {
+            result.error = "No node for key";
+        }
+        return false;
+    }
+    
+    // 每个节点一条MSET
+    std::vector<std::string> requests(nodes.size());
+    std::vector<size_t> reply_counts(nodes.size(), 1);
+    for (size_t n = 0; n < nodes.size(); n++) {
+        if (groups[n].empty()) {
+            continue;
+        }
+        std::vector<std::string> args;
+        args.reserve(groups[n].size() * 2 + 1);
+        args.push_back("MSET");
+        for (size_t i : groups[n]) {
+            args.push_back(kvs[i].first);
+            args.push_back(kvs[i].second);
+        }
+        requests[n] = ProtocolParser::EncodeRespCommand(args);
+    }
+    std::vector<std::vector<RespReply>> replies;
+    std::vector<std::string> errors;
+    scatterGather(nodes, requests, reply_counts, &replies, &errors);
+    
+    // 拒绝MSET的节点改为逐条SET，每个key得到各自的结果；
+    // MSET中途失败时前面的key可能已经写入，重新写一遍结果相同
+    std::vector<std::string> fallback(nodes.size());
+    for (size_t n = 0; n < nodes.size(); n++) {
+        if (groups[n].empty()) {
+            continue;
+        }
+        if (!errors[n].empty()) {
+            failKeys(groups[n], errors[n], results);
+        } else if (replies[n][0].type == RespReply::STATUS) {
+            for (size_t i : groups[n]) {
+                (*results)[i].ok = true;
+            }
+        } else {
+            for (size_t i : groups[n]) {
+                ProtocolParser::AppendRespCommand({"SET", kvs[i].first, kvs[i].second}, &fallback[n]);
+            }
+            reply_counts[n] = groups[n].size();
+        }
+    }
+    scatterGather(nodes, fallback, reply_counts, &replies, &errors);
+    for (size_t n = 0; n < nodes.size(); n++) {
+        if (fallback[n].empty()) {
+            continue;
+        }
+        if (!errors[n].empty()) {
+            failKeys(groups[n], errors[n], results);
+            continue;
+        }
+        for (size_t j = 0; j < groups[n].size(); j++) {
+            KeyResult& result = (*results)[groups[n][j]];
+            result.ok = replies[n][j].type == RespReply::STATUS;
+            result.error = result.ok ? "" : replies[n][j].str;
+        }
+    }
+    
+    bool all_success = true;
+    for (const KeyResult& result : *results) {
+        all_success = all_success && result.ok;
+    }
+    LOG_DEBUG("[KVClient] 批量SET " + std::to_string(kvs.size()) + " 个键" + (all_success ? "成功" : "部分失败"));
     return all_success;
 }
 
@@ -139,10 +367,10 @@ bool KVClient::ping() {
             return false;
         }
         
-        if (connectToNode(nodes[0])) {
-            std::string response = executeCommand("PING");
-            return response.find("PONG") != std::string::npos || 
-                   response.find("OK") != std::string::npos;
+        ConnectionPool::Lease connection = pool_->acquire(nodes[0]);
+        if (connection) {
+            RespReply reply = executeCommand(connection.get(), {"PING"});
+            return reply.type == RespReply::STATUS && reply.str == "PONG";
         }
     } catch (...) {
         // 忽略异常
@@ -1,15 +1,27 @@
 #ifndef KV_CLIENT_H
 #define KV_CLIENT_H
 
-#include "connection.h"
+#include "connection_pool.h"
 #include "router.h"
 #include "common/protocol.h"
 #include <string>
 #include <memory>
+#include <vector>
+
+// 批量操作中单个key的结果
+struct KeyResult {
+    // 请求成功完成；GET的key不存在也算成功，此时found为false
+    bool ok = false;
+    bool found = false;
+    std::string value;
+    // 失败原因（连接失败、服务器返回的错误等）
+    std::string error;
+};
 
 class KVClient {
 public:
-    KVClient();
+    // pool为空时使用自己独占的连接池；多个客户端可以共享同一个连接池
+    explicit KVClient(std::shared_ptr<ConnectionPool> pool = nullptr);
     ~KVClient();
     
     // 基本操作
@@ -17,24 +29,40 @@ public:
     std::string get(const std::string& key);
     bool del(const std::string& key);
     
-    // 批量操作
-    bool batchPut(const std::vector<std::pair<std::string, std::string>>& kvs);
+    // 批量操作：按所属节点分组，每个节点一条MGET/MSET（服务器不支持时退回逐条命令的流水线），
+    // 所有节点的请求先全部发出再读取响应，整批大约只需要一次往返。
+    // 结果与参数顺序一一对应，某个节点失败只影响该节点上的key，不重试
+    std::vector<KeyResult> batchGet(const std::vector<std::string>& keys);
+    // 全部成功时返回true；results不为空时填入每个key的结果
+    bool batchPut(const std::vector<std::pair<std::string, std::string>>& kvs,
+                  std::vector<KeyResult>* results = nullptr);
     
     // 测试连接
     bool ping();
     
 private:
     std::unique_ptr<Router> router_;
-    std::unique_ptr<Connection> current_connection_;
+    // 每个节点的连接在命令之间保持，不再每条命令重新建连
+    std::shared_ptr<ConnectionPool> pool_;
+    
+    // 在借来的连接上执行命令（RESP格式，key和value可以包含空格等任意字节）
+    RespReply executeCommand(Connection* connection, const std::vector<std::string>& args);
     
-    // 连接到指定节点
-    bool connectToNode(const NodeInfo& node);
+    // 重试机制，全部失败时返回ERROR类型的响应
+    RespReply executeWithRetry(const std::vector<std::string>& args, const std::string& key, int max_retries = 3);
     
-    // 执行命令
-    std::string executeCommand(const std::string& command);
+    // 把requests[n]（已编码的一条或多条命令）发给第n个节点，全部发出后再依次读取
+    // reply_counts[n]个响应到(*replies)[n]；requests[n]为空的节点跳过。
+    // 节点失败时(*errors)[n]为失败原因
+    void scatterGather(const std::vector<NodeInfo>& nodes, const std::vector<std::string>& requests,
+                       const std::vector<size_t>& reply_counts, std::vector<std::vector<RespReply>>* replies,
+                       std::vector<std::string>* errors);
     
-    // 重试机制
-    std::string executeWithRetry(const std::string& command, const std::string& key, int max_retries = 3);
+    // 按table->routeIndex分组（与单key操作的路由一致），返回每个节点上的key在参数中的下标；
+    // 路由失败时返回false
+    template <typename KeyAt>
+    bool groupByNode(const ClusterConfig::Table& table, size_t count, KeyAt key_at,
+                     std::vector<std::vector<size_t>>* groups);
 };
 
 #endif
@@ -1,24 +1,29 @@
 #include "router.h"
+#include "../common/utils.h"
 #include <iostream>
-#include <functional>
+#include <utility>
 
 Router::Router() : config_(ClusterConfig::getInstance()) {
     std::cout << "[Router] 路由器初始化完成" << std::endl;
 }
 
-uint32_t Router::hash(const std::string& key) {
-    std::hash<std::string> hash_fn;
-    return static_cast<uint32_t>(hash_fn(key));
+uint64_t Router::hash(std::string_view key) {
+    return utils::KeyHash(key);
 }
 
-NodeInfo Router::route(const std::string& key) {
-    uint32_t hash_value = hash(key);
-    auto target_node = config_.getNodeByKey(key);
-    
-    std::cout << "[Router] 键 '" << key << "' 哈希值: " << hash_value 
-              << " -> " << target_node.id << " (" << target_node.address() << ")" << std::endl;
-    
-    return target_node;
+std::shared_ptr<const NodeInfo> Router::route(std::string_view key) {
+    std::shared_ptr<const ClusterConfig::Table> table = config_.snapshot();
+    const NodeInfo* node = &table->nodes[table->routeIndex(key)];
+    // 别名构造，与节点表共用控制块，不另外分配
+    return std::shared_ptr<const NodeInfo>(std::move(table), node);
+}
+
+size_t Router::nodeIndex(std::string_view key) {
+    return config_.getNodeIndex(key);
+}
+
+std::shared_ptr<const ClusterConfig::Table> Router::snapshot() {
+    return config_.snapshot();
 }
 
 std::vector<NodeInfo> Router::getAllNodes() {
@@ -3,17 +3,26 @@
 
 #include "cluster_config.h"
 #include <string>
+#include <string_view>
 #include <memory>
 
 class Router {
 public:
     Router();
     
-    // 路由key到对应的节点
-    NodeInfo route(const std::string& key);
+    // 路由key到对应的节点，所属节点被标记为不健康时改用下一个健康节点。
+    // 只哈希一次，不复制节点信息，不分配内存也不输出日志；返回的指针与节点表共享引用计数，
+    // 重新加载集群配置后仍然有效
+    std::shared_ptr<const NodeInfo> route(std::string_view key);
     
-    // 计算key的哈希值
-    uint32_t hash(const std::string& key);
+    // key所属节点在getAllNodes()中的下标，不考虑健康状态
+    size_t nodeIndex(std::string_view key);
+    
+    // 当前的节点表。批量操作在同一张表上分组和发送，与route()一样跳过不健康的节点
+    std::shared_ptr<const ClusterConfig::Table> snapshot();
+    
+    // 计算key的哈希值（utils::KeyHash，与服务器选分片的哈希相同）
+    uint64_t hash(std::string_view key);
     
     // 获取所有节点
     std::vector<NodeInfo> getAllNodes();
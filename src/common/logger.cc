@@ -7,8 +7,11 @@ Logger& Logger::instance() {
 }
 
 void Logger::set_level(LogLevel level) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    level_ = level;
+    level_.store(level, std::memory_order_relaxed);
+}
+
+LogLevel Logger::get_level() const {
+    return level_.load(std::memory_order_relaxed);
 }
 
 void Logger::log(const std::string& level_str, const std::string& message, 
@@ -20,25 +23,25 @@ void Logger::log(const std::string& level_str, const std::string& message,
 }
 
 void Logger::debug(const std::string& message, const std::string& file, int line) {
-    if (level_ <= DEBUG) {
+    if (enabled(DEBUG)) {
         log("DEBUG", message, file, line);
     }
 }
 
 void Logger::info(const std::string& message, const std::string& file, int line) {
-    if (level_ <= INFO) {
+    if (enabled(INFO)) {
         log("INFO", message, file, line);
     }
 }
 
 void Logger::warning(const std::string& message, const std::string& file, int line) {
-    if (level_ <= WARNING) {
+    if (enabled(WARNING)) {
         log("WARNING", message, file, line);
     }
 }
 
 void Logger::error(const std::string& message, const std::string& file, int line) {
-    if (level_ <= ERROR) {
+    if (enabled(ERROR)) {
         log("ERROR", message, file, line);
     }
 }
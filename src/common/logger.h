@@ -2,6 +2,7 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
+#include <atomic>
 #include <string>
 #include <iostream>
 #include <mutex>
@@ -19,6 +20,8 @@ public:
     
     void set_level(LogLevel level);
     LogLevel get_level() const;
+    // 日志宏先用它判断级别，被过滤掉的日志不拼接消息，热路径上的调试日志没有开销
+    bool enabled(LogLevel level) const { return level >= level_.load(std::memory_order_relaxed); }
     
     void debug(const std::string& message, const std::string& file = "", int line = 0);
     void info(const std::string& message, const std::string& file = "", int line = 0);
@@ -33,14 +36,21 @@ private:
     void log(const std::string& level_str, const std::string& message, 
              const std::string& file, int line);
     
-    LogLevel level_;
+    // 每条日志都会读取，不加锁
+    std::atomic<LogLevel> level_;
     std::mutex mutex_;
 };
 
-// 宏定义便于使用
-#define LOG_DEBUG(msg) Logger::instance().debug(msg, __FILE__, __LINE__)
-#define LOG_INFO(msg) Logger::instance().info(msg, __FILE__, __LINE__)
-#define LOG_WARNING(msg) Logger::instance().warning(msg, __FILE__, __LINE__)
-#define LOG_ERROR(msg) Logger::instance().error(msg, __FILE__, __LINE__)
+// 宏定义便于使用；级别不够时msg不会被求值
+#define KV_LOG(level, method, msg)                                  \
+    do {                                                            \
+        if (Logger::instance().enabled(level)) {                    \
+            Logger::instance().method(msg, __FILE__, __LINE__);     \
+        }                                                           \
+    } while (0)
+#define LOG_DEBUG(msg) KV_LOG(DEBUG, debug, msg)
+#define LOG_INFO(msg) KV_LOG(INFO, info, msg)
+#define LOG_WARNING(msg) KV_LOG(WARNING, warning, msg)
+#define LOG_ERROR(msg) KV_LOG(ERROR, error, msg)
 
 #endif // LOGGER_H
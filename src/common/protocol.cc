@@ -1,72 +1,467 @@
 // src/common/protocol.cc
 #include "protocol.h"
-#include <sstream>
 #include <algorithm>
+#include <charconv>
+#include <cstring>
 #include "../common/logger.h"
 
-Request ProtocolParser::ParseRequest(const std::string& raw_request) {
-    Request req;
-    
-    if (raw_request.empty()) {
-        return req;
+namespace {
+
+// 与Redis的默认限制一致
+const int64_t kMaxRespArgs = 1024 * 1024;
+const int64_t kMaxRespBulkBytes = 512LL * 1024 * 1024;
+// 长度行（如"$12345\r\n"）的最大长度，超过仍没有换行视为格式错误
+const size_t kMaxRespLine = 64;
+// 数组头部声明的元素个数不可信，最多按这个数预分配，其余随元素解析逐个追加
+const size_t kMaxRespPrealloc = 1024;
+
+// 读取data[*pos]开始的一行RESP头部，返回类型字符和行内容；返回值同ParseRespRequest
+int ReadRespLine(const char* data, size_t size, size_t* pos, char* prefix, std::string_view* line) {
+    if (*pos >= size) {
+        return 0;
     }
-    
-    // 移除末尾的换行符
-    std::string request = raw_request;
-    if (!request.empty() && request.back() == '\n') {
-        request.pop_back();
+    const char* begin = data + *pos;
+    const char* end = static_cast<const char*>(memchr(begin, '\n', size - *pos));
+    if (!end) {
+        // 简单字符串和错误没有长度限制，其余的头部只是一个数字
+        return *begin != '+' && *begin != '-' && size - *pos > kMaxRespLine ? -1 : 0;
     }
-    
-    std::vector<std::string> parts = Split(request, ' ');
-    if (parts.empty()) {
-        return req;
+    if (end == begin || end[-1] != '\r') {
+        return -1;
     }
-    
-    req.type = ParseCommand(parts[0]);
-    if (req.type == CMD_UNKNOWN) {
-        LOG_WARNING("Unknown command: " + parts[0]);
+    *prefix = *begin;
+    *line = std::string_view(begin + 1, static_cast<size_t>(end - begin) - 2);
+    *pos = static_cast<size_t>(end - data) + 1;
+    return 1;
+}
+
+// 数字来自网络，超出int64_t范围的按格式错误处理
+bool ParseRespInteger(std::string_view str, int64_t* value) {
+    const char* end = str.data() + str.size();
+    std::from_chars_result result = std::from_chars(str.data(), end, *value);
+    return result.ec == std::errc() && result.ptr == end;
+}
+
+// 读取长度为len的bulk string内容及其后的\r\n，*out指向data中的内容
+int ReadRespBulk(const char* data, size_t size, size_t* pos, int64_t len, std::string_view* out) {
+    size_t need = static_cast<size_t>(len) + 2;
+    if (size - *pos < need) {
+        return 0;
     }
-    
-    // 复制参数（跳过命令本身）
-    if (parts.size() > 1) {
-        req.args.assign(parts.begin() + 1, parts.end());
+    if (data[*pos + len] != '\r' || data[*pos + len + 1] != '\n') {
+        return -1;
     }
-    
-    LOG_DEBUG("Parsed request: " + CommandToString(req.type) + 
-              " with " + std::to_string(req.args.size()) + " args");
-    return req;
+    *out = std::string_view(data + *pos, static_cast<size_t>(len));
+    *pos += need;
+    return 1;
 }
 
-std::string ProtocolParser::FormatResponse(const Response& response) {
-    std::stringstream ss;
-    ss << (response.success ? "OK" : "ERROR");
+// 以下函数都直接追加到out，不创建临时字符串
+void AppendInteger(std::string* out, int64_t n) {
+    char digits[24];
+    char* end = std::to_chars(digits, digits + sizeof(digits), n).ptr;
+    out->append(digits, static_cast<size_t>(end - digits));
+}
+
+// 类型字符、整数和\r\n组成的一行，如":1\r\n"、"*2\r\n"
+void AppendIntegerLine(std::string* out, char prefix, int64_t n) {
+    out->push_back(prefix);
+    AppendInteger(out, n);
+    out->append("\r\n", 2);
+}
+
+void AppendBulk(std::string* out, std::string_view value) {
+    AppendIntegerLine(out, '$', static_cast<int64_t>(value.size()));
+    out->append(value.data(), value.size());
+    out->append("\r\n", 2);
+}
+
+// 简单字符串和错误不能包含换行
+void AppendSingleLine(std::string* out, const std::string& str) {
+    size_t begin = out->size();
+    out->append(str);
+    std::replace(out->begin() + begin, out->end(), '\r', ' ');
+    std::replace(out->begin() + begin, out->end(), '\n', ' ');
+}
+
+int ParseRespReplyAt(const char* data, size_t size, size_t* pos, RespReply* reply, int depth) {
+    char prefix = 0;
+    std::string_view line;
+    int ret = ReadRespLine(data, size, pos, &prefix, &line);
+    if (ret <= 0) {
+        return ret;
+    }
+    int64_t n;
+    std::string_view bulk;
+    switch (prefix) {
+        case '+':
+            reply->type = RespReply::STATUS;
+            reply->str.assign(line.data(), line.size());
+            return 1;
+        case '-':
+            reply->type = RespReply::ERROR;
+            reply->str.assign(line.data(), line.size());
+            return 1;
+        case ':':
+            reply->type = RespReply::INTEGER;
+            return ParseRespInteger(line, &reply->integer) ? 1 : -1;
+        case '$':
+            if (!ParseRespInteger(line, &n) || n < -1 || n > kMaxRespBulkBytes) {
+                return -1;
+            }
+            if (n == -1) {
+                reply->type = RespReply::NIL;
+                return 1;
+            }
+            reply->type = RespReply::BULK;
+            ret = ReadRespBulk(data, size, pos, n, &bulk);
+            if (ret == 1) {
+                reply->str.assign(bulk.data(), bulk.size());
+            }
+            return ret;
+        case '*':
+            if (!ParseRespInteger(line, &n) || n < -1 || n > kMaxRespArgs || depth > 8) {
+                return -1;
+            }
+            if (n == -1) {
+                reply->type = RespReply::NIL;
+                return 1;
+            }
+            reply->type = RespReply::ARRAY;
+            reply->elements.clear();
+            reply->elements.reserve(std::min(static_cast<size_t>(n), kMaxRespPrealloc));
+            for (int64_t i = 0; i < n; i++) {
+                reply->elements.emplace_back();
+                ret = ParseRespReplyAt(data, size, pos, &reply->elements.back(), depth + 1);
+                if (ret <= 0) {
+                    return ret;
+                }
+            }
+            return 1;
+        default:
+            return -1;
+    }
+}
+
+}  // namespace
+
+void ProtocolParser::ParseRequest(std::string_view line, Request* request) {
+    request->type = CMD_UNKNOWN;
+    request->args.clear();
+    request->resp = false;
+
+    // 按空格切分，连续的空格视为一个；第一个词是命令
+    bool command = true;
+    size_t pos = 0;
+    while (pos < line.size()) {
+        if (line[pos] == ' ') {
+            pos++;
+            continue;
+        }
+        size_t end = std::min(line.find(' ', pos), line.size());
+        std::string_view token = line.substr(pos, end - pos);
+        if (command) {
+            request->type = ParseCommand(token);
+            if (request->type == CMD_UNKNOWN) {
+                LOG_WARNING("Unknown command: " + std::string(token));
+            }
+            command = false;
+        } else {
+            request->args.push_back(token);
+        }
+        pos = end;
+    }
+
+    LOG_DEBUG("Parsed request: " + CommandToString(request->type) +
+              " with " + std::to_string(request->args.size()) + " args");
+}
+
+void ProtocolParser::FormatResponse(const Response& response, std::string* out) {
+    out->append(response.success ? "OK" : "ERROR");
     
     if (!response.message.empty()) {
-        ss << " " << response.message;
+        out->push_back(' ');
+        out->append(response.message);
     }
     
     if (!response.data.empty()) {
-        ss << " " << response.data;
+        out->push_back(' ');
+        out->append(response.data);
     }
     
-    ss << "\n";
-    return ss.str();
+    out->push_back('\n');
 }
 
-CommandType ProtocolParser::ParseCommand(const std::string& cmd_str) {
-    std::string cmd = cmd_str;
-    std::transform(cmd.begin(), cmd.end(), cmd.begin(), ::toupper);
-    
-    if (cmd == "SET") return CMD_SET;
-    if (cmd == "GET") return CMD_GET;
-    if (cmd == "DEL" || cmd == "DELETE") return CMD_DEL;
-    if (cmd == "EXISTS") return CMD_EXISTS;
-    if (cmd == "PING") return CMD_PING;
-    if (cmd == "QUIT" || cmd == "EXIT") return CMD_QUIT;
-    
+void ProtocolParser::FormatRespResponse(CommandType type, const Response& response, std::string* out) {
+    if (!response.success) {
+        if (response.not_found && type == CMD_GET) {
+            out->append("$-1\r\n");
+            return;
+        }
+        if (response.not_found && (type == CMD_DEL || type == CMD_EXPIRE)) {
+            out->append(":0\r\n");
+            return;
+        }
+        out->append("-ERR ");
+        AppendSingleLine(out, response.message);
+        out->append("\r\n");
+        return;
+    }
+    switch (type) {
+        case CMD_GET:
+            AppendBulk(out, response.data);
+            break;
+        case CMD_INFO:
+            AppendBulk(out, response.message);
+            break;
+        case CMD_DEL:
+        case CMD_EXPIRE:
+            out->append(":1\r\n");
+            break;
+        case CMD_EXISTS:
+            out->append(response.message == "true" ? ":1\r\n" : ":0\r\n");
+            break;
+        case CMD_TTL:
+        case CMD_MDEL:
+            out->push_back(':');
+            out->append(response.message);
+            out->append("\r\n");
+            break;
+        case CMD_RANGE:
+        case CMD_PREFIX:
+            AppendIntegerLine(out, '*', static_cast<int64_t>(response.items.size()));
+            for (const std::string& item : response.items) {
+                AppendBulk(out, item);
+            }
+            break;
+        case CMD_QUIT:
+            out->append("+OK\r\n");
+            break;
+        default:
+            out->push_back('+');
+            if (response.message.empty()) {
+                out->append("OK");
+            } else {
+                AppendSingleLine(out, response.message);
+            }
+            out->append("\r\n");
+            break;
+    }
+}
+
+void ProtocolParser::FormatValues(const std::vector<std::string>& values, const std::vector<char>& found, bool resp,
+                                  std::string* out) {
+    if (resp) {
+        AppendIntegerLine(out, '*', static_cast<int64_t>(values.size()));
+        for (size_t i = 0; i < values.size(); ++i) {
+            if (found[i]) {
+                AppendBulk(out, values[i]);
+            } else {
+                out->append("$-1\r\n");
+            }
+        }
+        return;
+    }
+    out->append("OK ");
+    AppendInteger(out, static_cast<int64_t>(values.size()));
+    for (size_t i = 0; i < values.size(); ++i) {
+        out->push_back(' ');
+        if (found[i]) {
+            out->append(values[i]);
+        } else {
+            out->append("(nil)");
+        }
+    }
+    out->push_back('\n');
+}
+
+void ProtocolParser::FormatValue(const std::string& value, bool resp, std::string* out) {
+    if (resp) {
+        AppendBulk(out, value);
+        return;
+    }
+    // 与FormatResponse一致：空value不输出分隔的空格
+    out->append(value.empty() ? "OK" : "OK ");
+    out->append(value);
+    out->push_back('\n');
+}
+
+std::string ProtocolParser::EncodeRespCommand(const std::vector<std::string>& args) {
+    std::string out;
+    AppendIntegerLine(&out, '*', static_cast<int64_t>(args.size()));
+    for (const std::string& arg : args) {
+        AppendBulk(&out, arg);
+    }
+    return out;
+}
+
+void ProtocolParser::AppendRespCommand(std::initializer_list<std::string_view> args, std::string* out) {
+    AppendIntegerLine(out, '*', static_cast<int64_t>(args.size()));
+    for (std::string_view arg : args) {
+        AppendBulk(out, arg);
+    }
+}
+
+int ProtocolParser::ParseRespRequest(const char* data, size_t size, Request* request, size_t* consumed) {
+    size_t pos = 0;
+    char prefix = 0;
+    std::string_view line;
+    int64_t count;
+    int ret = ReadRespLine(data, size, &pos, &prefix, &line);
+    if (ret <= 0) {
+        return ret;
+    }
+    if (prefix != '*' || !ParseRespInteger(line, &count) || count <= 0 || count > kMaxRespArgs) {
+        return -1;
+    }
+    // 参数直接指向data；数组长度来自对端，args随参数到达逐个增长，不按它预先分配
+    std::string_view command;
+    request->args.clear();
+    for (int64_t i = 0; i < count; ++i) {
+        int64_t len;
+        std::string_view bulk;
+        ret = ReadRespLine(data, size, &pos, &prefix, &line);
+        if (ret <= 0) {
+            return ret;
+        }
+        if (prefix != '$' || !ParseRespInteger(line, &len) || len < 0 || len > kMaxRespBulkBytes) {
+            return -1;
+        }
+        ret = ReadRespBulk(data, size, &pos, len, &bulk);
+        if (ret <= 0) {
+            return ret;
+        }
+        if (i == 0) {
+            command = bulk;
+        } else {
+            request->args.push_back(bulk);
+        }
+    }
+    request->type = ParseCommand(command);
+    request->resp = true;
+    *consumed = pos;
+    return 1;
+}
+
+int RespScanner::Scan(const char* data, size_t size, size_t* length) {
+    if (remaining_.empty()) {
+        pos_ = 0;
+        remaining_.push_back(1);
+    }
+    while (!remaining_.empty()) {
+        if (remaining_.back() == 0) {
+            remaining_.pop_back();
+            continue;
+        }
+        size_t pos = pos_;
+        char prefix = 0;
+        std::string_view line;
+        int ret = ReadRespLine(data, size, &pos, &prefix, &line);
+        if (ret <= 0) {
+            return ret;
+        }
+        // 限制与ParseRespReplyAt一致，简单字符串、错误和整数的内容留给完整解析检查
+        int64_t n = 0;
+        if (prefix == '$' || prefix == '*') {
+            if (!ParseRespInteger(line, &n) || n < -1) {
+                return -1;
+            }
+        } else if (prefix != '+' && prefix != '-' && prefix != ':') {
+            return -1;
+        }
+        if (prefix == '$' && n >= 0) {
+            if (n > kMaxRespBulkBytes) {
+                return -1;
+            }
+            if (size - pos < static_cast<size_t>(n) + 2) {
+                return 0;
+            }
+            pos += static_cast<size_t>(n) + 2;
+        }
+        if (prefix == '*' && (n > kMaxRespArgs || remaining_.size() > 9)) {
+            return -1;
+        }
+        pos_ = pos;
+        remaining_.back()--;
+        if (prefix == '*' && n > 0) {
+            remaining_.push_back(n);
+        }
+    }
+    *length = pos_;
+    return 1;
+}
+
+void RespScanner::Reset() {
+    pos_ = 0;
+    remaining_.clear();
+}
+
+int ProtocolParser::ParseRespReply(const char* data, size_t size, RespReply* reply, size_t* consumed) {
+    size_t pos = 0;
+    int ret = ParseRespReplyAt(data, size, &pos, reply, 0);
+    if (ret == 1) {
+        *consumed = pos;
+    }
+    return ret;
+}
+
+CommandType ProtocolParser::ParseCommand(std::string_view cmd) {
+    // 先按长度、再按首字母（转为大写）分派，每个命令最多完整比较一次
+    if (cmd.empty()) {
+        return CMD_UNKNOWN;
+    }
+    char first = static_cast<char>(cmd[0] & ~0x20);
+    switch (cmd.size()) {
+        case 3:
+            switch (first) {
+                case 'S': return EqualsUpper(cmd, "SET") ? CMD_SET : CMD_UNKNOWN;
+                case 'G': return EqualsUpper(cmd, "GET") ? CMD_GET : CMD_UNKNOWN;
+                case 'D': return EqualsUpper(cmd, "DEL") ? CMD_DEL : CMD_UNKNOWN;
+                case 'T': return EqualsUpper(cmd, "TTL") ? CMD_TTL : CMD_UNKNOWN;
+            }
+            break;
+        case 4:
+            switch (first) {
+                case 'P': return EqualsUpper(cmd, "PING") ? CMD_PING : CMD_UNKNOWN;
+                case 'Q': return EqualsUpper(cmd, "QUIT") ? CMD_QUIT : CMD_UNKNOWN;
+                case 'E': return EqualsUpper(cmd, "EXIT") ? CMD_QUIT : CMD_UNKNOWN;
+                case 'I': return EqualsUpper(cmd, "INFO") ? CMD_INFO : CMD_UNKNOWN;
+                case 'M':
+                    if (EqualsUpper(cmd, "MGET")) return CMD_MGET;
+                    if (EqualsUpper(cmd, "MSET")) return CMD_MSET;
+                    return EqualsUpper(cmd, "MDEL") ? CMD_MDEL : CMD_UNKNOWN;
+            }
+            break;
+        case 5:
+            return EqualsUpper(cmd, "RANGE") ? CMD_RANGE : CMD_UNKNOWN;
+        case 6:
+            switch (first) {
+                case 'E':
+                    if (EqualsUpper(cmd, "EXISTS")) return CMD_EXISTS;
+                    return EqualsUpper(cmd, "EXPIRE") ? CMD_EXPIRE : CMD_UNKNOWN;
+                case 'D': return EqualsUpper(cmd, "DELETE") ? CMD_DEL : CMD_UNKNOWN;
+                case 'P': return EqualsUpper(cmd, "PREFIX") ? CMD_PREFIX : CMD_UNKNOWN;
+                case 'B': return EqualsUpper(cmd, "BGSAVE") ? CMD_BGSAVE : CMD_UNKNOWN;
+            }
+            break;
+    }
     return CMD_UNKNOWN;
 }
 
+bool ProtocolParser::EqualsUpper(std::string_view str, const char* word) {
+    size_t i = 0;
+    for (; i < str.size() && word[i] != '\0'; ++i) {
+        char c = str[i];
+        if (c >= 'a' && c <= 'z') {
+            c = static_cast<char>(c - 'a' + 'A');
+        }
+        if (c != word[i]) {
+            return false;
+        }
+    }
+    return i == str.size() && word[i] == '\0';
+}
+
 std::string ProtocolParser::CommandToString(CommandType cmd) {
     switch (cmd) {
         case CMD_SET: return "SET";
@@ -75,20 +470,55 @@ std::string ProtocolParser::CommandToString(CommandType cmd) {
         case CMD_EXISTS: return "EXISTS";
         case CMD_PING: return "PING";
         case CMD_QUIT: return "QUIT";
+        case CMD_INFO: return "INFO";
+        case CMD_EXPIRE: return "EXPIRE";
+        case CMD_TTL: return "TTL";
+        case CMD_RANGE: return "RANGE";
+        case CMD_PREFIX: return "PREFIX";
+        case CMD_BGSAVE: return "BGSAVE";
+        case CMD_MGET: return "MGET";
+        case CMD_MSET: return "MSET";
+        case CMD_MDEL: return "MDEL";
         default: return "UNKNOWN";
     }
 }
 
-std::vector<std::string> ProtocolParser::Split(const std::string& str, char delimiter) {
-    std::vector<std::string> tokens;
-    std::stringstream ss(str);
-    std::string token;
-    
-    while (std::getline(ss, token, delimiter)) {
-        if (!token.empty()) {
-            tokens.push_back(token);
+bool ProtocolParser::ParseSetOptions(const std::vector<std::string_view>& args, int64_t* ttl_ms) {
+    *ttl_ms = -1;
+    if (args.size() == 2) {
+        return true;
+    }
+    if (args.size() != 4) {
+        return false;
+    }
+
+    bool seconds = EqualsUpper(args[2], "EX");
+    if (!seconds && !EqualsUpper(args[2], "PX")) {
+        return false;
+    }
+    int64_t amount;
+    if (!ParseInteger(args[3], &amount)) {
+        return false;
+    }
+    if (amount <= 0 || amount > (seconds ? kMaxTtlMs / 1000 : kMaxTtlMs)) {
+        *ttl_ms = 0;
+        return false;
+    }
+    *ttl_ms = seconds ? amount * 1000 : amount;
+    return true;
+}
+
+bool ProtocolParser::ParseInteger(std::string_view str, int64_t* value) {
+    if (str.empty() || str.size() > 18) {
+        return false;
+    }
+    int64_t result = 0;
+    for (char c : str) {
+        if (c < '0' || c > '9') {
+            return false;
         }
+        result = result * 10 + (c - '0');
     }
-    
-    return tokens;
+    *value = result;
+    return true;
 }
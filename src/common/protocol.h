@@ -2,12 +2,19 @@
 #ifndef PROTOCOL_H
 #define PROTOCOL_H
 
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
 #include <string>
+#include <string_view>
 #include <vector>
 
-// 简单文本协议
-// 请求格式：COMMAND [ARG1] [ARG2] ...\n
-// 响应格式：STATUS [MESSAGE]\n
+// 两种协议在同一端口上按请求自动识别：
+// 内联文本协议
+//   请求格式：COMMAND [ARG1] [ARG2] ...\n
+//   响应格式：STATUS [MESSAGE]\n
+// RESP2（与Redis兼容）：请求是以'*'开头的bulk string数组，参数可以包含空格、换行等任意字节，
+//   响应按命令使用简单字符串、错误、整数、bulk string或数组
 
 enum CommandType {
     CMD_UNKNOWN = 0,
@@ -16,34 +23,106 @@ enum CommandType {
     CMD_DEL = 3,
     CMD_EXISTS = 4,
     CMD_PING = 5,
-    CMD_QUIT = 6
+    CMD_QUIT = 6,
+    CMD_INFO = 7,
+    CMD_EXPIRE = 8,
+    CMD_TTL = 9,
+    CMD_RANGE = 10,
+    CMD_PREFIX = 11,
+    CMD_BGSAVE = 12,
+    // 多key命令：MGET k1 k2 ...、MSET k1 v1 k2 v2 ...、MDEL k1 k2 ...
+    CMD_MGET = 13,
+    CMD_MSET = 14,
+    CMD_MDEL = 15
 };
 
 struct Request {
     CommandType type;
-    std::vector<std::string> args;
+    // 命令之后的参数，直接指向连接的读缓冲，不复制；只在读取下一条命令之前有效。
+    // 同一个Request对象在连接上反复使用，args的容量保留下来，解析时不再分配内存
+    std::vector<std::string_view> args;
+    // 以RESP发来的请求，响应也要用RESP格式
+    bool resp;
     
-    Request() : type(CMD_UNKNOWN) {}
+    Request() : type(CMD_UNKNOWN), resp(false) {}
 };
 
 struct Response {
     bool success;
     std::string message;
     std::string data;
+    // 以下只有RESP格式用到：key不存在（GET返回nil，DEL、EXPIRE返回0），范围查询的结果
+    bool not_found;
+    std::vector<std::string> items;
     
     Response(bool s = true, const std::string& m = "", const std::string& d = "") 
-        : success(s), message(m), data(d) {}
+        : success(s), message(m), data(d), not_found(false) {}
+};
+
+// 客户端解析出的RESP响应
+struct RespReply {
+    enum Type { STATUS, ERROR, INTEGER, BULK, NIL, ARRAY };
+
+    Type type = NIL;
+    // STATUS、ERROR和BULK的内容
+    std::string str;
+    int64_t integer = 0;
+    std::vector<RespReply> elements;
+};
+
+// 检查缓冲开头的RESP响应是否已经收全。数据分多次到达时从上次停下的位置继续，
+// 已确认的部分不再扫描，bulk string的内容直接跳过，收全后再用ParseRespReply解析一次
+class RespScanner {
+public:
+    // 返回值同ParseRespReply；返回1时*length为响应的长度，之后从新的响应开始。
+    // 两次调用之间data只能在末尾追加数据
+    int Scan(const char* data, size_t size, size_t* length);
+    void Reset();
+
+private:
+    // 已确认完整的前缀长度
+    size_t pos_ = 0;
+    // 每层数组还没读到的元素个数，最外层是响应本身（1个）
+    std::vector<int64_t> remaining_;
 };
 
 class ProtocolParser {
 public:
-    static Request ParseRequest(const std::string& raw_request);
-    static std::string FormatResponse(const Response& response);
-    static CommandType ParseCommand(const std::string& cmd_str);
+    // 解析一行内联命令（不含换行），参数指向line的内容
+    static void ParseRequest(std::string_view line, Request* request);
+    // 以下函数把响应追加到out末尾，连接的输出缓冲可以直接作为out
+    static void FormatResponse(const Response& response, std::string* out);
+    // 按命令类型把结果编码为RESP响应
+    static void FormatRespResponse(CommandType type, const Response& response, std::string* out);
+    // GET命中的响应，按请求的协议格式化；value不经过Response复制
+    static void FormatValue(const std::string& value, bool resp, std::string* out);
+    // MGET的响应：RESP为bulk string数组，不存在的key为nil；内联协议为"OK count v1 v2 ..."，
+    // 不存在的key为"(nil)"
+    static void FormatValues(const std::vector<std::string>& values, const std::vector<char>& found, bool resp,
+                             std::string* out);
+    // 把命令和参数编码为RESP数组
+    static std::string EncodeRespCommand(const std::vector<std::string>& args);
+    // 同上，直接追加到out，流水线客户端把多条命令连续编码进同一个发送缓冲
+    static void AppendRespCommand(std::initializer_list<std::string_view> args, std::string* out);
+    // 解析data开头的一个RESP请求或响应。返回1并设置*consumed表示成功，
+    // 返回0表示数据还不完整，返回-1表示格式错误。请求的参数指向data的内容
+    static int ParseRespRequest(const char* data, size_t size, Request* request, size_t* consumed);
+    static int ParseRespReply(const char* data, size_t size, RespReply* reply, size_t* consumed);
+    // 不区分大小写
+    static CommandType ParseCommand(std::string_view cmd);
     static std::string CommandToString(CommandType cmd);
-    
-private:
-    static std::vector<std::string> Split(const std::string& str, char delimiter);
+
+    // 过期时间上限（毫秒），加上当前时间戳仍不会溢出int64
+    static const int64_t kMaxTtlMs = INT64_MAX / 2;
+
+    // 解析SET key value之后的可选参数：EX seconds 或 PX milliseconds。
+    // 没有过期参数时*ttl_ms为-1；参数格式错误时返回false，
+    // 其中数值非正或换算成毫秒后超过kMaxTtlMs时*ttl_ms为0
+    static bool ParseSetOptions(const std::vector<std::string_view>& args, int64_t* ttl_ms);
+    // 解析非负整数参数，失败时返回false
+    static bool ParseInteger(std::string_view str, int64_t* value);
+    // 不区分大小写地比较，word必须是大写
+    static bool EqualsUpper(std::string_view str, const char* word);
 };
 
 #endif // PROTOCOL_H
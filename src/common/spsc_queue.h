@@ -0,0 +1,79 @@
+// src/common/spsc_queue.h
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+// 有界的单生产者单消费者无锁队列
+//
+// 生产者只写tail_，消费者只写head_，两者放在不同缓存行；各自再缓存一份对方的位置，
+// 只有看起来满（或空）时才去读对方的原子变量，正常情况下一次入队、出队不触碰对方写的缓存行。
+// 元素按值存放在预先分配的环形数组中，入队时移动进去，出队时移动出来。
+template <typename T>
+class SpscQueue {
+public:
+    // capacity向上取整为2的幂
+    explicit SpscQueue(size_t capacity) : mask_(RoundUp(capacity) - 1), slots_(new T[mask_ + 1]) {}
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // 只能由生产者线程调用；队列已满时返回false，value不变
+    bool TryPush(T&& value) {
+        size_t tail = producer_.tail.load(std::memory_order_relaxed);
+        if (tail - producer_.cached_head > mask_) {
+            producer_.cached_head = consumer_.head.load(std::memory_order_acquire);
+            if (tail - producer_.cached_head > mask_) {
+                return false;
+            }
+        }
+        slots_[tail & mask_] = std::move(value);
+        producer_.tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 只能由消费者线程调用；队列为空时返回false
+    bool TryPop(T* value) {
+        size_t head = consumer_.head.load(std::memory_order_relaxed);
+        if (head == consumer_.cached_tail) {
+            consumer_.cached_tail = producer_.tail.load(std::memory_order_acquire);
+            if (head == consumer_.cached_tail) {
+                return false;
+            }
+        }
+        *value = std::move(slots_[head & mask_]);
+        // 及时释放元素持有的内存，不等这个槽位被下一次入队覆盖
+        slots_[head & mask_] = T();
+        consumer_.head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    static size_t RoundUp(size_t n) {
+        size_t size = 2;
+        while (size < n) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    struct alignas(64) ProducerSide {
+        std::atomic<size_t> tail{0};
+        size_t cached_head = 0;
+    };
+    struct alignas(64) ConsumerSide {
+        std::atomic<size_t> head{0};
+        size_t cached_tail = 0;
+    };
+
+    const size_t mask_;
+    std::unique_ptr<T[]> slots_;
+    ProducerSide producer_;
+    ConsumerSide consumer_;
+};
+
+#endif // SPSC_QUEUE_H
@@ -0,0 +1,49 @@
+// src/common/thread_pool.cc
+#include "thread_pool.h"
+#include <chrono>
+#include <utility>
+
+ThreadPool::ThreadPool(size_t num_threads) : stopping_(false) {
+    if (num_threads == 0) {
+        num_threads = 1;
+    }
+    for (size_t i = 0; i < num_threads; ++i) {
+        workers_.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::Submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    cv_.notify_one();
+}
+
+void ThreadPool::WorkerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        if (!tasks_.empty()) {
+            std::function<void()> task = std::move(tasks_.front());
+            tasks_.pop_front();
+            lock.unlock();
+            task();
+            lock.lock();
+        } else if (stopping_) {
+            return;
+        } else {
+            cv_.wait_for(lock, std::chrono::seconds(1));
+        }
+    }
+}
@@ -0,0 +1,34 @@
+// src/common/thread_pool.h
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 固定大小的线程池，任务按提交顺序执行
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t num_threads);
+    // 等待已提交的任务全部执行完后退出
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void Submit(std::function<void()> task);
+    size_t size() const { return workers_.size(); }
+
+private:
+    void WorkerLoop();
+
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_;
+};
+
+#endif // THREAD_POOL_H
@@ -2,6 +2,14 @@
 #include <sstream>
 #include <algorithm>
 #include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
 
 namespace utils {
 
@@ -26,4 +34,190 @@ std::string Trim(const std::string& str) {
     return str.substr(start, end - start + 1);
 }
 
+bool ParseByteSize(const std::string& str, size_t* bytes) {
+    std::string s = Trim(str);
+    std::transform(s.begin(), s.end(), s.begin(), ::tolower);
+    if (s.empty() || !std::isdigit(static_cast<unsigned char>(s[0]))) {
+        return false;
+    }
+
+    char* end = nullptr;
+    errno = 0;
+    unsigned long long value = std::strtoull(s.c_str(), &end, 10);
+    if (errno == ERANGE) {
+        return false;
+    }
+    std::string unit(end);
+    size_t multiplier = 1;
+    if (unit == "k" || unit == "kb") {
+        multiplier = 1024;
+    } else if (unit == "m" || unit == "mb") {
+        multiplier = 1024 * 1024;
+    } else if (unit == "g" || unit == "gb") {
+        multiplier = 1024 * 1024 * 1024;
+    } else if (!unit.empty() && unit != "b") {
+        return false;
+    }
+    // 乘上单位后超出size_t的范围时拒绝，不能回绕成一个很小的值
+    if (value > SIZE_MAX / multiplier) {
+        return false;
+    }
+    *bytes = static_cast<size_t>(value) * multiplier;
+    return true;
+}
+
+size_t GetResidentMemory() {
+    // /proc/self/statm 第二列是常驻页数
+    std::ifstream statm("/proc/self/statm");
+    size_t total_pages = 0;
+    size_t resident_pages = 0;
+    if (!(statm >> total_pages >> resident_pages)) {
+        return 0;
+    }
+    return resident_pages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+namespace {
+
+struct Crc32cTable {
+    uint32_t entries[256];
+
+    Crc32cTable() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc >> 1) ^ (0x82f63b78u & (0u - (crc & 1)));
+            }
+            entries[i] = crc;
+        }
+    }
+};
+
+}  // namespace
+
+uint32_t Crc32c(const char* data, size_t len, uint32_t crc) {
+    static const Crc32cTable table;
+    crc = ~crc;
+    for (size_t i = 0; i < len; ++i) {
+        crc = table.entries[(crc ^ static_cast<uint8_t>(data[i])) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+namespace {
+
+const uint64_t kPrime64_1 = 0x9E3779B185EBCA87ULL;
+const uint64_t kPrime64_2 = 0xC2B2AE3D27D4EB4FULL;
+const uint64_t kPrime64_3 = 0x165667B19E3779F9ULL;
+const uint64_t kPrime64_4 = 0x85EBCA77C2B2AE63ULL;
+const uint64_t kPrime64_5 = 0x27D4EB2F165667C5ULL;
+
+inline uint64_t Rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+// 按小端读取，大端平台上也得到相同的哈希值
+inline uint64_t ReadLE64(const char* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+inline uint32_t ReadLE32(const char* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap32(v);
+#endif
+    return v;
+}
+
+inline uint64_t XXH64Round(uint64_t acc, uint64_t input) {
+    acc += input * kPrime64_2;
+    acc = Rotl64(acc, 31);
+    return acc * kPrime64_1;
+}
+
+inline uint64_t XXH64Merge(uint64_t acc, uint64_t val) {
+    acc ^= XXH64Round(0, val);
+    return acc * kPrime64_1 + kPrime64_4;
+}
+
+}  // namespace
+
+uint64_t XXHash64(const char* data, size_t len, uint64_t seed) {
+    const char* p = data;
+    const char* end = data + len;
+    uint64_t h;
+    if (len >= 32) {
+        // 四路并行累加，每轮消耗32字节
+        const char* limit = end - 32;
+        uint64_t v1 = seed + kPrime64_1 + kPrime64_2;
+        uint64_t v2 = seed + kPrime64_2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - kPrime64_1;
+        do {
+            v1 = XXH64Round(v1, ReadLE64(p));
+            v2 = XXH64Round(v2, ReadLE64(p + 8));
+            v3 = XXH64Round(v3, ReadLE64(p + 16));
+            v4 = XXH64Round(v4, ReadLE64(p + 24));
+            p += 32;
+        } while (p <= limit);
+        h = Rotl64(v1, 1) + Rotl64(v2, 7) + Rotl64(v3, 12) + Rotl64(v4, 18);
+        h = XXH64Merge(h, v1);
+        h = XXH64Merge(h, v2);
+        h = XXH64Merge(h, v3);
+        h = XXH64Merge(h, v4);
+    } else {
+        h = seed + kPrime64_5;
+    }
+    h += static_cast<uint64_t>(len);
+
+    for (; p + 8 <= end; p += 8) {
+        h ^= XXH64Round(0, ReadLE64(p));
+        h = Rotl64(h, 27) * kPrime64_1 + kPrime64_4;
+    }
+    if (p + 4 <= end) {
+        h ^= static_cast<uint64_t>(ReadLE32(p)) * kPrime64_1;
+        h = Rotl64(h, 23) * kPrime64_2 + kPrime64_3;
+        p += 4;
+    }
+    for (; p < end; ++p) {
+        h ^= static_cast<uint64_t>(static_cast<uint8_t>(*p)) * kPrime64_5;
+        h = Rotl64(h, 11) * kPrime64_1;
+    }
+
+    // 末尾混合，使每个输入位影响所有输出位
+    h ^= h >> 33;
+    h *= kPrime64_2;
+    h ^= h >> 29;
+    h *= kPrime64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+uint64_t KeyHash(std::string_view key) {
+    return XXHash64(key.data(), key.size(), kKeyHashSeed);
+}
+
+int64_t UnixTimeMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+bool SyncParentDirectory(const std::string& path) {
+    size_t slash = path.rfind('/');
+    std::string dir = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+    int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) {
+        return false;
+    }
+    int rc = fsync(fd);
+    close(fd);
+    return rc == 0;
+}
+
 }
@@ -1,12 +1,38 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace utils {
     std::vector<std::string> Split(const std::string& str, char delimiter);
     std::string Trim(const std::string& str);
+
+    // 解析字节数，支持k/kb/m/mb/g/gb后缀（1024进制），失败返回false
+    bool ParseByteSize(const std::string& str, size_t* bytes);
+
+    // 当前进程常驻内存(RSS)字节数，读取失败返回0
+    size_t GetResidentMemory();
+
+    // CRC-32C（Castagnoli），crc为之前数据的校验值，可分段累加
+    uint32_t Crc32c(const char* data, size_t len, uint32_t crc = 0);
+
+    // XXH64，与xxHash参考实现的输出逐位一致，不随编译器、标准库、平台字节序或进程变化
+    uint64_t XXHash64(const char* data, size_t len, uint64_t seed = 0);
+
+    // 集群中key的哈希：客户端据此选节点、服务器据此选分片，两端必须一致。
+    // 种子固定为kKeyHashSeed，修改它会改变所有key的归属，相当于重新分布全部数据
+    const uint64_t kKeyHashSeed = 0;
+    uint64_t KeyHash(std::string_view key);
+
+    // 墙上时钟毫秒数（Unix时间），用于需要跨进程重启保持意义的时间点
+    int64_t UnixTimeMs();
+
+    // fsync文件所在的目录，使rename或新建的目录项落盘，失败返回false并保留errno
+    bool SyncParentDirectory(const std::string& path);
 }
 
 #endif
@@ -0,0 +1,103 @@
+// src/core/arena.cc
+#include "arena.h"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+Arena::Arena() : cursor_(nullptr), remaining_(0), large_head_(nullptr), reserved_bytes_(0), used_bytes_(0) {
+    std::memset(free_lists_, 0, sizeof(free_lists_));
+}
+
+Arena::~Arena() {
+    Reset();
+}
+
+char* Arena::Allocate(size_t size) {
+    if (size > kMaxSmallSize) {
+        LargeHeader* header = static_cast<LargeHeader*>(std::malloc(sizeof(LargeHeader) + size));
+        if (!header) {
+            throw std::bad_alloc();
+        }
+        header->prev = nullptr;
+        header->next = large_head_;
+        if (large_head_) {
+            large_head_->prev = header;
+        }
+        large_head_ = header;
+        reserved_bytes_ += sizeof(LargeHeader) + size;
+        used_bytes_ += sizeof(LargeHeader) + size;
+        return reinterpret_cast<char*>(header + 1);
+    }
+
+    size_t index = ClassIndex(size);
+    size_t rounded = index * kGranularity;
+    used_bytes_ += rounded;
+    if (free_lists_[index]) {
+        FreeNode* node = free_lists_[index];
+        free_lists_[index] = node->next;
+        return reinterpret_cast<char*>(node);
+    }
+
+    if (remaining_ < rounded) {
+        // 当前块剩余的尾巴不足一次分配，直接丢弃
+        char* block = static_cast<char*>(std::malloc(kBlockSize));
+        if (!block) {
+            throw std::bad_alloc();
+        }
+        blocks_.push_back(block);
+        reserved_bytes_ += kBlockSize;
+        cursor_ = block;
+        remaining_ = kBlockSize;
+    }
+    char* ptr = cursor_;
+    cursor_ += rounded;
+    remaining_ -= rounded;
+    return ptr;
+}
+
+size_t Arena::ChunkSize(size_t size) {
+    if (size > kMaxSmallSize) {
+        return sizeof(LargeHeader) + size;
+    }
+    return ClassIndex(size) * kGranularity;
+}
+
+void Arena::Free(char* ptr, size_t size) {
+    if (size > kMaxSmallSize) {
+        LargeHeader* header = reinterpret_cast<LargeHeader*>(ptr) - 1;
+        if (header->prev) {
+            header->prev->next = header->next;
+        } else {
+            large_head_ = header->next;
+        }
+        if (header->next) {
+            header->next->prev = header->prev;
+        }
+        std::free(header);
+        reserved_bytes_ -= sizeof(LargeHeader) + size;
+        used_bytes_ -= sizeof(LargeHeader) + size;
+        return;
+    }
+    size_t index = ClassIndex(size);
+    used_bytes_ -= index * kGranularity;
+    FreeNode* node = reinterpret_cast<FreeNode*>(ptr);
+    node->next = free_lists_[index];
+    free_lists_[index] = node;
+}
+
+void Arena::Reset() {
+    for (char* block : blocks_) {
+        std::free(block);
+    }
+    blocks_.clear();
+    while (large_head_) {
+        LargeHeader* next = large_head_->next;
+        std::free(large_head_);
+        large_head_ = next;
+    }
+    cursor_ = nullptr;
+    remaining_ = 0;
+    std::memset(free_lists_, 0, sizeof(free_lists_));
+    reserved_bytes_ = 0;
+    used_bytes_ = 0;
+}
@@ -0,0 +1,62 @@
+// src/core/arena.h
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 变长记录的内存池
+//
+// 小块按16字节粒度分级，从大块内存中顺序切分，释放后挂到对应级别的空闲链表复用；
+// 超过kMaxSmallSize的大块直接走malloc。非线程安全，由调用者加锁。
+class Arena {
+public:
+    static const size_t kGranularity = 16;
+    static const size_t kMaxSmallSize = 4096;
+    static const size_t kBlockSize = 256 * 1024;
+
+    Arena();
+    ~Arena();
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    char* Allocate(size_t size);
+    // size必须与Allocate时一致
+    void Free(char* ptr, size_t size);
+
+    // Allocate(size)计入BytesInUse的字节数
+    static size_t ChunkSize(size_t size);
+
+    // 释放全部内存
+    void Reset();
+
+    // 向系统申请的总字节数
+    size_t MemoryUsage() const { return reserved_bytes_; }
+
+    // 已分配出去、尚未释放的字节数（按分级向上取整，含大块头部）
+    size_t BytesInUse() const { return used_bytes_; }
+
+private:
+    struct FreeNode {
+        FreeNode* next;
+    };
+
+    // 大块前面的链表头，Reset时据此释放仍在使用的大块
+    struct LargeHeader {
+        LargeHeader* prev;
+        LargeHeader* next;
+    };
+
+    static size_t ClassIndex(size_t size) { return (size + kGranularity - 1) / kGranularity; }
+
+    std::vector<char*> blocks_;
+    char* cursor_;
+    size_t remaining_;
+    FreeNode* free_lists_[kMaxSmallSize / kGranularity + 1];
+    LargeHeader* large_head_;
+    size_t reserved_bytes_;
+    size_t used_bytes_;
+};
+
+#endif // ARENA_H
@@ -0,0 +1,146 @@
+// src/core/epoch_manager.cc
+#include "epoch_manager.h"
+
+// 每个线程一份：持有的槽位和临界区嵌套深度，线程退出时归还槽位
+struct ThreadRecord {
+    EpochManager::Slot* slot = nullptr;
+    int depth = 0;
+
+    ~ThreadRecord() {
+        if (slot) {
+            EpochManager::instance().ReleaseSlot(slot);
+            // 之后其他thread_local析构时若再次进入临界区，会重新申请槽位
+            slot = nullptr;
+        }
+    }
+};
+
+namespace {
+thread_local ThreadRecord tls_record;
+}  // namespace
+
+EpochManager& EpochManager::instance() {
+    // 故意不析构：分离线程可能在进程退出时仍在临界区内
+    static EpochManager* instance = new EpochManager();
+    return *instance;
+}
+
+EpochManager::EpochManager() : global_epoch_(1) {}
+
+EpochManager::~EpochManager() {
+    for (const auto& r : retired_) {
+        r.deleter(r.ptr);
+    }
+    SlotBlock* block = head_block_.next.load();
+    while (block) {
+        SlotBlock* next = block->next.load();
+        delete block;
+        block = next;
+    }
+}
+
+EpochManager::Slot* EpochManager::AcquireSlot() {
+    // 优先复用已退出线程归还的槽位，所有块都占满时再追加一块
+    SlotBlock* block = &head_block_;
+    while (true) {
+        for (size_t i = 0; i < kSlotsPerBlock; ++i) {
+            Slot& slot = block->slots[i];
+            bool expected = false;
+            if (!slot.in_use.load(std::memory_order_relaxed) &&
+                slot.in_use.compare_exchange_strong(expected, true)) {
+                size_t high = block->high_water.load();
+                while (high < i + 1 && !block->high_water.compare_exchange_weak(high, i + 1)) {
+                }
+                return &slot;
+            }
+        }
+        SlotBlock* next = block->next.load(std::memory_order_acquire);
+        if (!next) {
+            SlotBlock* fresh = new SlotBlock();
+            if (block->next.compare_exchange_strong(next, fresh)) {
+                next = fresh;
+            } else {
+                delete fresh;  // 其他线程抢先追加了，next已更新为它的块
+            }
+        }
+        block = next;
+    }
+}
+
+void EpochManager::ReleaseSlot(Slot* slot) {
+    slot->epoch.store(0, std::memory_order_release);
+    slot->in_use.store(false, std::memory_order_release);
+}
+
+void EpochManager::Enter() {
+    ThreadRecord& rec = tls_record;
+    if (rec.depth++ > 0) {
+        return;
+    }
+    if (!rec.slot) {
+        rec.slot = AcquireSlot();
+    }
+    rec.slot->epoch.store(global_epoch_.load(std::memory_order_acquire), std::memory_order_relaxed);
+    // 与Reclaim中的栅栏配对：要么回收者看到本槽位，要么本线程看到摘除后的指针
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+void EpochManager::Exit() {
+    ThreadRecord& rec = tls_record;
+    if (--rec.depth == 0) {
+        rec.slot->epoch.store(0, std::memory_order_release);
+    }
+}
+
+void EpochManager::RetireRaw(void* ptr, void (*deleter)(void*)) {
+    bool should_reclaim;
+    {
+        std::lock_guard<std::mutex> lock(retire_mutex_);
+        retired_.push_back(Retired{ptr, deleter, global_epoch_.load(std::memory_order_relaxed)});
+        should_reclaim = retired_.size() >= kReclaimThreshold;
+    }
+    if (should_reclaim) {
+        Reclaim();
+    }
+}
+
+size_t EpochManager::Reclaim() {
+    std::vector<Retired> reclaimable;
+    {
+        std::lock_guard<std::mutex> lock(retire_mutex_);
+        uint64_t new_epoch = global_epoch_.fetch_add(1) + 1;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        uint64_t min_active = new_epoch;
+        for (SlotBlock* block = &head_block_; block; block = block->next.load(std::memory_order_acquire)) {
+            size_t high = block->high_water.load();
+            for (size_t i = 0; i < high; ++i) {
+                uint64_t e = block->slots[i].epoch.load(std::memory_order_acquire);
+                if (e != 0 && e < min_active) {
+                    min_active = e;
+                }
+            }
+        }
+
+        size_t kept = 0;
+        for (size_t i = 0; i < retired_.size(); ++i) {
+            if (retired_[i].epoch < min_active) {
+                reclaimable.push_back(retired_[i]);
+            } else {
+                retired_[kept++] = retired_[i];
+            }
+        }
+        retired_.resize(kept);
+    }
+
+    // 在锁外调用析构，避免析构函数里再次Retire造成死锁
+    for (const auto& r : reclaimable) {
+        r.deleter(r.ptr);
+    }
+    return reclaimable.size();
+}
+
+size_t EpochManager::PendingCount() const {
+    std::lock_guard<std::mutex> lock(retire_mutex_);
+    return retired_.size();
+}
@@ -0,0 +1,84 @@
+// src/core/epoch_manager.h
+#ifndef EPOCH_MANAGER_H
+#define EPOCH_MANAGER_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// 基于纪元(epoch)的内存回收
+//
+// 读者进入临界区时把当前全局纪元写到自己独占缓存行的槽位里，
+// 不加锁、不写共享缓存行；写者把摘除的节点连同当时的纪元放进退休列表，
+// 只有当所有活跃读者的纪元都大于退休纪元时才真正释放。
+// 槽位在线程退出时归还、由后来的线程复用；并发线程数超过已有槽位时追加新的槽位块，
+// 不设上限。
+class EpochManager {
+public:
+    static EpochManager& instance();
+
+    // RAII读临界区，可嵌套
+    class Guard {
+    public:
+        Guard() { EpochManager::instance().Enter(); }
+        ~Guard() { EpochManager::instance().Exit(); }
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+    };
+
+    void Enter();
+    void Exit();
+
+    // 延迟释放：调用者必须已经让ptr对新读者不可达
+    template <typename T>
+    void Retire(T* ptr) {
+        RetireRaw(ptr, [](void* p) { delete static_cast<T*>(p); });
+    }
+    void RetireRaw(void* ptr, void (*deleter)(void*));
+
+    // 推进纪元并释放所有读者都已离开的对象，返回释放个数
+    size_t Reclaim();
+
+    size_t PendingCount() const;
+
+private:
+    EpochManager();
+    ~EpochManager();
+    EpochManager(const EpochManager&) = delete;
+    EpochManager& operator=(const EpochManager&) = delete;
+
+    struct alignas(64) Slot {
+        // 0 表示不在临界区
+        std::atomic<uint64_t> epoch{0};
+        std::atomic<bool> in_use{false};
+    };
+
+    // 槽位块只追加不释放，读者持有的槽位指针在进程生命周期内一直有效
+    static const size_t kSlotsPerBlock = 64;
+    struct SlotBlock {
+        Slot slots[kSlotsPerBlock];
+        std::atomic<size_t> high_water{0};
+        std::atomic<SlotBlock*> next{nullptr};
+    };
+
+    struct Retired {
+        void* ptr;
+        void (*deleter)(void*);
+        uint64_t epoch;
+    };
+
+    friend struct ThreadRecord;
+    Slot* AcquireSlot();
+    void ReleaseSlot(Slot* slot);
+
+    static const size_t kReclaimThreshold = 128;
+
+    std::atomic<uint64_t> global_epoch_;
+    SlotBlock head_block_;
+
+    mutable std::mutex retire_mutex_;
+    std::vector<Retired> retired_;
+};
+
+#endif // EPOCH_MANAGER_H
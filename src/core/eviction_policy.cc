@@ -0,0 +1,174 @@
+// src/core/eviction_policy.cc
+#include "eviction_policy.h"
+#include "flat_hash_table.h"
+#include <chrono>
+
+namespace {
+
+// 基于抽样的策略：随机取kSamples个条目，淘汰其中得分最高的
+class SampledPolicy : public EvictionPolicy {
+public:
+    static const size_t kSamples = 5;
+    // 每次随机探测最多检查的槽位数，负载因子不低于7/16时几乎总能命中
+    static const size_t kProbeSlots = 64;
+    // 随机探测全部落空时顺序扫描的槽位数
+    static const size_t kScanSlots = 1024;
+
+    SampledPolicy() : rng_state_(0x9e3779b97f4a7c15ull), scan_pos_(0) {}
+
+    size_t SelectVictim(FlatHashTable& table) override {
+        size_t best = FlatHashTable::kNoSlot;
+        uint64_t best_score = 0;
+        for (size_t i = 0; i < kSamples; ++i) {
+            size_t pos = table.NextOccupied(NextRandom() % table.SlotCount(), kProbeSlots);
+            if (pos == FlatHashTable::kNoSlot) {
+                continue;
+            }
+            uint64_t score = Score(table.MetaAt(pos));
+            if (best == FlatHashTable::kNoSlot || score > best_score) {
+                best = pos;
+                best_score = score;
+            }
+        }
+        if (best == FlatHashTable::kNoSlot) {
+            // 大量删除后表很稀疏时随机探测可能落空，从上次停下的位置继续顺序扫描，
+            // 多次调用后能覆盖整张表
+            best = table.NextOccupied(scan_pos_, kScanSlots);
+            scan_pos_ = best == FlatHashTable::kNoSlot ? scan_pos_ + kScanSlots : best + 1;
+        }
+        return best;
+    }
+
+protected:
+    // 得分越高越应该被淘汰
+    virtual uint64_t Score(uint32_t meta) = 0;
+
+    // xorshift64*
+    uint64_t NextRandom() {
+        rng_state_ ^= rng_state_ >> 12;
+        rng_state_ ^= rng_state_ << 25;
+        rng_state_ ^= rng_state_ >> 27;
+        return rng_state_ * 0x2545f4914f6cdd1dull;
+    }
+
+private:
+    uint64_t rng_state_;
+    size_t scan_pos_;
+};
+
+// 近似LRU：元数据是32位逻辑时钟，每次插入或访问时钟加一，淘汰样本中最久未访问的条目
+class LruPolicy : public SampledPolicy {
+public:
+    LruPolicy() : clock_(0) {}
+
+    const char* Name() const override { return "lru"; }
+    uint32_t OnInsert() override { return ++clock_; }
+    uint32_t OnAccess(uint32_t) override { return ++clock_; }
+
+protected:
+    // 无符号减法在时钟回绕后依然得到正确的间隔
+    uint64_t Score(uint32_t meta) override { return static_cast<uint32_t>(clock_ - meta); }
+
+private:
+    uint32_t clock_;
+};
+
+// 近似LFU：元数据低8位是对数访问计数，其上16位是最近一次衰减的时间（分钟）。
+// 计数越大自增概率越低，255可以表示百万级的访问次数；每空闲kDecayMinutes分钟计数减一，
+// 过去的热点会逐渐冷却。新条目从kInitCount开始，避免刚写入就被淘汰。
+class LfuPolicy : public SampledPolicy {
+public:
+    static const uint32_t kInitCount = 5;
+    static const uint32_t kLogFactor = 10;
+    static const uint32_t kDecayMinutes = 1;
+
+    const char* Name() const override { return "lfu"; }
+
+    uint32_t OnInsert() override { return Pack(NowMinutes(), kInitCount); }
+
+    uint32_t OnAccess(uint32_t meta) override {
+        uint32_t count = DecayedCount(meta);
+        if (count < 255) {
+            uint32_t base = count > kInitCount ? count - kInitCount : 0;
+            double r = static_cast<double>(NextRandom() >> 11) / static_cast<double>(1ull << 53);
+            if (r < 1.0 / (base * kLogFactor + 1)) {
+                count++;
+            }
+        }
+        return Pack(NowMinutes(), count);
+    }
+
+protected:
+    uint64_t Score(uint32_t meta) override { return 255 - DecayedCount(meta); }
+
+private:
+    static uint32_t NowMinutes() {
+        auto now = std::chrono::steady_clock::now().time_since_epoch();
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::minutes>(now).count()) & 0xffff;
+    }
+
+    static uint32_t Pack(uint32_t minutes, uint32_t count) { return (minutes << 8) | count; }
+
+    static uint32_t DecayedCount(uint32_t meta) {
+        uint32_t count = meta & 0xff;
+        uint32_t elapsed = (NowMinutes() - (meta >> 8)) & 0xffff;
+        uint32_t periods = elapsed / kDecayMinutes;
+        return periods >= count ? 0 : count - periods;
+    }
+};
+
+// CLOCK：元数据是引用位，插入和访问时置1。指针沿槽位顺序前进，
+// 遇到引用位为1的条目清零后跳过，遇到为0的条目淘汰
+class ClockPolicy : public EvictionPolicy {
+public:
+    // 单次淘汰最多前进的步数，以及每步最多检查的槽位数
+    static const size_t kMaxSteps = 64;
+    static const size_t kStepSlots = 1024;
+
+    ClockPolicy() : hand_(0) {}
+
+    const char* Name() const override { return "clock"; }
+    uint32_t OnInsert() override { return 1; }
+    uint32_t OnAccess(uint32_t) override { return 1; }
+
+    size_t SelectVictim(FlatHashTable& table) override {
+        // 步数用完时淘汰最后一个清除了引用位的条目
+        size_t last = FlatHashTable::kNoSlot;
+        for (size_t n = 0; n < kMaxSteps; ++n) {
+            size_t pos = table.NextOccupied(hand_, kStepSlots);
+            if (pos == FlatHashTable::kNoSlot) {
+                hand_ = (hand_ + kStepSlots) % table.SlotCount();
+                continue;
+            }
+            hand_ = pos + 1;
+            if (table.MetaAt(pos) == 0) {
+                return pos;
+            }
+            table.SetMetaAt(pos, 0);
+            last = pos;
+        }
+        return last;
+    }
+
+private:
+    size_t hand_;
+};
+
+}  // namespace
+
+std::unique_ptr<EvictionPolicy> EvictionPolicy::Create(const std::string& name) {
+    if (name == "lru") {
+        return std::make_unique<LruPolicy>();
+    }
+    if (name == "lfu") {
+        return std::make_unique<LfuPolicy>();
+    }
+    if (name == "clock") {
+        return std::make_unique<ClockPolicy>();
+    }
+    return nullptr;
+}
+
+bool EvictionPolicy::IsValidName(const std::string& name) {
+    return name == "noeviction" || name == "lru" || name == "lfu" || name == "clock";
+}
@@ -0,0 +1,37 @@
+// src/core/eviction_policy.h
+#ifndef EVICTION_POLICY_H
+#define EVICTION_POLICY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+class FlatHashTable;
+
+// 内存达到上限时选择淘汰对象的策略
+//
+// 每个条目只有FlatHashTable槽位中的4字节元数据，策略在插入和访问时更新它，
+// 淘汰时只抽样或扫描常数个槽位，不维护全局链表，也不做O(n)遍历。
+// 非线程安全，与所在的哈希表共用调用者的锁。
+class EvictionPolicy {
+public:
+    virtual ~EvictionPolicy() = default;
+
+    virtual const char* Name() const = 0;
+
+    // 新条目的初始元数据
+    virtual uint32_t OnInsert() = 0;
+    // 条目被读取或覆盖时，根据原元数据计算新的元数据
+    virtual uint32_t OnAccess(uint32_t meta) = 0;
+
+    // 在table中选出一个淘汰对象，返回其位置；限定检查的槽位数内找不到条目时返回kNoSlot
+    virtual size_t SelectVictim(FlatHashTable& table) = 0;
+
+    // name为"lru"、"lfu"或"clock"；"noeviction"和未知名称返回nullptr
+    static std::unique_ptr<EvictionPolicy> Create(const std::string& name);
+    // name是否为合法的策略名（含"noeviction"）
+    static bool IsValidName(const std::string& name);
+};
+
+#endif // EVICTION_POLICY_H
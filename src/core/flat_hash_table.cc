@@ -0,0 +1,525 @@
+// src/core/flat_hash_table.cc
+#include "flat_hash_table.h"
+#include "eviction_policy.h"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <sys/mman.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+const uint8_t kEmpty = 0x00;
+const uint8_t kDeleted = 0x01;
+const uint8_t kFullBit = 0x80;
+
+inline uint8_t H2(size_t hash) { return static_cast<uint8_t>(hash & 0x7f) | kFullBit; }
+inline size_t H1(size_t hash) { return hash >> 7; }
+
+#if defined(__SSE2__)
+// 返回组内控制字节等于b的槽位位图
+inline uint32_t MatchByte(const uint8_t* group, uint8_t b) {
+    __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(static_cast<char>(b)))));
+}
+
+// 空或已删除的槽位最高位为0
+inline uint32_t MatchFree(const uint8_t* group) {
+    __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    return ~static_cast<uint32_t>(_mm_movemask_epi8(ctrl)) & 0xffffu;
+}
+#else
+inline uint32_t MatchByte(const uint8_t* group, uint8_t b) {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < FlatHashTable::kGroupSize; ++i) {
+        if (group[i] == b) {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+}
+
+inline uint32_t MatchFree(const uint8_t* group) {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < FlatHashTable::kGroupSize; ++i) {
+        if (!(group[i] & kFullBit)) {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+}
+#endif
+
+inline uint64_t Load64(const char* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t Mix(uint64_t a, uint64_t b) {
+    __uint128_t r = static_cast<__uint128_t>(a) * b;
+    return static_cast<uint64_t>(r) ^ static_cast<uint64_t>(r >> 64);
+}
+
+// 按8字节分块的乘法混合哈希，直接作用于字节序列，扩容时无需重建std::string
+uint64_t HashBytes(const char* data, size_t len) {
+    const uint64_t kMul0 = 0xa0761d6478bd642full;
+    const uint64_t kMul1 = 0xe7037ed1a0b428dbull;
+    uint64_t h = len * kMul0;
+    while (len >= 8) {
+        h = Mix(h ^ Load64(data), kMul1);
+        data += 8;
+        len -= 8;
+    }
+    if (len > 0) {
+        uint64_t tail = 0;
+        std::memcpy(&tail, data, len);
+        h = Mix(h ^ tail, kMul1);
+    }
+    return Mix(h, kMul0);
+}
+
+}  // namespace
+
+const size_t FlatHashTable::kGroupSize;
+const size_t FlatHashTable::kInlineCapacity;
+const size_t FlatHashTable::kRehashGroupsPerOp;
+const size_t FlatHashTable::kMmapThreshold;
+const size_t FlatHashTable::kNoSlot;
+const size_t FlatHashTable::kPrefetchDistance;
+
+FlatHashTable::FlatHashTable(size_t initial_capacity)
+    : rehash_group_(0), logical_bytes_(0), generation_(0), policy_(nullptr) {
+    size_t capacity = kGroupSize;
+    while (capacity * 7 / 8 < initial_capacity) {
+        capacity <<= 1;
+    }
+    cur_ = AllocateTable(capacity);
+}
+
+FlatHashTable::~FlatHashTable() {
+    cur_.Free();
+    old_.Free();
+}
+
+FlatHashTable::Table FlatHashTable::AllocateTable(size_t capacity) {
+    // calloc得到的全零控制字节即"全部为空"，大数组由内核按需清零，
+    // 分配本身不会随容量变慢
+    Table table;
+    table.ctrl = static_cast<uint8_t*>(std::calloc(capacity, 1));
+    size_t slot_bytes = capacity * sizeof(Slot);
+    if (slot_bytes >= kMmapThreshold) {
+        void* mem = mmap(nullptr, slot_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        table.slots = mem == MAP_FAILED ? nullptr : static_cast<Slot*>(mem);
+        table.slots_mapped = true;
+    } else {
+        table.slots = static_cast<Slot*>(std::calloc(capacity, sizeof(Slot)));
+    }
+    if (!table.ctrl || !table.slots) {
+        table.Free();
+        throw std::bad_alloc();
+    }
+    table.capacity = capacity;
+    return table;
+}
+
+void FlatHashTable::Table::Free() {
+    std::free(ctrl);
+    if (slots_mapped) {
+        if (slots) {
+            size_t total = capacity * sizeof(Slot);
+            munmap(reinterpret_cast<char*>(slots) + released_bytes, total - released_bytes);
+        }
+    } else {
+        std::free(slots);
+    }
+    *this = Table();
+}
+
+void FlatHashTable::Table::ReleaseSlotsBefore(size_t index) {
+    if (!slots_mapped) {
+        return;
+    }
+    // 按kMmapThreshold对齐成块归还，块大小是页大小的整数倍
+    size_t bytes = index * sizeof(Slot) / kMmapThreshold * kMmapThreshold;
+    if (bytes > released_bytes) {
+        munmap(reinterpret_cast<char*>(slots) + released_bytes, bytes - released_bytes);
+        released_bytes = bytes;
+    }
+}
+
+size_t FlatHashTable::Hash(const std::string& key) {
+    return HashBytes(key.data(), key.size());
+}
+
+const char* FlatHashTable::RecordData(const Slot& slot) {
+    if (IsInline(slot.key_len, slot.value_len)) {
+        return slot.data;
+    }
+    const char* ptr;
+    std::memcpy(&ptr, slot.data, sizeof(ptr));
+    return ptr;
+}
+
+bool FlatHashTable::KeyEquals(const Slot& slot, const std::string& key) {
+    return slot.key_len == key.size() && std::memcmp(RecordData(slot), key.data(), key.size()) == 0;
+}
+
+void FlatHashTable::StoreRecord(Slot& slot, const std::string& key, const std::string& value) {
+    slot.key_len = static_cast<uint32_t>(key.size());
+    slot.value_len = static_cast<uint32_t>(value.size());
+    logical_bytes_ += key.size() + value.size();
+    char* dest = slot.data;
+    if (!IsInline(key.size(), value.size())) {
+        dest = arena_.Allocate(key.size() + value.size());
+        std::memcpy(slot.data, &dest, sizeof(dest));
+    }
+    std::memcpy(dest, key.data(), key.size());
+    std::memcpy(dest + key.size(), value.data(), value.size());
+}
+
+void FlatHashTable::FreeRecord(Slot& slot) {
+    logical_bytes_ -= slot.key_len + slot.value_len;
+    if (!IsInline(slot.key_len, slot.value_len)) {
+        arena_.Free(const_cast<char*>(RecordData(slot)), slot.key_len + slot.value_len);
+    }
+}
+
+size_t FlatHashTable::Table::FindIndex(const std::string& key, size_t hash) const {
+    const size_t group_mask = capacity / kGroupSize - 1;
+    const uint8_t h2 = H2(hash);
+    size_t group = H1(hash) & group_mask;
+    for (size_t step = 1;; ++step) {
+        const uint8_t* group_ctrl = ctrl + group * kGroupSize;
+        for (uint32_t match = MatchByte(group_ctrl, h2); match; match &= match - 1) {
+            size_t index = group * kGroupSize + __builtin_ctz(match);
+            if (KeyEquals(slots[index], key)) {
+                return index;
+            }
+        }
+        if (MatchByte(group_ctrl, kEmpty)) {
+            return capacity;
+        }
+        // 三角数步长，容量为2的幂时能遍历所有组
+        group = (group + step) & group_mask;
+    }
+}
+
+size_t FlatHashTable::Table::FindInsertIndex(size_t hash) const {
+    const size_t group_mask = capacity / kGroupSize - 1;
+    size_t group = H1(hash) & group_mask;
+    for (size_t step = 1;; ++step) {
+        uint32_t free_mask = MatchFree(ctrl + group * kGroupSize);
+        if (free_mask) {
+            return group * kGroupSize + __builtin_ctz(free_mask);
+        }
+        group = (group + step) & group_mask;
+    }
+}
+
+void FlatHashTable::Table::MarkErased(size_t index) {
+    // 组内仍有空槽说明没有探测序列经过这个组，可以直接置空而不留墓碑
+    const uint8_t* group = ctrl + (index & ~(kGroupSize - 1));
+    if (MatchByte(group, kEmpty)) {
+        ctrl[index] = kEmpty;
+    } else {
+        ctrl[index] = kDeleted;
+        deleted++;
+    }
+    size--;
+}
+
+FlatHashTable::Table* FlatHashTable::Locate(const std::string& key, size_t hash, size_t* index) {
+    const FlatHashTable* self = this;
+    return const_cast<Table*>(self->Locate(key, hash, index));
+}
+
+const FlatHashTable::Table* FlatHashTable::Locate(const std::string& key, size_t hash,
+                                                  size_t* index) const {
+    *index = cur_.FindIndex(key, hash);
+    if (*index != cur_.capacity) {
+        return &cur_;
+    }
+    if (IsRehashing()) {
+        *index = old_.FindIndex(key, hash);
+        if (*index != old_.capacity) {
+            return &old_;
+        }
+    }
+    return nullptr;
+}
+
+bool FlatHashTable::Insert(const std::string& key, const std::string& value) {
+    RehashStep();
+
+    size_t hash = Hash(key);
+    size_t index;
+    Table* table = Locate(key, hash, &index);
+    if (table) {
+        // 旧表中的条目原地覆盖，稍后随所在组一起搬迁
+        Slot& slot = table->slots[index];
+        FreeRecord(slot);
+        StoreRecord(slot, key, value);
+        if (policy_) {
+            slot.meta = policy_->OnAccess(slot.meta);
+        }
+        return false;
+    }
+
+    size_t new_capacity = GrowthCapacity();
+    if (new_capacity > 0) {
+        // 新表在搬迁完成前就写满的情况按负载因子不会出现，这里兜底一次性搬完
+        while (IsRehashing()) {
+            RehashStep(old_.capacity / kGroupSize);
+        }
+        StartRehash(new_capacity);
+    }
+
+    index = cur_.FindInsertIndex(hash);
+    if (cur_.ctrl[index] == kDeleted) {
+        cur_.deleted--;
+    }
+    cur_.ctrl[index] = H2(hash);
+    StoreRecord(cur_.slots[index], key, value);
+    cur_.slots[index].meta = policy_ ? policy_->OnInsert() : 0;
+    cur_.size++;
+    return true;
+}
+
+bool FlatHashTable::Find(const std::string& key, std::string* value) {
+    return Find(key, Hash(key), value);
+}
+
+size_t FlatHashTable::Prefetch(const std::string& key) const {
+    size_t hash = Hash(key);
+    size_t group = H1(hash) & (cur_.capacity / kGroupSize - 1);
+    __builtin_prefetch(cur_.ctrl + group * kGroupSize);
+    return hash;
+}
+
+bool FlatHashTable::Find(const std::string& key, size_t hash, std::string* value) {
+    size_t index;
+    Table* table = Locate(key, hash, &index);
+    if (!table) {
+        return false;
+    }
+    Slot& slot = table->slots[index];
+    if (policy_) {
+        slot.meta = policy_->OnAccess(slot.meta);
+    }
+    value->assign(RecordData(slot) + slot.key_len, slot.value_len);
+    return true;
+}
+
+bool FlatHashTable::Contains(const std::string& key) const {
+    size_t index;
+    return Locate(key, Hash(key), &index) != nullptr;
+}
+
+bool FlatHashTable::Erase(const std::string& key) {
+    RehashStep();
+
+    size_t index;
+    Table* table = Locate(key, Hash(key), &index);
+    if (!table) {
+        return false;
+    }
+    FreeRecord(table->slots[index]);
+    table->MarkErased(index);
+    return true;
+}
+
+void FlatHashTable::Clear() {
+    cur_.Free();
+    old_.Free();
+    arena_.Reset();
+    cur_ = AllocateTable(kGroupSize);
+    rehash_group_ = 0;
+    logical_bytes_ = 0;
+    generation_++;
+}
+
+void FlatHashTable::Reserve(size_t n) {
+    size_t capacity = cur_.capacity;
+    while (capacity * 7 / 8 < n) {
+        capacity <<= 1;
+    }
+    if (capacity == cur_.capacity || IsRehashing()) {
+        return;
+    }
+    if (size() == 0) {
+        cur_.Free();
+        cur_ = AllocateTable(capacity);
+        generation_++;
+    } else {
+        StartRehash(capacity);
+    }
+}
+
+size_t FlatHashTable::GrowthCapacity() const {
+    if (cur_.size + cur_.deleted + 1 <= cur_.capacity * 7 / 8) {
+        return 0;
+    }
+    // 墓碑较多时按原容量重建即可，否则扩容一倍
+    return size() + 1 > cur_.capacity * 7 / 16 ? cur_.capacity * 2 : cur_.capacity;
+}
+
+size_t FlatHashTable::RecordBytes(size_t key_len, size_t value_len) {
+    size_t bytes = sizeof(Slot) + 1;
+    if (!IsInline(key_len, value_len)) {
+        bytes += Arena::ChunkSize(key_len + value_len);
+    }
+    return bytes;
+}
+
+size_t FlatHashTable::InsertBytes(const std::string& key, const std::string& value) const {
+    size_t bytes = RecordBytes(key.size(), value.size());
+    size_t index;
+    const Table* table = Locate(key, Hash(key), &index);
+    if (table) {
+        const Slot& slot = table->slots[index];
+        size_t old_bytes = RecordBytes(slot.key_len, slot.value_len);
+        bytes = bytes > old_bytes ? bytes - old_bytes : 0;
+    }
+    return bytes;
+}
+
+void FlatHashTable::StartRehash(size_t new_capacity) {
+    old_ = cur_;
+    cur_ = AllocateTable(new_capacity);
+    rehash_group_ = 0;
+    generation_++;
+}
+
+void FlatHashTable::Scan(ScanCursor* cursor, size_t max_slots, const ScanCallback& callback) const {
+    if (cursor->done) {
+        return;
+    }
+    if (!cursor->started || cursor->generation != generation_) {
+        cursor->started = true;
+        cursor->generation = generation_;
+        cursor->in_cur = !IsRehashing();
+        cursor->index = 0;
+    }
+    if (!cursor->in_cur && !IsRehashing()) {
+        // 上次调用之后旧表已搬空，其中的条目都已在新表里
+        cursor->in_cur = true;
+        cursor->index = 0;
+    }
+
+    for (size_t n = 0; n < max_slots; ++n) {
+        const Table& table = cursor->in_cur ? cur_ : old_;
+        if (cursor->index >= table.capacity) {
+            if (cursor->in_cur) {
+                cursor->done = true;
+                return;
+            }
+            cursor->in_cur = true;
+            cursor->index = 0;
+            continue;
+        }
+        // 旧表中已搬走的槽位是墓碑，不会访问到可能已归还的槽位内存
+        if (table.ctrl[cursor->index] & kFullBit) {
+            const Slot& slot = table.slots[cursor->index];
+            const char* data = RecordData(slot);
+            callback(data, slot.key_len, data + slot.key_len, slot.value_len);
+        }
+        cursor->index++;
+    }
+}
+
+size_t FlatHashTable::RehashStep(size_t max_groups) {
+    if (!IsRehashing()) {
+        return 0;
+    }
+
+    const size_t num_groups = old_.capacity / kGroupSize;
+    size_t moved = 0;
+    for (size_t n = 0; n < max_groups && rehash_group_ < num_groups; ++n, ++rehash_group_) {
+        for (size_t i = rehash_group_ * kGroupSize; i < (rehash_group_ + 1) * kGroupSize; ++i) {
+            if (!(old_.ctrl[i] & kFullBit)) {
+                continue;
+            }
+            // 记录本身（内联数据或Arena指针）原样搬到新表
+            const Slot& slot = old_.slots[i];
+            size_t hash = HashBytes(RecordData(slot), slot.key_len);
+            size_t index = cur_.FindInsertIndex(hash);
+            if (cur_.ctrl[index] == kDeleted) {
+                cur_.deleted--;
+            }
+            cur_.ctrl[index] = H2(hash);
+            cur_.slots[index] = slot;
+            cur_.size++;
+            // 已搬走的槽位在旧表中留墓碑，保持旧表其余条目的探测链完整
+            old_.ctrl[i] = kDeleted;
+            old_.size--;
+            moved++;
+        }
+    }
+
+    if (rehash_group_ == num_groups) {
+        old_.Free();
+        rehash_group_ = 0;
+    } else {
+        old_.ReleaseSlotsBefore(rehash_group_ * kGroupSize);
+    }
+    return moved;
+}
+
+size_t FlatHashTable::TableBytes() const {
+    return (cur_.capacity + old_.capacity) * (sizeof(Slot) + 1) - old_.released_bytes;
+}
+
+size_t FlatHashTable::MemoryUsage() const {
+    return TableBytes() + arena_.MemoryUsage();
+}
+
+size_t FlatHashTable::UsedBytes() const {
+    return size() * (sizeof(Slot) + 1) + arena_.BytesInUse();
+}
+
+const FlatHashTable::Slot& FlatHashTable::SlotAt(size_t pos) const {
+    return pos < cur_.capacity ? cur_.slots[pos] : old_.slots[pos - cur_.capacity];
+}
+
+FlatHashTable::Slot& FlatHashTable::SlotAt(size_t pos) {
+    return pos < cur_.capacity ? cur_.slots[pos] : old_.slots[pos - cur_.capacity];
+}
+
+size_t FlatHashTable::NextOccupied(size_t pos, size_t max_slots) const {
+    const size_t total = SlotCount();
+    // 旧表中已搬迁的前缀都是墓碑（槽位内存可能已归还），直接跳过且不计入max_slots
+    const size_t migrated_end = cur_.capacity + rehash_group_ * kGroupSize;
+    pos %= total;
+    for (size_t n = 0; n < max_slots && n < total; ++n) {
+        if (pos >= cur_.capacity && pos < migrated_end) {
+            pos = migrated_end == total ? 0 : migrated_end;
+        }
+        uint8_t c = pos < cur_.capacity ? cur_.ctrl[pos] : old_.ctrl[pos - cur_.capacity];
+        if (c & kFullBit) {
+            return pos;
+        }
+        if (++pos == total) {
+            pos = 0;
+        }
+    }
+    return kNoSlot;
+}
+
+std::string FlatHashTable::KeyAt(size_t pos) const {
+    const Slot& slot = SlotAt(pos);
+    return std::string(RecordData(slot), slot.key_len);
+}
+
+void FlatHashTable::EraseAt(size_t pos) {
+    // 不推动搬迁，保证调用者持有的位置在删除前有效
+    FreeRecord(SlotAt(pos));
+    if (pos < cur_.capacity) {
+        cur_.MarkErased(pos);
+    } else {
+        old_.MarkErased(pos - cur_.capacity);
+    }
+}
@@ -0,0 +1,197 @@
+// src/core/flat_hash_table.h
+#ifndef FLAT_HASH_TABLE_H
+#define FLAT_HASH_TABLE_H
+
+#include "arena.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+class EvictionPolicy;
+
+// 开放寻址哈希表（Swiss table风格），替代 unordered_map<string, string>
+//
+// 每个槽位对应1字节控制信息：空、已删除，或"满 + 哈希值低7位"。
+// 查找时以16个槽位为一组，用SSE2一次比较整组控制字节，只有控制字节
+// 匹配的槽位才去比较key。key+value总长不超过kInlineCapacity时直接存在槽位里，
+// 更长的记录放到Arena中，槽位只保存指针。非线程安全，由调用者加锁。
+//
+// 扩容是渐进式的：超过负载因子时只分配新表，旧表保持可用，
+// 之后每次写操作（或调用RehashStep）最多搬迁kRehashGroupsPerOp组，
+// 搬迁期间查找依次检查新表和旧表，单次操作的延迟与表大小无关。
+//
+// 每个槽位带4字节元数据，设置了淘汰策略时在插入和访问时由策略更新，
+// 淘汰策略通过按位置访问槽位的接口抽样或扫描候选条目。
+class FlatHashTable {
+public:
+    static const size_t kGroupSize = 16;
+    static const size_t kInlineCapacity = 20;
+    static const size_t kRehashGroupsPerOp = 4;
+    // 槽位数组不小于该值时直接mmap，搬迁过程中按块逐步munmap已搬空的部分，
+    // 避免搬迁结束时一次性释放整张旧表造成停顿
+    static const size_t kMmapThreshold = 1 << 20;
+    // 按位置访问槽位的接口中表示"没有条目"
+    static const size_t kNoSlot = static_cast<size_t>(-1);
+    // 批量操作时提前预取的key数：处理第i个key时预取第i+kPrefetchDistance个
+    static const size_t kPrefetchDistance = 8;
+
+    explicit FlatHashTable(size_t initial_capacity = kGroupSize);
+    ~FlatHashTable();
+    FlatHashTable(const FlatHashTable&) = delete;
+    FlatHashTable& operator=(const FlatHashTable&) = delete;
+
+    // 插入或覆盖，返回true表示新插入
+    bool Insert(const std::string& key, const std::string& value);
+    // 设置了淘汰策略时会更新条目的访问元数据
+    bool Find(const std::string& key, std::string* value);
+    // 批量操作用：计算key的哈希并预取它在当前表中探测起点的控制字节组，返回的哈希交给
+    // 下面的Find重载，稍后查找时控制字节多半已在缓存中，多个key的内存访问可以重叠
+    size_t Prefetch(const std::string& key) const;
+    bool Find(const std::string& key, size_t hash, std::string* value);
+    // 依次对第0..n-1个key调用visit(i, hash)，每处理一个key之前预取后面第kPrefetchDistance个。
+    // key_at(i)返回第i个key
+    template <typename KeyAt, typename Visit>
+    void ForEachPrefetched(size_t n, KeyAt key_at, Visit visit) const {
+        size_t hashes[kPrefetchDistance];
+        for (size_t i = 0; i < n && i < kPrefetchDistance; ++i) {
+            hashes[i] = Prefetch(key_at(i));
+        }
+        for (size_t i = 0; i < n; ++i) {
+            size_t hash = hashes[i % kPrefetchDistance];
+            if (i + kPrefetchDistance < n) {
+                hashes[i % kPrefetchDistance] = Prefetch(key_at(i + kPrefetchDistance));
+            }
+            visit(i, hash);
+        }
+    }
+    bool Contains(const std::string& key) const;
+    bool Erase(const std::string& key);
+    void Clear();
+    // 保证至少能容纳n个条目而不再扩容。表为空时直接按目标容量重新分配，
+    // 否则发起一次到目标容量的渐进式rehash
+    void Reserve(size_t n);
+
+    // 插入和访问时由policy维护槽位元数据，nullptr表示不维护；policy的生命周期由调用者管理
+    void SetEvictionPolicy(EvictionPolicy* policy) { policy_ = policy; }
+
+    // 一条key+value记录计入UsedBytes的字节数：槽位、控制字节和Arena中按分级取整后的记录
+    static size_t RecordBytes(size_t key_len, size_t value_len);
+    // Insert(key, value)会使UsedBytes增加的字节数（覆盖为更短的记录时为0），
+    // 用于在写入前做内存上限检查
+    size_t InsertBytes(const std::string& key, const std::string& value) const;
+
+    // 搬迁最多max_groups组旧表槽位，返回搬迁的条目数；可由后台定时调用
+    size_t RehashStep(size_t max_groups = kRehashGroupsPerOp);
+    bool IsRehashing() const { return old_.ctrl != nullptr; }
+
+    size_t size() const { return cur_.size + old_.size; }
+    // 当前（新）表的槽位数
+    size_t capacity() const { return cur_.capacity; }
+
+    // 槽位数组、控制字节和Arena向系统申请的总字节数
+    size_t MemoryUsage() const;
+    // 现有条目占用的字节数：每个条目的槽位和控制字节，加上Arena中在用的记录。
+    // 不含负载因子留出的空槽位和搬迁中的旧表，删除条目后立即减少
+    size_t UsedBytes() const;
+    // 所有条目key+value字节数之和
+    size_t LogicalBytes() const { return logical_bytes_; }
+
+    // 分批遍历的游标，默认构造即从头开始
+    struct ScanCursor {
+        bool started = false;
+        bool done = false;
+        uint64_t generation = 0;
+        // false表示正在遍历搬迁中的旧表
+        bool in_cur = false;
+        size_t index = 0;
+    };
+    using ScanCallback = std::function<void(const char* key, size_t key_len, const char* value, size_t value_len)>;
+
+    // 从cursor处继续遍历，最多检查max_slots个槽位，对每个条目调用callback，遍历完时cursor->done为true。
+    // 两次调用之间可以有写操作：先遍历旧表再遍历新表，条目只会从旧表搬到新表，
+    // 所以遍历全程存在且未被修改的条目至少被访问一次；期间开始了新一轮扩容时从头重新遍历，
+    // 条目可能被访问多次
+    void Scan(ScanCursor* cursor, size_t max_slots, const ScanCallback& callback) const;
+
+    // 按位置访问槽位，供淘汰策略使用。位置[0, cur容量)是新表下标，其后是搬迁中的旧表下标；
+    // 任何写操作之后之前取得的位置都可能失效
+    size_t SlotCount() const { return cur_.capacity + old_.capacity; }
+    // 从pos开始（到末尾后回绕）最多检查max_slots个位置，返回第一个有条目的位置，没有则返回kNoSlot
+    size_t NextOccupied(size_t pos, size_t max_slots) const;
+    uint32_t MetaAt(size_t pos) const { return SlotAt(pos).meta; }
+    void SetMetaAt(size_t pos, uint32_t meta) { SlotAt(pos).meta = meta; }
+    std::string KeyAt(size_t pos) const;
+    void EraseAt(size_t pos);
+
+private:
+    struct Slot {
+        uint32_t key_len;
+        uint32_t value_len;
+        // 淘汰策略的访问信息（LRU时钟、LFU计数或CLOCK引用位）
+        uint32_t meta;
+        // 内联时依次存放key和value，否则前8字节是Arena中记录的地址
+        char data[kInlineCapacity];
+    };
+
+    struct Table {
+        uint8_t* ctrl = nullptr;
+        Slot* slots = nullptr;
+        size_t capacity = 0;
+        size_t size = 0;
+        size_t deleted = 0;
+        // 槽位数组是否直接mmap分配，以及搬迁时已从头部归还给系统的字节数
+        bool slots_mapped = false;
+        size_t released_bytes = 0;
+
+        // 返回key所在槽位下标，不存在时返回capacity
+        size_t FindIndex(const std::string& key, size_t hash) const;
+        // 返回可插入的第一个空或已删除槽位
+        size_t FindInsertIndex(size_t hash) const;
+        void MarkErased(size_t index);
+        // 归还[0, index)槽位占用的整块内存，这些槽位必须都已搬走
+        void ReleaseSlotsBefore(size_t index);
+        void Free();
+    };
+
+    static bool IsInline(size_t key_len, size_t value_len) {
+        return key_len + value_len <= kInlineCapacity;
+    }
+
+    static size_t Hash(const std::string& key);
+    static const char* RecordData(const Slot& slot);
+    static bool KeyEquals(const Slot& slot, const std::string& key);
+
+    const Slot& SlotAt(size_t pos) const;
+    Slot& SlotAt(size_t pos);
+
+    // 新旧两张表的控制字节和槽位数组字节数
+    size_t TableBytes() const;
+
+    void StoreRecord(Slot& slot, const std::string& key, const std::string& value);
+    void FreeRecord(Slot& slot);
+
+    // 定位key：返回所在的表（cur_或old_）和下标，不存在时返回nullptr
+    Table* Locate(const std::string& key, size_t hash, size_t* index);
+    const Table* Locate(const std::string& key, size_t hash, size_t* index) const;
+
+    // 插入一个新key前是否需要扩容，需要时返回新表容量，否则返回0
+    size_t GrowthCapacity() const;
+
+    // 分配new_capacity的新表并开始渐进搬迁
+    void StartRehash(size_t new_capacity);
+    static Table AllocateTable(size_t capacity);
+
+    Table cur_;
+    // 搬迁中的旧表；old_.ctrl为空表示没有进行中的搬迁
+    Table old_;
+    // 旧表中下一个待搬迁的组
+    size_t rehash_group_;
+    size_t logical_bytes_;
+    // 每次开始扩容或Clear时加一，供Scan判断位置是否失效
+    uint64_t generation_;
+    Arena arena_;
+    EvictionPolicy* policy_;
+};
+
+#endif // FLAT_HASH_TABLE_H
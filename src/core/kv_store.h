@@ -2,14 +2,18 @@
 #ifndef KV_STORE_H
 #define KV_STORE_H
 
+#include <cstdint>
+#include <functional>
 #include <string>
 #include <memory>
+#include <vector>
 
 enum StatusCode {
     OK = 0,
     KEY_NOT_FOUND = 1,
     STORAGE_ERROR = 2,
-    INVALID_ARGUMENT = 3
+    INVALID_ARGUMENT = 3,
+    OUT_OF_MEMORY = 4
 };
 
 struct Status {
@@ -21,6 +25,7 @@ struct Status {
     
     bool ok() const { return code == OK; }
     bool is_key_not_found() const { return code == KEY_NOT_FOUND; }
+    bool is_out_of_memory() const { return code == OUT_OF_MEMORY; }
     bool is_error() const { return code != OK; }
     
     static Status OK_STATUS() { return Status(); }
@@ -30,6 +35,49 @@ struct Status {
     static Status Error(const std::string& msg) {
         return Status(STORAGE_ERROR, msg);
     }
+    static Status OutOfMemory() {
+        return Status(OUT_OF_MEMORY, "OOM command not allowed when used memory > 'maxmemory'");
+    }
+};
+
+// 存储内存统计，未实现的字段为0
+struct StoreStats {
+    size_t keys = 0;
+    size_t logical_bytes = 0;    // 所有key+value字节数之和
+    size_t used_bytes = 0;       // 存储结构实际在用的字节数
+    size_t allocator_bytes = 0;  // 向系统申请的字节数（含分配器空闲块）
+    size_t maxmemory = 0;        // 0表示不限制
+    size_t hits = 0;             // GET命中次数
+    size_t misses = 0;           // GET未命中次数
+    size_t evictions = 0;        // 因内存上限被淘汰的条目数
+    size_t expires = 0;          // 设置了过期时间的key数
+    size_t expired = 0;          // 因过期被删除的key数
+    size_t snapshots = 0;        // 存活的MVCC快照数
+    size_t versions = 0;         // 为快照保留的旧版本数
+};
+
+// 按key字节序升序遍历的迭代器
+//
+// 并发写入时是弱一致的：遍历开始前已存在、遍历期间未被删除的key一定会出现，
+// 遍历期间的写入可能看到也可能看不到
+class KVIterator {
+public:
+    virtual ~KVIterator() = default;
+
+    virtual bool Valid() const = 0;
+    // 定位到第一个不小于target的key
+    virtual void Seek(const std::string& target) = 0;
+    virtual void Next() = 0;
+    // 仅在Valid()时可调用
+    virtual const std::string& key() const = 0;
+    virtual const std::string& value() const = 0;
+};
+
+// 只读快照句柄，持有期间通过KVStore::Get(snapshot, ...)读到创建时刻的数据。
+// 句柄释放后快照引用的旧版本才能被回收；句柄不能比创建它的存储活得久
+class KVSnapshot {
+public:
+    virtual ~KVSnapshot() = default;
 };
 
 class KVStore {
@@ -42,9 +90,103 @@ public:
     virtual Status Contains(const std::string& key) = 0;
     virtual size_t Size() const = 0;
     virtual void Clear() = 0;
+
+    // 过期时间（毫秒）：带过期时间写入、给已有key设置过期时间、查询剩余时间。
+    // 普通Put会清除key的过期时间；Ttl在key没有过期时间时返回-1。
+    // 默认实现表示引擎不支持过期
+    virtual Status PutWithTtl(const std::string& key, const std::string& value, int64_t ttl_ms) {
+        (void)key; (void)value; (void)ttl_ms;
+        return Status::Error("TTL is not supported by this storage engine");
+    }
+    virtual Status Expire(const std::string& key, int64_t ttl_ms) {
+        (void)key; (void)ttl_ms;
+        return Status::Error("TTL is not supported by this storage engine");
+    }
+    virtual Status Ttl(const std::string& key, int64_t* ttl_ms) {
+        (void)key; (void)ttl_ms;
+        return Status::Error("TTL is not supported by this storage engine");
+    }
+
+    // 批量操作：一次调用处理多个key，实现应在一次加锁（分片存储每个分片一次）内完成整批。
+    // 默认实现逐个调用单key接口。
+    // MultiGet：(*values)[i]为keys[i]的值，(*found)[i]表示keys[i]是否存在
+    virtual void MultiGet(const std::vector<std::string>& keys, std::vector<std::string>* values,
+                          std::vector<char>* found) {
+        values->resize(keys.size());
+        found->resize(keys.size());
+        for (size_t i = 0; i < keys.size(); ++i) {
+            (*found)[i] = Get(keys[i], (*values)[i]).ok();
+        }
+    }
+    // MultiPut：依次写入keys[i] -> values[i]，与Put一样清除过期时间；出错时停止，之前的key已写入
+    virtual Status MultiPut(const std::vector<std::string>& keys, const std::vector<std::string>& values) {
+        for (size_t i = 0; i < keys.size() && i < values.size(); ++i) {
+            Status status = Put(keys[i], values[i]);
+            if (!status.ok()) {
+                return status;
+            }
+        }
+        return Status::OK_STATUS();
+    }
+    // MultiDelete：返回实际删除的key数
+    virtual size_t MultiDelete(const std::vector<std::string>& keys) {
+        size_t deleted = 0;
+        for (const std::string& key : keys) {
+            deleted += Delete(key).ok() ? 1 : 0;
+        }
+        return deleted;
+    }
+
+    // 预计将写入expected_keys个key时提前扩容，避免批量加载过程中反复扩容；默认不做任何事
+    virtual void Reserve(size_t expected_keys) { (void)expected_keys; }
+
+    // 有序遍历，新迭代器需要先Seek；不支持有序遍历的引擎返回nullptr
+    virtual std::unique_ptr<KVIterator> NewIterator() { return nullptr; }
+
+    // MVCC快照：多个key的读取看到同一时刻的数据，写入不等待持有快照的读者。
+    // 不支持快照的引擎返回nullptr
+    virtual std::shared_ptr<const KVSnapshot> GetSnapshot() { return nullptr; }
+    virtual Status Get(const KVSnapshot& snapshot, const std::string& key, std::string& value) {
+        (void)snapshot; (void)key; (void)value;
+        return Status::Error("Snapshots are not supported by this storage engine");
+    }
+
+    // 全量遍历的回调，ttl_ms为剩余过期时间，没有过期时间时为-1
+    using ForEachCallback = std::function<void(const std::string& key, const std::string& value, int64_t ttl_ms)>;
+
+    // 弱一致的全量遍历，用于持久化导出。遍历全程存在且未被修改的key一定会被访问一次以上，
+    // 遍历期间修改过的key可能被访问零次或多次。实现应分批加锁，回调在锁外执行，
+    // 不会在整个遍历期间阻塞读写。默认实现基于NewIterator
+    virtual Status ForEach(const ForEachCallback& callback) {
+        std::unique_ptr<KVIterator> it = NewIterator();
+        if (!it) {
+            return Status::Error("ForEach is not supported by this storage engine");
+        }
+        for (it->Seek(std::string()); it->Valid(); it->Next()) {
+            callback(it->key(), it->value(), -1);
+        }
+        return Status::OK_STATUS();
+    }
+
+    virtual StoreStats GetStats() const {
+        StoreStats stats;
+        stats.keys = Size();
+        return stats;
+    }
     
-    // 工厂方法：创建内存存储实例
-    static std::unique_ptr<KVStore> CreateMemoryStore();
+    // 工厂方法：创建内存存储实例，maxmemory为0表示不限制内存。
+    // eviction_policy为"lru"、"lfu"或"clock"时达到上限后淘汰旧条目，"noeviction"时拒绝写入
+    static std::unique_ptr<KVStore> CreateMemoryStore(size_t maxmemory = 0,
+                                                      const std::string& eviction_policy = "noeviction");
+
+    // 工厂方法：创建分片内存存储实例（每个分片独立加锁），num_shards为0时使用默认分片数
+    static std::unique_ptr<KVStore> CreateShardedMemoryStore(size_t num_shards = 0);
+
+    // 工厂方法：创建读路径无锁的存储实例，适合以GET为主的负载
+    static std::unique_ptr<KVStore> CreateRcuMemoryStore();
+
+    // 工厂方法：创建按key有序的存储实例（跳表），支持NewIterator范围遍历，读路径无锁
+    static std::unique_ptr<KVStore> CreateSkipListStore();
 };
 
 #endif // KV_STORE_H
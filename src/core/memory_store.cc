@@ -1,15 +1,97 @@
 // src/core/memory_store.cc
 #include "memory_store.h"
 #include "../common/logger.h"
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+const int MemoryStore::kReapIntervalMs;
+const size_t MemoryStore::kReapBatch;
+const size_t MemoryStore::kScanBatchSlots;
+
+class MemoryStore::Snapshot : public KVSnapshot {
+public:
+    Snapshot(MemoryStore* store, uint64_t sequence, uint64_t time_ms)
+        : store_(store), sequence_(sequence), time_ms_(time_ms) {}
+    ~Snapshot() override { store_->ReleaseSnapshot(sequence_); }
+
+    const MemoryStore* store() const { return store_; }
+    uint64_t sequence() const { return sequence_; }
+    // 创建时刻（steady_clock毫秒），到期时间不晚于它的key在快照中不可见
+    uint64_t time_ms() const { return time_ms_; }
+
+private:
+    MemoryStore* store_;
+    uint64_t sequence_;
+    uint64_t time_ms_;
+};
+
+MemoryStore::MemoryStore(size_t maxmemory, const std::string& eviction_policy)
+    : maxmemory_(maxmemory), policy_(EvictionPolicy::Create(eviction_policy)),
+      hits_(0), misses_(0), evictions_(0), wheel_(NowMs()), expired_(0),
+      sequence_(0), version_count_(0), stopping_(false) {
+    data_.SetEvictionPolicy(policy_.get());
+}
+
+MemoryStore::~MemoryStore() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    reaper_cv_.notify_all();
+    if (reaper_.joinable()) {
+        reaper_.join();
+    }
+}
+
+uint64_t MemoryStore::NowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 
 Status MemoryStore::Put(const std::string& key, const std::string& value) {
     std::lock_guard<std::mutex> lock(mutex_);
-    
+    Status status = PutLocked(key, value);
+    if (status.ok() && !expires_.empty()) {
+        // 与Redis的SET一致，覆盖写入清除原有的过期时间；时间轮中的旧条目到期时会被忽略
+        expires_.erase(key);
+    }
+    return status;
+}
+
+Status MemoryStore::PutWithTtl(const std::string& key, const std::string& value, int64_t ttl_ms) {
+    if (ttl_ms <= 0) {
+        return Status(INVALID_ARGUMENT, "invalid expire time");
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    Status status = PutLocked(key, value);
+    if (status.ok()) {
+        SetDeadline(key, NowMs() + ttl_ms);
+    }
+    return status;
+}
+
+Status MemoryStore::PutLocked(const std::string& key, const std::string& value) {
     if (key.empty()) {
         return Status::Error("Key cannot be empty");
     }
+
+    // 在写入前按本次写入增加的占用检查，超限时先按策略淘汰，
+    // 无法腾出足够空间时直接失败，不做任何分配
+    if (maxmemory_ > 0) {
+        size_t needed = data_.InsertBytes(key, value);
+        while (data_.UsedBytes() + needed > maxmemory_) {
+            if (needed > maxmemory_ || !EvictOne()) {
+                LOG_DEBUG("Put rejected by maxmemory: " + key);
+                return Status::OutOfMemory();
+            }
+            // 被淘汰的可能正是要覆盖的key
+            needed = data_.InsertBytes(key, value);
+        }
+    }
     
-    data_[key] = value;
+    SaveVersionLocked(key);
+    data_.Insert(key, value);
     LOG_DEBUG("Put key: " + key + ", value: " + value);
     return Status::OK_STATUS();
 }
@@ -17,13 +99,13 @@ Status MemoryStore::Put(const std::string& key, const std::string& value) {
 Status MemoryStore::Get(const std::string& key, std::string& value) {
     std::lock_guard<std::mutex> lock(mutex_);
     
-    auto it = data_.find(key);
-    if (it == data_.end()) {
+    if (ExpireIfNeeded(key) || !data_.Find(key, &value)) {
+        misses_++;
         LOG_DEBUG("Key not found: " + key);
         return Status::KeyNotFound(key);
     }
+    hits_++;
     
-    value = it->second;
     LOG_DEBUG("Get key: " + key + ", value: " + value);
     return Status::OK_STATUS();
 }
@@ -31,17 +113,162 @@ Status MemoryStore::Get(const std::string& key, std::string& value) {
 Status MemoryStore::Delete(const std::string& key) {
     std::lock_guard<std::mutex> lock(mutex_);
     
-    if (data_.erase(key) == 0) {
+    if (ExpireIfNeeded(key) || !data_.Contains(key)) {
         return Status::KeyNotFound(key);
     }
+    SaveVersionLocked(key);
+    data_.Erase(key);
+    if (!expires_.empty()) {
+        expires_.erase(key);
+    }
     
     LOG_DEBUG("Delete key: " + key);
     return Status::OK_STATUS();
 }
 
+void MemoryStore::MultiGet(const std::vector<std::string>& keys, std::vector<std::string>* values,
+                           std::vector<char>* found) {
+    values->resize(keys.size());
+    found->resize(keys.size());
+    std::lock_guard<std::mutex> lock(mutex_);
+    data_.ForEachPrefetched(keys.size(), [&](size_t i) -> const std::string& { return keys[i]; },
+                            [&](size_t i, size_t hash) {
+        // 惰性过期可能删除条目，但哈希与表无关，预先算好的哈希仍然有效
+        bool hit = !ExpireIfNeeded(keys[i]) && data_.Find(keys[i], hash, &(*values)[i]);
+        (*found)[i] = hit;
+        if (hit) {
+            hits_++;
+        } else {
+            misses_++;
+        }
+    });
+}
+
+Status MemoryStore::MultiPut(const std::vector<std::string>& keys, const std::vector<std::string>& values) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Status status;
+    data_.ForEachPrefetched(std::min(keys.size(), values.size()),
+                            [&](size_t i) -> const std::string& { return keys[i]; },
+                            [&](size_t i, size_t) {
+        if (!status.ok()) {
+            return;
+        }
+        status = PutLocked(keys[i], values[i]);
+        if (status.ok() && !expires_.empty()) {
+            expires_.erase(keys[i]);
+        }
+    });
+    return status;
+}
+
+size_t MemoryStore::MultiDelete(const std::vector<std::string>& keys) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t deleted = 0;
+    data_.ForEachPrefetched(keys.size(), [&](size_t i) -> const std::string& { return keys[i]; },
+                            [&](size_t i, size_t) {
+        const std::string& key = keys[i];
+        if (ExpireIfNeeded(key) || !data_.Contains(key)) {
+            return;
+        }
+        SaveVersionLocked(key);
+        data_.Erase(key);
+        if (!expires_.empty()) {
+            expires_.erase(key);
+        }
+        deleted++;
+    });
+    return deleted;
+}
+
 Status MemoryStore::Contains(const std::string& key) {
     std::lock_guard<std::mutex> lock(mutex_);
-    return data_.find(key) != data_.end() ? Status::OK_STATUS() : Status::KeyNotFound(key);
+    if (ExpireIfNeeded(key) || !data_.Contains(key)) {
+        return Status::KeyNotFound(key);
+    }
+    return Status::OK_STATUS();
+}
+
+Status MemoryStore::Expire(const std::string& key, int64_t ttl_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (ExpireIfNeeded(key) || !data_.Contains(key)) {
+        return Status::KeyNotFound(key);
+    }
+    if (ttl_ms <= 0) {
+        // 与Redis一致，非正的过期时间直接删除key
+        SaveVersionLocked(key);
+        data_.Erase(key);
+        expires_.erase(key);
+        expired_++;
+        return Status::OK_STATUS();
+    }
+    // 快照看到的是修改前的过期时间
+    SaveVersionLocked(key);
+    SetDeadline(key, NowMs() + ttl_ms);
+    return Status::OK_STATUS();
+}
+
+Status MemoryStore::Ttl(const std::string& key, int64_t* ttl_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (ExpireIfNeeded(key) || !data_.Contains(key)) {
+        return Status::KeyNotFound(key);
+    }
+    auto it = expires_.find(key);
+    *ttl_ms = it == expires_.end() ? -1 : static_cast<int64_t>(it->second - NowMs());
+    return Status::OK_STATUS();
+}
+
+bool MemoryStore::ExpireIfNeeded(const std::string& key) {
+    if (expires_.empty()) {
+        return false;
+    }
+    auto it = expires_.find(key);
+    if (it == expires_.end() || it->second > NowMs()) {
+        return false;
+    }
+    SaveVersionLocked(key);
+    data_.Erase(key);
+    expires_.erase(it);
+    expired_++;
+    LOG_DEBUG("Expired key: " + key);
+    return true;
+}
+
+void MemoryStore::SetDeadline(const std::string& key, uint64_t deadline_ms) {
+    expires_[key] = deadline_ms;
+    wheel_.Schedule(key, deadline_ms);
+    StartReaperLocked();
+}
+
+void MemoryStore::StartReaperLocked() {
+    if (!reaper_.joinable()) {
+        reaper_ = std::thread(&MemoryStore::ReaperLoop, this);
+    }
+}
+
+void MemoryStore::ReaperLoop() {
+    auto on_expire = [this](const std::string& key, uint64_t deadline_ms) {
+        auto it = expires_.find(key);
+        // 过期时间被修改或清除过的旧条目直接忽略
+        if (it == expires_.end() || it->second != deadline_ms) {
+            return;
+        }
+        SaveVersionLocked(key);
+        data_.Erase(key);
+        expires_.erase(it);
+        expired_++;
+    };
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        // 每批最多处理kReapBatch个条目就释放锁，大量key同时到期时不会长时间阻塞读写
+        if (wheel_.Advance(NowMs(), kReapBatch, on_expire)) {
+            reaper_cv_.wait_for(lock, std::chrono::milliseconds(kReapIntervalMs));
+        } else {
+            lock.unlock();
+            std::this_thread::yield();
+            lock.lock();
+        }
+    }
 }
 
 size_t MemoryStore::Size() const {
@@ -51,11 +278,206 @@ size_t MemoryStore::Size() const {
 
 void MemoryStore::Clear() {
     std::lock_guard<std::mutex> lock(mutex_);
-    data_.clear();
+    if (!snapshots_.empty()) {
+        std::vector<std::string> keys;
+        keys.reserve(data_.size());
+        FlatHashTable::ScanCursor cursor;
+        while (!cursor.done) {
+            data_.Scan(&cursor, kScanBatchSlots, [&](const char* key, size_t key_len, const char*, size_t) {
+                keys.emplace_back(key, key_len);
+            });
+        }
+        // 快照仍能看到清空前的全部数据
+        for (const std::string& key : keys) {
+            SaveVersionLocked(key);
+        }
+    }
+    data_.Clear();
+    expires_.clear();
+    wheel_.Clear();
     LOG_INFO("Memory store cleared");
 }
 
+void MemoryStore::Reserve(size_t expected_keys) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    data_.Reserve(expected_keys);
+}
+
+StoreStats MemoryStore::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    StoreStats stats;
+    stats.keys = data_.size();
+    stats.logical_bytes = data_.LogicalBytes();
+    stats.used_bytes = data_.UsedBytes();
+    stats.allocator_bytes = data_.MemoryUsage();
+    stats.maxmemory = maxmemory_;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.evictions = evictions_;
+    stats.expires = expires_.size();
+    stats.expired = expired_;
+    for (const auto& kv : snapshots_) {
+        stats.snapshots += kv.second;
+    }
+    stats.versions = version_count_;
+    return stats;
+}
+
+std::shared_ptr<const KVSnapshot> MemoryStore::GetSnapshot() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    snapshots_[sequence_]++;
+    return std::make_shared<Snapshot>(this, sequence_, NowMs());
+}
+
+void MemoryStore::ReleaseSnapshot(uint64_t sequence) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = snapshots_.find(sequence);
+    if (it == snapshots_.end()) {
+        return;
+    }
+    if (--it->second == 0) {
+        bool oldest = it == snapshots_.begin();
+        snapshots_.erase(it);
+        if (oldest) {
+            PruneVersionsLocked();
+        }
+    }
+}
+
+Status MemoryStore::Get(const KVSnapshot& snapshot, const std::string& key, std::string& value) {
+    const Snapshot* snap = dynamic_cast<const Snapshot*>(&snapshot);
+    if (!snap || snap->store() != this) {
+        return Status(INVALID_ARGUMENT, "snapshot does not belong to this store");
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = versions_.find(key);
+    if (it != versions_.end()) {
+        // 第一个在快照之后才失效的版本就是快照时刻的值
+        auto version = std::upper_bound(it->second.begin(), it->second.end(), snap->sequence(),
+                                        [](uint64_t sequence, const Version& v) {
+                                            return sequence < v.end_sequence;
+                                        });
+        if (version != it->second.end()) {
+            if (!version->present || (version->deadline_ms != 0 && version->deadline_ms <= snap->time_ms())) {
+                return Status::KeyNotFound(key);
+            }
+            value = version->value;
+            return Status::OK_STATUS();
+        }
+    }
+    // 快照之后key没有被修改过，当前值和过期时间就是快照时刻的；只读不删，已过期的key留给惰性过期处理
+    if (!expires_.empty()) {
+        auto deadline = expires_.find(key);
+        if (deadline != expires_.end() && deadline->second <= snap->time_ms()) {
+            return Status::KeyNotFound(key);
+        }
+    }
+    if (!data_.Find(key, &value)) {
+        return Status::KeyNotFound(key);
+    }
+    return Status::OK_STATUS();
+}
+
+void MemoryStore::SaveVersionLocked(const std::string& key) {
+    uint64_t sequence = ++sequence_;
+    if (snapshots_.empty()) {
+        return;
+    }
+    auto it = versions_.find(key);
+    if (it != versions_.end() && it->second.back().end_sequence > snapshots_.rbegin()->first) {
+        // 当前值写入于所有快照之后，没有快照能看到它
+        return;
+    }
+    Version version;
+    version.end_sequence = sequence;
+    version.present = data_.Find(key, &version.value);
+    auto deadline = expires_.find(key);
+    version.deadline_ms = version.present && deadline != expires_.end() ? deadline->second : 0;
+    if (it == versions_.end()) {
+        it = versions_.emplace(key, std::deque<Version>()).first;
+    }
+    it->second.push_back(std::move(version));
+    version_queue_.emplace_back(sequence, key);
+    version_count_++;
+}
+
+void MemoryStore::PruneVersionsLocked() {
+    if (snapshots_.empty()) {
+        versions_.clear();
+        version_queue_.clear();
+        version_count_ = 0;
+        return;
+    }
+    // 失效序列号不大于最老快照的版本对所有快照都不可见
+    const uint64_t oldest = snapshots_.begin()->first;
+    while (!version_queue_.empty() && version_queue_.front().first <= oldest) {
+        auto it = versions_.find(version_queue_.front().second);
+        std::deque<Version>& chain = it->second;
+        chain.pop_front();
+        version_count_--;
+        if (chain.empty()) {
+            versions_.erase(it);
+        }
+        version_queue_.pop_front();
+    }
+}
+
+Status MemoryStore::ForEach(const ForEachCallback& callback) {
+    struct Entry {
+        std::string key;
+        std::string value;
+        int64_t ttl_ms;
+    };
+    std::vector<Entry> batch;
+    FlatHashTable::ScanCursor cursor;
+    while (!cursor.done) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            const uint64_t now = NowMs();
+            data_.Scan(&cursor, kScanBatchSlots, [&](const char* key, size_t key_len, const char* value,
+                                                     size_t value_len) {
+                Entry entry{std::string(key, key_len), std::string(value, value_len), -1};
+                if (!expires_.empty()) {
+                    auto it = expires_.find(entry.key);
+                    if (it != expires_.end()) {
+                        if (it->second <= now) {
+                            return;
+                        }
+                        entry.ttl_ms = static_cast<int64_t>(it->second - now);
+                    }
+                }
+                batch.push_back(std::move(entry));
+            });
+        }
+        for (const Entry& entry : batch) {
+            callback(entry.key, entry.value, entry.ttl_ms);
+        }
+        batch.clear();
+    }
+    return Status::OK_STATUS();
+}
+
+bool MemoryStore::EvictOne() {
+    if (!policy_ || data_.size() == 0) {
+        return false;
+    }
+    size_t pos = policy_->SelectVictim(data_);
+    if (pos == FlatHashTable::kNoSlot) {
+        return false;
+    }
+    std::string key = data_.KeyAt(pos);
+    LOG_DEBUG("Evict key: " + key);
+    // Find只更新访问元数据，不移动槽位，pos在保存版本后仍然有效
+    SaveVersionLocked(key);
+    data_.EraseAt(pos);
+    if (!expires_.empty()) {
+        expires_.erase(key);
+    }
+    evictions_++;
+    return true;
+}
+
 // 工厂方法实现
-std::unique_ptr<KVStore> KVStore::CreateMemoryStore() {
-    return std::make_unique<MemoryStore>();
+std::unique_ptr<KVStore> KVStore::CreateMemoryStore(size_t maxmemory, const std::string& eviction_policy) {
+    return std::make_unique<MemoryStore>(maxmemory, eviction_policy);
 }
@@ -3,21 +3,119 @@
 #define MEMORY_STORE_H
 
 #include "kv_store.h"
-#include <unordered_map>
+#include "flat_hash_table.h"
+#include "eviction_policy.h"
+#include "timing_wheel.h"
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
 #include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
+// MVCC快照的实现：每次写入分配一个递增的序列号，快照记录创建时的序列号。
+// 只有存在快照时，写入才把被覆盖或删除的旧值连同它失效时的序列号保存到版本链中，
+// 快照读取先查版本链，找不到时当前值就是快照时刻的值。旧版本按失效序列号排队，
+// 最老的快照释放时回收所有不再可见的版本，没有快照时不保留任何旧版本。
+// 过期、淘汰等内部删除同样先保存旧版本；版本带着当时的过期时间，
+// 快照按创建时刻判断key是否已过期，读取快照不会修改当前数据
 class MemoryStore : public KVStore {
 public:
+    // 后台清理线程的唤醒间隔，以及每批在锁内处理的时间轮条目数
+    static const int kReapIntervalMs = 100;
+    static const size_t kReapBatch = 1000;
+    // ForEach每批在锁内检查的槽位数
+    static const size_t kScanBatchSlots = 1024;
+
+    // maxmemory: 条目占用字节数（FlatHashTable::UsedBytes）的上限，0表示不限制。
+    // eviction_policy为"noeviction"或未知名称时超限的Put返回OUT_OF_MEMORY，
+    // 否则按策略淘汰条目腾出空间
+    explicit MemoryStore(size_t maxmemory = 0, const std::string& eviction_policy = "noeviction");
+    ~MemoryStore() override;
+
     Status Put(const std::string& key, const std::string& value) override;
     Status Get(const std::string& key, std::string& value) override;
     Status Delete(const std::string& key) override;
     Status Contains(const std::string& key) override;
     size_t Size() const override;
     void Clear() override;
+    void Reserve(size_t expected_keys) override;
+    StoreStats GetStats() const override;
+    Status ForEach(const ForEachCallback& callback) override;
+
+    // 整批在一次加锁内完成，并提前预取后面key所在的哈希表控制字节
+    void MultiGet(const std::vector<std::string>& keys, std::vector<std::string>* values,
+                  std::vector<char>* found) override;
+    Status MultiPut(const std::vector<std::string>& keys, const std::vector<std::string>& values) override;
+    size_t MultiDelete(const std::vector<std::string>& keys) override;
+
+    // 过期分两路：访问时检查（惰性），以及后台线程按时间轮主动删除
+    Status PutWithTtl(const std::string& key, const std::string& value, int64_t ttl_ms) override;
+    Status Expire(const std::string& key, int64_t ttl_ms) override;
+    Status Ttl(const std::string& key, int64_t* ttl_ms) override;
+
+    std::shared_ptr<const KVSnapshot> GetSnapshot() override;
+    Status Get(const KVSnapshot& snapshot, const std::string& key, std::string& value) override;
 
 private:
-    std::unordered_map<std::string, std::string> data_;
+    class Snapshot;
+
+    // 被覆盖或删除的旧值，在序列号小于end_sequence的快照中可见
+    struct Version {
+        uint64_t end_sequence;
+        bool present;
+        // 该版本的到期时间（steady_clock毫秒），0表示没有过期时间
+        uint64_t deadline_ms;
+        std::string value;
+    };
+
+    static uint64_t NowMs();
+
+    void ReleaseSnapshot(uint64_t sequence);
+
+    // 以下函数要求已持有mutex_
+    Status PutLocked(const std::string& key, const std::string& value);
+    // key已过期时删除它并返回true
+    bool ExpireIfNeeded(const std::string& key);
+    void SetDeadline(const std::string& key, uint64_t deadline_ms);
+    // 按淘汰策略删除一个条目，找不到可淘汰的条目时返回false
+    bool EvictOne();
+    // 修改或删除key（包括过期和淘汰）之前调用：分配新的序列号，
+    // 有快照可能看到当前值时把它连同过期时间保存到版本链
+    void SaveVersionLocked(const std::string& key);
+    // 回收最老的快照也看不到的旧版本
+    void PruneVersionsLocked();
+
+    // 第一次设置过期时间时才启动后台清理线程
+    void StartReaperLocked();
+    void ReaperLoop();
+
+    size_t maxmemory_;
+    std::unique_ptr<EvictionPolicy> policy_;
+    size_t hits_;
+    size_t misses_;
+    size_t evictions_;
+    FlatHashTable data_;
+    // 设置了过期时间的key -> 到期时间（steady_clock毫秒）
+    std::unordered_map<std::string, uint64_t> expires_;
+    TimingWheel wheel_;
+    size_t expired_;
     mutable std::mutex mutex_;
+
+    uint64_t sequence_;
+    // 存活快照的序列号 -> 引用该序列号的快照数
+    std::map<uint64_t, size_t> snapshots_;
+    // key -> 旧版本，按end_sequence升序
+    std::unordered_map<std::string, std::deque<Version>> versions_;
+    // (end_sequence, key)，按end_sequence升序，回收时从队头开始
+    std::deque<std::pair<uint64_t, std::string>> version_queue_;
+    size_t version_count_;
+
+    std::thread reaper_;
+    std::condition_variable reaper_cv_;
+    bool stopping_;
 };
 
 #endif // MEMORY_STORE_H
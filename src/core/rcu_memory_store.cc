@@ -0,0 +1,184 @@
+// src/core/rcu_memory_store.cc
+#include "rcu_memory_store.h"
+#include "epoch_manager.h"
+#include "../common/logger.h"
+#include <functional>
+
+RcuMemoryStore::Table::Table(size_t n) : mask(n - 1), buckets(new std::atomic<Node*>[n]) {
+    for (size_t i = 0; i < n; ++i) {
+        buckets[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+RcuMemoryStore::Table::~Table() {
+    for (size_t i = 0; i <= mask; ++i) {
+        Node* node = buckets[i].load(std::memory_order_relaxed);
+        while (node) {
+            Node* next = node->next.load(std::memory_order_relaxed);
+            delete node;
+            node = next;
+        }
+    }
+}
+
+RcuMemoryStore::RcuMemoryStore(size_t initial_buckets) : size_(0) {
+    size_t n = 16;
+    while (n < initial_buckets) {
+        n <<= 1;
+    }
+    table_.store(new Table(n));
+}
+
+RcuMemoryStore::~RcuMemoryStore() {
+    delete table_.load();
+}
+
+void RcuMemoryStore::RetireTable(Table* table) {
+    EpochManager::instance().Retire(table);
+}
+
+const RcuMemoryStore::Node* RcuMemoryStore::FindNode(const std::string& key, size_t hash) const {
+    Table* table = table_.load(std::memory_order_acquire);
+    const Node* node = table->buckets[hash & table->mask].load(std::memory_order_acquire);
+    while (node) {
+        if (node->hash == hash && node->key == key) {
+            return node;
+        }
+        node = node->next.load(std::memory_order_acquire);
+    }
+    return nullptr;
+}
+
+std::atomic<RcuMemoryStore::Node*>* RcuMemoryStore::FindLink(Table* table, const std::string& key,
+                                                             size_t hash) {
+    std::atomic<Node*>* link = &table->buckets[hash & table->mask];
+    Node* node = link->load(std::memory_order_relaxed);
+    while (node) {
+        if (node->hash == hash && node->key == key) {
+            return link;
+        }
+        link = &node->next;
+        node = link->load(std::memory_order_relaxed);
+    }
+    return nullptr;
+}
+
+Status RcuMemoryStore::Put(const std::string& key, const std::string& value) {
+    if (key.empty()) {
+        return Status::Error("Key cannot be empty");
+    }
+
+    size_t hash = std::hash<std::string>()(key);
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    Table* table = table_.load(std::memory_order_relaxed);
+
+    std::atomic<Node*>* link = FindLink(table, key, hash);
+    if (link) {
+        // 复制出新节点替换旧节点，正在读旧节点的读者不受影响
+        Node* old_node = link->load(std::memory_order_relaxed);
+        Node* new_node = new Node(hash, key, value, old_node->next.load(std::memory_order_relaxed));
+        link->store(new_node, std::memory_order_release);
+        EpochManager::instance().Retire(old_node);
+    } else {
+        std::atomic<Node*>& head = table->buckets[hash & table->mask];
+        head.store(new Node(hash, key, value, head.load(std::memory_order_relaxed)),
+                   std::memory_order_release);
+        size_.fetch_add(1, std::memory_order_relaxed);
+        MaybeGrow();
+    }
+
+    LOG_DEBUG("Put key: " + key + ", value: " + value);
+    return Status::OK_STATUS();
+}
+
+Status RcuMemoryStore::Get(const std::string& key, std::string& value) {
+    size_t hash = std::hash<std::string>()(key);
+    EpochManager::Guard guard;
+
+    const Node* node = FindNode(key, hash);
+    if (!node) {
+        LOG_DEBUG("Key not found: " + key);
+        return Status::KeyNotFound(key);
+    }
+
+    value = node->value;
+    LOG_DEBUG("Get key: " + key + ", value: " + value);
+    return Status::OK_STATUS();
+}
+
+Status RcuMemoryStore::Delete(const std::string& key) {
+    size_t hash = std::hash<std::string>()(key);
+    std::lock_guard<std::mutex> lock(write_mutex_);
+
+    std::atomic<Node*>* link = FindLink(table_.load(std::memory_order_relaxed), key, hash);
+    if (!link) {
+        return Status::KeyNotFound(key);
+    }
+
+    Node* node = link->load(std::memory_order_relaxed);
+    link->store(node->next.load(std::memory_order_relaxed), std::memory_order_release);
+    EpochManager::instance().Retire(node);
+    size_.fetch_sub(1, std::memory_order_relaxed);
+
+    LOG_DEBUG("Delete key: " + key);
+    return Status::OK_STATUS();
+}
+
+Status RcuMemoryStore::Contains(const std::string& key) {
+    size_t hash = std::hash<std::string>()(key);
+    EpochManager::Guard guard;
+    return FindNode(key, hash) ? Status::OK_STATUS() : Status::KeyNotFound(key);
+}
+
+size_t RcuMemoryStore::Size() const {
+    return size_.load(std::memory_order_relaxed);
+}
+
+void RcuMemoryStore::Clear() {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    Table* old_table = table_.load(std::memory_order_relaxed);
+    table_.store(new Table(old_table->mask + 1), std::memory_order_release);
+    size_.store(0, std::memory_order_relaxed);
+    RetireTable(old_table);
+    LOG_INFO("RCU memory store cleared");
+}
+
+Status RcuMemoryStore::ForEach(const ForEachCallback& callback) {
+    EpochManager::Guard guard;
+    Table* table = table_.load(std::memory_order_acquire);
+    for (size_t i = 0; i <= table->mask; ++i) {
+        for (const Node* node = table->buckets[i].load(std::memory_order_acquire); node;
+             node = node->next.load(std::memory_order_acquire)) {
+            callback(node->key, node->value, -1);
+        }
+    }
+    return Status::OK_STATUS();
+}
+
+void RcuMemoryStore::MaybeGrow() {
+    Table* old_table = table_.load(std::memory_order_relaxed);
+    size_t bucket_count = old_table->mask + 1;
+    if (size_.load(std::memory_order_relaxed) <= bucket_count * 2) {
+        return;
+    }
+
+    // 旧表里的节点仍可能被读者访问，不能修改它们的next指针，
+    // 所以把所有节点复制到新表后整体替换，旧表连同节点一起延迟释放
+    Table* new_table = new Table(bucket_count * 2);
+    for (size_t i = 0; i < bucket_count; ++i) {
+        Node* node = old_table->buckets[i].load(std::memory_order_relaxed);
+        while (node) {
+            std::atomic<Node*>& head = new_table->buckets[node->hash & new_table->mask];
+            head.store(new Node(node->hash, node->key, node->value, head.load(std::memory_order_relaxed)),
+                       std::memory_order_relaxed);
+            node = node->next.load(std::memory_order_relaxed);
+        }
+    }
+    table_.store(new_table, std::memory_order_release);
+    RetireTable(old_table);
+    LOG_DEBUG("RCU table grown to " + std::to_string(bucket_count * 2) + " buckets");
+}
+
+std::unique_ptr<KVStore> KVStore::CreateRcuMemoryStore() {
+    return std::make_unique<RcuMemoryStore>();
+}
@@ -0,0 +1,64 @@
+// src/core/rcu_memory_store.h
+#ifndef RCU_MEMORY_STORE_H
+#define RCU_MEMORY_STORE_H
+
+#include "kv_store.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+// 读多写少场景的存储：读路径无锁
+//
+// 节点发布后内容不可变，更新时复制出新节点并原子替换链表指针，
+// 被替换的节点交给EpochManager延迟释放。读者只在自己的纪元槽位上写，
+// 不获取任何锁；写者之间用一把互斥锁串行化，保证写操作可线性化。
+class RcuMemoryStore : public KVStore {
+public:
+    explicit RcuMemoryStore(size_t initial_buckets = 1024);
+    ~RcuMemoryStore() override;
+
+    Status Put(const std::string& key, const std::string& value) override;
+    Status Get(const std::string& key, std::string& value) override;
+    Status Delete(const std::string& key) override;
+    Status Contains(const std::string& key) override;
+    size_t Size() const override;
+    void Clear() override;
+    // 在一个纪元临界区内遍历当前表，不阻塞写者，但遍历期间被替换的节点要等遍历结束才能回收
+    Status ForEach(const ForEachCallback& callback) override;
+
+private:
+    struct Node {
+        Node(size_t h, const std::string& k, const std::string& v, Node* n)
+            : hash(h), key(k), value(v), next(n) {}
+
+        const size_t hash;
+        const std::string key;
+        const std::string value;
+        std::atomic<Node*> next;
+    };
+
+    struct Table {
+        explicit Table(size_t n);
+        ~Table();
+
+        size_t mask;
+        std::unique_ptr<std::atomic<Node*>[]> buckets;
+    };
+
+    // 读者：在Guard保护下查找节点
+    const Node* FindNode(const std::string& key, size_t hash) const;
+
+    // 写者（持有write_mutex_）：返回指向目标节点的链接指针，不存在时返回nullptr
+    std::atomic<Node*>* FindLink(Table* table, const std::string& key, size_t hash);
+
+    // 写者（持有write_mutex_）：负载因子超过2时扩容为两倍
+    void MaybeGrow();
+
+    static void RetireTable(Table* table);
+
+    std::atomic<Table*> table_;
+    std::atomic<size_t> size_;
+    std::mutex write_mutex_;
+};
+
+#endif // RCU_MEMORY_STORE_H
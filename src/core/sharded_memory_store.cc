@@ -0,0 +1,210 @@
+// src/core/sharded_memory_store.cc
+#include "sharded_memory_store.h"
+#include "../common/logger.h"
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace {
+
+size_t RoundUpToPowerOfTwo(size_t n) {
+    size_t result = 1;
+    while (result < n) {
+        result <<= 1;
+    }
+    return result;
+}
+
+}  // namespace
+
+ShardedMemoryStore::ShardedMemoryStore(size_t num_shards) {
+    if (num_shards == 0) {
+        num_shards = kDefaultShards;
+    }
+    num_shards = RoundUpToPowerOfTwo(num_shards);
+    shards_.reset(new Shard[num_shards]);
+    shard_mask_ = num_shards - 1;
+}
+
+size_t ShardedMemoryStore::ShardIndex(const std::string& key) const {
+    size_t h = std::hash<std::string>()(key);
+    // 用高位参与分片选择，与分片内哈希表使用的哈希互不相关
+    return (h ^ (h >> 32)) & shard_mask_;
+}
+
+template <typename Fn>
+void ShardedMemoryStore::ForEachShardGroup(const std::vector<std::string>& keys, size_t n, Fn fn) {
+    // 按分片计数排序：O(n + 分片数)，且天然稳定，同一个key出现多次时按原顺序处理。
+    // 批量通常只有几十到几百个key，分到每个分片的很少，比较排序和每次分配的开销会抵消合并加锁的收益
+    thread_local std::vector<size_t> shard_of;
+    thread_local std::vector<size_t> starts;
+    thread_local std::vector<size_t> order;
+    size_t shards = ShardCount();
+    shard_of.resize(n);
+    starts.assign(shards + 1, 0);
+    order.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        shard_of[i] = ShardIndex(keys[i]);
+        starts[shard_of[i] + 1]++;
+    }
+    for (size_t s = 0; s < shards; ++s) {
+        starts[s + 1] += starts[s];
+    }
+    for (size_t i = 0; i < n; ++i) {
+        order[starts[shard_of[i]]++] = i;
+    }
+    // 放置完成后starts[s]是分片s的结束位置，也就是分片s+1的起始位置
+    size_t begin = 0;
+    for (size_t s = 0; s < shards; ++s) {
+        size_t end = starts[s];
+        if (end > begin) {
+            std::lock_guard<std::mutex> lock(shards_[s].mutex);
+            fn(shards_[s], order.data() + begin, end - begin);
+        }
+        begin = end;
+    }
+}
+
+void ShardedMemoryStore::MultiGet(const std::vector<std::string>& keys, std::vector<std::string>* values,
+                                  std::vector<char>* found) {
+    values->resize(keys.size());
+    found->resize(keys.size());
+    ForEachShardGroup(keys, keys.size(), [&](Shard& shard, const size_t* indices, size_t count) {
+        shard.data.ForEachPrefetched(count, [&](size_t i) -> const std::string& { return keys[indices[i]]; },
+                                     [&](size_t i, size_t hash) {
+            size_t k = indices[i];
+            (*found)[k] = shard.data.Find(keys[k], hash, &(*values)[k]);
+        });
+    });
+}
+
+Status ShardedMemoryStore::MultiPut(const std::vector<std::string>& keys, const std::vector<std::string>& values) {
+    size_t n = std::min(keys.size(), values.size());
+    for (size_t i = 0; i < n; ++i) {
+        if (keys[i].empty()) {
+            return Status::Error("Key cannot be empty");
+        }
+    }
+    ForEachShardGroup(keys, n, [&](Shard& shard, const size_t* indices, size_t count) {
+        shard.data.ForEachPrefetched(count, [&](size_t i) -> const std::string& { return keys[indices[i]]; },
+                                     [&](size_t i, size_t) {
+            shard.data.Insert(keys[indices[i]], values[indices[i]]);
+        });
+        shard.count.store(shard.data.size(), std::memory_order_relaxed);
+    });
+    return Status::OK_STATUS();
+}
+
+size_t ShardedMemoryStore::MultiDelete(const std::vector<std::string>& keys) {
+    size_t deleted = 0;
+    ForEachShardGroup(keys, keys.size(), [&](Shard& shard, const size_t* indices, size_t count) {
+        shard.data.ForEachPrefetched(count, [&](size_t i) -> const std::string& { return keys[indices[i]]; },
+                                     [&](size_t i, size_t) {
+            deleted += shard.data.Erase(keys[indices[i]]) ? 1 : 0;
+        });
+        shard.count.store(shard.data.size(), std::memory_order_relaxed);
+    });
+    return deleted;
+}
+
+Status ShardedMemoryStore::Put(const std::string& key, const std::string& value) {
+    if (key.empty()) {
+        return Status::Error("Key cannot be empty");
+    }
+
+    Shard& shard = ShardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    if (shard.data.Insert(key, value)) {
+        shard.count.store(shard.data.size(), std::memory_order_relaxed);
+    }
+    LOG_DEBUG("Put key: " + key + ", value: " + value);
+    return Status::OK_STATUS();
+}
+
+Status ShardedMemoryStore::Get(const std::string& key, std::string& value) {
+    Shard& shard = ShardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    if (!shard.data.Find(key, &value)) {
+        LOG_DEBUG("Key not found: " + key);
+        return Status::KeyNotFound(key);
+    }
+
+    LOG_DEBUG("Get key: " + key + ", value: " + value);
+    return Status::OK_STATUS();
+}
+
+Status ShardedMemoryStore::Delete(const std::string& key) {
+    Shard& shard = ShardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    if (!shard.data.Erase(key)) {
+        return Status::KeyNotFound(key);
+    }
+    shard.count.store(shard.data.size(), std::memory_order_relaxed);
+
+    LOG_DEBUG("Delete key: " + key);
+    return Status::OK_STATUS();
+}
+
+Status ShardedMemoryStore::Contains(const std::string& key) {
+    Shard& shard = ShardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.data.Contains(key) ? Status::OK_STATUS() : Status::KeyNotFound(key);
+}
+
+size_t ShardedMemoryStore::Size() const {
+    // 各分片计数独立读取，并发写入时结果是近似值
+    size_t total = 0;
+    for (size_t i = 0; i <= shard_mask_; ++i) {
+        total += shards_[i].count.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void ShardedMemoryStore::Clear() {
+    for (size_t i = 0; i <= shard_mask_; ++i) {
+        std::lock_guard<std::mutex> lock(shards_[i].mutex);
+        shards_[i].data.Clear();
+        shards_[i].count.store(0, std::memory_order_relaxed);
+    }
+    LOG_INFO("Sharded memory store cleared");
+}
+
+void ShardedMemoryStore::Reserve(size_t expected_keys) {
+    // 哈希分布不完全均匀，每个分片多留1/8的余量
+    size_t per_shard = expected_keys / ShardCount();
+    per_shard += per_shard / 8;
+    for (size_t i = 0; i <= shard_mask_; ++i) {
+        std::lock_guard<std::mutex> lock(shards_[i].mutex);
+        shards_[i].data.Reserve(per_shard);
+    }
+}
+
+Status ShardedMemoryStore::ForEach(const ForEachCallback& callback) {
+    const size_t kBatchSlots = 1024;
+    std::vector<std::pair<std::string, std::string>> batch;
+    for (size_t i = 0; i <= shard_mask_; ++i) {
+        FlatHashTable::ScanCursor cursor;
+        while (!cursor.done) {
+            {
+                std::lock_guard<std::mutex> lock(shards_[i].mutex);
+                shards_[i].data.Scan(&cursor, kBatchSlots, [&](const char* key, size_t key_len,
+                                                               const char* value, size_t value_len) {
+                    batch.emplace_back(std::string(key, key_len), std::string(value, value_len));
+                });
+            }
+            for (const auto& kv : batch) {
+                callback(kv.first, kv.second, -1);
+            }
+            batch.clear();
+        }
+    }
+    return Status::OK_STATUS();
+}
+
+std::unique_ptr<KVStore> KVStore::CreateShardedMemoryStore(size_t num_shards) {
+    return std::make_unique<ShardedMemoryStore>(num_shards);
+}
@@ -0,0 +1,59 @@
+// src/core/sharded_memory_store.h
+#ifndef SHARDED_MEMORY_STORE_H
+#define SHARDED_MEMORY_STORE_H
+
+#include "kv_store.h"
+#include "flat_hash_table.h"
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// 分片内存存储：按key哈希把数据分散到N个独立子表，
+// 每个子表有自己的锁，不同分片上的操作可以并行执行
+class ShardedMemoryStore : public KVStore {
+public:
+    static const size_t kDefaultShards = 64;
+
+    // num_shards 会向上取整到2的幂，0表示使用默认值
+    explicit ShardedMemoryStore(size_t num_shards = kDefaultShards);
+
+    Status Put(const std::string& key, const std::string& value) override;
+    Status Get(const std::string& key, std::string& value) override;
+    Status Delete(const std::string& key) override;
+    Status Contains(const std::string& key) override;
+    size_t Size() const override;
+    void Clear() override;
+    void Reserve(size_t expected_keys) override;
+    // 逐个分片分批遍历，每批只持有一个分片的锁
+    Status ForEach(const ForEachCallback& callback) override;
+
+    // 按分片分组，每个涉及到的分片只加锁一次，分片内提前预取后面key所在的控制字节
+    void MultiGet(const std::vector<std::string>& keys, std::vector<std::string>* values,
+                  std::vector<char>* found) override;
+    Status MultiPut(const std::vector<std::string>& keys, const std::vector<std::string>& values) override;
+    size_t MultiDelete(const std::vector<std::string>& keys) override;
+
+    size_t ShardCount() const { return shard_mask_ + 1; }
+
+private:
+    // 每个分片独占整数个缓存行，避免相邻分片的锁和计数器伪共享
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        FlatHashTable data;
+        // 只在持有mutex时修改，Size()无锁读取
+        std::atomic<size_t> count{0};
+    };
+
+    size_t ShardIndex(const std::string& key) const;
+    Shard& ShardFor(const std::string& key) { return shards_[ShardIndex(key)]; }
+    // 把keys[0..n)按所属分片分组，对每组持有该分片的锁调用fn(shard, indices, count)，
+    // indices是这一组key在keys中的下标，同一分片内保持原来的顺序
+    template <typename Fn>
+    void ForEachShardGroup(const std::vector<std::string>& keys, size_t n, Fn fn);
+
+    std::unique_ptr<Shard[]> shards_;
+    size_t shard_mask_;
+};
+
+#endif // SHARDED_MEMORY_STORE_H
@@ -0,0 +1,222 @@
+// src/core/skiplist_store.cc
+#include "skiplist_store.h"
+#include "epoch_manager.h"
+#include "../common/logger.h"
+#include <new>
+#include <utility>
+#include <vector>
+
+const int SkipListStore::kMaxHeight;
+const size_t SkipListStore::kIteratorBatch;
+
+// 迭代器：在纪元临界区内把一批条目复制出来，批与批之间按上一批最后一个key重新定位
+class SkipListStore::Iterator : public KVIterator {
+public:
+    explicit Iterator(const SkipListStore* store) : store_(store), pos_(0), exhausted_(true) {}
+
+    bool Valid() const override { return pos_ < batch_.size(); }
+
+    void Seek(const std::string& target) override { Fill(target, true); }
+
+    void Next() override {
+        if (++pos_ == batch_.size() && !exhausted_) {
+            std::string last = std::move(batch_.back().first);
+            Fill(last, false);
+        }
+    }
+
+    const std::string& key() const override { return batch_[pos_].first; }
+    const std::string& value() const override { return batch_[pos_].second; }
+
+private:
+    void Fill(const std::string& start, bool inclusive) {
+        batch_.clear();
+        pos_ = 0;
+        EpochManager::Guard guard;
+        Node* node = store_->FindGreaterOrEqual(start, inclusive, nullptr);
+        while (node && batch_.size() < kIteratorBatch) {
+            batch_.emplace_back(node->key, *node->value.load(std::memory_order_acquire));
+            node = node->next[0].load(std::memory_order_acquire);
+        }
+        exhausted_ = node == nullptr;
+    }
+
+    const SkipListStore* store_;
+    std::vector<std::pair<std::string, std::string>> batch_;
+    size_t pos_;
+    // 当前批之后已没有条目
+    bool exhausted_;
+};
+
+SkipListStore::Node* SkipListStore::Node::Create(const std::string& key, const std::string* value, int height) {
+    void* mem = ::operator new(sizeof(Node) + sizeof(std::atomic<Node*>) * (height - 1));
+    Node* node = new (mem) Node{key, {value}, height, {}};
+    for (int i = 0; i < height; ++i) {
+        new (&node->next[i]) std::atomic<Node*>(nullptr);
+    }
+    return node;
+}
+
+void SkipListStore::Node::Destroy(void* ptr) {
+    Node* node = static_cast<Node*>(ptr);
+    delete node->value.load(std::memory_order_relaxed);
+    node->~Node();
+    ::operator delete(ptr);
+}
+
+SkipListStore::SkipListStore()
+    : head_(Node::Create(std::string(), nullptr, kMaxHeight)), max_height_(1), size_(0),
+      rng_state_(0x2545f4914f6cdd1dull) {}
+
+SkipListStore::~SkipListStore() {
+    Node* node = head_;
+    while (node) {
+        Node* next = node->next[0].load(std::memory_order_relaxed);
+        Node::Destroy(node);
+        node = next;
+    }
+}
+
+int SkipListStore::RandomHeight() {
+    // 每层以1/4的概率继续增高
+    int height = 1;
+    while (height < kMaxHeight) {
+        rng_state_ ^= rng_state_ << 13;
+        rng_state_ ^= rng_state_ >> 7;
+        rng_state_ ^= rng_state_ << 17;
+        if (rng_state_ & 3) {
+            break;
+        }
+        height++;
+    }
+    return height;
+}
+
+SkipListStore::Node* SkipListStore::FindGreaterOrEqual(const std::string& target, bool inclusive,
+                                                       Node** prev) const {
+    Node* node = head_;
+    int level = max_height_.load(std::memory_order_acquire) - 1;
+    for (;;) {
+        Node* next = node->next[level].load(std::memory_order_acquire);
+        int cmp = next ? next->key.compare(target) : 1;
+        if (cmp < 0 || (cmp == 0 && !inclusive)) {
+            node = next;
+            continue;
+        }
+        if (prev) {
+            prev[level] = node;
+        }
+        if (level == 0) {
+            return next;
+        }
+        level--;
+    }
+}
+
+Status SkipListStore::Put(const std::string& key, const std::string& value) {
+    if (key.empty()) {
+        return Status::Error("Key cannot be empty");
+    }
+
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    // 被摘下的节点只由写者在持锁时摘除，写者遍历时不会遇到已退休的节点，无需进入纪元
+    Node* prev[kMaxHeight];
+    Node* node = FindGreaterOrEqual(key, true, prev);
+
+    if (node && node->key == key) {
+        // 原子替换值指针，正在读旧值的读者不受影响
+        const std::string* old_value =
+            node->value.exchange(new std::string(value), std::memory_order_acq_rel);
+        EpochManager::instance().Retire(const_cast<std::string*>(old_value));
+    } else {
+        int height = RandomHeight();
+        int max_height = max_height_.load(std::memory_order_relaxed);
+        if (height > max_height) {
+            for (int i = max_height; i < height; ++i) {
+                prev[i] = head_;
+            }
+            // 读者先看到新高度时，head在新层上的指针为空或指向已初始化好的新节点，都是安全的
+            max_height_.store(height, std::memory_order_release);
+        }
+
+        Node* new_node = Node::Create(key, new std::string(value), height);
+        for (int i = 0; i < height; ++i) {
+            new_node->next[i].store(prev[i]->next[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            prev[i]->next[i].store(new_node, std::memory_order_release);
+        }
+        size_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    LOG_DEBUG("Put key: " + key + ", value: " + value);
+    return Status::OK_STATUS();
+}
+
+Status SkipListStore::Get(const std::string& key, std::string& value) {
+    EpochManager::Guard guard;
+    Node* node = FindGreaterOrEqual(key, true, nullptr);
+    if (!node || node->key != key) {
+        LOG_DEBUG("Key not found: " + key);
+        return Status::KeyNotFound(key);
+    }
+
+    value = *node->value.load(std::memory_order_acquire);
+    LOG_DEBUG("Get key: " + key + ", value: " + value);
+    return Status::OK_STATUS();
+}
+
+Status SkipListStore::Delete(const std::string& key) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    Node* prev[kMaxHeight];
+    Node* node = FindGreaterOrEqual(key, true, prev);
+    if (!node || node->key != key) {
+        return Status::KeyNotFound(key);
+    }
+
+    // 自顶向下摘链，被删节点自身的next指针保持不变
+    for (int i = node->height - 1; i >= 0; --i) {
+        prev[i]->next[i].store(node->next[i].load(std::memory_order_relaxed), std::memory_order_release);
+    }
+    EpochManager::instance().RetireRaw(node, &Node::Destroy);
+    size_.fetch_sub(1, std::memory_order_relaxed);
+
+    LOG_DEBUG("Delete key: " + key);
+    return Status::OK_STATUS();
+}
+
+Status SkipListStore::Contains(const std::string& key) {
+    EpochManager::Guard guard;
+    Node* node = FindGreaterOrEqual(key, true, nullptr);
+    return node && node->key == key ? Status::OK_STATUS() : Status::KeyNotFound(key);
+}
+
+size_t SkipListStore::Size() const {
+    return size_.load(std::memory_order_relaxed);
+}
+
+void SkipListStore::Clear() {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    RetireAll();
+    LOG_INFO("Skiplist store cleared");
+}
+
+void SkipListStore::RetireAll() {
+    Node* node = head_->next[0].load(std::memory_order_relaxed);
+    for (int i = 0; i < kMaxHeight; ++i) {
+        head_->next[i].store(nullptr, std::memory_order_release);
+    }
+    // 正在遍历的读者仍可沿被摘下节点的next指针走完，节点在它们离开后才释放
+    while (node) {
+        Node* next = node->next[0].load(std::memory_order_relaxed);
+        EpochManager::instance().RetireRaw(node, &Node::Destroy);
+        node = next;
+    }
+    size_.store(0, std::memory_order_relaxed);
+}
+
+std::unique_ptr<KVIterator> SkipListStore::NewIterator() {
+    return std::unique_ptr<KVIterator>(new Iterator(this));
+}
+
+std::unique_ptr<KVStore> KVStore::CreateSkipListStore() {
+    return std::make_unique<SkipListStore>();
+}
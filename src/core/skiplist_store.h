@@ -0,0 +1,66 @@
+// src/core/skiplist_store.h
+#ifndef SKIPLIST_STORE_H
+#define SKIPLIST_STORE_H
+
+#include "kv_store.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+// 按key有序的存储：跳表
+//
+// 读者（Get/Contains/迭代器）不加锁，在EpochManager的临界区内沿原子指针前进；
+// 写者之间用一把互斥锁串行化。新节点先初始化完再自底向上发布，
+// 删除的节点只摘链不修改其next指针，正停在它上面的读者可以继续往后走，
+// 节点和被覆盖的旧值都交给EpochManager延迟释放。
+//
+// 迭代器每次在临界区内取一批条目，批与批之间不持有纪元，
+// 长时间的范围扫描既不阻塞写者，也不会长时间阻止内存回收。
+class SkipListStore : public KVStore {
+public:
+    static const int kMaxHeight = 16;
+    // 迭代器每批读取的条目数
+    static const size_t kIteratorBatch = 64;
+
+    SkipListStore();
+    ~SkipListStore() override;
+
+    Status Put(const std::string& key, const std::string& value) override;
+    Status Get(const std::string& key, std::string& value) override;
+    Status Delete(const std::string& key) override;
+    Status Contains(const std::string& key) override;
+    size_t Size() const override;
+    void Clear() override;
+    std::unique_ptr<KVIterator> NewIterator() override;
+
+private:
+    class Iterator;
+
+    struct Node {
+        const std::string key;
+        std::atomic<const std::string*> value;
+        const int height;
+        // 实际长度为height，随节点一起分配
+        std::atomic<Node*> next[1];
+
+        static Node* Create(const std::string& key, const std::string* value, int height);
+        static void Destroy(void* node);
+    };
+
+    // 读者：返回第一个key不小于target的节点（inclusive为false时严格大于），需在纪元临界区内调用。
+    // prev不为空时记录每层最后一个小于target的节点，供写者使用
+    Node* FindGreaterOrEqual(const std::string& target, bool inclusive, Node** prev) const;
+
+    // 写者（持有write_mutex_）
+    int RandomHeight();
+    // 摘下并延迟释放所有节点
+    void RetireAll();
+
+    Node* head_;
+    std::atomic<int> max_height_;
+    std::atomic<size_t> size_;
+    uint64_t rng_state_;
+    std::mutex write_mutex_;
+};
+
+#endif // SKIPLIST_STORE_H
@@ -0,0 +1,121 @@
+// src/core/timing_wheel.cc
+#include "timing_wheel.h"
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+const int TimingWheel::kLevels;
+const int TimingWheel::kLevel0Bits;
+const int TimingWheel::kLevelBits;
+
+TimingWheel::TimingWheel(uint64_t now_ms) : pending_pos_(0), current_(now_ms), size_(0) {
+    for (int level = 0; level < kLevels; ++level) {
+        levels_[level].resize(SlotsAt(level));
+        level_size_[level] = 0;
+    }
+}
+
+void TimingWheel::Schedule(const std::string& key, uint64_t deadline_ms) {
+    Entry entry;
+    entry.key = key;
+    entry.deadline = deadline_ms;
+    Place(std::move(entry));
+    size_++;
+}
+
+void TimingWheel::Place(Entry&& entry) {
+    if (entry.deadline <= current_) {
+        pending_.push_back(std::move(entry));
+        return;
+    }
+    const uint64_t delta = entry.deadline - current_;
+    for (int level = 0; level < kLevels; ++level) {
+        const uint64_t span = uint64_t(1) << (ShiftAt(level) + (level == 0 ? kLevel0Bits : kLevelBits));
+        if (delta < span || level == kLevels - 1) {
+            // 超出总跨度的条目放到最高层最远的槽位，转到时按真实到期时间重新放置
+            uint64_t when = delta < span ? entry.deadline : current_ + span - 1;
+            size_t slot = (when >> ShiftAt(level)) & (SlotsAt(level) - 1);
+            levels_[level][slot].push_back(std::move(entry));
+            level_size_[level]++;
+            return;
+        }
+    }
+}
+
+void TimingWheel::MoveToPending(int level, size_t index) {
+    std::vector<Entry>& slot = levels_[level][index];
+    if (slot.empty()) {
+        return;
+    }
+    level_size_[level] -= slot.size();
+    if (pending_.empty()) {
+        pending_.swap(slot);
+        return;
+    }
+    pending_.insert(pending_.end(), std::make_move_iterator(slot.begin()), std::make_move_iterator(slot.end()));
+    slot.clear();
+}
+
+bool TimingWheel::Advance(uint64_t now_ms, size_t max_work, const ExpireCallback& callback) {
+    size_t work = 0;
+    for (;;) {
+        while (pending_pos_ < pending_.size()) {
+            if (work == max_work) {
+                return false;
+            }
+            work++;
+            Entry& entry = pending_[pending_pos_++];
+            if (entry.deadline <= current_) {
+                size_--;
+                callback(entry.key, entry.deadline);
+            } else {
+                Place(std::move(entry));
+            }
+        }
+        pending_.clear();
+        pending_pos_ = 0;
+
+        if (current_ >= now_ms) {
+            return true;
+        }
+        if (size_ == 0) {
+            current_ = now_ms;
+            return true;
+        }
+
+        // 低层都为空时直接跳到第一个非空层的下一个槽位边界，空闲时推进时间不必逐个tick
+        int lowest = 0;
+        while (lowest < kLevels - 1 && level_size_[lowest] == 0) {
+            lowest++;
+        }
+        if (lowest > 0) {
+            uint64_t boundary = ((current_ >> ShiftAt(lowest)) + 1) << ShiftAt(lowest);
+            current_ = std::min(now_ms, boundary - 1);
+            if (current_ == now_ms) {
+                return true;
+            }
+        }
+
+        // 前进一个tick：低位全为0的高层槽位级联下来，再取出第0层当前槽位
+        current_++;
+        for (int level = 1; level < kLevels; ++level) {
+            if (current_ & ((uint64_t(1) << ShiftAt(level)) - 1)) {
+                break;
+            }
+            MoveToPending(level, (current_ >> ShiftAt(level)) & (SlotsAt(level) - 1));
+        }
+        MoveToPending(0, current_ & (SlotsAt(0) - 1));
+    }
+}
+
+void TimingWheel::Clear() {
+    for (int level = 0; level < kLevels; ++level) {
+        for (auto& slot : levels_[level]) {
+            slot.clear();
+        }
+        level_size_[level] = 0;
+    }
+    pending_.clear();
+    pending_pos_ = 0;
+    size_ = 0;
+}
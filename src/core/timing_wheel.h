@@ -0,0 +1,67 @@
+// src/core/timing_wheel.h
+#ifndef TIMING_WHEEL_H
+#define TIMING_WHEEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// 分层时间轮，按毫秒精度记录key的到期时间
+//
+// 第0层256个槽位，每槽1ms；往上4层各64个槽位，每层的一个槽位覆盖下一层整圈，
+// 总跨度2^32 ms（约49天），更远的到期时间先放在最高层，转到时再重新放置。
+// 高层槽位转到时把其中的条目"级联"到低层，每个条目最多被移动层数次，
+// 插入和到期都是摊还O(1)。
+//
+// 时间轮本身不支持删除：key的过期时间被修改或清除后旧条目照常到期，
+// 由回调方对比当前的过期时间判断是否仍然有效。非线程安全，由调用者加锁。
+class TimingWheel {
+public:
+    using ExpireCallback = std::function<void(const std::string& key, uint64_t deadline_ms)>;
+
+    explicit TimingWheel(uint64_t now_ms = 0);
+
+    // 记录key在deadline_ms到期；已经过去的时间在下次Advance时立即到期
+    void Schedule(const std::string& key, uint64_t deadline_ms);
+
+    // 把时间推进到now_ms，对每个到期条目调用callback。
+    // 到期和级联合计最多处理max_work个条目，没处理完时返回false，剩余部分留给下次调用
+    bool Advance(uint64_t now_ms, size_t max_work, const ExpireCallback& callback);
+
+    void Clear();
+
+    // 尚未到期的条目数（含已失效的旧条目）
+    size_t size() const { return size_; }
+
+private:
+    static const int kLevels = 5;
+    static const int kLevel0Bits = 8;
+    static const int kLevelBits = 6;
+
+    struct Entry {
+        std::string key;
+        uint64_t deadline;
+    };
+
+    // 第level层的槽位数和每个槽位覆盖的时间位数
+    static size_t SlotsAt(int level) { return size_t(1) << (level == 0 ? kLevel0Bits : kLevelBits); }
+    static int ShiftAt(int level) { return level == 0 ? 0 : kLevel0Bits + (level - 1) * kLevelBits; }
+
+    // 按到期时间与current_的距离放入对应层的槽位，已到期的放入pending_
+    void Place(Entry&& entry);
+    // 把第level层一个槽位的全部条目移入pending_
+    void MoveToPending(int level, size_t slot);
+
+    std::vector<std::vector<Entry>> levels_[kLevels];
+    // 每层的条目数，低层为空时推进时间可以直接跳到高层的下一个槽位边界
+    size_t level_size_[kLevels];
+    // 已到期或待级联的条目，必须全部处理完才继续推进时间
+    std::vector<Entry> pending_;
+    size_t pending_pos_;
+    uint64_t current_;
+    size_t size_;
+};
+
+#endif // TIMING_WHEEL_H
@@ -1,10 +1,24 @@
 // src/main_server.cc
 #include "core/kv_store.h"
+#include "core/eviction_policy.h"
 #include "network/simple_server.h"
+#include "storage/durable_store.h"
+#include "storage/lsm_store.h"
+#include "storage/tiered_store.h"
+#include "storage/snapshot.h"
 #include "common/logger.h"
+#include "common/utils.h"
+#include <algorithm>
 #include <iostream>
 #include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cctype>
+#include <cerrno>
 #include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 std::unique_ptr<SimpleServer> server;
 
@@ -15,6 +29,40 @@ void signal_handler(int signal) {
     }
 }
 
+// 创建纯内存引擎，engine不是内存引擎时返回空
+std::unique_ptr<KVStore> CreateMemoryEngine(const std::string& engine, size_t maxmemory, const std::string& eviction) {
+    if (engine == "memory") {
+        return KVStore::CreateMemoryStore(maxmemory, eviction);
+    } else if (engine == "sharded") {
+        return KVStore::CreateShardedMemoryStore();
+    } else if (engine == "rcu") {
+        return KVStore::CreateRcuMemoryStore();
+    } else if (engine == "skiplist") {
+        return KVStore::CreateSkipListStore();
+    }
+    return nullptr;
+}
+
+void PrintUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [port] [--engine memory|sharded|rcu|skiplist|lsm|tiered]\n"
+              << "       [--maxmemory <bytes>] [--eviction noeviction|lru|lfu|clock]\n"
+              << "       [--aof <path>] [--aof-fsync always|interval|no] [--aof-fsync-ms <n>]\n"
+              << "       [--data-dir <dir>] [--io threads|epoll|io_uring|shards] [--reactors <n>]" << std::endl;
+}
+
+// 解析正整数参数，整个字符串必须是数字且在int范围内，失败返回false
+bool ParsePositiveInt(const std::string& str, int* value) {
+    if (str.empty() || !std::all_of(str.begin(), str.end(), ::isdigit)) {
+        return false;
+    }
+    try {
+        *value = std::stoi(str);
+    } catch (const std::exception&) {
+        return false;
+    }
+    return *value > 0;
+}
+
 int main(int argc, char* argv[]) {
     // 设置日志级别
     Logger::instance().set_level(INFO);
@@ -26,29 +74,203 @@ int main(int argc, char* argv[]) {
     std::cout << "=== Distributed KV Store - Single Node Server ===" << std::endl;
     std::cout << "Starting server..." << std::endl;
     
+    // 解析命令行参数：kv_server [port] [--engine memory|sharded|rcu|skiplist|lsm|tiered] [--maxmemory <bytes>]
+    //                 [--eviction noeviction|lru|lfu|clock]
+    //                 [--aof <path>] [--aof-fsync always|interval|no] [--aof-fsync-ms <n>]
+    //                 [--data-dir <dir>] [--io threads|epoll|io_uring|shards] [--reactors <n>]
+    int port = 6379;  // 默认使用Redis端口
+    std::string engine = "memory";
+    size_t maxmemory = 0;
+    std::string eviction = "noeviction";
+    AppendLogOptions aof;
+    std::string data_dir;
+    ServerOptions server_options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--engine" && i + 1 < argc) {
+            engine = argv[++i];
+        } else if (arg == "--maxmemory" && i + 1 < argc) {
+            if (!utils::ParseByteSize(argv[++i], &maxmemory)) {
+                std::cerr << "Invalid --maxmemory value: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--eviction" && i + 1 < argc) {
+            eviction = argv[++i];
+            if (!EvictionPolicy::IsValidName(eviction)) {
+                std::cerr << "Unknown eviction policy: " << eviction << std::endl;
+                return 1;
+            }
+        } else if (arg == "--aof" && i + 1 < argc) {
+            aof.path = argv[++i];
+        } else if (arg == "--aof-fsync" && i + 1 < argc) {
+            if (!ParseFsyncPolicy(argv[++i], &aof.fsync)) {
+                std::cerr << "Invalid --aof-fsync value: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--aof-fsync-ms" && i + 1 < argc) {
+            if (!ParsePositiveInt(argv[++i], &aof.fsync_interval_ms)) {
+                std::cerr << "Invalid --aof-fsync-ms value: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--data-dir" && i + 1 < argc) {
+            data_dir = argv[++i];
+        } else if (arg == "--io" && i + 1 < argc) {
+            if (!ParseIoModel(argv[++i], &server_options.io_model)) {
+                std::cerr << "Invalid --io value: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--reactors" && i + 1 < argc) {
+            int reactors = 0;
+            if (!ParsePositiveInt(argv[++i], &reactors)) {
+                std::cerr << "Invalid --reactors value: " << argv[i] << std::endl;
+                return 1;
+            }
+            server_options.reactor_threads = static_cast<size_t>(reactors);
+        } else if (!ParsePositiveInt(arg, &port) || port > 65535) {
+            // 未知参数、缺少取值的参数和非法端口号都走这里
+            if (arg != "--help" && arg != "-h") {
+                std::cerr << "Invalid argument: " << arg << std::endl;
+            }
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+    
     // 创建存储实例
-    auto store = KVStore::CreateMemoryStore();
+    std::unique_ptr<KVStore> store;
+    if (maxmemory > 0 && engine != "memory" && engine != "tiered") {
+        std::cerr << "--maxmemory is only supported by the memory and tiered engines" << std::endl;
+        return 1;
+    }
+    if (eviction != "noeviction" && maxmemory == 0) {
+        std::cerr << "--eviction requires --maxmemory" << std::endl;
+        return 1;
+    }
+    std::vector<std::shared_ptr<KVStore>> shards;
+    if (server_options.io_model == IO_SHARD_PER_CORE) {
+        // 每个分片一个独立的内存引擎，--reactors为分片数，--maxmemory平均分给各分片
+        if (!aof.path.empty() || !data_dir.empty()) {
+            std::cerr << "--io shards does not support --aof or --data-dir" << std::endl;
+            return 1;
+        }
+        size_t count = server_options.reactor_threads;
+        if (count == 0) {
+            count = std::max(1u, std::thread::hardware_concurrency());
+        }
+        for (size_t i = 0; i < count; ++i) {
+            std::unique_ptr<KVStore> shard = CreateMemoryEngine(engine, maxmemory / count, eviction);
+            if (!shard) {
+                std::cerr << "--io shards requires an in-memory engine (memory, sharded, rcu or skiplist)"
+                          << std::endl;
+                return 1;
+            }
+            shards.push_back(std::move(shard));
+        }
+    } else if (engine == "lsm") {
+        // LSM引擎自带预写日志和表文件，数据直接放在数据目录中，不再使用追加写日志和快照
+        if (data_dir.empty() || !aof.path.empty()) {
+            std::cerr << "The lsm engine requires --data-dir and cannot be combined with --aof" << std::endl;
+            return 1;
+        }
+        LsmOptions lsm_options;
+        lsm_options.dir = data_dir;
+        std::unique_ptr<LsmStore> lsm;
+        Status s = LsmStore::Open(lsm_options, &lsm);
+        if (!s.ok()) {
+            std::cerr << "Failed to open LSM store: " << s.message << std::endl;
+            return 1;
+        }
+        store = std::move(lsm);
+    } else if (engine == "tiered") {
+        // --maxmemory是热数据的内存预算，超出部分的value放到数据目录中的值日志
+        if (data_dir.empty()) {
+            std::cerr << "The tiered engine requires --data-dir for its value log" << std::endl;
+            return 1;
+        }
+        TieredOptions tiered_options;
+        tiered_options.dir = data_dir;
+        if (maxmemory > 0) {
+            tiered_options.hot_bytes = maxmemory;
+        }
+        std::unique_ptr<TieredStore> tiered;
+        Status s = TieredStore::Open(tiered_options, &tiered);
+        if (!s.ok()) {
+            std::cerr << "Failed to open tiered store: " << s.message << std::endl;
+            return 1;
+        }
+        store = std::move(tiered);
+    } else if (!(store = CreateMemoryEngine(engine, maxmemory, eviction))) {
+        std::cerr << "Unknown storage engine: " << engine << std::endl;
+        return 1;
+    }
+    // 数据目录中的快照在启动时加载；同时开启日志时由DurableStore把快照和日志拼接起来
+    std::string snapshot_path;
+    if (!data_dir.empty() && engine != "lsm") {
+        if (mkdir(data_dir.c_str(), 0755) != 0 && errno != EEXIST) {
+            std::cerr << "Failed to create data directory: " << data_dir << std::endl;
+            return 1;
+        }
+        snapshot_path = SnapshotManager::SnapshotPath(data_dir);
+    }
+    DurableStore* durable_store = nullptr;
+    if (!aof.path.empty()) {
+        // 先回放日志恢复数据，之后的修改都写入日志
+        std::unique_ptr<DurableStore> durable;
+        Status s = DurableStore::Open(std::move(store), aof, &durable, snapshot_path);
+        if (!s.ok()) {
+            std::cerr << "Failed to open append log: " << s.message << std::endl;
+            return 1;
+        }
+        durable_store = durable.get();
+        store = std::move(durable);
+    } else if (!snapshot_path.empty() && access(snapshot_path.c_str(), F_OK) == 0) {
+        SnapshotHeader header;
+        Status s = LoadSnapshot(snapshot_path, store.get(), &header);
+        if (!s.ok()) {
+            std::cerr << "Failed to load snapshot: " << s.message << std::endl;
+            return 1;
+        }
+    }
+    std::shared_ptr<SnapshotManager> snapshots;
+    if (!snapshot_path.empty()) {
+        snapshots = std::make_shared<SnapshotManager>(store.get(), durable_store, data_dir);
+    }
     
     // 创建并启动服务器
-    int port = 6379;  // 默认使用Redis端口
-    if (argc > 1) {
-        port = std::stoi(argv[1]);
+
+    if (!shards.empty()) {
+        server = std::make_unique<SimpleServer>(port, std::move(shards), server_options);
+    } else {
+        server = std::make_unique<SimpleServer>(port, std::move(store), server_options);
+    }
+    if (snapshots) {
+        server->SetBackgroundSaveHandler([snapshots]() {
+            Status s = snapshots->StartBackgroundSave();
+            return s.ok() ? std::string() : s.message;
+        });
     }
-    
-    server = std::make_unique<SimpleServer>(port, std::move(store));
     
     if (!server->Start()) {
         std::cerr << "Failed to start server" << std::endl;
         return 1;
     }
     
-    std::cout << "Server is running on port " << port << std::endl;
+    std::cout << "Server is running on port " << port << " (engine: " << engine << ")" << std::endl;
     std::cout << "Commands:" << std::endl;
-    std::cout << "  SET <key> <value>" << std::endl;
+    std::cout << "  SET <key> <value> [EX <seconds>|PX <milliseconds>]" << std::endl;
     std::cout << "  GET <key>" << std::endl;
     std::cout << "  DEL <key>" << std::endl;
     std::cout << "  EXISTS <key>" << std::endl;
+    std::cout << "  MGET <key> [key ...]" << std::endl;
+    std::cout << "  MSET <key> <value> [key value ...]" << std::endl;
+    std::cout << "  MDEL <key> [key ...]" << std::endl;
+    std::cout << "  EXPIRE <key> <seconds>" << std::endl;
+    std::cout << "  TTL <key>" << std::endl;
+    std::cout << "  RANGE <start> <end> [LIMIT <n>]" << std::endl;
+    std::cout << "  PREFIX <prefix> [LIMIT <n>]" << std::endl;
+    std::cout << "  BGSAVE" << std::endl;
     std::cout << "  PING" << std::endl;
+    std::cout << "  INFO" << std::endl;
     std::cout << "  QUIT" << std::endl;
     std::cout << "Press Ctrl+C to stop server" << std::endl;
     
@@ -57,6 +279,13 @@ int main(int argc, char* argv[]) {
         std::this_thread::sleep_for(std::chrono::seconds(1));
     }
     
+    if (snapshots) {
+        // 正常退出时保存一次快照，下次启动可以直接加载
+        Status s = snapshots->Save();
+        if (!s.ok()) {
+            std::cerr << "Failed to save snapshot: " << s.message << std::endl;
+        }
+    }
     std::cout << "Server stopped" << std::endl;
     return 0;
 }
@@ -0,0 +1,247 @@
+// src/network/event_loop.cc
+#include "event_loop.h"
+#include "../common/logger.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+const size_t EventLoop::kMaxOutputBytes;
+const size_t EventLoop::kReadBufferSize;
+const int EventLoop::kMaxEvents;
+
+EventLoop::EventLoop(Handler handler)
+    : handler_(std::move(handler)), epoll_fd_(-1), wake_fd_(-1), stopping_(false), connection_count_(0),
+      requests_(0), syscalls_(0) {}
+
+EventLoop::~EventLoop() {
+    Stop();
+    for (auto& kv : connections_) {
+        close(kv.first);
+    }
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        for (int fd : pending_) {
+            close(fd);
+        }
+    }
+    if (wake_fd_ >= 0) {
+        close(wake_fd_);
+    }
+    if (epoll_fd_ >= 0) {
+        close(epoll_fd_);
+    }
+}
+
+bool EventLoop::Start() {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        LOG_ERROR("Failed to create epoll instance: " + std::string(strerror(errno)));
+        return false;
+    }
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        LOG_ERROR("Failed to create eventfd: " + std::string(strerror(errno)));
+        return false;
+    }
+    // 唤醒用的eventfd用data.ptr为空来区分
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.ptr = nullptr;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev) < 0) {
+        LOG_ERROR("Failed to register eventfd: " + std::string(strerror(errno)));
+        return false;
+    }
+    thread_ = std::thread(&EventLoop::Run, this);
+    return true;
+}
+
+void EventLoop::Stop() {
+    stopping_ = true;
+    Wakeup();
+    if (thread_.joinable() && thread_.get_id() != std::this_thread::get_id()) {
+        thread_.join();
+    }
+}
+
+void EventLoop::Wakeup() {
+    if (wake_fd_ >= 0) {
+        uint64_t one = 1;
+        ssize_t n = write(wake_fd_, &one, sizeof(one));
+        (void)n;
+    }
+}
+
+void EventLoop::AddConnection(int fd) {
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        pending_.push_back(fd);
+    }
+    Wakeup();
+}
+
+void EventLoop::RegisterPending() {
+    std::vector<int> fds;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        fds.swap(pending_);
+    }
+    for (int fd : fds) {
+        std::unique_ptr<Connection> conn(new Connection());
+        conn->fd = fd;
+        struct epoll_event ev;
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        ev.data.ptr = conn.get();
+        AddSyscalls(1);
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            LOG_ERROR("Failed to register connection: " + std::string(strerror(errno)));
+            close(fd);
+            continue;
+        }
+        connections_[fd] = std::move(conn);
+        connection_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void EventLoop::Run() {
+    struct epoll_event events[kMaxEvents];
+    while (!stopping_) {
+        // 还有没读完的连接时不阻塞等待
+        int n = epoll_wait(epoll_fd_, events, kMaxEvents, readable_.empty() ? -1 : 0);
+        AddSyscalls(1);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("epoll_wait failed: " + std::string(strerror(errno)));
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            Connection* conn = static_cast<Connection*>(events[i].data.ptr);
+            if (!conn) {
+                uint64_t count;
+                while (read(wake_fd_, &count, sizeof(count)) > 0) {
+                }
+                RegisterPending();
+                continue;
+            }
+            uint32_t mask = events[i].events;
+            if (mask & (EPOLLERR | EPOLLHUP)) {
+                CloseConnection(conn);
+                continue;
+            }
+            if ((mask & (EPOLLIN | EPOLLRDHUP)) && !HandleReadable(conn)) {
+                continue;
+            }
+            if ((mask & EPOLLOUT) && FlushOutput(conn) && conn->read_closed && conn->output.empty()) {
+                CloseConnection(conn);
+            }
+        }
+        ResumeReads();
+    }
+}
+
+void EventLoop::ResumeReads() {
+    std::vector<int> fds;
+    fds.swap(readable_);
+    for (int fd : fds) {
+        auto it = connections_.find(fd);
+        if (it == connections_.end() || !it->second->read_pending) {
+            continue;
+        }
+        it->second->read_pending = false;
+        HandleReadable(it->second.get());
+    }
+}
+
+bool EventLoop::HandleReadable(Connection* conn) {
+    // 边缘触发：必须读到EAGAIN，否则剩余数据不会再有通知。
+    // 读满kMaxReadsPerEvent次或输入超过上限时先停下，由ResumeReads接着读
+    char buffer[kReadBufferSize];
+    bool eof = false;
+    bool more = false;
+    for (int reads = 0;; reads++) {
+        if (reads == kMaxReadsPerEvent || conn->input.pending() > RequestFramer::kMaxCommandBytes) {
+            more = true;
+            break;
+        }
+        ssize_t n = read(conn->fd, buffer, sizeof(buffer));
+        AddSyscalls(1);
+        if (n > 0) {
+            conn->input.Append(buffer, static_cast<size_t>(n));
+            continue;
+        }
+        if (n == 0) {
+            eof = true;
+        } else if (errno == EINTR) {
+            reads--;
+            continue;
+        } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            CloseConnection(conn);
+            return false;
+        }
+        break;
+    }
+
+    // 逐条处理完整的命令，剩余的半条命令保留到下次
+    uint64_t requests = 0;
+    while (conn->input.Next(&request_)) {
+        handler_(request_, conn->output.buffer());
+        requests++;
+    }
+    requests_.store(requests_.load(std::memory_order_relaxed) + requests, std::memory_order_relaxed);
+
+    if (conn->input.broken()) {
+        LOG_WARNING("Closing connection with malformed or oversized request");
+        CloseConnection(conn);
+        return false;
+    }
+    if (!FlushOutput(conn)) {
+        return false;
+    }
+    if (eof) {
+        // 客户端发完请求后半关闭：随FIN到达的命令的响应要先写完，写不完的等EPOLLOUT
+        conn->read_closed = true;
+        if (conn->output.empty()) {
+            CloseConnection(conn);
+            return false;
+        }
+    } else if (more && !conn->read_pending) {
+        conn->read_pending = true;
+        readable_.push_back(conn->fd);
+    }
+    return true;
+}
+
+bool EventLoop::FlushOutput(Connection* conn) {
+    size_t calls = 0;
+    bool ok = conn->output.WriteTo(conn->fd, &calls);
+    AddSyscalls(calls);
+    if (!ok) {
+        CloseConnection(conn);
+        return false;
+    }
+    // 发送缓冲区已满时剩余部分等EPOLLOUT
+    if (conn->output.bytes() > kMaxOutputBytes) {
+        LOG_WARNING("Closing connection whose client is not reading responses");
+        CloseConnection(conn);
+        return false;
+    }
+    return true;
+}
+
+void EventLoop::AddSyscalls(uint64_t n) {
+    syscalls_.store(syscalls_.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+void EventLoop::CloseConnection(Connection* conn) {
+    int fd = conn->fd;
+    // 关闭fd会自动把它从epoll中移除
+    close(fd);
+    connections_.erase(fd);
+    connection_count_.fetch_sub(1, std::memory_order_relaxed);
+    LOG_INFO("Client disconnected");
+}
@@ -0,0 +1,92 @@
+// src/network/event_loop.h
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include "framing.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// 单线程的epoll事件循环（边缘触发），负责一组非阻塞客户端连接的读写
+//
+// 每个连接有自己的输入、输出缓冲。可读时一直读到EAGAIN，由RequestFramer切出全部完整命令
+// 交给handler，半条命令留在输入缓冲等待后续数据；这一批的响应直接写进输出缓冲，用一次write写出，
+// 写不完的部分等EPOLLOUT再写。新连接由接受线程通过AddConnection交给事件循环，用eventfd唤醒。
+class EventLoop {
+public:
+    // 执行命令，把响应追加到out（连接的输出缓冲）末尾
+    using Handler = std::function<void(const Request&, std::string* out)>;
+
+    // 客户端不读取而积压的输出超过上限时断开连接
+    static const size_t kMaxOutputBytes = 64 * 1024 * 1024;
+    static const size_t kReadBufferSize = 16 * 1024;
+    static const int kMaxEvents = 256;
+    // 一次可读事件最多read的次数。还没读到EAGAIN的连接处理完这一批事件后再接着读，
+    // 发送很快的客户端不会独占事件循环，输入缓冲也不会远超命令长度上限
+    static const int kMaxReadsPerEvent = 16;
+
+    explicit EventLoop(Handler handler);
+    ~EventLoop();
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    bool Start();
+    // 通知事件循环退出；不在事件循环线程中调用时等待线程结束
+    void Stop();
+    // 线程安全：把已设为非阻塞的连接交给事件循环，之后由事件循环负责关闭
+    void AddConnection(int fd);
+    size_t ConnectionCount() const { return connection_count_.load(std::memory_order_relaxed); }
+    // 处理过的命令数，以及为此发起的epoll_wait、epoll_ctl、read、sendmsg调用数
+    uint64_t requests() const { return requests_.load(std::memory_order_relaxed); }
+    uint64_t syscalls() const { return syscalls_.load(std::memory_order_relaxed); }
+
+private:
+    struct Connection {
+        int fd = -1;
+        // 对端已关闭写端：不会再有请求，输出写完后关闭连接
+        bool read_closed = false;
+        // 在readable_中：socket里还有没读完的数据，边缘触发不会再通知
+        bool read_pending = false;
+        RequestFramer input;
+        ResponseQueue output;
+    };
+
+    void Run();
+    void Wakeup();
+    void RegisterPending();
+    void AddSyscalls(uint64_t n);
+    // 以下函数返回false表示连接已被关闭
+    bool HandleReadable(Connection* conn);
+    // 接着读取readable_中的连接
+    void ResumeReads();
+    bool FlushOutput(Connection* conn);
+    void CloseConnection(Connection* conn);
+
+    Handler handler_;
+    int epoll_fd_;
+    int wake_fd_;
+    std::thread thread_;
+    std::atomic<bool> stopping_;
+
+    std::mutex pending_mutex_;
+    std::vector<int> pending_;
+    // 只在事件循环线程中访问
+    std::unordered_map<int, std::unique_ptr<Connection>> connections_;
+    // 达到单次读取上限的连接的fd，按fd查找，期间被关闭的连接自然跳过
+    std::vector<int> readable_;
+    // 解析命令时反复使用，保留参数数组的容量
+    Request request_;
+    std::atomic<size_t> connection_count_;
+    // 只由事件循环线程修改
+    std::atomic<uint64_t> requests_;
+    std::atomic<uint64_t> syscalls_;
+};
+
+#endif // EVENT_LOOP_H
@@ -0,0 +1,95 @@
+// src/network/framing.cc
+#include "framing.h"
+#include <sys/socket.h>
+#include <cerrno>
+#include <utility>
+
+const size_t RequestFramer::kMaxCommandBytes;
+const size_t ResponseQueue::kMaxIdleCapacity;
+
+bool RequestFramer::Next(Request* request) {
+    if (protocol_error_ || start_ == buffer_.size()) {
+        Compact();
+        return false;
+    }
+    if (buffer_[start_] == '*') {
+        size_t consumed = 0;
+        int ret = ProtocolParser::ParseRespRequest(buffer_.data() + start_, buffer_.size() - start_, request,
+                                                   &consumed);
+        if (ret <= 0) {
+            protocol_error_ = ret < 0;
+            Compact();
+            return false;
+        }
+        start_ = scan_ = start_ + consumed;
+        return true;
+    }
+
+    size_t end = buffer_.find('\n', scan_);
+    if (end == std::string::npos) {
+        scan_ = buffer_.size();
+        Compact();
+        return false;
+    }
+    size_t len = end - start_;
+    if (len > 0 && buffer_[end - 1] == '\r') {
+        len--;
+    }
+    ProtocolParser::ParseRequest(std::string_view(buffer_.data() + start_, len), request);
+    start_ = scan_ = end + 1;
+    return true;
+}
+
+void RequestFramer::Compact() {
+    buffer_.erase(0, start_);
+    scan_ -= start_;
+    start_ = 0;
+}
+
+bool ResponseQueue::FillIov(struct iovec* iov) {
+    if (offset_ == sending_.size()) {
+        if (buffer_.empty()) {
+            return false;
+        }
+        sending_.swap(buffer_);
+        offset_ = 0;
+    }
+    iov->iov_base = &sending_[offset_];
+    iov->iov_len = sending_.size() - offset_;
+    return true;
+}
+
+void ResponseQueue::Consume(size_t written) {
+    offset_ += written;
+    if (offset_ < sending_.size()) {
+        return;
+    }
+    offset_ = 0;
+    if (sending_.capacity() > kMaxIdleCapacity) {
+        std::string().swap(sending_);
+    } else {
+        sending_.clear();
+    }
+}
+
+bool ResponseQueue::WriteTo(int fd, size_t* syscalls) {
+    struct iovec iov;
+    while (FillIov(&iov)) {
+        // 等价于write，但对端已关闭时返回EPIPE而不是触发SIGPIPE
+        struct msghdr msg = {};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        ssize_t n = sendmsg(fd, &msg, MSG_NOSIGNAL);
+        if (syscalls) {
+            (*syscalls)++;
+        }
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        Consume(static_cast<size_t>(n));
+    }
+    return true;
+}
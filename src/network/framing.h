@@ -0,0 +1,77 @@
+// src/network/framing.h
+#ifndef FRAMING_H
+#define FRAMING_H
+
+#include "../common/protocol.h"
+#include <sys/uio.h>
+#include <cstddef>
+#include <string>
+
+// 从连接的字节流中切出完整的命令并解析
+//
+// 每条命令单独识别协议：以'*'开头的是RESP数组，否则是以'\n'结尾（允许"\r\n"）的内联命令。
+// 一次读取可能包含多条命令，也可能只有半条，半条命令留在缓冲中等后续数据，
+// 命令长度不受单次读取大小限制。
+class RequestFramer {
+public:
+    // 超过该长度仍不完整的命令视为非法，调用方应断开连接
+    static const size_t kMaxCommandBytes = 64 * 1024 * 1024;
+
+    RequestFramer() : start_(0), scan_(0), protocol_error_(false) {}
+
+    void Append(const char* data, size_t size) { buffer_.append(data, size); }
+    // 取出并解析下一条完整命令，没有完整命令或格式错误时返回false。
+    // request的参数指向内部缓冲，下一次调用Next或Append之后失效
+    bool Next(Request* request);
+    // 尚未组成完整命令的字节数
+    size_t pending() const { return buffer_.size() - start_; }
+    // 命令超长或RESP格式错误，调用方应断开连接
+    bool broken() const { return protocol_error_ || pending() > kMaxCommandBytes; }
+
+private:
+    // 已经处理过的命令在没有完整命令时一次性移出缓冲
+    void Compact();
+
+    std::string buffer_;
+    // 下一条命令的起点，以及内联命令已经确认没有换行的位置（避免大value反复从头查找）
+    size_t start_;
+    size_t scan_;
+    bool protocol_error_;
+};
+
+// 连接上待发送的响应
+//
+// 响应直接序列化进一块连续的缓冲，一次write尽量把积压的响应全部写出。异步发送时正在被内核
+// 读取的数据必须保持不动，所以分成两块：sending_是已交给发送的数据，新响应追加到buffer_，
+// sending_写完后两者交换。两块缓冲的容量反复使用，稳定后追加响应不再分配内存。
+class ResponseQueue {
+public:
+    // 写空后容量超过该值的缓冲释放掉，避免偶尔的大响应让连接长期占用内存
+    static const size_t kMaxIdleCapacity = 1024 * 1024;
+
+    ResponseQueue() : offset_(0) {}
+
+    void Push(const std::string& response) { buffer_.append(response); }
+    // 新响应可以直接追加到返回的缓冲末尾
+    std::string* buffer() { return &buffer_; }
+
+    // 写出尽可能多的数据。阻塞fd上一直写到队列为空；非阻塞fd写满时剩余数据留在队列中。
+    // 连接出错时返回false。syscalls不为空时累加发起的系统调用次数
+    bool WriteTo(int fd, size_t* syscalls = nullptr);
+
+    // 异步发送用：用未写出的数据填充iov，没有数据时返回false；写完成后调用Consume。
+    // 两次调用之间追加新响应不影响iov指向的内存
+    bool FillIov(struct iovec* iov);
+    void Consume(size_t written);
+
+    bool empty() const { return bytes() == 0; }
+    size_t bytes() const { return sending_.size() - offset_ + buffer_.size(); }
+
+private:
+    std::string sending_;
+    // sending_中已写出的字节数
+    size_t offset_;
+    std::string buffer_;
+};
+
+#endif // FRAMING_H
@@ -0,0 +1,417 @@
+// src/network/shard_worker.cc
+#include "shard_worker.h"
+#include "../common/logger.h"
+#include "../common/utils.h"
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+const size_t ShardWorker::kQueueCapacity;
+const size_t ShardWorker::kMaxOutputBytes;
+const size_t ShardWorker::kReadBufferSize;
+const int ShardWorker::kMaxEvents;
+
+namespace {
+
+// epoll事件的data.u64：唤醒用的eventfd、监听socket，其余为连接id
+const uint64_t kWakeToken = 0;
+const uint64_t kListenToken = 1;
+const uint64_t kFirstConnectionId = 2;
+
+bool HasKey(const Request& request) {
+    switch (request.type) {
+        case CMD_SET:
+        case CMD_GET:
+        case CMD_DEL:
+        case CMD_EXISTS:
+        case CMD_EXPIRE:
+        case CMD_TTL:
+            return !request.args.empty();
+        default:
+            return false;
+    }
+}
+
+}  // namespace
+
+ShardWorker::ShardWorker(size_t id, std::shared_ptr<KVStore> store, int listen_fd, Executor executor)
+    : id_(id), store_(std::move(store)), listen_fd_(listen_fd), executor_(std::move(executor)), epoll_fd_(-1),
+      wake_fd_(-1), stopping_(false), next_conn_id_(kFirstConnectionId), connection_count_(0), requests_(0),
+      forwarded_(0), syscalls_(0) {
+    // 其他worker可能在本worker启动前就开始转交命令，唤醒用的eventfd在构造时就要准备好
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+}
+
+ShardWorker::~ShardWorker() {
+    Stop();
+    for (auto& kv : connections_) {
+        close(kv.second->fd);
+    }
+    if (listen_fd_ >= 0) {
+        close(listen_fd_);
+    }
+    if (wake_fd_ >= 0) {
+        close(wake_fd_);
+    }
+    if (epoll_fd_ >= 0) {
+        close(epoll_fd_);
+    }
+}
+
+void ShardWorker::Link(const std::vector<ShardWorker*>& workers) {
+    for (ShardWorker* worker : workers) {
+        worker->peers_ = workers;
+        worker->inbox_.clear();
+        worker->inbox_.resize(workers.size());
+        for (size_t i = 0; i < workers.size(); ++i) {
+            if (i != worker->id_) {
+                worker->inbox_[i].reset(new SpscQueue<Message>(kQueueCapacity));
+            }
+        }
+        worker->backlog_.assign(workers.size(), std::deque<Message>());
+        worker->wake_peer_.assign(workers.size(), 0);
+    }
+}
+
+size_t ShardWorker::ShardForKey(std::string_view key, size_t shards) {
+    // 与客户端选节点用同一个稳定哈希，取高32位选分片，同一节点收到的key仍均匀分布到各分片
+    uint64_t h = utils::KeyHash(key);
+    return static_cast<size_t>((h >> 32) % shards);
+}
+
+bool ShardWorker::Start(int cpu) {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        LOG_ERROR("Failed to create epoll instance: " + std::string(strerror(errno)));
+        return false;
+    }
+    if (wake_fd_ < 0) {
+        LOG_ERROR("Failed to create eventfd: " + std::string(strerror(errno)));
+        return false;
+    }
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.u64 = kWakeToken;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev) < 0) {
+        LOG_ERROR("Failed to register eventfd: " + std::string(strerror(errno)));
+        return false;
+    }
+    ev.events = EPOLLIN;
+    ev.data.u64 = kListenToken;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &ev) < 0) {
+        LOG_ERROR("Failed to register listening socket: " + std::string(strerror(errno)));
+        return false;
+    }
+    thread_ = std::thread(&ShardWorker::Run, this);
+    if (cpu >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu, &cpus);
+        int err = pthread_setaffinity_np(thread_.native_handle(), sizeof(cpus), &cpus);
+        if (err != 0) {
+            LOG_WARNING("Failed to pin shard " + std::to_string(id_) + " to CPU " + std::to_string(cpu) + ": " +
+                        std::string(strerror(err)));
+        }
+    }
+    return true;
+}
+
+void ShardWorker::Stop() {
+    stopping_ = true;
+    if (wake_fd_ >= 0) {
+        uint64_t one = 1;
+        ssize_t n = write(wake_fd_, &one, sizeof(one));
+        (void)n;
+    }
+    if (thread_.joinable() && thread_.get_id() != std::this_thread::get_id()) {
+        thread_.join();
+    }
+}
+
+void ShardWorker::Run() {
+    struct epoll_event events[kMaxEvents];
+    while (!stopping_) {
+        // 有发不出去的消息时不能无限期睡眠，要定期重试
+        bool backlogged = false;
+        for (const auto& queue : backlog_) {
+            backlogged = backlogged || !queue.empty();
+        }
+        int n = epoll_wait(epoll_fd_, events, kMaxEvents, backlogged ? 1 : -1);
+        AddSyscalls(1);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("epoll_wait failed: " + std::string(strerror(errno)));
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            uint64_t token = events[i].data.u64;
+            if (token == kWakeToken) {
+                uint64_t count;
+                while (read(wake_fd_, &count, sizeof(count)) > 0) {
+                }
+                AddSyscalls(1);
+                continue;
+            }
+            if (token == kListenToken) {
+                AcceptConnections();
+                continue;
+            }
+            auto it = connections_.find(token);
+            if (it == connections_.end()) {
+                continue;
+            }
+            Connection* conn = it->second.get();
+            uint32_t mask = events[i].events;
+            if (mask & (EPOLLERR | EPOLLHUP)) {
+                CloseConnection(conn);
+                continue;
+            }
+            if ((mask & (EPOLLIN | EPOLLRDHUP)) && !HandleReadable(conn)) {
+                continue;
+            }
+            if ((mask & EPOLLOUT) && FlushOutput(conn)) {
+                CloseIfDrained(conn);
+            }
+        }
+
+        DrainInbox();
+        FlushBacklog();
+        // 收到其他分片响应的连接，这一轮统一写一次
+        std::vector<uint64_t> dirty;
+        dirty.swap(dirty_);
+        for (uint64_t conn_id : dirty) {
+            auto it = connections_.find(conn_id);
+            if (it != connections_.end()) {
+                it->second->dirty = false;
+                if (FlushOutput(it->second.get())) {
+                    CloseIfDrained(it->second.get());
+                }
+            }
+        }
+        WakePeers();
+    }
+}
+
+void ShardWorker::AcceptConnections() {
+    for (;;) {
+        int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        AddSyscalls(1);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK && !stopping_) {
+                LOG_ERROR("Failed to accept connection: " + std::string(strerror(errno)));
+            }
+            return;
+        }
+        // 本地命令的响应先写出，转交命令的响应随后单独写出；不关Nagle的话后一次小写会等前一次的ACK，
+        // 而客户端在收齐响应前不会再发数据，只能等延迟确认超时
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        AddSyscalls(1);
+        std::unique_ptr<Connection> conn(new Connection());
+        conn->fd = fd;
+        conn->id = next_conn_id_++;
+        struct epoll_event ev;
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        ev.data.u64 = conn->id;
+        AddSyscalls(1);
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            LOG_ERROR("Failed to register connection: " + std::string(strerror(errno)));
+            close(fd);
+            continue;
+        }
+        connections_[conn->id] = std::move(conn);
+        connection_count_.fetch_add(1, std::memory_order_relaxed);
+        LOG_INFO("New connection on shard " + std::to_string(id_));
+    }
+}
+
+bool ShardWorker::HandleReadable(Connection* conn) {
+    // 边缘触发：必须读到EAGAIN
+    char buffer[kReadBufferSize];
+    bool eof = false;
+    for (;;) {
+        ssize_t n = read(conn->fd, buffer, sizeof(buffer));
+        AddSyscalls(1);
+        if (n > 0) {
+            conn->input.Append(buffer, static_cast<size_t>(n));
+            continue;
+        }
+        if (n == 0) {
+            eof = true;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            CloseConnection(conn);
+            return false;
+        }
+        break;
+    }
+
+    uint64_t requests = 0;
+    while (conn->input.Next(&request_)) {
+        Dispatch(conn, request_);
+        requests++;
+    }
+    requests_.store(requests_.load(std::memory_order_relaxed) + requests, std::memory_order_relaxed);
+
+    if (conn->input.broken()) {
+        LOG_WARNING("Closing connection with malformed or oversized request");
+        CloseConnection(conn);
+        return false;
+    }
+    if (!FlushOutput(conn)) {
+        return false;
+    }
+    if (eof) {
+        // 客户端发完请求后半关闭：先写完本地响应，等转交给其他分片的响应也写出后再关闭
+        conn->read_closed = true;
+        return CloseIfDrained(conn);
+    }
+    return true;
+}
+
+bool ShardWorker::FlushOutput(Connection* conn) {
+    size_t calls = 0;
+    bool ok = conn->output.WriteTo(conn->fd, &calls);
+    AddSyscalls(calls);
+    if (!ok) {
+        CloseConnection(conn);
+        return false;
+    }
+    if (conn->output.bytes() > kMaxOutputBytes) {
+        LOG_WARNING("Closing connection whose client is not reading responses");
+        CloseConnection(conn);
+        return false;
+    }
+    return true;
+}
+
+bool ShardWorker::CloseIfDrained(Connection* conn) {
+    if (!conn->read_closed || !conn->pending.empty() || !conn->output.empty()) {
+        return true;
+    }
+    CloseConnection(conn);
+    return false;
+}
+
+void ShardWorker::CloseConnection(Connection* conn) {
+    // 还没返回的转交命令照常执行，响应到达时找不到连接就丢弃
+    close(conn->fd);
+    connections_.erase(conn->id);
+    connection_count_.fetch_sub(1, std::memory_order_relaxed);
+    LOG_INFO("Client disconnected");
+}
+
+void ShardWorker::Dispatch(Connection* conn, const Request& request) {
+    size_t owner = HasKey(request) ? ShardForKey(request.args[0], peers_.size()) : id_;
+    if (owner == id_) {
+        // 前面没有等待中的转交命令时，响应直接写进输出缓冲
+        if (conn->pending.empty()) {
+            executor_(request, store_.get(), conn->output.buffer());
+            return;
+        }
+        Pending slot;
+        slot.ready = true;
+        executor_(request, store_.get(), &slot.response);
+        conn->pending.push_back(std::move(slot));
+        return;
+    }
+    Message message;
+    message.conn_id = conn->id;
+    message.seq = conn->pending_base + conn->pending.size();
+    message.type = request.type;
+    message.resp = request.resp;
+    message.args.assign(request.args.begin(), request.args.end());
+    conn->pending.emplace_back();
+    Send(owner, std::move(message));
+    forwarded_.store(forwarded_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void ShardWorker::Send(size_t to, Message message) {
+    // 有积压时必须排在积压之后，保证同一对worker之间的消息顺序
+    std::deque<Message>& backlog = backlog_[to];
+    if (backlog.empty() && peers_[to]->inbox_[id_]->TryPush(std::move(message))) {
+        wake_peer_[to] = 1;
+        return;
+    }
+    backlog.push_back(std::move(message));
+}
+
+void ShardWorker::DrainInbox() {
+    Message message;
+    for (size_t from = 0; from < inbox_.size(); ++from) {
+        if (!inbox_[from]) {
+            continue;
+        }
+        while (inbox_[from]->TryPop(&message)) {
+            if (!message.reply) {
+                Request request;
+                request.type = message.type;
+                request.resp = message.resp;
+                request.args.assign(message.args.begin(), message.args.end());
+                Message reply;
+                reply.reply = true;
+                reply.conn_id = message.conn_id;
+                reply.seq = message.seq;
+                executor_(request, store_.get(), &reply.response);
+                Send(from, std::move(reply));
+                continue;
+            }
+            auto it = connections_.find(message.conn_id);
+            if (it == connections_.end()) {
+                continue;
+            }
+            Connection* conn = it->second.get();
+            Pending& slot = conn->pending[message.seq - conn->pending_base];
+            slot.ready = true;
+            slot.response = std::move(message.response);
+            while (!conn->pending.empty() && conn->pending.front().ready) {
+                conn->output.Push(conn->pending.front().response);
+                conn->pending.pop_front();
+                conn->pending_base++;
+            }
+            if (!conn->dirty) {
+                conn->dirty = true;
+                dirty_.push_back(conn->id);
+            }
+        }
+    }
+}
+
+void ShardWorker::FlushBacklog() {
+    for (size_t to = 0; to < backlog_.size(); ++to) {
+        std::deque<Message>& backlog = backlog_[to];
+        while (!backlog.empty() && peers_[to]->inbox_[id_]->TryPush(std::move(backlog.front()))) {
+            backlog.pop_front();
+            wake_peer_[to] = 1;
+        }
+    }
+}
+
+void ShardWorker::WakePeers() {
+    for (size_t to = 0; to < wake_peer_.size(); ++to) {
+        if (wake_peer_[to]) {
+            wake_peer_[to] = 0;
+            uint64_t one = 1;
+            ssize_t n = write(peers_[to]->wake_fd_, &one, sizeof(one));
+            (void)n;
+            AddSyscalls(1);
+        }
+    }
+}
+
+void ShardWorker::AddSyscalls(uint64_t n) {
+    syscalls_.store(syscalls_.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
@@ -0,0 +1,138 @@
+// src/network/shard_worker.h
+#ifndef SHARD_WORKER_H
+#define SHARD_WORKER_H
+
+#include "framing.h"
+#include "../common/protocol.h"
+#include "../common/spsc_queue.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class KVStore;
+
+// 分片模式（每核一个线程）的工作线程
+//
+// 每个worker绑定到一个CPU，独占一个存储分片和一个SO_REUSEPORT监听socket，用自己的
+// epoll循环处理内核分给它的连接。key按哈希归属某个分片：本分片的命令直接在本线程执行；
+// 其他分片的命令经无锁SPSC队列转交给所属worker，执行结果再经反方向的队列送回，
+// 整个过程不经过任何共享锁，存储也只被所属线程访问。同一连接上的响应按请求顺序返回。
+class ShardWorker {
+public:
+    // 在给定分片上执行一条已解析的命令，把格式化好的响应追加到out末尾
+    using Executor = std::function<void(const Request&, KVStore*, std::string* out)>;
+
+    static const size_t kQueueCapacity = 4096;
+    static const size_t kMaxOutputBytes = 64 * 1024 * 1024;
+    static const size_t kReadBufferSize = 16 * 1024;
+    static const int kMaxEvents = 256;
+
+    // listen_fd必须是非阻塞的，之后由worker负责关闭
+    ShardWorker(size_t id, std::shared_ptr<KVStore> store, int listen_fd, Executor executor);
+    ~ShardWorker();
+    ShardWorker(const ShardWorker&) = delete;
+    ShardWorker& operator=(const ShardWorker&) = delete;
+
+    // 在所有worker的Start之前调用一次，建立两两之间的队列；workers[i]的id必须为i
+    static void Link(const std::vector<ShardWorker*>& workers);
+    // key所属的分片
+    static size_t ShardForKey(std::string_view key, size_t shards);
+
+    // cpu小于0时不绑定CPU
+    bool Start(int cpu);
+    // 通知worker退出；不在worker线程中调用时等待线程结束
+    void Stop();
+
+    KVStore* store() const { return store_.get(); }
+    size_t ConnectionCount() const { return connection_count_.load(std::memory_order_relaxed); }
+    // 从本worker的连接收到的命令数，其中转交给其他分片的命令数，以及本线程发起的系统调用数
+    uint64_t requests() const { return requests_.load(std::memory_order_relaxed); }
+    uint64_t forwarded() const { return forwarded_.load(std::memory_order_relaxed); }
+    uint64_t syscalls() const { return syscalls_.load(std::memory_order_relaxed); }
+
+private:
+    // 转交的命令和送回的响应，conn_id和seq定位发起方连接上的响应位置。
+    // Request的参数指向发起方连接的读缓冲，转交时要复制一份
+    struct Message {
+        bool reply = false;
+        uint64_t conn_id = 0;
+        uint64_t seq = 0;
+        CommandType type = CMD_UNKNOWN;
+        bool resp = false;
+        std::vector<std::string> args;
+        std::string response;
+    };
+
+    // 等待其他分片返回的响应占位，前面的响应没到齐时后面的也不能写出
+    struct Pending {
+        bool ready = false;
+        std::string response;
+    };
+
+    struct Connection {
+        int fd = -1;
+        uint64_t id = 0;
+        RequestFramer input;
+        ResponseQueue output;
+        std::deque<Pending> pending;
+        // pending队首对应的序号
+        uint64_t pending_base = 0;
+        // 已在dirty_列表中
+        bool dirty = false;
+        // 对端已关闭写端：不再有新请求，本地和转交命令的响应都写完后关闭
+        bool read_closed = false;
+    };
+
+    void Run();
+    void AcceptConnections();
+    // 以下函数返回false表示连接已被关闭
+    bool HandleReadable(Connection* conn);
+    bool FlushOutput(Connection* conn);
+    // 半关闭的连接没有待写出和待返回的响应时关闭它
+    bool CloseIfDrained(Connection* conn);
+    void CloseConnection(Connection* conn);
+
+    void Dispatch(Connection* conn, const Request& request);
+    void Send(size_t to, Message message);
+    void DrainInbox();
+    void FlushBacklog();
+    void WakePeers();
+    void AddSyscalls(uint64_t n);
+
+    const size_t id_;
+    std::shared_ptr<KVStore> store_;
+    int listen_fd_;
+    Executor executor_;
+    int epoll_fd_;
+    int wake_fd_;
+    std::thread thread_;
+    std::atomic<bool> stopping_;
+
+    // 以下只在worker线程中访问（Link除外）
+    std::vector<ShardWorker*> peers_;
+    // inbox_[i]由第i个worker写入、本worker读取
+    std::vector<std::unique_ptr<SpscQueue<Message>>> inbox_;
+    // 对方队列已满时暂存的消息，backlog_[i]发往第i个worker
+    std::vector<std::deque<Message>> backlog_;
+    std::vector<char> wake_peer_;
+    std::unordered_map<uint64_t, std::unique_ptr<Connection>> connections_;
+    std::vector<uint64_t> dirty_;
+    uint64_t next_conn_id_;
+    // 解析命令时反复使用，保留参数数组的容量
+    Request request_;
+
+    std::atomic<size_t> connection_count_;
+    std::atomic<uint64_t> requests_;
+    std::atomic<uint64_t> forwarded_;
+    std::atomic<uint64_t> syscalls_;
+};
+
+#endif // SHARD_WORKER_H
@@ -1,35 +1,151 @@
 // src/network/simple_server.cc
 #include "simple_server.h"
+#include "event_loop.h"
+#include "uring_loop.h"
+#include "shard_worker.h"
+#include "framing.h"
 #include "../core/kv_store.h"
 #include "../common/protocol.h"
 #include "../common/logger.h"
+#include "../common/utils.h"
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <unistd.h>
+#include <algorithm>
+#include <cstdio>
 #include <cstring>
 #include <arpa/inet.h>
 
-SimpleServer::SimpleServer(int port, std::shared_ptr<KVStore> store) 
-    : port_(port), server_fd_(-1), running_(false), store_(store) {}
+namespace {
+
+// 线程内反复使用的参数缓冲超过该容量时释放，偶尔的大value不长期占用内存
+const size_t kMaxScratchCapacity = 1024 * 1024;
+
+void TrimScratch(std::string* buffer) {
+    if (buffer->capacity() > kMaxScratchCapacity) {
+        std::string().swap(*buffer);
+    }
+}
+
+void TrimScratch(std::vector<std::string>* buffers) {
+    size_t bytes = buffers->capacity() * sizeof(std::string);
+    for (const std::string& buffer : *buffers) {
+        bytes += buffer.capacity();
+    }
+    if (bytes > kMaxScratchCapacity) {
+        std::vector<std::string>().swap(*buffers);
+    }
+}
+
+// 把args中从first开始、每隔step个的参数复制进out，复用out中已有字符串的容量
+void CopyArgs(const std::vector<std::string_view>& args, size_t first, size_t step, std::vector<std::string>* out) {
+    out->resize((args.size() - first + step - 1) / step);
+    for (size_t i = 0; i < out->size(); ++i) {
+        std::string_view arg = args[first + i * step];
+        (*out)[i].assign(arg.data(), arg.size());
+    }
+}
+
+// 解析范围命令末尾可选的 LIMIT n，没有时*limit为0（不限制）
+bool ParseScanLimit(const std::vector<std::string_view>& args, size_t first, size_t* limit) {
+    *limit = 0;
+    if (args.size() == first) {
+        return true;
+    }
+    if (args.size() != first + 2) {
+        return false;
+    }
+    int64_t n;
+    if (!ProtocolParser::EqualsUpper(args[first], "LIMIT") || !ProtocolParser::ParseInteger(args[first + 1], &n) ||
+        n == 0) {
+        return false;
+    }
+    *limit = static_cast<size_t>(n);
+    return true;
+}
+
+// 从it当前位置起收集key，直到key不满足in_range或达到limit；
+// 内联协议的结果格式为 "count" + 数据 "k1 v1 k2 v2 ..."，RESP请求的结果放进items
+template <typename InRange>
+void CollectScan(KVIterator* it, size_t limit, InRange in_range, bool resp_format, Response* resp) {
+    size_t count = 0;
+    std::string data;
+    for (; it->Valid() && in_range(it->key()) && (limit == 0 || count < limit); it->Next()) {
+        if (resp_format) {
+            count++;
+            resp->items.push_back(it->key());
+            resp->items.push_back(it->value());
+            continue;
+        }
+        if (count++ > 0) {
+            data += ' ';
+        }
+        data += it->key();
+        data += ' ';
+        data += it->value();
+    }
+    resp->success = true;
+    resp->message = std::to_string(count);
+    resp->data = data;
+}
+
+}  // namespace
+
+bool ParseIoModel(const std::string& name, IoModel* model) {
+    if (name == "threads") {
+        *model = IO_THREAD_PER_CONNECTION;
+    } else if (name == "epoll") {
+        *model = IO_EPOLL;
+    } else if (name == "io_uring") {
+        *model = IO_URING;
+    } else if (name == "shards") {
+        *model = IO_SHARD_PER_CORE;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+SimpleServer::SimpleServer(int port, std::shared_ptr<KVStore> store, const ServerOptions& options)
+    : port_(port), options_(options), server_fd_(-1), running_(false), store_(store), next_loop_(0),
+      thread_requests_(0), thread_syscalls_(0) {}
+
+SimpleServer::SimpleServer(int port, std::vector<std::shared_ptr<KVStore>> shards, const ServerOptions& options)
+    : port_(port), options_(options), server_fd_(-1), running_(false), shard_stores_(std::move(shards)),
+      next_loop_(0), thread_requests_(0), thread_syscalls_(0) {
+    options_.io_model = IO_SHARD_PER_CORE;
+}
 
 SimpleServer::~SimpleServer() {
     Stop();
+    if (acceptor_.joinable()) {
+        acceptor_.join();
+    }
+    // 事件循环线程退出后再关闭它们的连接
+    loops_.clear();
+    uring_loops_.clear();
+    shard_workers_.clear();
+    if (server_fd_ >= 0) {
+        close(server_fd_);
+        server_fd_ = -1;
+    }
 }
 
-bool SimpleServer::Start() {
-    // 创建socket
-    server_fd_ = socket(AF_INET, SOCK_STREAM, 0);
-    if (server_fd_ < 0) {
+int SimpleServer::Listen(bool reuse_port) {
+    // 创建socket；分片模式的监听socket由事件循环处理，需要非阻塞
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC | (reuse_port ? SOCK_NONBLOCK : 0), 0);
+    if (fd < 0) {
         LOG_ERROR("Failed to create socket");
-        return false;
+        return -1;
     }
     
-    // 设置SO_REUSEADDR选项
+    // 设置SO_REUSEADDR选项；SO_REUSEPORT让多个socket绑定同一端口，由内核按连接的四元组哈希分配
     int opt = 1;
-    if (setsockopt(server_fd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0 ||
+        (reuse_port && setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0)) {
         LOG_ERROR("Failed to set socket options");
-        close(server_fd_);
-        return false;
+        close(fd);
+        return -1;
     }
     
     // 绑定地址
@@ -38,35 +154,134 @@ bool SimpleServer::Start() {
     address.sin_addr.s_addr = INADDR_ANY;
     address.sin_port = htons(port_);
     
-    if (bind(server_fd_, (struct sockaddr*)&address, sizeof(address)) < 0) {
+    if (bind(fd, (struct sockaddr*)&address, sizeof(address)) < 0) {
         LOG_ERROR("Failed to bind socket");
-        close(server_fd_);
-        return false;
+        close(fd);
+        return -1;
     }
     
-    // 开始监听
-    if (listen(server_fd_, 10) < 0) {
+    // 开始监听，积压队列足够容纳突发的大量新连接
+    if (listen(fd, options_.backlog) < 0) {
         LOG_ERROR("Failed to listen on socket");
-        close(server_fd_);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool SimpleServer::StartShards() {
+    if (shard_stores_.empty()) {
+        LOG_ERROR("Shard-per-core mode requires at least one shard");
+        return false;
+    }
+    std::vector<ShardWorker*> workers;
+    for (size_t i = 0; i < shard_stores_.size(); ++i) {
+        int fd = Listen(true);
+        if (fd < 0) {
+            shard_workers_.clear();
+            return false;
+        }
+        shard_workers_.emplace_back(new ShardWorker(i, shard_stores_[i], fd,
+                                                    [this](const Request& req, KVStore* store, std::string* out) {
+            ProcessCommand(req, store, out);
+        }));
+        workers.push_back(shard_workers_.back().get());
+    }
+    ShardWorker::Link(workers);
+    // 分片多于CPU时轮流绑定
+    unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t i = 0; i < workers.size(); ++i) {
+        if (!workers[i]->Start(static_cast<int>(i % cpus))) {
+            for (size_t j = 0; j < i; ++j) {
+                workers[j]->Stop();
+            }
+            shard_workers_.clear();
+            return false;
+        }
+    }
+    running_ = true;
+    LOG_INFO("Server started on port " + std::to_string(port_) + " with " + std::to_string(workers.size()) +
+             " shards");
+    return true;
+}
+
+bool SimpleServer::Start() {
+    if (options_.io_model == IO_SHARD_PER_CORE) {
+        return StartShards();
+    }
+    server_fd_ = Listen(false);
+    if (server_fd_ < 0) {
         return false;
     }
+
+    size_t threads = options_.reactor_threads;
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (options_.io_model == IO_EPOLL) {
+        for (size_t i = 0; i < threads; ++i) {
+            std::unique_ptr<EventLoop> loop(new EventLoop([this](const Request& req, std::string* out) {
+                ProcessCommand(req, store_.get(), out);
+            }));
+            if (!loop->Start()) {
+                loops_.clear();
+                close(server_fd_);
+                server_fd_ = -1;
+                return false;
+            }
+            loops_.push_back(std::move(loop));
+        }
+    } else if (options_.io_model == IO_URING) {
+        // 每个循环在监听socket上挂自己的多发accept，由内核分配连接，不需要接受线程
+        for (size_t i = 0; i < threads; ++i) {
+            std::unique_ptr<UringLoop> loop(new UringLoop([this](const Request& req, std::string* out) {
+                ProcessCommand(req, store_.get(), out);
+            }, server_fd_));
+            if (!loop->Start()) {
+                uring_loops_.clear();
+                close(server_fd_);
+                server_fd_ = -1;
+                return false;
+            }
+            uring_loops_.push_back(std::move(loop));
+        }
+    }
     
     running_ = true;
     
-    // 启动服务器线程
-    std::thread server_thread(&SimpleServer::Run, this);
-    server_thread.detach();
+    std::string mode;
+    if (options_.io_model == IO_EPOLL) {
+        mode = " with " + std::to_string(loops_.size()) + " epoll reactors";
+    } else if (options_.io_model == IO_URING) {
+        mode = " with " + std::to_string(uring_loops_.size()) + " io_uring reactors";
+    } else {
+        mode = " with a thread per connection";
+    }
+    if (options_.io_model != IO_URING) {
+        // 启动接受连接的线程
+        acceptor_ = std::thread(&SimpleServer::Run, this);
+    }
     
-    LOG_INFO("Server started on port " + std::to_string(port_));
+    LOG_INFO("Server started on port " + std::to_string(port_) + mode);
     return true;
 }
 
 void SimpleServer::Stop() {
     if (running_) {
         running_ = false;
+        // io_uring循环的accept挂在监听socket上，先让循环退出，避免accept失败后反复重新提交
+        for (auto& loop : uring_loops_) {
+            loop->Stop();
+        }
+        // 只关闭读写让阻塞的accept返回，fd在析构时关闭，避免接受线程用到被复用的fd
         if (server_fd_ >= 0) {
-            close(server_fd_);
-            server_fd_ = -1;
+            shutdown(server_fd_, SHUT_RDWR);
+        }
+        for (auto& loop : loops_) {
+            loop->Stop();
+        }
+        for (auto& worker : shard_workers_) {
+            worker->Stop();
         }
         LOG_INFO("Server stopped");
     }
@@ -77,7 +292,12 @@ void SimpleServer::Run() {
         struct sockaddr_in client_addr;
         socklen_t client_len = sizeof(client_addr);
         
-        int client_fd = accept(server_fd_, (struct sockaddr*)&client_addr, &client_len);
+        // epoll模式的连接必须是非阻塞的
+        int flags = options_.io_model == IO_EPOLL ? SOCK_NONBLOCK | SOCK_CLOEXEC : SOCK_CLOEXEC;
+        int client_fd = accept4(server_fd_, (struct sockaddr*)&client_addr, &client_len, flags);
+        if (options_.io_model == IO_THREAD_PER_CONNECTION) {
+            thread_syscalls_.fetch_add(1, std::memory_order_relaxed);
+        }
         if (client_fd < 0) {
             if (running_) {
                 LOG_ERROR("Failed to accept connection");
@@ -89,6 +309,12 @@ void SimpleServer::Run() {
         inet_ntop(AF_INET, &client_addr.sin_addr, client_ip, INET_ADDRSTRLEN);
         LOG_INFO("New connection from " + std::string(client_ip) + 
                 ":" + std::to_string(ntohs(client_addr.sin_port)));
+
+        if (options_.io_model == IO_EPOLL) {
+            // 轮流分给各个事件循环
+            loops_[next_loop_++ % loops_.size()]->AddConnection(client_fd);
+            continue;
+        }
         
         // 为每个客户端创建新线程处理
         std::thread client_thread(&SimpleServer::HandleClient, this, client_fd);
@@ -97,50 +323,83 @@ void SimpleServer::Run() {
 }
 
 void SimpleServer::HandleClient(int client_fd) {
-    char buffer[1024];
+    // 一次读取可能包含多条命令（流水线），也可能只有半条；这一批的响应用一次writev写回
+    char buffer[16 * 1024];
     ssize_t bytes_read;
+    RequestFramer framer;
+    ResponseQueue responses;
+    Request request;
     
-    while ((bytes_read = read(client_fd, buffer, sizeof(buffer) - 1)) > 0) {
-        buffer[bytes_read] = '\0';
-        std::string request(buffer);
-        
-        LOG_DEBUG("Received request: " + request);
-        
-        std::string response = ProcessCommand(request);
-        
-        LOG_DEBUG("Sending response: " + response);
-        write(client_fd, response.c_str(), response.length());
+    uint64_t requests = 0;
+    size_t syscalls = 0;
+    
+    while ((bytes_read = read(client_fd, buffer, sizeof(buffer))) > 0) {
+        syscalls++;
+        framer.Append(buffer, static_cast<size_t>(bytes_read));
+        while (framer.Next(&request)) {
+            LOG_DEBUG("Received request: " + ProtocolParser::CommandToString(request.type));
+            ProcessCommand(request, store_.get(), responses.buffer());
+            requests++;
+        }
+        if (framer.broken()) {
+            LOG_WARNING("Closing connection with malformed or oversized request");
+            break;
+        }
+        bool ok = responses.WriteTo(client_fd, &syscalls);
+        thread_requests_.fetch_add(requests, std::memory_order_relaxed);
+        thread_syscalls_.fetch_add(syscalls, std::memory_order_relaxed);
+        requests = 0;
+        syscalls = 0;
+        if (!ok) {
+            break;
+        }
     }
     
     close(client_fd);
     LOG_INFO("Client disconnected");
 }
 
-std::string SimpleServer::ProcessCommand(const std::string& request) {
-    Request req = ProtocolParser::ParseRequest(request);
+void SimpleServer::ProcessCommand(const Request& req, KVStore* store, std::string* out) {
     Response resp;
+    // 存储接口的参数是std::string：key和value复制进线程内反复使用的缓冲，容量稳定后不再分配内存
+    thread_local std::string key;
+    thread_local std::string value;
+    if (!req.args.empty()) {
+        key.assign(req.args[0].data(), req.args[0].size());
+    }
     
     switch (req.type) {
-        case CMD_SET:
-            if (req.args.size() >= 2) {
-                Status status = store_->Put(req.args[0], req.args[1]);
-                resp.success = status.ok();
-                resp.message = status.message;
-            } else {
+        case CMD_SET: {
+            int64_t ttl_ms;
+            if (req.args.size() < 2) {
                 resp.success = false;
                 resp.message = "SET requires key and value";
+            } else if (!ProtocolParser::ParseSetOptions(req.args, &ttl_ms)) {
+                resp.success = false;
+                resp.message = ttl_ms == 0 ? "invalid expire time"
+                                           : "SET options must be EX <seconds> or PX <milliseconds>";
+            } else {
+                value.assign(req.args[1].data(), req.args[1].size());
+                Status status = ttl_ms > 0 ? store->PutWithTtl(key, value, ttl_ms) : store->Put(key, value);
+                TrimScratch(&value);
+                resp.success = status.ok();
+                resp.message = status.message;
             }
             break;
+        }
             
         case CMD_GET:
             if (req.args.size() >= 1) {
-                std::string value;
-                Status status = store_->Get(req.args[0], value);
-                resp.success = status.ok();
-                resp.message = status.message;
+                Status status = store->Get(key, value);
                 if (status.ok()) {
-                    resp.data = value;
+                    // 命中时value直接写进输出缓冲，不经过Response
+                    ProtocolParser::FormatValue(value, req.resp, out);
+                    TrimScratch(&value);
+                    return;
                 }
+                resp.success = false;
+                resp.message = status.message;
+                resp.not_found = status.is_key_not_found();
             } else {
                 resp.success = false;
                 resp.message = "GET requires key";
@@ -149,9 +408,10 @@ std::string SimpleServer::ProcessCommand(const std::string& request) {
             
         case CMD_DEL:
             if (req.args.size() >= 1) {
-                Status status = store_->Delete(req.args[0]);
+                Status status = store->Delete(key);
                 resp.success = status.ok();
                 resp.message = status.message;
+                resp.not_found = status.is_key_not_found();
             } else {
                 resp.success = false;
                 resp.message = "DEL requires key";
@@ -160,7 +420,7 @@ std::string SimpleServer::ProcessCommand(const std::string& request) {
             
         case CMD_EXISTS:
             if (req.args.size() >= 1) {
-                Status status = store_->Contains(req.args[0]);
+                Status status = store->Contains(key);
                 resp.success = true;
                 resp.message = status.ok() ? "true" : "false";
             } else {
@@ -169,6 +429,128 @@ std::string SimpleServer::ProcessCommand(const std::string& request) {
             }
             break;
             
+        case CMD_EXPIRE: {
+            int64_t seconds;
+            if (req.args.size() < 2 || !ProtocolParser::ParseInteger(req.args[1], &seconds)) {
+                resp.success = false;
+                resp.message = "EXPIRE requires key and seconds";
+            } else if (seconds > ProtocolParser::kMaxTtlMs / 1000) {
+                resp.success = false;
+                resp.message = "invalid expire time";
+            } else {
+                Status status = store->Expire(key, seconds * 1000);
+                resp.success = status.ok();
+                resp.message = status.message;
+                resp.not_found = status.is_key_not_found();
+            }
+            break;
+        }
+
+        case CMD_TTL:
+            if (req.args.size() >= 1) {
+                // 与Redis一致：-2表示key不存在，-1表示没有过期时间，否则为剩余秒数
+                int64_t ttl_ms;
+                Status status = store->Ttl(key, &ttl_ms);
+                resp.success = status.ok() || status.is_key_not_found();
+                if (status.is_key_not_found()) {
+                    resp.message = "-2";
+                } else if (!status.ok()) {
+                    resp.message = status.message;
+                } else {
+                    resp.message = std::to_string(ttl_ms < 0 ? -1 : (ttl_ms + 500) / 1000);
+                }
+            } else {
+                resp.success = false;
+                resp.message = "TTL requires key";
+            }
+            break;
+            
+        case CMD_RANGE:
+        case CMD_PREFIX: {
+            // RANGE start end [LIMIT n] 返回 [start, end) 内的key；PREFIX p [LIMIT n] 返回以p开头的key
+            size_t limit;
+            size_t key_args = req.type == CMD_RANGE ? 2 : 1;
+            std::unique_ptr<KVIterator> it;
+            if (req.args.size() < key_args || !ParseScanLimit(req.args, key_args, &limit)) {
+                resp.success = false;
+                resp.message = req.type == CMD_RANGE ? "RANGE requires start and end [LIMIT n]"
+                                                     : "PREFIX requires prefix [LIMIT n]";
+            } else if (options_.io_model == IO_SHARD_PER_CORE) {
+                // 结果要合并所有分片，会打破分片之间互不访问的约定
+                resp.success = false;
+                resp.message = "Range queries are not supported in shard-per-core mode";
+            } else if (!(it = store->NewIterator())) {
+                resp.success = false;
+                resp.message = "Range queries are not supported by this storage engine";
+            } else if (req.type == CMD_RANGE) {
+                std::string_view end = req.args[1];
+                it->Seek(key);
+                CollectScan(it.get(), limit, [&](const std::string& k) { return k < end; }, req.resp, &resp);
+            } else {
+                std::string_view prefix = req.args[0];
+                it->Seek(key);
+                CollectScan(it.get(), limit, [&](const std::string& k) {
+                    return k.compare(0, prefix.size(), prefix) == 0;
+                }, req.resp, &resp);
+            }
+            break;
+        }
+
+        case CMD_MGET:
+        case CMD_MSET:
+        case CMD_MDEL: {
+            // 整批在存储的一次加锁内完成，结果作为一个响应返回
+            thread_local std::vector<std::string> keys;
+            thread_local std::vector<std::string> values;
+            thread_local std::vector<char> found;
+            const char* name = req.type == CMD_MGET ? "MGET" : req.type == CMD_MSET ? "MSET" : "MDEL";
+            if (req.args.empty() || (req.type == CMD_MSET && req.args.size() % 2 != 0)) {
+                resp.success = false;
+                resp.message = std::string(name) + (req.type == CMD_MSET ? " requires key value pairs"
+                                                                           : " requires at least one key");
+                break;
+            }
+            if (options_.io_model == IO_SHARD_PER_CORE) {
+                // key可能分属不同分片，与范围查询一样不跨分片执行
+                resp.success = false;
+                resp.message = "Multi-key commands are not supported in shard-per-core mode";
+                break;
+            }
+            if (req.type == CMD_MGET) {
+                CopyArgs(req.args, 0, 1, &keys);
+                store->MultiGet(keys, &values, &found);
+                ProtocolParser::FormatValues(values, found, req.resp, out);
+                TrimScratch(&keys);
+                TrimScratch(&values);
+                return;
+            }
+            if (req.type == CMD_MSET) {
+                CopyArgs(req.args, 0, 2, &keys);
+                CopyArgs(req.args, 1, 2, &values);
+                Status status = store->MultiPut(keys, values);
+                resp.success = status.ok();
+                resp.message = status.message;
+            } else {
+                CopyArgs(req.args, 0, 1, &keys);
+                resp.success = true;
+                resp.message = std::to_string(store->MultiDelete(keys));
+            }
+            TrimScratch(&keys);
+            TrimScratch(&values);
+            break;
+        }
+
+        case CMD_BGSAVE:
+            if (!bgsave_handler_) {
+                resp.success = false;
+                resp.message = "Snapshots are disabled, start the server with --data-dir";
+            } else {
+                std::string error = bgsave_handler_();
+                resp.success = error.empty();
+                resp.message = error.empty() ? "Background saving started" : error;
+            }
+            break;
+
         case CMD_PING:
             resp.success = true;
             resp.message = "PONG";
@@ -179,11 +561,79 @@ std::string SimpleServer::ProcessCommand(const std::string& request) {
             resp.message = "BYE";
             break;
             
+        case CMD_INFO: {
+            // 内存统计：逻辑字节数、存储实际占用、进程RSS，以及RSS相对逻辑数据的放大倍数
+            StoreStats stats;
+            if (options_.io_model != IO_SHARD_PER_CORE) {
+                stats = store->GetStats();
+            }
+            // 分片模式汇总所有分片；INFO不在热路径上，跨分片读统计可以接受
+            for (const auto& shard : shard_stores_) {
+                StoreStats s = shard->GetStats();
+                stats.keys += s.keys;
+                stats.logical_bytes += s.logical_bytes;
+                stats.used_bytes += s.used_bytes;
+                stats.allocator_bytes += s.allocator_bytes;
+                stats.maxmemory += s.maxmemory;
+                stats.hits += s.hits;
+                stats.misses += s.misses;
+                stats.evictions += s.evictions;
+                stats.expires += s.expires;
+                stats.expired += s.expired;
+                stats.snapshots += s.snapshots;
+                stats.versions += s.versions;
+            }
+            // 网络层统计：处理的命令数和为此发起的系统调用数，用于比较各种连接处理方式
+            uint64_t io_requests = thread_requests_.load(std::memory_order_relaxed);
+            uint64_t io_syscalls = thread_syscalls_.load(std::memory_order_relaxed);
+            for (const auto& loop : loops_) {
+                io_requests += loop->requests();
+                io_syscalls += loop->syscalls();
+            }
+            for (const auto& loop : uring_loops_) {
+                io_requests += loop->requests();
+                io_syscalls += loop->syscalls();
+            }
+            uint64_t io_forwarded = 0;
+            for (const auto& worker : shard_workers_) {
+                io_requests += worker->requests();
+                io_syscalls += worker->syscalls();
+                io_forwarded += worker->forwarded();
+            }
+            size_t rss = utils::GetResidentMemory();
+            char ratio[32];
+            snprintf(ratio, sizeof(ratio), "%.2f",
+                     stats.logical_bytes > 0 ? static_cast<double>(rss) / stats.logical_bytes : 0.0);
+            resp.success = true;
+            resp.message = "keys=" + std::to_string(stats.keys) +
+                           " logical_bytes=" + std::to_string(stats.logical_bytes) +
+                           " used_bytes=" + std::to_string(stats.used_bytes) +
+                           " allocator_bytes=" + std::to_string(stats.allocator_bytes) +
+                           " rss_bytes=" + std::to_string(rss) +
+                           " maxmemory=" + std::to_string(stats.maxmemory) +
+                           " fragmentation_ratio=" + ratio +
+                           " hits=" + std::to_string(stats.hits) +
+                           " misses=" + std::to_string(stats.misses) +
+                           " evictions=" + std::to_string(stats.evictions) +
+                           " expires=" + std::to_string(stats.expires) +
+                           " expired=" + std::to_string(stats.expired) +
+                           " snapshots=" + std::to_string(stats.snapshots) +
+                           " versions=" + std::to_string(stats.versions) +
+                           " io_requests=" + std::to_string(io_requests) +
+                           " io_syscalls=" + std::to_string(io_syscalls) +
+                           " io_forwarded=" + std::to_string(io_forwarded);
+            break;
+        }
+            
         default:
             resp.success = false;
             resp.message = "Unknown command";
             break;
     }
     
-    return ProtocolParser::FormatResponse(resp);
+    if (req.resp) {
+        ProtocolParser::FormatRespResponse(req.type, resp, out);
+    } else {
+        ProtocolParser::FormatResponse(resp, out);
+    }
 }
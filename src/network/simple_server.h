@@ -7,31 +7,78 @@
 #include <thread>
 #include <vector>
 #include <atomic>
+#include <cstdint>
 #include <memory>
+#include <utility>
 
 class KVStore;  // 前向声明
+class EventLoop;
+class UringLoop;
+class ShardWorker;
+struct Request;
+
+// 连接的处理方式：每个连接一个阻塞线程，少量epoll事件循环线程处理全部非阻塞连接，
+// 少量io_uring事件循环线程（需要Linux 6.0及以上），或每核一个线程、各自独占一个存储分片
+enum IoModel {
+    IO_THREAD_PER_CONNECTION,
+    IO_EPOLL,
+    IO_URING,
+    IO_SHARD_PER_CORE
+};
+
+// 解析"threads"、"epoll"、"io_uring"或"shards"
+bool ParseIoModel(const std::string& name, IoModel* model);
+
+struct ServerOptions {
+    IoModel io_model = IO_EPOLL;
+    // epoll和io_uring模式的事件循环线程数，0表示CPU核数；分片模式的线程数等于分片数
+    size_t reactor_threads = 0;
+    // listen的全连接队列长度，实际值受net.core.somaxconn限制
+    int backlog = 511;
+};
 
 class SimpleServer {
 public:
-    using RequestHandler = std::function<std::string(const std::string&)>;
+    using RequestHandler = std::function<void(const Request&, std::string*)>;
+    // 开始后台保存快照，返回空字符串表示已开始，否则为错误信息
+    using BackgroundSaveHandler = std::function<std::string()>;
     
-    SimpleServer(int port, std::shared_ptr<KVStore> store);
+    SimpleServer(int port, std::shared_ptr<KVStore> store, const ServerOptions& options = ServerOptions());
+    // 分片模式：每个分片一个绑定CPU的工作线程，key按哈希归属分片。不支持RANGE、PREFIX和BGSAVE
+    SimpleServer(int port, std::vector<std::shared_ptr<KVStore>> shards, const ServerOptions& options);
     ~SimpleServer();
     
     bool Start();
     void Stop();
     bool IsRunning() const { return running_; }
+    // 未设置时BGSAVE命令返回错误
+    void SetBackgroundSaveHandler(BackgroundSaveHandler handler) { bgsave_handler_ = std::move(handler); }
     
 private:
+    // 创建监听socket，失败时返回-1
+    int Listen(bool reuse_port);
+    bool StartShards();
     void Run();
     void HandleClient(int client_fd);
-    std::string ProcessCommand(const std::string& request);
+    // 在指定存储上执行命令，按请求的协议把响应追加到out；分片模式下store是key所属的分片
+    void ProcessCommand(const Request& req, KVStore* store, std::string* out);
     
     int port_;
+    ServerOptions options_;
     int server_fd_;
     std::atomic<bool> running_;
     std::shared_ptr<KVStore> store_;
-    std::vector<std::thread> worker_threads_;
+    std::vector<std::shared_ptr<KVStore>> shard_stores_;
+    BackgroundSaveHandler bgsave_handler_;
+    // 接受连接的线程，析构时等待它退出
+    std::thread acceptor_;
+    std::vector<std::unique_ptr<EventLoop>> loops_;
+    std::vector<std::unique_ptr<UringLoop>> uring_loops_;
+    std::vector<std::unique_ptr<ShardWorker>> shard_workers_;
+    size_t next_loop_;
+    // 每连接一个线程模式下处理的命令数和read、sendmsg、accept4调用数，INFO与事件循环的统计合并输出
+    std::atomic<uint64_t> thread_requests_;
+    std::atomic<uint64_t> thread_syscalls_;
 };
 
 #endif // SIMPLE_SERVER_H
@@ -0,0 +1,525 @@
+// src/network/uring_loop.cc
+#include "uring_loop.h"
+#include "../common/logger.h"
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+const unsigned UringLoop::kQueueDepth;
+const unsigned UringLoop::kBufferCount;
+const size_t UringLoop::kBufferSize;
+const size_t UringLoop::kMaxOutputBytes;
+
+namespace {
+
+// 完成队列要容纳多发请求一次产生的大量事件
+const unsigned kCompletionQueueDepth = UringLoop::kQueueDepth * 4;
+// 缓冲环所在的缓冲组
+const uint16_t kBufferGroup = 0;
+const uint64_t kOpMask = 7;
+
+int SysSetup(unsigned entries, struct io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int SysEnter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int SysRegister(int fd, unsigned opcode, void* arg, unsigned nr_args) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+std::string ErrnoMessage(const std::string& what) {
+    return what + ": " + std::strerror(errno);
+}
+
+}  // namespace
+
+UringLoop::UringLoop(Handler handler, int listen_fd)
+    : handler_(std::move(handler)), listen_fd_(listen_fd), ring_fd_(-1), wake_fd_(-1), wake_value_(0),
+      sq_ring_(nullptr), sq_ring_size_(0), cq_ring_(nullptr), cq_ring_size_(0), sqes_(nullptr), sqes_size_(0),
+      sq_head_(nullptr), sq_tail_(nullptr), sq_mask_(0), sq_entries_(0), cq_head_(nullptr), cq_tail_(nullptr),
+      cq_mask_(0), cqes_(nullptr), inflight_(0), buf_ring_(nullptr), buf_ring_size_(0), buffers_(nullptr),
+      buf_tail_(0), stopping_(false), connection_count_(0), requests_(0), syscalls_(0) {}
+
+UringLoop::~UringLoop() {
+    Stop();
+    for (auto& kv : connections_) {
+        close(kv.second->fd);
+    }
+    // 关闭ring之后内核不再访问下面这些内存
+    if (ring_fd_ >= 0) {
+        close(ring_fd_);
+    }
+    if (sqes_) {
+        munmap(sqes_, sqes_size_);
+    }
+    if (cq_ring_ && cq_ring_ != sq_ring_) {
+        munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_) {
+        munmap(sq_ring_, sq_ring_size_);
+    }
+    if (buf_ring_) {
+        munmap(buf_ring_, buf_ring_size_);
+    }
+    if (buffers_) {
+        munmap(buffers_, static_cast<size_t>(kBufferCount) * kBufferSize);
+    }
+    if (wake_fd_ >= 0) {
+        close(wake_fd_);
+    }
+}
+
+bool UringLoop::Supported() {
+    // 多发recv没有可以探测的标志位，只能看内核版本
+    struct utsname name;
+    int major = 0;
+    int minor = 0;
+    if (uname(&name) != 0 || sscanf(name.release, "%d.%d", &major, &minor) != 2 || major < 6) {
+        return false;
+    }
+    UringLoop probe(Handler(), -1);
+    return probe.SetupRing() && probe.SetupBufferRing();
+}
+
+bool UringLoop::Start() {
+    wake_fd_ = eventfd(0, EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        LOG_ERROR(ErrnoMessage("Failed to create eventfd"));
+        return false;
+    }
+    if (!SetupRing() || !SetupBufferRing()) {
+        return false;
+    }
+    thread_ = std::thread(&UringLoop::Run, this);
+    return true;
+}
+
+void UringLoop::Stop() {
+    stopping_ = true;
+    if (wake_fd_ >= 0) {
+        uint64_t one = 1;
+        ssize_t n = write(wake_fd_, &one, sizeof(one));
+        (void)n;
+    }
+    if (thread_.joinable() && thread_.get_id() != std::this_thread::get_id()) {
+        thread_.join();
+    }
+}
+
+bool UringLoop::SetupRing() {
+    struct io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_COOP_TASKRUN;
+    params.cq_entries = kCompletionQueueDepth;
+    ring_fd_ = SysSetup(kQueueDepth, &params);
+    if (ring_fd_ < 0 && errno == EINVAL) {
+        // 旧内核不认识COOP_TASKRUN，它只是一个优化
+        std::memset(&params, 0, sizeof(params));
+        params.flags = IORING_SETUP_CQSIZE;
+        params.cq_entries = kCompletionQueueDepth;
+        ring_fd_ = SysSetup(kQueueDepth, &params);
+    }
+    if (ring_fd_ < 0) {
+        LOG_ERROR(ErrnoMessage("io_uring_setup failed"));
+        return false;
+    }
+
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+        sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+    sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                    IORING_OFF_SQ_RING);
+    if (sq_ring_ == MAP_FAILED) {
+        sq_ring_ = nullptr;
+        LOG_ERROR(ErrnoMessage("Failed to map io_uring submission queue"));
+        return false;
+    }
+    if (single_mmap) {
+        cq_ring_ = sq_ring_;
+    } else {
+        cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                        IORING_OFF_CQ_RING);
+        if (cq_ring_ == MAP_FAILED) {
+            cq_ring_ = nullptr;
+            LOG_ERROR(ErrnoMessage("Failed to map io_uring completion queue"));
+            return false;
+        }
+    }
+    sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    void* sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                      IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        LOG_ERROR(ErrnoMessage("Failed to map io_uring submission entries"));
+        return false;
+    }
+    sqes_ = static_cast<struct io_uring_sqe*>(sqes);
+
+    char* sq = static_cast<char*>(sq_ring_);
+    sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_entries_ = params.sq_entries;
+    // 提交队列的下标数组固定为恒等映射，之后只需移动tail
+    unsigned* array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    for (unsigned i = 0; i < sq_entries_; ++i) {
+        array[i] = i;
+    }
+    char* cq = static_cast<char*>(cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+    return true;
+}
+
+bool UringLoop::SetupBufferRing() {
+    buf_ring_size_ = kBufferCount * sizeof(struct io_uring_buf);
+    void* ring = mmap(nullptr, buf_ring_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    void* buffers = mmap(nullptr, static_cast<size_t>(kBufferCount) * kBufferSize, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring == MAP_FAILED || buffers == MAP_FAILED) {
+        LOG_ERROR(ErrnoMessage("Failed to allocate io_uring receive buffers"));
+        return false;
+    }
+    buf_ring_ = static_cast<struct io_uring_buf*>(ring);
+    buffers_ = static_cast<char*>(buffers);
+
+    struct io_uring_buf_reg reg;
+    std::memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<uint64_t>(buf_ring_);
+    reg.ring_entries = kBufferCount;
+    reg.bgid = kBufferGroup;
+    if (SysRegister(ring_fd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        LOG_ERROR(ErrnoMessage("Failed to register io_uring buffer ring (requires Linux 5.19+)"));
+        return false;
+    }
+    for (unsigned i = 0; i < kBufferCount; ++i) {
+        RecycleBuffer(static_cast<uint16_t>(i));
+    }
+    return true;
+}
+
+void UringLoop::RecycleBuffer(uint16_t bid) {
+    // 第0项的resv字段就是环的tail，只能逐个字段写
+    struct io_uring_buf* buf = &buf_ring_[buf_tail_ & (kBufferCount - 1)];
+    buf->addr = reinterpret_cast<uint64_t>(buffers_ + static_cast<size_t>(bid) * kBufferSize);
+    buf->len = static_cast<uint32_t>(kBufferSize);
+    buf->bid = bid;
+    buf_tail_++;
+    uint16_t* tail = &reinterpret_cast<struct io_uring_buf*>(buf_ring_)[0].resv;
+    __atomic_store_n(tail, buf_tail_, __ATOMIC_RELEASE);
+}
+
+struct io_uring_sqe* UringLoop::GetSqe() {
+    unsigned tail = *sq_tail_;
+    // 提交队列已满，先把已填好的请求交给内核。完成队列积压时内核不会取走请求，
+    // 要先把完成事件移出完成队列；这里不能直接处理它们（处理时还会申请请求），留给Run处理
+    while (tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_) {
+        if (!Enter(false)) {
+            stopping_ = true;
+            return nullptr;
+        }
+        if (tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) < sq_entries_) {
+            break;
+        }
+        if (!StashCompletions() && !Enter(true)) {
+            // 没有可以移出的完成事件，等内核产生一个再试
+            stopping_ = true;
+            return nullptr;
+        }
+    }
+    struct io_uring_sqe* sqe = &sqes_[tail & sq_mask_];
+    std::memset(sqe, 0, sizeof(*sqe));
+    // 没有SQPOLL时内核只在io_uring_enter中读取提交队列，可以先移动tail再填写
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    inflight_++;
+    return sqe;
+}
+
+bool UringLoop::Enter(bool wait) {
+    for (;;) {
+        // 多报的to_submit没有影响，内核最多提交tail - head个
+        unsigned to_submit = *sq_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+        int ret = SysEnter(ring_fd_, to_submit, wait ? 1 : 0, wait ? IORING_ENTER_GETEVENTS : 0);
+        syscalls_.store(syscalls_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (ret >= 0) {
+            return true;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EAGAIN || errno == EBUSY) {
+            // 完成队列积压，调用者先取走完成事件再提交
+            return true;
+        }
+        LOG_ERROR(ErrnoMessage("io_uring_enter failed"));
+        return false;
+    }
+}
+
+void UringLoop::ArmAccept() {
+    struct io_uring_sqe* sqe = GetSqe();
+    if (!sqe) {
+        return;
+    }
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = listen_fd_;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    sqe->user_data = OP_ACCEPT;
+}
+
+void UringLoop::ArmWake() {
+    struct io_uring_sqe* sqe = GetSqe();
+    if (!sqe) {
+        return;
+    }
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = wake_fd_;
+    sqe->addr = reinterpret_cast<uint64_t>(&wake_value_);
+    sqe->len = sizeof(wake_value_);
+    sqe->user_data = OP_WAKE;
+}
+
+void UringLoop::ArmRecv(Connection* conn) {
+    struct io_uring_sqe* sqe = GetSqe();
+    if (!sqe) {
+        return;
+    }
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = conn->fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = kBufferGroup;
+    sqe->user_data = reinterpret_cast<uint64_t>(conn) | OP_RECV;
+    conn->recv_armed = true;
+}
+
+void UringLoop::StartSend(Connection* conn) {
+    std::memset(&conn->msg, 0, sizeof(conn->msg));
+    conn->msg.msg_iov = &conn->iov;
+    conn->msg.msg_iovlen = conn->output.FillIov(&conn->iov) ? 1 : 0;
+    struct io_uring_sqe* sqe = GetSqe();
+    if (!sqe) {
+        return;
+    }
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = conn->fd;
+    sqe->addr = reinterpret_cast<uint64_t>(&conn->msg);
+    sqe->len = 1;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = reinterpret_cast<uint64_t>(conn) | OP_SEND;
+    conn->sending = true;
+}
+
+void UringLoop::Run() {
+    ArmAccept();
+    ArmWake();
+    while (!stopping_) {
+        if (!Enter(true)) {
+            break;
+        }
+        ProcessCompletions();
+        // 这一轮产生的响应一起提交，随下一次io_uring_enter发出
+        FlushPending();
+    }
+    CancelAll();
+}
+
+bool UringLoop::StashCompletions() {
+    unsigned head = *cq_head_;
+    unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    if (head == tail) {
+        return false;
+    }
+    for (; head != tail; ++head) {
+        completions_.push_back(cqes_[head & cq_mask_]);
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    return true;
+}
+
+void UringLoop::ProcessCompletions() {
+    StashCompletions();
+    // 处理过程中GetSqe可能追加完成事件，按下标遍历并复制一份，追加时vector可能重新分配
+    for (size_t i = 0; i < completions_.size(); i++) {
+        struct io_uring_cqe cqe = completions_[i];
+        HandleCompletion(cqe);
+        if (i + 1 == completions_.size()) {
+            StashCompletions();
+        }
+    }
+    completions_.clear();
+}
+
+void UringLoop::HandleCompletion(const struct io_uring_cqe& cqe) {
+    bool more = (cqe.flags & IORING_CQE_F_MORE) != 0;
+    if (!more) {
+        inflight_--;
+    }
+    Connection* conn = reinterpret_cast<Connection*>(cqe.user_data & ~kOpMask);
+    switch (cqe.user_data & kOpMask) {
+        case OP_ACCEPT:
+            if (cqe.res >= 0) {
+                if (stopping_) {
+                    close(cqe.res);
+                } else {
+                    std::unique_ptr<Connection> accepted(new Connection());
+                    accepted->fd = cqe.res;
+                    Connection* raw = accepted.get();
+                    connections_[raw] = std::move(accepted);
+                    connection_count_.fetch_add(1, std::memory_order_relaxed);
+                    ArmRecv(raw);
+                    LOG_INFO("New connection on io_uring loop");
+                }
+            } else if (cqe.res != -ECANCELED && !stopping_) {
+                LOG_ERROR("io_uring accept failed: " + std::string(std::strerror(-cqe.res)));
+            }
+            if (!more && !stopping_) {
+                ArmAccept();
+            }
+            break;
+
+        case OP_WAKE:
+            if (!stopping_) {
+                ArmWake();
+            }
+            break;
+
+        case OP_RECV:
+            HandleRecv(conn, cqe.res, cqe.flags);
+            break;
+
+        case OP_SEND:
+            conn->sending = false;
+            if (cqe.res < 0) {
+                BeginClose(conn);
+            } else {
+                conn->output.Consume(static_cast<size_t>(cqe.res));
+                if (!conn->closing && !conn->output.empty()) {
+                    QueueFlush(conn);
+                } else if (conn->read_closed) {
+                    BeginClose(conn);
+                }
+            }
+            MaybeRelease(conn);
+            break;
+
+        default:
+            break;
+    }
+}
+
+void UringLoop::HandleRecv(Connection* conn, int res, uint32_t flags) {
+    if (res > 0) {
+        uint16_t bid = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+        conn->input.Append(buffers_ + static_cast<size_t>(bid) * kBufferSize, static_cast<size_t>(res));
+        RecycleBuffer(bid);
+        if (!conn->closing) {
+            uint64_t requests = 0;
+            while (conn->input.Next(&request_)) {
+                handler_(request_, conn->output.buffer());
+                requests++;
+            }
+            requests_.store(requests_.load(std::memory_order_relaxed) + requests, std::memory_order_relaxed);
+            if (conn->input.broken()) {
+                LOG_WARNING("Closing connection with malformed or oversized request");
+                BeginClose(conn);
+            } else if (conn->output.bytes() > kMaxOutputBytes) {
+                LOG_WARNING("Closing connection whose client is not reading responses");
+                BeginClose(conn);
+            } else {
+                QueueFlush(conn);
+            }
+        }
+    } else if (res == 0 && !conn->closing) {
+        // 对端半关闭：随FIN到达的命令的响应还没发出，发送完成后再关闭
+        conn->read_closed = true;
+        if (!conn->sending && conn->output.empty()) {
+            BeginClose(conn);
+        } else {
+            QueueFlush(conn);
+        }
+    } else if (res != -ENOBUFS) {
+        // 连接出错；ENOBUFS只是缓冲环暂时用完，重新挂上recv即可
+        BeginClose(conn);
+    }
+    if (!(flags & IORING_CQE_F_MORE)) {
+        conn->recv_armed = false;
+        if (!conn->closing && !conn->read_closed) {
+            ArmRecv(conn);
+        }
+    }
+    MaybeRelease(conn);
+}
+
+void UringLoop::QueueFlush(Connection* conn) {
+    if (!conn->queued && !conn->sending) {
+        conn->queued = true;
+        flush_list_.push_back(conn);
+    }
+}
+
+void UringLoop::FlushPending() {
+    std::vector<Connection*> pending;
+    pending.swap(flush_list_);
+    for (Connection* conn : pending) {
+        conn->queued = false;
+        if (!conn->closing && !conn->sending && !conn->output.empty()) {
+            StartSend(conn);
+        }
+        MaybeRelease(conn);
+    }
+}
+
+void UringLoop::BeginClose(Connection* conn) {
+    if (conn->closing) {
+        return;
+    }
+    conn->closing = true;
+    // 让挂着的recv和send尽快结束，fd在它们都完成后才关闭
+    shutdown(conn->fd, SHUT_RDWR);
+    syscalls_.store(syscalls_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void UringLoop::MaybeRelease(Connection* conn) {
+    if (!conn->closing || conn->recv_armed || conn->sending || conn->queued) {
+        return;
+    }
+    close(conn->fd);
+    connections_.erase(conn);
+    connection_count_.fetch_sub(1, std::memory_order_relaxed);
+    LOG_INFO("Client disconnected");
+}
+
+void UringLoop::CancelAll() {
+    for (auto& kv : connections_) {
+        BeginClose(kv.second.get());
+    }
+    struct io_uring_sqe* sqe = GetSqe();
+    if (!sqe) {
+        return;
+    }
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->cancel_flags = IORING_ASYNC_CANCEL_ALL | IORING_ASYNC_CANCEL_ANY;
+    sqe->user_data = OP_CANCEL;
+    // 等所有请求都结束，之后内核不会再写入连接和接收缓冲
+    while (inflight_ > 0 && Enter(true)) {
+        ProcessCompletions();
+        FlushPending();
+    }
+}
@@ -0,0 +1,152 @@
+// src/network/uring_loop.h
+#ifndef URING_LOOP_H
+#define URING_LOOP_H
+
+#include "framing.h"
+#include <sys/socket.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+struct io_uring_buf;
+
+// 基于io_uring的事件循环，直接使用内核接口（io_uring_setup/enter/register），不依赖liburing
+//
+// 每个循环在监听socket上挂一个多发（multishot）accept，自己接受连接；每个连接挂一个
+// 多发recv，数据放进注册给内核的缓冲环（provided buffer ring），不需要为每次读取提交请求。
+// 一轮完成事件处理完后，所有有待发响应的连接各提交一个sendmsg，与等待下一批完成事件
+// 合并成一次io_uring_enter。命令切分和响应排队与epoll模式共用RequestFramer和ResponseQueue。
+// 需要Linux 6.0及以上（多发recv）。
+class UringLoop {
+public:
+    // 执行命令，把响应追加到out（连接的输出缓冲）末尾
+    using Handler = std::function<void(const Request&, std::string* out)>;
+
+    static const unsigned kQueueDepth = 4096;
+    // 缓冲环的缓冲区个数（2的幂）和每个缓冲区的大小
+    static const unsigned kBufferCount = 1024;
+    static const size_t kBufferSize = 16 * 1024;
+    static const size_t kMaxOutputBytes = 64 * 1024 * 1024;
+
+    // listen_fd由调用方负责关闭，且要在Stop之后
+    UringLoop(Handler handler, int listen_fd);
+    ~UringLoop();
+    UringLoop(const UringLoop&) = delete;
+    UringLoop& operator=(const UringLoop&) = delete;
+
+    // 探测当前内核能否运行本循环：版本不低于6.0，且能建立ring并注册缓冲环。
+    // 容器的seccomp策略禁用io_uring时也返回false
+    static bool Supported();
+
+    // 内核不支持io_uring或所需特性时返回false
+    bool Start();
+    // 通知循环退出；不在循环线程中调用时等待线程结束
+    void Stop();
+
+    size_t ConnectionCount() const { return connection_count_.load(std::memory_order_relaxed); }
+    // 处理过的命令数，以及io_uring_enter和关闭连接时shutdown的调用数
+    uint64_t requests() const { return requests_.load(std::memory_order_relaxed); }
+    uint64_t syscalls() const { return syscalls_.load(std::memory_order_relaxed); }
+
+private:
+    struct Connection {
+        int fd = -1;
+        RequestFramer input;
+        ResponseQueue output;
+        bool recv_armed = false;
+        bool sending = false;
+        // 对端已关闭写端：不再挂recv，已生成的响应发完后再关闭
+        bool read_closed = false;
+        bool closing = false;
+        // 在flush_list_中等待提交发送
+        bool queued = false;
+        struct msghdr msg;
+        struct iovec iov;
+    };
+
+    // user_data的低3位区分请求类型，其余位是Connection指针
+    enum OpKind : uint64_t {
+        OP_ACCEPT = 1,
+        OP_WAKE = 2,
+        OP_RECV = 3,
+        OP_SEND = 4,
+        OP_CANCEL = 5
+    };
+
+    bool SetupRing();
+    bool SetupBufferRing();
+    // 提交队列满且无法腾出位置（io_uring_enter出错）时返回nullptr，并让循环退出
+    io_uring_sqe* GetSqe();
+    // 提交已填好的请求；wait为true时至少等到一个完成事件
+    bool Enter(bool wait);
+    void ArmAccept();
+    void ArmWake();
+    void ArmRecv(Connection* conn);
+    void StartSend(Connection* conn);
+    void RecycleBuffer(uint16_t bid);
+
+    void Run();
+    // 把完成队列中的事件移到completions_，腾出完成队列；没有事件时返回false
+    bool StashCompletions();
+    // 处理完成队列和completions_中的全部事件
+    void ProcessCompletions();
+    void HandleCompletion(const io_uring_cqe& cqe);
+    void HandleRecv(Connection* conn, int res, uint32_t flags);
+    void QueueFlush(Connection* conn);
+    void FlushPending();
+    void BeginClose(Connection* conn);
+    // 连接上没有进行中的请求后才释放，内核可能还在使用它的缓冲
+    void MaybeRelease(Connection* conn);
+    void CancelAll();
+
+    Handler handler_;
+    int listen_fd_;
+    int ring_fd_;
+    int wake_fd_;
+    uint64_t wake_value_;
+
+    // 提交队列和完成队列在共享内存中的位置
+    void* sq_ring_;
+    size_t sq_ring_size_;
+    void* cq_ring_;
+    size_t cq_ring_size_;
+    io_uring_sqe* sqes_;
+    size_t sqes_size_;
+    unsigned* sq_head_;
+    unsigned* sq_tail_;
+    unsigned sq_mask_;
+    unsigned sq_entries_;
+    unsigned* cq_head_;
+    unsigned* cq_tail_;
+    unsigned cq_mask_;
+    io_uring_cqe* cqes_;
+    // 已从完成队列取出、尚未处理的完成事件
+    std::vector<io_uring_cqe> completions_;
+    // 已提交且还会产生完成事件的请求数
+    size_t inflight_;
+    // 解析命令时反复使用，保留参数数组的容量
+    Request request_;
+
+    io_uring_buf* buf_ring_;
+    size_t buf_ring_size_;
+    char* buffers_;
+    uint16_t buf_tail_;
+
+    std::thread thread_;
+    std::atomic<bool> stopping_;
+    std::unordered_map<Connection*, std::unique_ptr<Connection>> connections_;
+    std::vector<Connection*> flush_list_;
+    std::atomic<size_t> connection_count_;
+    std::atomic<uint64_t> requests_;
+    std::atomic<uint64_t> syscalls_;
+};
+
+#endif // URING_LOOP_H
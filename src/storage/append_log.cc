@@ -0,0 +1,428 @@
+// src/storage/append_log.cc
+#include "append_log.h"
+#include "../common/logger.h"
+#include "../common/utils.h"
+#include "coding.h"
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+const char AppendLog::kMagic[8] = {'K', 'V', 'A', 'O', 'F', '0', '0', '1'};
+const size_t AppendLog::kHeaderSize;
+
+namespace {
+
+// 记录格式：crc32c(4) | payload长度(4) | type(1) seq(8) expire_at_ms(8) key长度(4) key value
+// crc覆盖payload长度和payload，长度字段损坏也能被发现
+const size_t kRecordPrefix = 8;
+const size_t kPayloadFixed = 21;
+// 等待领导者时的超时，只是兜底，正常情况下由领导者notify唤醒
+const int kLeaderWaitMs = 100;
+// 单条记录payload的上限，超过视为损坏，防止按错误长度分配内存
+const uint32_t kMaxPayload = 1u << 30;
+// 重写时导出数据和重写缓冲按这个大小分批写入新文件
+const size_t kRewriteChunk = 1 << 20;
+// 重写缓冲追赶的最多轮数，之后在锁内写完剩余部分
+const int kRewriteCatchUpRounds = 16;
+
+std::string ErrnoMessage(const std::string& what, const std::string& path) {
+    return what + " " + path + ": " + std::strerror(errno);
+}
+
+}  // namespace
+
+using coding::GetFixed32;
+using coding::GetFixed64;
+using coding::PutFixed32;
+using coding::PutFixed64;
+
+bool ParseFsyncPolicy(const std::string& name, FsyncPolicy* policy) {
+    if (name == "always") {
+        *policy = FSYNC_ALWAYS;
+    } else if (name == "interval" || name == "everysec") {
+        *policy = FSYNC_INTERVAL;
+    } else if (name == "no") {
+        *policy = FSYNC_NO;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+AppendLog::AppendLog(const AppendLogOptions& options)
+    : options_(options), fd_(-1), leader_active_(false), last_seq_(0), written_seq_(0), synced_seq_(0),
+      file_size_(0), sync_count_(0), rewriting_(false), rewrite_fd_(-1), rewrite_size_(0),
+      rewrite_base_seq_(0), stopping_(false) {}
+
+AppendLog::~AppendLog() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    flusher_cv_.notify_all();
+    if (flusher_.joinable()) {
+        flusher_.join();
+    }
+
+    if (rewriting_) {
+        AbortRewrite();
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    WaitForLeaderLocked(lock);
+    if (fd_ >= 0) {
+        // 正常退出时把缓冲中剩余的记录写完并落盘
+        FlushLocked(lock, options_.fsync != FSYNC_NO);
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+void AppendLog::EncodeRecord(LogRecordType type, uint64_t seq, int64_t expire_at_ms, const std::string& key,
+                             const std::string& value, std::string* out) {
+    size_t start = out->size();
+    uint32_t payload_len = static_cast<uint32_t>(kPayloadFixed + key.size() + value.size());
+    PutFixed32(out, 0);
+    PutFixed32(out, payload_len);
+    out->push_back(static_cast<char>(type));
+    PutFixed64(out, seq);
+    PutFixed64(out, static_cast<uint64_t>(expire_at_ms));
+    PutFixed32(out, static_cast<uint32_t>(key.size()));
+    out->append(key);
+    out->append(value);
+
+    uint32_t crc = utils::Crc32c(out->data() + start + 4, out->size() - start - 4);
+    std::memcpy(&(*out)[start], &crc, 4);
+}
+
+std::string AppendLog::EncodeHeader(uint64_t base_seq) {
+    std::string header(kMagic, sizeof(kMagic));
+    PutFixed64(&header, base_seq);
+    PutFixed32(&header, utils::Crc32c(header.data(), header.size()));
+    return header;
+}
+
+Status AppendLog::WriteAll(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return Status::Error(std::string("Failed to write append log: ") + std::strerror(errno));
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return Status::OK_STATUS();
+}
+
+Status AppendLog::Open(const std::function<void(const LogRecord&)>& replay, uint64_t start_seq) {
+    fd_ = ::open(options_.path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        return Status::Error(ErrnoMessage("Failed to open append log", options_.path));
+    }
+
+    struct stat st;
+    if (::fstat(fd_, &st) != 0) {
+        return Status::Error(ErrnoMessage("Failed to stat append log", options_.path));
+    }
+    size_t file_size = static_cast<size_t>(st.st_size);
+
+    uint64_t last_seq = 0;
+    size_t valid_end = 0;
+    if (file_size >= kHeaderSize) {
+        std::ifstream in(options_.path, std::ios::binary);
+        std::vector<char> stream_buffer(1 << 20);
+        in.rdbuf()->pubsetbuf(stream_buffer.data(), stream_buffer.size());
+
+        char header[kHeaderSize];
+        in.read(header, kHeaderSize);
+        if (!in || std::memcmp(header, kMagic, sizeof(kMagic)) != 0 ||
+            GetFixed32(header + 16) != utils::Crc32c(header, 16)) {
+            return Status::Error("Not a valid append log: " + options_.path);
+        }
+        last_seq = GetFixed64(header + 8);
+        valid_end = kHeaderSize;
+
+        std::string payload;
+        LogRecord record;
+        char prefix[kRecordPrefix];
+        while (in.read(prefix, kRecordPrefix)) {
+            uint32_t crc = GetFixed32(prefix);
+            uint32_t payload_len = GetFixed32(prefix + 4);
+            if (payload_len < kPayloadFixed || payload_len > kMaxPayload) {
+                break;
+            }
+            payload.resize(payload_len);
+            if (!in.read(&payload[0], payload_len)) {
+                break;
+            }
+            uint32_t actual = utils::Crc32c(payload.data(), payload.size(), utils::Crc32c(prefix + 4, 4));
+            uint32_t key_len = GetFixed32(payload.data() + 17);
+            if (actual != crc || key_len > payload_len - kPayloadFixed) {
+                break;
+            }
+
+            record.type = static_cast<LogRecordType>(payload[0]);
+            record.seq = GetFixed64(payload.data() + 1);
+            record.expire_at_ms = static_cast<int64_t>(GetFixed64(payload.data() + 9));
+            record.key.assign(payload.data() + kPayloadFixed, key_len);
+            record.value.assign(payload.data() + kPayloadFixed + key_len, payload_len - kPayloadFixed - key_len);
+            replay(record);
+
+            if (record.seq > last_seq) {
+                last_seq = record.seq;
+            }
+            valid_end += kRecordPrefix + payload_len;
+        }
+    }
+
+    if (valid_end < file_size) {
+        // 只有最后一次写入可能不完整，截掉之后的内容，新记录接在有效记录后面
+        LOG_WARNING("Truncating " + std::to_string(file_size - valid_end) + " bytes of incomplete records from " +
+                    options_.path);
+        if (::ftruncate(fd_, static_cast<off_t>(valid_end)) != 0) {
+            return Status::Error(ErrnoMessage("Failed to truncate append log", options_.path));
+        }
+    }
+    if (valid_end == 0) {
+        std::string header = EncodeHeader(start_seq);
+        Status s = WriteAll(fd_, header.data(), header.size());
+        if (!s.ok()) {
+            return s;
+        }
+        if (::fdatasync(fd_) != 0) {
+            return Status::Error(ErrnoMessage("Failed to sync append log", options_.path));
+        }
+        valid_end = header.size();
+    }
+
+    if (last_seq < start_seq) {
+        last_seq = start_seq;
+    }
+    last_seq_ = written_seq_ = synced_seq_ = last_seq;
+    file_size_ = valid_end;
+    LOG_INFO("Opened append log " + options_.path + ", last sequence " + std::to_string(last_seq));
+
+    if (options_.fsync == FSYNC_INTERVAL) {
+        flusher_ = std::thread(&AppendLog::FlusherLoop, this);
+    }
+    return Status::OK_STATUS();
+}
+
+bool AppendLog::ReadBaseSequence(const std::string& path, uint64_t* base_seq) {
+    std::ifstream in(path, std::ios::binary);
+    char header[kHeaderSize];
+    if (!in.read(header, kHeaderSize) || std::memcmp(header, kMagic, sizeof(kMagic)) != 0 ||
+        GetFixed32(header + 16) != utils::Crc32c(header, 16)) {
+        return false;
+    }
+    *base_seq = GetFixed64(header + 8);
+    return true;
+}
+
+uint64_t AppendLog::Append(LogRecordType type, const std::string& key, const std::string& value,
+                           int64_t expire_at_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t seq = ++last_seq_;
+    size_t start = buffer_.size();
+    EncodeRecord(type, seq, expire_at_ms, key, value, &buffer_);
+    if (rewriting_) {
+        rewrite_buffer_.append(buffer_, start, std::string::npos);
+    }
+    file_size_ += buffer_.size() - start;
+    return seq;
+}
+
+void AppendLog::FlushLocked(std::unique_lock<std::mutex>& lock, bool sync) {
+    leader_active_ = true;
+    flush_buffer_.clear();
+    flush_buffer_.swap(buffer_);
+    uint64_t batch_seq = last_seq_;
+    int fd = fd_;
+    lock.unlock();
+
+    // 这一批里包含了领导者等待期间所有写者追加的记录，一次write/fdatasync全部覆盖
+    Status s = WriteAll(fd, flush_buffer_.data(), flush_buffer_.size());
+    if (s.ok() && sync) {
+        if (::fdatasync(fd) != 0) {
+            s = Status::Error(std::string("Failed to sync append log: ") + std::strerror(errno));
+        }
+        sync_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    lock.lock();
+    if (!s.ok()) {
+        // 写失败后文件内容不再可信，之后的写入都返回这个错误
+        if (error_.ok()) {
+            LOG_ERROR(s.message);
+            error_ = s;
+        }
+    } else {
+        written_seq_ = batch_seq;
+        if (sync) {
+            synced_seq_ = batch_seq;
+        }
+    }
+    leader_active_ = false;
+    cond_.notify_all();
+}
+
+void AppendLog::WaitForLeaderLocked(std::unique_lock<std::mutex>& lock) {
+    while (leader_active_) {
+        cond_.wait_for(lock, std::chrono::milliseconds(kLeaderWaitMs));
+    }
+}
+
+Status AppendLog::WaitDurable(uint64_t seq) {
+    const bool sync = options_.fsync == FSYNC_ALWAYS;
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        if (!error_.ok()) {
+            return error_;
+        }
+        if ((sync ? synced_seq_ : written_seq_) >= seq) {
+            return Status::OK_STATUS();
+        }
+        if (leader_active_) {
+            // 上一批正在写，等它完成后由等待者之一带着新积累的记录成为下一个领导者
+            cond_.wait_for(lock, std::chrono::milliseconds(kLeaderWaitMs));
+        } else {
+            FlushLocked(lock, sync);
+        }
+    }
+}
+
+void AppendLog::FlusherLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        flusher_cv_.wait_for(lock, std::chrono::milliseconds(options_.fsync_interval_ms));
+        if (stopping_) {
+            break;
+        }
+        // 有领导者正在写时跳过这一轮，避免与它争抢
+        if (synced_seq_ < last_seq_ && !leader_active_ && error_.ok()) {
+            FlushLocked(lock, true);
+        }
+    }
+}
+
+Status AppendLog::StartRewrite(uint64_t* base_seq) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (rewriting_) {
+        return Status::Error("Append log rewrite already in progress");
+    }
+    std::string tmp_path = options_.path + ".rewrite";
+    rewrite_fd_ = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (rewrite_fd_ < 0) {
+        return Status::Error(ErrnoMessage("Failed to create", tmp_path));
+    }
+
+    rewrite_base_seq_ = last_seq_;
+    rewrite_pending_ = EncodeHeader(rewrite_base_seq_);
+    rewrite_size_ = 0;
+    rewrite_buffer_.clear();
+    rewriting_ = true;
+    *base_seq = rewrite_base_seq_;
+    return Status::OK_STATUS();
+}
+
+Status AppendLog::AddRewriteRecord(const std::string& key, const std::string& value, int64_t expire_at_ms) {
+    EncodeRecord(LOG_PUT, rewrite_base_seq_, expire_at_ms, key, value, &rewrite_pending_);
+    if (rewrite_pending_.size() < kRewriteChunk) {
+        return Status::OK_STATUS();
+    }
+    Status s = WriteAll(rewrite_fd_, rewrite_pending_.data(), rewrite_pending_.size());
+    rewrite_size_ += rewrite_pending_.size();
+    rewrite_pending_.clear();
+    return s;
+}
+
+Status AppendLog::FinishRewrite() {
+    Status s = WriteAll(rewrite_fd_, rewrite_pending_.data(), rewrite_pending_.size());
+    rewrite_size_ += rewrite_pending_.size();
+    rewrite_pending_.clear();
+
+    // 先在锁外追赶重写期间积累的记录，剩余部分足够小后再在锁内写完并切换文件
+    for (int round = 0; s.ok() && round < kRewriteCatchUpRounds; ++round) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (rewrite_buffer_.size() <= kRewriteChunk) {
+            break;
+        }
+        rewrite_pending_.swap(rewrite_buffer_);
+        lock.unlock();
+        s = WriteAll(rewrite_fd_, rewrite_pending_.data(), rewrite_pending_.size());
+        rewrite_size_ += rewrite_pending_.size();
+        rewrite_pending_.clear();
+    }
+    if (!s.ok()) {
+        AbortRewrite();
+        return s;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    // 成为领导者，保证切换期间没有人在写旧文件
+    WaitForLeaderLocked(lock);
+    std::string tmp_path = options_.path + ".rewrite";
+    s = WriteAll(rewrite_fd_, rewrite_buffer_.data(), rewrite_buffer_.size());
+    if (s.ok() && ::fdatasync(rewrite_fd_) != 0) {
+        s = Status::Error(ErrnoMessage("Failed to sync", tmp_path));
+    }
+    if (s.ok() && ::rename(tmp_path.c_str(), options_.path.c_str()) != 0) {
+        s = Status::Error(ErrnoMessage("Failed to rename", tmp_path));
+    }
+    if (!s.ok()) {
+        lock.unlock();
+        AbortRewrite();
+        return s;
+    }
+
+    // 新文件已经包含缓冲中尚未写入旧文件的记录，且已落盘
+    ::close(fd_);
+    fd_ = rewrite_fd_;
+    rewrite_fd_ = -1;
+    file_size_ = rewrite_size_ + rewrite_buffer_.size();
+    buffer_.clear();
+    written_seq_ = synced_seq_ = last_seq_;
+    rewriting_ = false;
+    std::string().swap(rewrite_buffer_);
+    std::string().swap(rewrite_pending_);
+    cond_.notify_all();
+    lock.unlock();
+
+    // 目录项落盘失败时新文件内容仍然完整，只记录错误
+    if (!utils::SyncParentDirectory(options_.path)) {
+        LOG_WARNING(ErrnoMessage("Failed to sync directory of", options_.path));
+    }
+    LOG_INFO("Append log rewritten, size " + std::to_string(FileSize()) + " bytes");
+    return Status::OK_STATUS();
+}
+
+void AppendLog::AbortRewrite() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!rewriting_) {
+        return;
+    }
+    rewriting_ = false;
+    std::string().swap(rewrite_buffer_);
+    std::string().swap(rewrite_pending_);
+    ::close(rewrite_fd_);
+    rewrite_fd_ = -1;
+    ::unlink((options_.path + ".rewrite").c_str());
+}
+
+size_t AppendLog::FileSize() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return file_size_;
+}
+
+uint64_t AppendLog::LastSequence() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return last_seq_;
+}
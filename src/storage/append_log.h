@@ -0,0 +1,140 @@
+// src/storage/append_log.h
+#ifndef APPEND_LOG_H
+#define APPEND_LOG_H
+
+#include "../core/kv_store.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// 日志落盘策略
+enum FsyncPolicy {
+    FSYNC_ALWAYS = 0,    // 每次写入在返回前fdatasync，并发写者合并为一次
+    FSYNC_INTERVAL = 1,  // 写入在返回前write到内核，后台线程每隔一段时间fdatasync
+    FSYNC_NO = 2         // 只write到内核，何时落盘由操作系统决定
+};
+
+// 解析"always"、"interval"、"no"，失败返回false
+bool ParseFsyncPolicy(const std::string& name, FsyncPolicy* policy);
+
+struct AppendLogOptions {
+    std::string path;
+    FsyncPolicy fsync = FSYNC_INTERVAL;
+    int fsync_interval_ms = 1000;
+    // 日志超过该大小、且达到上次重写后大小的两倍时自动后台重写，0表示不自动重写
+    size_t auto_rewrite_min_bytes = 64 * 1024 * 1024;
+};
+
+enum LogRecordType {
+    LOG_PUT = 1,        // key, value, expire_at_ms（0表示没有过期时间）
+    LOG_DELETE = 2,     // key
+    LOG_EXPIRE_AT = 3,  // key, expire_at_ms
+    LOG_CLEAR = 4
+};
+
+struct LogRecord {
+    LogRecordType type;
+    uint64_t seq;
+    // Unix毫秒时间，重启后依然有意义
+    int64_t expire_at_ms;
+    std::string key;
+    std::string value;
+};
+
+// 追加写日志
+//
+// 文件由头部（魔数、基准序列号）和连续的记录组成，每条记录带CRC-32C和单调递增的序列号。
+// 写入分两步：Append把编码后的记录放进内存缓冲并分配序列号，WaitDurable等待记录达到
+// 配置的持久化级别。等待者中恰好有一个成为"领导者"，把缓冲中所有写者的记录一次write
+// （FSYNC_ALWAYS时再加一次fdatasync），其余写者等它完成，从而共享一次系统调用。
+//
+// 重写：StartRewrite之后新追加的记录会同时进入重写缓冲，调用者把当前数据通过
+// AddRewriteRecord写入临时文件，FinishRewrite补上重写缓冲后原子替换日志文件。
+class AppendLog {
+public:
+    static const char kMagic[8];
+    static const size_t kHeaderSize = 20;
+
+    explicit AppendLog(const AppendLogOptions& options);
+    ~AppendLog();
+    AppendLog(const AppendLog&) = delete;
+    AppendLog& operator=(const AppendLog&) = delete;
+
+    // 打开日志并按顺序回放已有记录；文件不存在时创建空日志。
+    // 末尾不完整或校验失败的记录（崩溃时写了一半）会被截掉。
+    // start_seq为已由快照覆盖的序列号，之后分配的序列号都大于它
+    Status Open(const std::function<void(const LogRecord&)>& replay, uint64_t start_seq = 0);
+
+    // 读取日志头部的基准序列号（上次重写时的序列号），文件不存在或不是日志时返回false
+    static bool ReadBaseSequence(const std::string& path, uint64_t* base_seq);
+
+    // 追加一条记录到内存缓冲，返回其序列号，不等待写入
+    uint64_t Append(LogRecordType type, const std::string& key, const std::string& value = std::string(),
+                    int64_t expire_at_ms = 0);
+
+    // 等待序列号不大于seq的记录达到配置的持久化级别，返回写入过程中遇到的错误
+    Status WaitDurable(uint64_t seq);
+
+    // 开始重写，返回新日志的基准序列号（此前的记录都应体现在导出的数据里）
+    Status StartRewrite(uint64_t* base_seq);
+    // 把导出的一条数据写入重写中的新日志，只能由调用StartRewrite的线程调用
+    Status AddRewriteRecord(const std::string& key, const std::string& value, int64_t expire_at_ms);
+    // 写入重写期间追加的记录，落盘后替换原日志
+    Status FinishRewrite();
+    // 放弃重写并删除临时文件
+    void AbortRewrite();
+
+    const AppendLogOptions& options() const { return options_; }
+    // 当前日志文件大小（含尚未write的缓冲）
+    size_t FileSize() const;
+    uint64_t LastSequence() const;
+    // 累计fdatasync次数，用于观察组提交的合并效果
+    uint64_t SyncCount() const { return sync_count_.load(std::memory_order_relaxed); }
+
+private:
+    // 持有lock且当前没有领导者时调用：把缓冲中的记录写入文件，sync为true时再fdatasync。
+    // 执行期间释放锁
+    void FlushLocked(std::unique_lock<std::mutex>& lock, bool sync);
+    void WaitForLeaderLocked(std::unique_lock<std::mutex>& lock);
+    void FlusherLoop();
+
+    static void EncodeRecord(LogRecordType type, uint64_t seq, int64_t expire_at_ms, const std::string& key,
+                             const std::string& value, std::string* out);
+    static std::string EncodeHeader(uint64_t base_seq);
+    static Status WriteAll(int fd, const char* data, size_t len);
+
+    AppendLogOptions options_;
+    int fd_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cond_;
+    std::string buffer_;
+    // 领导者写文件时使用，与buffer_交换以复用内存
+    std::string flush_buffer_;
+    bool leader_active_;
+    uint64_t last_seq_;
+    uint64_t written_seq_;
+    uint64_t synced_seq_;
+    size_t file_size_;
+    Status error_;
+    std::atomic<uint64_t> sync_count_;
+
+    // 重写状态：rewriting_和rewrite_buffer_受mutex_保护，其余只由重写线程访问
+    bool rewriting_;
+    std::string rewrite_buffer_;
+    int rewrite_fd_;
+    std::string rewrite_pending_;
+    size_t rewrite_size_;
+    uint64_t rewrite_base_seq_;
+
+    // FSYNC_INTERVAL模式下定期fdatasync的后台线程
+    std::thread flusher_;
+    std::condition_variable flusher_cv_;
+    bool stopping_;
+};
+
+#endif // APPEND_LOG_H
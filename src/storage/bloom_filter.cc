@@ -0,0 +1,68 @@
+// src/storage/bloom_filter.cc
+#include "bloom_filter.h"
+#include <cstring>
+
+uint32_t BloomFilter::Hash(const char* data, size_t len) {
+    // 64位FNV-1a，再把高低位混合到32位
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < len; ++i) {
+        h ^= static_cast<unsigned char>(data[i]);
+        h *= 0x100000001b3ull;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return static_cast<uint32_t>(h);
+}
+
+void BloomFilter::Build(const std::vector<uint32_t>& key_hashes, int bits_per_key, std::string* out) {
+    // k = bits_per_key * ln2 时误判率最低
+    int k = static_cast<int>(bits_per_key * 0.69);
+    if (k < 1) {
+        k = 1;
+    } else if (k > 30) {
+        k = 30;
+    }
+    // 条目很少时位数组太短误判率会很高，至少64位
+    size_t bits = key_hashes.size() * bits_per_key;
+    if (bits < 64) {
+        bits = 64;
+    }
+    size_t bytes = (bits + 7) / 8;
+    bits = bytes * 8;
+
+    size_t start = out->size();
+    out->resize(start + bytes, 0);
+    out->push_back(static_cast<char>(k));
+    char* array = &(*out)[start];
+    for (uint32_t h : key_hashes) {
+        const uint32_t delta = (h >> 17) | (h << 15);
+        for (int j = 0; j < k; ++j) {
+            size_t pos = h % bits;
+            array[pos / 8] |= static_cast<char>(1 << (pos % 8));
+            h += delta;
+        }
+    }
+}
+
+bool BloomFilter::MayContain(const std::string& filter, uint32_t key_hash) {
+    if (filter.size() < 2) {
+        return true;
+    }
+    const size_t bits = (filter.size() - 1) * 8;
+    const int k = static_cast<unsigned char>(filter.back());
+    if (k > 30) {
+        // 未知的编码，保守地认为可能存在
+        return true;
+    }
+    uint32_t h = key_hash;
+    const uint32_t delta = (h >> 17) | (h << 15);
+    for (int j = 0; j < k; ++j) {
+        size_t pos = h % bits;
+        if ((filter[pos / 8] & (1 << (pos % 8))) == 0) {
+            return false;
+        }
+        h += delta;
+    }
+    return true;
+}
@@ -0,0 +1,23 @@
+// src/storage/bloom_filter.h
+#ifndef BLOOM_FILTER_H
+#define BLOOM_FILTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 布隆过滤器：每个key只计算一次32位哈希，用双重哈希(h + i*delta)生成k个探测位置。
+// 序列化格式为位数组，末尾1字节保存k，读取时不依赖构建时的参数
+class BloomFilter {
+public:
+    static uint32_t Hash(const char* data, size_t len);
+
+    // bits_per_key为10时误判率约1%
+    static void Build(const std::vector<uint32_t>& key_hashes, int bits_per_key, std::string* out);
+
+    // 返回false时key一定不存在
+    static bool MayContain(const std::string& filter, uint32_t key_hash);
+};
+
+#endif // BLOOM_FILTER_H
@@ -0,0 +1,38 @@
+// src/storage/coding.h
+#ifndef STORAGE_CODING_H
+#define STORAGE_CODING_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// 磁盘格式中定长整数的编解码，统一使用本机字节序（小端）
+namespace coding {
+
+inline void PutFixed32(std::string* out, uint32_t v) {
+    char buf[4];
+    std::memcpy(buf, &v, 4);
+    out->append(buf, 4);
+}
+
+inline void PutFixed64(std::string* out, uint64_t v) {
+    char buf[8];
+    std::memcpy(buf, &v, 8);
+    out->append(buf, 8);
+}
+
+inline uint32_t GetFixed32(const char* p) {
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return v;
+}
+
+inline uint64_t GetFixed64(const char* p) {
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+    return v;
+}
+
+}  // namespace coding
+
+#endif // STORAGE_CODING_H
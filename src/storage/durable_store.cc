@@ -0,0 +1,289 @@
+// src/storage/durable_store.cc
+#include "durable_store.h"
+#include "snapshot.h"
+#include "../common/logger.h"
+#include "../common/utils.h"
+#include <algorithm>
+#include <functional>
+#include <unistd.h>
+
+const size_t DurableStore::kLockStripes;
+
+DurableStore::DurableStore(std::unique_ptr<KVStore> inner, const AppendLogOptions& options)
+    : inner_(std::move(inner)), log_(options), rewriting_(false), rewrite_base_size_(0) {}
+
+DurableStore::~DurableStore() {
+    if (rewrite_thread_.joinable()) {
+        rewrite_thread_.join();
+    }
+}
+
+Status DurableStore::Open(std::unique_ptr<KVStore> inner, const AppendLogOptions& options,
+                          std::unique_ptr<DurableStore>* store, const std::string& snapshot_path) {
+    std::unique_ptr<DurableStore> durable(new DurableStore(std::move(inner), options));
+
+    // 日志重写后基准点之前的修改已经不在日志里，只有不早于基准点的快照才能与日志拼接
+    uint64_t snapshot_seq = 0;
+    uint64_t log_base = 0;
+    bool has_log = AppendLog::ReadBaseSequence(options.path, &log_base);
+    if (!snapshot_path.empty() && ::access(snapshot_path.c_str(), F_OK) == 0) {
+        SnapshotReader reader;
+        Status s = reader.Open(snapshot_path);
+        if (!s.ok()) {
+            return s;
+        }
+        if (!has_log || reader.header().seq >= log_base) {
+            SnapshotHeader header;
+            s = LoadSnapshot(snapshot_path, durable->inner_.get(), &header);
+            if (!s.ok()) {
+                return s;
+            }
+            snapshot_seq = header.seq;
+        } else {
+            LOG_INFO("Snapshot " + snapshot_path + " is older than the append log, replaying the log only");
+        }
+    }
+
+    size_t records = 0;
+    Status s = durable->log_.Open([&](const LogRecord& record) {
+        if (record.seq > snapshot_seq) {
+            durable->Replay(record);
+            records++;
+        }
+    }, snapshot_seq);
+    if (!s.ok()) {
+        return s;
+    }
+    durable->rewrite_base_size_ = durable->log_.FileSize();
+    LOG_INFO("Replayed " + std::to_string(records) + " records, " + std::to_string(durable->Size()) + " keys");
+    *store = std::move(durable);
+    return Status::OK_STATUS();
+}
+
+void DurableStore::Replay(const LogRecord& record) {
+    int64_t ttl_ms = record.expire_at_ms - utils::UnixTimeMs();
+    switch (record.type) {
+        case LOG_PUT:
+            if (record.expire_at_ms == 0) {
+                inner_->Put(record.key, record.value);
+            } else if (ttl_ms > 0) {
+                inner_->PutWithTtl(record.key, record.value, ttl_ms);
+            } else {
+                // 停机期间已经过期
+                inner_->Delete(record.key);
+            }
+            break;
+        case LOG_DELETE:
+            inner_->Delete(record.key);
+            break;
+        case LOG_EXPIRE_AT:
+            if (ttl_ms > 0) {
+                inner_->Expire(record.key, ttl_ms);
+            } else {
+                inner_->Delete(record.key);
+            }
+            break;
+        case LOG_CLEAR:
+            inner_->Clear();
+            break;
+        default:
+            LOG_WARNING("Skipping log record with unknown type " + std::to_string(record.type));
+            break;
+    }
+}
+
+std::mutex& DurableStore::StripeFor(const std::string& key) {
+    size_t h = std::hash<std::string>()(key);
+    return stripes_[(h ^ (h >> 32)) % kLockStripes].mutex;
+}
+
+void DurableStore::LockAllStripes() {
+    for (size_t i = 0; i < kLockStripes; ++i) {
+        stripes_[i].mutex.lock();
+    }
+}
+
+void DurableStore::UnlockAllStripes() {
+    for (size_t i = 0; i < kLockStripes; ++i) {
+        stripes_[i].mutex.unlock();
+    }
+}
+
+Status DurableStore::WaitDurable(uint64_t seq) {
+    Status s = log_.WaitDurable(seq);
+
+    size_t min_bytes = log_.options().auto_rewrite_min_bytes;
+    if (min_bytes > 0 && !rewriting_.load(std::memory_order_relaxed)) {
+        size_t threshold = std::max(min_bytes, rewrite_base_size_.load(std::memory_order_relaxed) * 2);
+        if (log_.FileSize() >= threshold && !rewriting_.exchange(true)) {
+            // 上一次后台重写已经结束（rewriting_为false），join不会阻塞
+            if (rewrite_thread_.joinable()) {
+                rewrite_thread_.join();
+            }
+            rewrite_thread_ = std::thread([this]() {
+                Status rs = DoRewrite();
+                if (!rs.ok()) {
+                    LOG_ERROR("Background log rewrite failed: " + rs.message);
+                }
+                rewriting_ = false;
+            });
+        }
+    }
+    return s;
+}
+
+Status DurableStore::Put(const std::string& key, const std::string& value) {
+    uint64_t seq;
+    {
+        std::lock_guard<std::mutex> lock(StripeFor(key));
+        Status s = inner_->Put(key, value);
+        if (!s.ok()) {
+            return s;
+        }
+        seq = log_.Append(LOG_PUT, key, value);
+    }
+    return WaitDurable(seq);
+}
+
+Status DurableStore::PutWithTtl(const std::string& key, const std::string& value, int64_t ttl_ms) {
+    uint64_t seq;
+    {
+        std::lock_guard<std::mutex> lock(StripeFor(key));
+        Status s = inner_->PutWithTtl(key, value, ttl_ms);
+        if (!s.ok()) {
+            return s;
+        }
+        seq = log_.Append(LOG_PUT, key, value, utils::UnixTimeMs() + ttl_ms);
+    }
+    return WaitDurable(seq);
+}
+
+Status DurableStore::Delete(const std::string& key) {
+    uint64_t seq;
+    {
+        std::lock_guard<std::mutex> lock(StripeFor(key));
+        Status s = inner_->Delete(key);
+        if (!s.ok()) {
+            return s;
+        }
+        seq = log_.Append(LOG_DELETE, key);
+    }
+    return WaitDurable(seq);
+}
+
+Status DurableStore::Expire(const std::string& key, int64_t ttl_ms) {
+    uint64_t seq;
+    {
+        std::lock_guard<std::mutex> lock(StripeFor(key));
+        Status s = inner_->Expire(key, ttl_ms);
+        if (!s.ok()) {
+            return s;
+        }
+        // ttl_ms <= 0 时内部引擎已经删除了key
+        seq = ttl_ms > 0 ? log_.Append(LOG_EXPIRE_AT, key, std::string(), utils::UnixTimeMs() + ttl_ms)
+                         : log_.Append(LOG_DELETE, key);
+    }
+    return WaitDurable(seq);
+}
+
+void DurableStore::Clear() {
+    LockAllStripes();
+    inner_->Clear();
+    uint64_t seq = log_.Append(LOG_CLEAR, std::string());
+    UnlockAllStripes();
+    Status s = WaitDurable(seq);
+    if (!s.ok()) {
+        LOG_ERROR("Failed to log clear: " + s.message);
+    }
+}
+
+void DurableStore::Reserve(size_t expected_keys) {
+    inner_->Reserve(expected_keys);
+}
+
+Status DurableStore::Get(const std::string& key, std::string& value) {
+    return inner_->Get(key, value);
+}
+
+Status DurableStore::Contains(const std::string& key) {
+    return inner_->Contains(key);
+}
+
+size_t DurableStore::Size() const {
+    return inner_->Size();
+}
+
+StoreStats DurableStore::GetStats() const {
+    return inner_->GetStats();
+}
+
+std::unique_ptr<KVIterator> DurableStore::NewIterator() {
+    return inner_->NewIterator();
+}
+
+std::shared_ptr<const KVSnapshot> DurableStore::GetSnapshot() {
+    return inner_->GetSnapshot();
+}
+
+Status DurableStore::Get(const KVSnapshot& snapshot, const std::string& key, std::string& value) {
+    return inner_->Get(snapshot, key, value);
+}
+
+Status DurableStore::ForEach(const ForEachCallback& callback) {
+    return inner_->ForEach(callback);
+}
+
+Status DurableStore::Ttl(const std::string& key, int64_t* ttl_ms) {
+    return inner_->Ttl(key, ttl_ms);
+}
+
+Status DurableStore::RewriteLog() {
+    if (rewriting_.exchange(true)) {
+        return Status::Error("Append log rewrite already in progress");
+    }
+    Status s = DoRewrite();
+    rewriting_ = false;
+    return s;
+}
+
+Status DurableStore::DoRewrite() {
+    // 持有全部分段锁时确定基准序列号：之前的修改都已作用于内部引擎并进入旧日志，
+    // 之后的修改都会进入重写缓冲
+    uint64_t base_seq = 0;
+    LockAllStripes();
+    Status s = log_.StartRewrite(&base_seq);
+    UnlockAllStripes();
+    if (!s.ok()) {
+        return s;
+    }
+
+    // 导出是弱一致的，导出期间被修改的key可能是新值，回放其后的重写缓冲即可得到最终状态
+    Status write_status;
+    int64_t now = utils::UnixTimeMs();
+    s = inner_->ForEach([&](const std::string& key, const std::string& value, int64_t ttl_ms) {
+        if (write_status.ok()) {
+            write_status = log_.AddRewriteRecord(key, value, ttl_ms < 0 ? 0 : now + std::max<int64_t>(ttl_ms, 1));
+        }
+    });
+    if (s.ok()) {
+        s = write_status;
+    }
+    if (!s.ok()) {
+        log_.AbortRewrite();
+        return s;
+    }
+
+    s = log_.FinishRewrite();
+    if (s.ok()) {
+        rewrite_base_size_ = log_.FileSize();
+    }
+    return s;
+}
+
+Status DurableStore::SaveSnapshot(const std::string& path) {
+    // 与重写相同：持有全部分段锁取得的序列号之前的修改都已作用于内部引擎
+    LockAllStripes();
+    uint64_t seq = log_.LastSequence();
+    UnlockAllStripes();
+    return ::SaveSnapshot(inner_.get(), path, seq);
+}
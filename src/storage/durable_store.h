@@ -0,0 +1,81 @@
+// src/storage/durable_store.h
+#ifndef DURABLE_STORE_H
+#define DURABLE_STORE_H
+
+#include "../core/kv_store.h"
+#include "append_log.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// 持久化存储：在任意引擎外面加一层追加写日志
+//
+// 修改先作用于内部引擎，成功后在同一把按key分段的锁内追加日志，保证同一个key的日志顺序
+// 与实际生效顺序一致；随后在锁外等待日志达到配置的持久化级别，不同写者的等待由
+// AppendLog合并成一次write/fdatasync。过期时间以Unix毫秒时间记录，重启后仍然有效。
+//
+// 内部引擎因maxmemory淘汰或过期删除的key不写日志：回放时过期时间会再次生效，
+// 淘汰则由内部引擎在回放过程中重新进行。
+class DurableStore : public KVStore {
+public:
+    static const size_t kLockStripes = 64;
+
+    // 打开日志并把其中的记录回放到inner中，成功后store指向包装后的存储。
+    // snapshot_path非空且快照比日志的基准点新时，先加载快照，再只回放快照之后的日志记录
+    static Status Open(std::unique_ptr<KVStore> inner, const AppendLogOptions& options,
+                       std::unique_ptr<DurableStore>* store, const std::string& snapshot_path = std::string());
+    ~DurableStore() override;
+
+    Status Put(const std::string& key, const std::string& value) override;
+    Status Get(const std::string& key, std::string& value) override;
+    Status Delete(const std::string& key) override;
+    Status Contains(const std::string& key) override;
+    size_t Size() const override;
+    void Clear() override;
+    void Reserve(size_t expected_keys) override;
+    StoreStats GetStats() const override;
+    std::unique_ptr<KVIterator> NewIterator() override;
+    std::shared_ptr<const KVSnapshot> GetSnapshot() override;
+    Status Get(const KVSnapshot& snapshot, const std::string& key, std::string& value) override;
+    Status ForEach(const ForEachCallback& callback) override;
+
+    Status PutWithTtl(const std::string& key, const std::string& value, int64_t ttl_ms) override;
+    Status Expire(const std::string& key, int64_t ttl_ms) override;
+    Status Ttl(const std::string& key, int64_t* ttl_ms) override;
+
+    // 在调用线程中重写日志：把当前数据导出为新日志，再补上导出期间的修改，完成后替换原文件。
+    // 导出期间读写照常进行
+    Status RewriteLog();
+
+    // 保存快照并记录对应的日志序列号，导出期间读写照常进行
+    Status SaveSnapshot(const std::string& path);
+
+    const AppendLog& log() const { return log_; }
+
+private:
+    DurableStore(std::unique_ptr<KVStore> inner, const AppendLogOptions& options);
+
+    struct alignas(64) Stripe {
+        std::mutex mutex;
+    };
+
+    std::mutex& StripeFor(const std::string& key);
+    void LockAllStripes();
+    void UnlockAllStripes();
+    void Replay(const LogRecord& record);
+    // 等待日志落盘，并在日志增长到阈值时启动后台重写
+    Status WaitDurable(uint64_t seq);
+    Status DoRewrite();
+
+    std::unique_ptr<KVStore> inner_;
+    AppendLog log_;
+    Stripe stripes_[kLockStripes];
+
+    std::atomic<bool> rewriting_;
+    // 上次重写完成后的日志大小，自动重写以它的两倍为阈值
+    std::atomic<size_t> rewrite_base_size_;
+    std::thread rewrite_thread_;
+};
+
+#endif // DURABLE_STORE_H
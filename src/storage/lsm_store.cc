@@ -0,0 +1,1070 @@
+// src/storage/lsm_store.cc
+#include "lsm_store.h"
+#include "bloom_filter.h"
+#include "coding.h"
+#include "../common/logger.h"
+#include "../common/utils.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <map>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const int LsmStore::kNumLevels;
+const size_t LsmStore::kLevelMultiplier;
+const size_t LsmStore::kIteratorBatch;
+
+using coding::GetFixed32;
+using coding::GetFixed64;
+using coding::PutFixed32;
+using coding::PutFixed64;
+
+namespace {
+
+const char kManifestMagic[8] = {'K', 'V', 'L', 'S', 'M', 'M', 'F', '1'};
+// 内存表中每个条目除key和value以外的估计开销（map节点、指针和字符串头）
+const size_t kMemEntryOverhead = 64;
+// 后台任务进行中时等待者的轮询间隔
+const std::chrono::milliseconds kWaitInterval(10);
+
+std::string ErrnoMessage(const std::string& what, const std::string& path) {
+    return what + " " + path + ": " + std::strerror(errno);
+}
+
+// 多个有序迭代器的归并，同一个key只返回下标最小（最新）的来源中的条目
+class MergingIterator : public InternalIterator {
+public:
+    explicit MergingIterator(std::vector<std::unique_ptr<InternalIterator>> children)
+        : children_(std::move(children)), current_(-1) {}
+
+    bool Valid() const override { return current_ >= 0; }
+
+    void Seek(const std::string& target) override {
+        for (auto& child : children_) {
+            child->Seek(target);
+        }
+        FindSmallest();
+    }
+
+    void Next() override {
+        std::string key = children_[current_]->key();
+        for (auto& child : children_) {
+            if (child->Valid() && child->key() == key) {
+                child->Next();
+            }
+        }
+        FindSmallest();
+    }
+
+    const std::string& key() const override { return children_[current_]->key(); }
+    const std::string& value() const override { return children_[current_]->value(); }
+    bool deleted() const override { return children_[current_]->deleted(); }
+
+    Status status() const override {
+        for (const auto& child : children_) {
+            Status s = child->status();
+            if (!s.ok()) {
+                return s;
+            }
+        }
+        return Status::OK_STATUS();
+    }
+
+private:
+    void FindSmallest() {
+        current_ = -1;
+        for (size_t i = 0; i < children_.size(); ++i) {
+            if (children_[i]->Valid() && (current_ < 0 || children_[i]->key() < children_[current_]->key())) {
+                current_ = static_cast<int>(i);
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<InternalIterator>> children_;
+    int current_;
+};
+
+bool Overlaps(const std::string& smallest, const std::string& largest, const std::string& lo, const std::string& hi) {
+    return !(largest < lo || hi < smallest);
+}
+
+}  // namespace
+
+struct LsmStore::MemTable {
+    struct Entry {
+        std::string value;
+        bool deleted;
+    };
+
+    ~MemTable() {
+        wal.reset();
+        if (flushed) {
+            ::unlink(wal_path.c_str());
+        }
+    }
+
+    std::map<std::string, Entry> table;
+    size_t bytes = 0;
+    uint64_t number = 0;
+    std::string wal_path;
+    std::unique_ptr<AppendLog> wal;
+    // 已经刷成表且记录进MANIFEST，最后一个引用释放时删除预写日志
+    bool flushed = false;
+};
+
+// 内存表迭代器：每批在锁内复制最多kIteratorBatch个条目，批与批之间按上一批最后一个key重新定位。
+// mutex为空时内存表已不可变，无需加锁
+class LsmStore::MemTableIterator : public InternalIterator {
+public:
+    MemTableIterator(std::shared_ptr<MemTable> mem, std::mutex* mutex)
+        : mem_(std::move(mem)), mutex_(mutex), pos_(0), exhausted_(true) {}
+
+    bool Valid() const override { return pos_ < batch_.size(); }
+    void Seek(const std::string& target) override { Fill(target, true); }
+
+    void Next() override {
+        if (++pos_ == batch_.size() && !exhausted_) {
+            std::string last = std::move(batch_.back().key);
+            Fill(last, false);
+        }
+    }
+
+    const std::string& key() const override { return batch_[pos_].key; }
+    const std::string& value() const override { return batch_[pos_].value; }
+    bool deleted() const override { return batch_[pos_].deleted; }
+
+private:
+    struct Item {
+        std::string key;
+        std::string value;
+        bool deleted;
+    };
+
+    void Fill(const std::string& start, bool inclusive) {
+        batch_.clear();
+        pos_ = 0;
+        std::unique_lock<std::mutex> lock;
+        if (mutex_) {
+            lock = std::unique_lock<std::mutex>(*mutex_);
+        }
+        auto it = inclusive ? mem_->table.lower_bound(start) : mem_->table.upper_bound(start);
+        for (; it != mem_->table.end() && batch_.size() < kIteratorBatch; ++it) {
+            batch_.push_back(Item{it->first, it->second.value, it->second.deleted});
+        }
+        exhausted_ = it == mem_->table.end();
+    }
+
+    std::shared_ptr<MemTable> mem_;
+    std::mutex* mutex_;
+    std::vector<Item> batch_;
+    size_t pos_;
+    bool exhausted_;
+};
+
+// 把一层中按key排序、互不重叠的表串成一个迭代器，用到哪个表才打开哪个表的迭代器
+class LsmStore::LevelIterator : public InternalIterator {
+public:
+    explicit LevelIterator(std::vector<std::shared_ptr<FileMeta>> files)
+        : files_(std::move(files)), file_index_(0) {}
+
+    bool Valid() const override { return iter_ && iter_->Valid(); }
+
+    void Seek(const std::string& target) override {
+        // 第一个largest不小于target的表
+        file_index_ = static_cast<size_t>(
+            std::partition_point(files_.begin(), files_.end(),
+                                 [&](const std::shared_ptr<FileMeta>& f) { return f->largest < target; }) -
+            files_.begin());
+        OpenFile();
+        if (iter_) {
+            iter_->Seek(target);
+            SkipEmptyFiles();
+        }
+    }
+
+    void Next() override {
+        iter_->Next();
+        SkipEmptyFiles();
+    }
+
+    const std::string& key() const override { return iter_->key(); }
+    const std::string& value() const override { return iter_->value(); }
+    bool deleted() const override { return iter_->deleted(); }
+    Status status() const override { return iter_ ? iter_->status() : Status::OK_STATUS(); }
+
+private:
+    void OpenFile() {
+        iter_.reset();
+        if (file_index_ < files_.size()) {
+            iter_ = files_[file_index_]->table->NewIterator();
+        }
+    }
+
+    // 当前表读完（且没有出错）时转到下一个表的开头
+    void SkipEmptyFiles() {
+        while (iter_ && !iter_->Valid() && iter_->status().ok() && file_index_ + 1 < files_.size()) {
+            file_index_++;
+            OpenFile();
+            iter_->Seek(std::string());
+        }
+    }
+
+    std::vector<std::shared_ptr<FileMeta>> files_;
+    size_t file_index_;
+    std::unique_ptr<InternalIterator> iter_;
+};
+
+// 对外的迭代器：在归并结果上跳过删除标记
+class LsmStore::Iterator : public KVIterator {
+public:
+    explicit Iterator(std::unique_ptr<InternalIterator> merged) : merged_(std::move(merged)) {}
+
+    bool Valid() const override { return merged_->Valid(); }
+
+    void Seek(const std::string& target) override {
+        merged_->Seek(target);
+        SkipDeleted();
+    }
+
+    void Next() override {
+        merged_->Next();
+        SkipDeleted();
+    }
+
+    const std::string& key() const override { return merged_->key(); }
+    const std::string& value() const override { return merged_->value(); }
+
+private:
+    void SkipDeleted() {
+        while (merged_->Valid() && merged_->deleted()) {
+            merged_->Next();
+        }
+        Status s = merged_->status();
+        if (!s.ok()) {
+            LOG_ERROR("LSM iterator stopped: " + s.message);
+        }
+    }
+
+    std::unique_ptr<InternalIterator> merged_;
+};
+
+LsmStore::LsmStore(const LsmOptions& options)
+    : options_(options), current_(std::make_shared<Version>()), next_file_number_(1), log_number_(0),
+      flush_scheduled_(false), running_compactions_(0), shutting_down_(false), clearing_(false),
+      user_bytes_written_(0), wal_bytes_written_(0), flush_bytes_written_(0), compaction_bytes_read_(0),
+      compaction_bytes_written_(0), compactions_(0), gets_(0), block_reads_(0),
+      pool_(new ThreadPool(options.compaction_threads)) {
+    for (int i = 0; i < kNumLevels; ++i) {
+        level_busy_[i] = false;
+    }
+}
+
+LsmStore::~LsmStore() {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        shutting_down_ = true;
+        while (flush_scheduled_ || running_compactions_ > 0) {
+            cv_.wait_for(lock, kWaitInterval);
+        }
+    }
+    // 未刷盘的内存表留在预写日志里，下次打开时回放
+    pool_.reset();
+}
+
+Status LsmStore::Open(const LsmOptions& options, std::unique_ptr<LsmStore>* store) {
+    if (options.dir.empty()) {
+        return Status(INVALID_ARGUMENT, "LSM store needs a data directory");
+    }
+    if (::mkdir(options.dir.c_str(), 0755) != 0 && errno != EEXIST) {
+        return Status::Error(ErrnoMessage("Failed to create", options.dir));
+    }
+    std::unique_ptr<LsmStore> lsm(new LsmStore(options));
+    Status s = lsm->Recover();
+    if (!s.ok()) {
+        return s;
+    }
+    *store = std::move(lsm);
+    return Status::OK_STATUS();
+}
+
+std::string LsmStore::TablePath(uint64_t number) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "/%06llu.sst", static_cast<unsigned long long>(number));
+    return options_.dir + name;
+}
+
+std::string LsmStore::WalPath(uint64_t number) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "/%06llu.wal", static_cast<unsigned long long>(number));
+    return options_.dir + name;
+}
+
+std::string LsmStore::ManifestPath() const {
+    return options_.dir + "/MANIFEST";
+}
+
+// MANIFEST格式：魔数(8) | 下一个文件编号(8) | 日志编号(8) | 表个数(4) |
+//   { 层(4) | 编号(8) | 大小(8) | 条目数(8) | key长度(4) | 最小key | key长度(4) | 最大key }* | crc32c(4)
+Status LsmStore::WriteManifestLocked(const Version& version) {
+    std::string data(kManifestMagic, sizeof(kManifestMagic));
+    PutFixed64(&data, next_file_number_);
+    PutFixed64(&data, log_number_);
+    size_t count = 0;
+    for (int level = 0; level < kNumLevels; ++level) {
+        count += version.levels[level].size();
+    }
+    PutFixed32(&data, static_cast<uint32_t>(count));
+    for (int level = 0; level < kNumLevels; ++level) {
+        for (const auto& f : version.levels[level]) {
+            PutFixed32(&data, static_cast<uint32_t>(level));
+            PutFixed64(&data, f->number);
+            PutFixed64(&data, f->size);
+            PutFixed64(&data, f->entries);
+            PutFixed32(&data, static_cast<uint32_t>(f->smallest.size()));
+            data.append(f->smallest);
+            PutFixed32(&data, static_cast<uint32_t>(f->largest.size()));
+            data.append(f->largest);
+        }
+    }
+    PutFixed32(&data, utils::Crc32c(data.data(), data.size()));
+
+    std::string path = ManifestPath();
+    std::string tmp_path = path + ".tmp";
+    int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return Status::Error(ErrnoMessage("Failed to create", tmp_path));
+    }
+    bool ok = ::write(fd, data.data(), data.size()) == static_cast<ssize_t>(data.size()) && ::fdatasync(fd) == 0;
+    ::close(fd);
+    if (!ok) {
+        Status s = Status::Error(ErrnoMessage("Failed to write", tmp_path));
+        ::unlink(tmp_path.c_str());
+        return s;
+    }
+    if (::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        return Status::Error(ErrnoMessage("Failed to rename", tmp_path));
+    }
+    if (!utils::SyncParentDirectory(path)) {
+        return Status::Error(ErrnoMessage("Failed to sync directory of", path));
+    }
+    return Status::OK_STATUS();
+}
+
+Status LsmStore::ReadManifest(Version* version, bool* exists) {
+    std::string path = ManifestPath();
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        *exists = false;
+        return errno == ENOENT ? Status::OK_STATUS() : Status::Error(ErrnoMessage("Failed to open", path));
+    }
+    *exists = true;
+    std::string data;
+    char buf[65536];
+    ssize_t n;
+    while ((n = ::read(fd, buf, sizeof(buf))) > 0) {
+        data.append(buf, static_cast<size_t>(n));
+    }
+    ::close(fd);
+    if (n < 0) {
+        return Status::Error(ErrnoMessage("Failed to read", path));
+    }
+
+    Status corrupt = Status::Error("Corrupt manifest: " + path);
+    if (data.size() < sizeof(kManifestMagic) + 24 ||
+        std::memcmp(data.data(), kManifestMagic, sizeof(kManifestMagic)) != 0 ||
+        utils::Crc32c(data.data(), data.size() - 4) != GetFixed32(data.data() + data.size() - 4)) {
+        return corrupt;
+    }
+    data.resize(data.size() - 4);
+    size_t pos = sizeof(kManifestMagic);
+    next_file_number_ = GetFixed64(data.data() + pos);
+    log_number_ = GetFixed64(data.data() + pos + 8);
+    uint32_t count = GetFixed32(data.data() + pos + 16);
+    pos += 20;
+
+    auto read_key = [&](std::string* key) {
+        if (data.size() - pos < 4) {
+            return false;
+        }
+        uint32_t len = GetFixed32(data.data() + pos);
+        if (data.size() - pos - 4 < len) {
+            return false;
+        }
+        key->assign(data.data() + pos + 4, len);
+        pos += 4 + len;
+        return true;
+    };
+    for (uint32_t i = 0; i < count; ++i) {
+        if (data.size() - pos < 28) {
+            return corrupt;
+        }
+        uint32_t level = GetFixed32(data.data() + pos);
+        auto f = std::make_shared<FileMeta>();
+        f->number = GetFixed64(data.data() + pos + 4);
+        f->size = GetFixed64(data.data() + pos + 12);
+        f->entries = GetFixed64(data.data() + pos + 20);
+        pos += 28;
+        if (level >= static_cast<uint32_t>(kNumLevels) || !read_key(&f->smallest) || !read_key(&f->largest)) {
+            return corrupt;
+        }
+        Status s = SSTable::Open(TablePath(f->number), f->size, &block_reads_, &f->table);
+        if (!s.ok()) {
+            return s;
+        }
+        version->levels[level].push_back(std::move(f));
+    }
+    return Status::OK_STATUS();
+}
+
+Status LsmStore::RecoverWal(uint64_t number, std::vector<std::shared_ptr<FileMeta>>* outputs) {
+    auto mem = std::make_shared<MemTable>();
+    AppendLogOptions wal_options;
+    wal_options.path = WalPath(number);
+    wal_options.fsync = FSYNC_NO;
+    wal_options.auto_rewrite_min_bytes = 0;
+    AppendLog wal(wal_options);
+    Status s = wal.Open([&](const LogRecord& record) {
+        if (record.type == LOG_PUT) {
+            mem->table[record.key] = MemTable::Entry{record.value, false};
+        } else if (record.type == LOG_DELETE) {
+            mem->table[record.key] = MemTable::Entry{std::string(), true};
+        }
+    });
+    if (!s.ok()) {
+        return s;
+    }
+    MemTableIterator it(mem, nullptr);
+    it.Seek(std::string());
+    uint64_t bytes_written = 0;
+    s = WriteTables(&it, false, false, outputs, &bytes_written);
+    if (s.ok()) {
+        LOG_INFO("Recovered " + std::to_string(mem->table.size()) + " entries from " + wal_options.path);
+    }
+    return s;
+}
+
+Status LsmStore::Recover() {
+    auto version = std::make_shared<Version>();
+    bool exists = false;
+    Status s = ReadManifest(version.get(), &exists);
+    if (!s.ok()) {
+        return s;
+    }
+
+    std::vector<uint64_t> live_tables;
+    for (int level = 0; level < kNumLevels; ++level) {
+        for (const auto& f : version->levels[level]) {
+            live_tables.push_back(f->number);
+        }
+    }
+    std::vector<uint64_t> wals;
+    std::vector<std::string> orphans;
+    DIR* dir = ::opendir(options_.dir.c_str());
+    if (!dir) {
+        return Status::Error(ErrnoMessage("Failed to open", options_.dir));
+    }
+    while (struct dirent* entry = ::readdir(dir)) {
+        unsigned long long number = 0;
+        char ext[8] = {0};
+        if (std::sscanf(entry->d_name, "%llu.%3s", &number, ext) != 2) {
+            continue;
+        }
+        next_file_number_ = std::max<uint64_t>(next_file_number_, number + 1);
+        std::string name = entry->d_name;
+        if (std::strcmp(ext, "wal") == 0 && number >= log_number_) {
+            wals.push_back(number);
+        } else if (std::strcmp(ext, "wal") == 0 ||
+                   (std::strcmp(ext, "sst") == 0 &&
+                    std::find(live_tables.begin(), live_tables.end(), number) == live_tables.end())) {
+            // 已经刷盘的日志，以及写了一半或已被合并掉、但没来得及删除的表
+            orphans.push_back(options_.dir + "/" + name);
+        }
+    }
+    ::closedir(dir);
+    for (const auto& path : orphans) {
+        ::unlink(path.c_str());
+    }
+
+    // 按编号从旧到新回放，每个日志刷成一个L0表，越新的表越靠前
+    std::sort(wals.begin(), wals.end());
+    for (uint64_t number : wals) {
+        std::vector<std::shared_ptr<FileMeta>> outputs;
+        s = RecoverWal(number, &outputs);
+        if (!s.ok()) {
+            return s;
+        }
+        version->levels[0].insert(version->levels[0].begin(), outputs.begin(), outputs.end());
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        s = NewMemTableLocked(&mem_);
+        if (!s.ok()) {
+            return s;
+        }
+        log_number_ = mem_->number;
+        s = WriteManifestLocked(*version);
+        if (!s.ok()) {
+            return s;
+        }
+        current_ = version;
+        for (uint64_t number : wals) {
+            ::unlink(WalPath(number).c_str());
+        }
+        ScheduleWorkLocked();
+    }
+    if (exists || !wals.empty()) {
+        LOG_INFO("Opened LSM store in " + options_.dir + " with about " + std::to_string(Size()) + " keys");
+    }
+    return Status::OK_STATUS();
+}
+
+Status LsmStore::NewMemTableLocked(std::shared_ptr<MemTable>* mem) {
+    auto m = std::make_shared<MemTable>();
+    m->number = next_file_number_++;
+    m->wal_path = WalPath(m->number);
+    AppendLogOptions wal_options;
+    wal_options.path = m->wal_path;
+    wal_options.fsync = options_.wal_fsync;
+    wal_options.auto_rewrite_min_bytes = 0;
+    m->wal.reset(new AppendLog(wal_options));
+    Status s = m->wal->Open([](const LogRecord&) {});
+    if (!s.ok()) {
+        return s;
+    }
+    *mem = std::move(m);
+    return Status::OK_STATUS();
+}
+
+size_t LsmStore::LevelMaxBytes(int level) const {
+    size_t bytes = options_.level1_bytes;
+    for (int i = 1; i < level; ++i) {
+        bytes *= kLevelMultiplier;
+    }
+    return bytes;
+}
+
+double LsmStore::LevelScore(const Version& version, int level) const {
+    if (level == 0) {
+        return static_cast<double>(version.levels[0].size()) / std::max<size_t>(options_.l0_compaction_trigger, 1);
+    }
+    uint64_t bytes = 0;
+    for (const auto& f : version.levels[level]) {
+        bytes += f->size;
+    }
+    return static_cast<double>(bytes) / LevelMaxBytes(level);
+}
+
+Status LsmStore::MakeRoomForWrite(std::unique_lock<std::mutex>& lock, bool force) {
+    for (;;) {
+        if (!bg_error_.ok()) {
+            return bg_error_;
+        }
+        if (current_->levels[0].size() >= options_.l0_stop_writes) {
+            // L0表太多时读放大失控，等合并赶上
+            cv_.wait_for(lock, kWaitInterval);
+        } else if (!force && mem_->bytes < options_.memtable_bytes) {
+            return Status::OK_STATUS();
+        } else if (imm_) {
+            // 上一个内存表还没刷完
+            cv_.wait_for(lock, kWaitInterval);
+        } else {
+            std::shared_ptr<MemTable> mem;
+            Status s = NewMemTableLocked(&mem);
+            if (!s.ok()) {
+                return s;
+            }
+            wal_bytes_written_ += mem_->wal->FileSize();
+            imm_ = std::move(mem_);
+            mem_ = std::move(mem);
+            ScheduleWorkLocked();
+            return Status::OK_STATUS();
+        }
+    }
+}
+
+Status LsmStore::Write(const std::string& key, const std::string* value) {
+    std::shared_ptr<MemTable> mem;
+    uint64_t seq;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        Status s = MakeRoomForWrite(lock, false);
+        if (!s.ok()) {
+            return s;
+        }
+        mem = mem_;
+        auto result = mem->table.emplace(key, MemTable::Entry{std::string(), value == nullptr});
+        MemTable::Entry& entry = result.first->second;
+        if (result.second) {
+            mem->bytes += key.size() + kMemEntryOverhead;
+        } else {
+            mem->bytes -= entry.value.size();
+            entry.deleted = value == nullptr;
+        }
+        if (value) {
+            entry.value = *value;
+            mem->bytes += value->size();
+            seq = mem->wal->Append(LOG_PUT, key, *value);
+        } else {
+            entry.value.clear();
+            seq = mem->wal->Append(LOG_DELETE, key);
+        }
+    }
+    user_bytes_written_.fetch_add(key.size() + (value ? value->size() : 0), std::memory_order_relaxed);
+    return mem->wal->WaitDurable(seq);
+}
+
+Status LsmStore::Put(const std::string& key, const std::string& value) {
+    if (key.empty()) {
+        return Status::Error("Key cannot be empty");
+    }
+    return Write(key, &value);
+}
+
+Status LsmStore::Delete(const std::string& key) {
+    // 先查一次，保持"删除不存在的key返回KEY_NOT_FOUND"的语义，也避免写入无用的删除标记
+    Status s = Contains(key);
+    if (!s.ok()) {
+        return s;
+    }
+    return Write(key, nullptr);
+}
+
+Status LsmStore::Get(const std::string& key, std::string& value) {
+    gets_.fetch_add(1, std::memory_order_relaxed);
+    std::shared_ptr<MemTable> imm;
+    std::shared_ptr<const Version> version;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = mem_->table.find(key);
+        if (it != mem_->table.end()) {
+            if (it->second.deleted) {
+                return Status::KeyNotFound(key);
+            }
+            value = it->second.value;
+            return Status::OK_STATUS();
+        }
+        imm = imm_;
+        version = current_;
+    }
+
+    // 不可变内存表和表文件集合都不会再被修改，锁外访问
+    if (imm) {
+        auto it = imm->table.find(key);
+        if (it != imm->table.end()) {
+            if (it->second.deleted) {
+                return Status::KeyNotFound(key);
+            }
+            value = it->second.value;
+            return Status::OK_STATUS();
+        }
+    }
+
+    uint32_t hash = BloomFilter::Hash(key.data(), key.size());
+    bool deleted = false;
+    Status s;
+    auto search = [&](const FileMeta& f) {
+        return f.smallest <= key && key <= f.largest && f.table->Get(key, hash, &value, &deleted, &s);
+    };
+    bool found = false;
+    for (const auto& f : version->levels[0]) {
+        if ((found = search(*f)) || !s.ok()) {
+            break;
+        }
+    }
+    for (int level = 1; level < kNumLevels && !found && s.ok(); ++level) {
+        const auto& files = version->levels[level];
+        auto it = std::partition_point(files.begin(), files.end(),
+                                       [&](const std::shared_ptr<FileMeta>& f) { return f->largest < key; });
+        if (it != files.end()) {
+            found = search(**it);
+        }
+    }
+    if (!s.ok()) {
+        return s;
+    }
+    if (!found || deleted) {
+        return Status::KeyNotFound(key);
+    }
+    return Status::OK_STATUS();
+}
+
+Status LsmStore::Contains(const std::string& key) {
+    std::string value;
+    return Get(key, value);
+}
+
+size_t LsmStore::Size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t keys = mem_->table.size() + (imm_ ? imm_->table.size() : 0);
+    for (int level = 0; level < kNumLevels; ++level) {
+        for (const auto& f : current_->levels[level]) {
+            keys += f->entries;
+        }
+    }
+    return keys;
+}
+
+StoreStats LsmStore::GetStats() const {
+    StoreStats stats;
+    LsmStats lsm = GetLsmStats();
+    stats.keys = Size();
+    stats.used_bytes = lsm.table_bytes;
+    return stats;
+}
+
+LsmStats LsmStore::GetLsmStats() const {
+    LsmStats stats;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (int level = 0; level < kNumLevels; ++level) {
+            stats.files_per_level.push_back(current_->levels[level].size());
+            for (const auto& f : current_->levels[level]) {
+                stats.table_bytes += f->size;
+            }
+        }
+        stats.wal_bytes_written = wal_bytes_written_.load() + mem_->wal->FileSize() + (imm_ ? imm_->wal->FileSize() : 0);
+    }
+    stats.user_bytes_written = user_bytes_written_.load();
+    stats.flush_bytes_written = flush_bytes_written_.load();
+    stats.compaction_bytes_read = compaction_bytes_read_.load();
+    stats.compaction_bytes_written = compaction_bytes_written_.load();
+    stats.compactions = compactions_.load();
+    stats.gets = gets_.load();
+    stats.block_reads = block_reads_.load();
+    return stats;
+}
+
+std::unique_ptr<KVIterator> LsmStore::NewIterator() {
+    std::vector<std::unique_ptr<InternalIterator>> children;
+    std::lock_guard<std::mutex> lock(mutex_);
+    // 按从新到旧的顺序排列，归并时同一个key取最新的来源
+    children.emplace_back(new MemTableIterator(mem_, &mutex_));
+    if (imm_) {
+        children.emplace_back(new MemTableIterator(imm_, nullptr));
+    }
+    for (const auto& f : current_->levels[0]) {
+        children.push_back(f->table->NewIterator());
+    }
+    for (int level = 1; level < kNumLevels; ++level) {
+        if (!current_->levels[level].empty()) {
+            children.emplace_back(new LevelIterator(current_->levels[level]));
+        }
+    }
+    return std::unique_ptr<KVIterator>(
+        new Iterator(std::unique_ptr<InternalIterator>(new MergingIterator(std::move(children)))));
+}
+
+Status LsmStore::WaitForBackgroundLocked(std::unique_lock<std::mutex>& lock) {
+    while (flush_scheduled_ || running_compactions_ > 0) {
+        cv_.wait_for(lock, kWaitInterval);
+    }
+    return bg_error_;
+}
+
+Status LsmStore::Flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!mem_->table.empty()) {
+        Status s = MakeRoomForWrite(lock, true);
+        if (!s.ok()) {
+            return s;
+        }
+    }
+    // 合并结束时会在锁内调度后续合并，计数降为0时已经没有待做的工作
+    return WaitForBackgroundLocked(lock);
+}
+
+void LsmStore::Clear() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    clearing_ = true;
+    WaitForBackgroundLocked(lock);
+
+    std::shared_ptr<MemTable> mem;
+    Status s = NewMemTableLocked(&mem);
+    uint64_t old_log_number = log_number_;
+    if (s.ok()) {
+        log_number_ = mem->number;
+        s = WriteManifestLocked(Version());
+    }
+    if (s.ok()) {
+        for (int level = 0; level < kNumLevels; ++level) {
+            for (const auto& f : current_->levels[level]) {
+                f->table->MarkObsolete();
+            }
+        }
+        mem_->flushed = true;
+        if (imm_) {
+            imm_->flushed = true;
+        }
+        wal_bytes_written_ += mem_->wal->FileSize() + (imm_ ? imm_->wal->FileSize() : 0);
+        mem_ = std::move(mem);
+        imm_.reset();
+        current_ = std::make_shared<Version>();
+        for (int level = 0; level < kNumLevels; ++level) {
+            compact_pointer_[level].clear();
+        }
+    } else {
+        log_number_ = old_log_number;
+        LOG_ERROR("Failed to clear LSM store: " + s.message);
+    }
+    clearing_ = false;
+    cv_.notify_all();
+}
+
+void LsmStore::ScheduleWorkLocked() {
+    if (shutting_down_ || clearing_ || !bg_error_.ok()) {
+        return;
+    }
+    if (imm_ && !flush_scheduled_) {
+        flush_scheduled_ = true;
+        pool_->Submit([this]() { BackgroundFlush(); });
+    }
+    // 留一个线程给刷盘，避免长时间的合并占满线程池使写入等待不可变内存表
+    size_t max_compactions = std::max<size_t>(pool_->size() - 1, 1);
+    while (running_compactions_ < max_compactions) {
+        auto c = std::make_shared<Compaction>();
+        if (!PickCompactionLocked(c.get())) {
+            break;
+        }
+        running_compactions_++;
+        level_busy_[c->level] = true;
+        level_busy_[c->level + 1] = true;
+        pool_->Submit([this, c]() { BackgroundCompaction(c); });
+    }
+}
+
+bool LsmStore::PickCompactionLocked(Compaction* c) {
+    const Version& version = *current_;
+    int best_level = -1;
+    double best_score = 1.0;
+    for (int level = 0; level + 1 < kNumLevels; ++level) {
+        if (level_busy_[level] || level_busy_[level + 1]) {
+            continue;
+        }
+        double score = LevelScore(version, level);
+        if (score >= best_score) {
+            best_level = level;
+            best_score = score;
+        }
+    }
+    if (best_level < 0) {
+        return false;
+    }
+
+    c->level = best_level;
+    const auto& files = version.levels[best_level];
+    if (best_level == 0) {
+        // L0的表之间互相重叠，一次全部合并
+        c->inputs[0] = files;
+    } else {
+        // 从上次合并的位置之后选一个表，让合并轮流覆盖整层
+        auto it = std::find_if(files.begin(), files.end(), [&](const std::shared_ptr<FileMeta>& f) {
+            return compact_pointer_[best_level].empty() || f->smallest > compact_pointer_[best_level];
+        });
+        if (it == files.end()) {
+            it = files.begin();
+        }
+        c->inputs[0].push_back(*it);
+        compact_pointer_[best_level] = (*it)->largest;
+    }
+
+    std::string smallest = c->inputs[0].front()->smallest;
+    std::string largest = c->inputs[0].front()->largest;
+    for (const auto& f : c->inputs[0]) {
+        smallest = std::min(smallest, f->smallest);
+        largest = std::max(largest, f->largest);
+    }
+    for (const auto& f : version.levels[best_level + 1]) {
+        if (Overlaps(f->smallest, f->largest, smallest, largest)) {
+            c->inputs[1].push_back(f);
+        }
+    }
+    c->drop_tombstones = true;
+    for (int level = best_level + 2; level < kNumLevels && c->drop_tombstones; ++level) {
+        for (const auto& f : version.levels[level]) {
+            if (Overlaps(f->smallest, f->largest, smallest, largest)) {
+                c->drop_tombstones = false;
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+Status LsmStore::WriteTables(InternalIterator* input, bool drop_tombstones, bool split,
+                             std::vector<std::shared_ptr<FileMeta>>* outputs, uint64_t* bytes_written) {
+    std::unique_ptr<SSTableBuilder> builder;
+    uint64_t number = 0;
+    Status s;
+
+    auto finish = [&]() {
+        s = builder->Finish();
+        if (s.ok()) {
+            auto f = std::make_shared<FileMeta>();
+            f->number = number;
+            f->size = builder->FileSize();
+            f->entries = builder->entries();
+            f->smallest = builder->smallest();
+            f->largest = builder->largest();
+            s = SSTable::Open(TablePath(number), f->size, &block_reads_, &f->table);
+            if (s.ok()) {
+                *bytes_written += f->size;
+                outputs->push_back(std::move(f));
+            }
+        }
+        builder.reset();
+    };
+
+    for (; input->Valid() && s.ok(); input->Next()) {
+        if (drop_tombstones && input->deleted()) {
+            continue;
+        }
+        if (!builder) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                number = next_file_number_++;
+            }
+            builder.reset(new SSTableBuilder(TablePath(number), options_.bloom_bits_per_key));
+            s = builder->Open();
+            if (!s.ok()) {
+                break;
+            }
+        }
+        s = builder->Add(input->key(), input->value(), input->deleted());
+        if (s.ok() && split && builder->FileSize() >= options_.target_file_bytes) {
+            finish();
+        }
+    }
+    if (s.ok()) {
+        s = input->status();
+    }
+    if (s.ok() && builder) {
+        finish();
+    }
+    if (!s.ok()) {
+        // 未完成的表由builder析构时删除，已完成的表在最后一个引用释放时删除
+        builder.reset();
+        for (const auto& f : *outputs) {
+            f->table->MarkObsolete();
+        }
+        outputs->clear();
+    }
+    return s;
+}
+
+void LsmStore::BackgroundFlush() {
+    std::shared_ptr<MemTable> imm;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        imm = imm_;
+    }
+    MemTableIterator it(imm, nullptr);
+    it.Seek(std::string());
+    std::vector<std::shared_ptr<FileMeta>> outputs;
+    uint64_t bytes_written = 0;
+    Status s = WriteTables(&it, false, false, &outputs, &bytes_written);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (s.ok()) {
+        auto version = std::make_shared<Version>(*current_);
+        version->levels[0].insert(version->levels[0].begin(), outputs.begin(), outputs.end());
+        uint64_t old_log_number = log_number_;
+        log_number_ = mem_->number;
+        s = WriteManifestLocked(*version);
+        if (s.ok()) {
+            current_ = version;
+            imm->flushed = true;
+            imm_.reset();
+            flush_bytes_written_ += bytes_written;
+        } else {
+            log_number_ = old_log_number;
+            for (const auto& f : outputs) {
+                f->table->MarkObsolete();
+            }
+        }
+    }
+    if (!s.ok()) {
+        LOG_ERROR("Failed to flush memtable: " + s.message);
+        bg_error_ = s;
+    }
+    flush_scheduled_ = false;
+    ScheduleWorkLocked();
+    cv_.notify_all();
+}
+
+void LsmStore::BackgroundCompaction(std::shared_ptr<Compaction> c) {
+    int level = c->level;
+    std::vector<std::shared_ptr<FileMeta>> outputs;
+    Status s;
+    // 下一层没有重叠的单个表直接移到下一层，不用重写
+    bool trivial_move = c->inputs[0].size() == 1 && c->inputs[1].empty();
+    if (trivial_move) {
+        outputs = c->inputs[0];
+    } else {
+        std::vector<std::unique_ptr<InternalIterator>> children;
+        uint64_t bytes_read = 0;
+        for (const auto& f : c->inputs[0]) {
+            // L0的输入已按从新到旧排列，其余层的输入只有一个表
+            children.push_back(f->table->NewIterator());
+            bytes_read += f->size;
+        }
+        for (const auto& f : c->inputs[1]) {
+            bytes_read += f->size;
+        }
+        children.emplace_back(new LevelIterator(c->inputs[1]));
+        MergingIterator merged(std::move(children));
+        merged.Seek(std::string());
+        uint64_t bytes_written = 0;
+        s = WriteTables(&merged, c->drop_tombstones, true, &outputs, &bytes_written);
+        if (s.ok()) {
+            compaction_bytes_read_ += bytes_read;
+            compaction_bytes_written_ += bytes_written;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (s.ok()) {
+        auto version = std::make_shared<Version>(*current_);
+        for (int which = 0; which < 2; ++which) {
+            auto& files = version->levels[level + which];
+            for (const auto& input : c->inputs[which]) {
+                files.erase(std::remove(files.begin(), files.end(), input), files.end());
+            }
+        }
+        auto& next = version->levels[level + 1];
+        next.insert(next.end(), outputs.begin(), outputs.end());
+        std::sort(next.begin(), next.end(), [](const std::shared_ptr<FileMeta>& a, const std::shared_ptr<FileMeta>& b) {
+            return a->smallest < b->smallest;
+        });
+        s = WriteManifestLocked(*version);
+        if (s.ok()) {
+            current_ = version;
+            compactions_++;
+            if (!trivial_move) {
+                for (int which = 0; which < 2; ++which) {
+                    for (const auto& f : c->inputs[which]) {
+                        f->table->MarkObsolete();
+                    }
+                }
+            }
+        } else if (!trivial_move) {
+            for (const auto& f : outputs) {
+                f->table->MarkObsolete();
+            }
+        }
+    }
+    if (!s.ok()) {
+        LOG_ERROR("Compaction of level " + std::to_string(level) + " failed: " + s.message);
+        bg_error_ = s;
+    }
+    level_busy_[level] = false;
+    level_busy_[level + 1] = false;
+    running_compactions_--;
+    ScheduleWorkLocked();
+    cv_.notify_all();
+}
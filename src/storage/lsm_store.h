@@ -0,0 +1,173 @@
+// src/storage/lsm_store.h
+#ifndef LSM_STORE_H
+#define LSM_STORE_H
+
+#include "../core/kv_store.h"
+#include "../common/thread_pool.h"
+#include "append_log.h"
+#include "sstable.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct LsmOptions {
+    std::string dir;
+    // 内存表达到该大小后转为不可变并刷成L0表
+    size_t memtable_bytes = 4 * 1024 * 1024;
+    // 合并输出的单个表文件大小
+    size_t target_file_bytes = 2 * 1024 * 1024;
+    // L1的总大小上限，之后每层是上一层的kLevelMultiplier倍
+    size_t level1_bytes = 10 * 1024 * 1024;
+    // L0表文件数达到该值时触发L0->L1合并，达到stop值时写入等待合并
+    size_t l0_compaction_trigger = 4;
+    size_t l0_stop_writes = 12;
+    int bloom_bits_per_key = 10;
+    // 后台刷盘和合并使用的线程数
+    size_t compaction_threads = 2;
+    // 内存表对应的预写日志的落盘策略
+    FsyncPolicy wal_fsync = FSYNC_NO;
+};
+
+// LSM引擎的I/O统计，用于计算写放大、读放大和空间放大
+struct LsmStats {
+    uint64_t user_bytes_written = 0;   // Put/Delete的key+value字节数
+    uint64_t wal_bytes_written = 0;
+    uint64_t flush_bytes_written = 0;  // 内存表刷成L0表写入的字节数
+    uint64_t compaction_bytes_read = 0;
+    uint64_t compaction_bytes_written = 0;
+    uint64_t compactions = 0;
+    uint64_t gets = 0;
+    uint64_t block_reads = 0;          // 点查和迭代读取的数据块数
+    uint64_t table_bytes = 0;          // 当前所有表文件的总大小
+    std::vector<size_t> files_per_level;
+};
+
+// 日志结构合并树(LSM-tree)存储引擎
+//
+// 写入先进预写日志和内存表（std::map），内存表写满后转为不可变内存表，由后台线程
+// 刷成L0的SSTable。L0的表之间key范围可以重叠，L1及以下每层内的表互不重叠、按key排序。
+// 某层超出大小上限时，后台线程池选出该层的一个表（L0为全部表）和下一层与之重叠的表
+// 归并成新的表；不相邻的层可以同时合并。
+//
+// 读取依次查内存表、不可变内存表、L0（从新到旧）和各层，每个表先查布隆过滤器，
+// 最多读一个数据块。表文件集合（Version）是不可变的，读者持有引用后无需加锁即可访问，
+// 被合并掉的表在最后一个读者释放后删除。当前的表文件集合记录在MANIFEST中。
+class LsmStore : public KVStore {
+public:
+    static const int kNumLevels = 7;
+    static const size_t kLevelMultiplier = 10;
+    // 迭代器每批取出的条目数
+    static const size_t kIteratorBatch = 256;
+
+    // 打开（或创建）dir中的数据库：读取MANIFEST，打开表文件，回放未刷盘的预写日志
+    static Status Open(const LsmOptions& options, std::unique_ptr<LsmStore>* store);
+    ~LsmStore() override;
+
+    Status Put(const std::string& key, const std::string& value) override;
+    Status Get(const std::string& key, std::string& value) override;
+    Status Delete(const std::string& key) override;
+    Status Contains(const std::string& key) override;
+    // 估计值：覆盖写和删除在合并之前会被重复计入
+    size_t Size() const override;
+    void Clear() override;
+    StoreStats GetStats() const override;
+    std::unique_ptr<KVIterator> NewIterator() override;
+
+    LsmStats GetLsmStats() const;
+    // 把内存表刷成L0表，并等待由此触发的合并全部完成，用于测试和基准
+    Status Flush();
+
+private:
+    class Iterator;
+    class MemTableIterator;
+    class LevelIterator;
+    struct MemTable;
+
+    struct FileMeta {
+        uint64_t number;
+        uint64_t size;
+        uint64_t entries;
+        std::string smallest;
+        std::string largest;
+        std::shared_ptr<SSTable> table;
+    };
+
+    // 不可变的表文件集合；L0按从新到旧排列，其余各层按smallest排序
+    struct Version {
+        std::vector<std::shared_ptr<FileMeta>> levels[kNumLevels];
+    };
+
+    struct Compaction {
+        int level;
+        // inputs[0]为level层的输入，inputs[1]为level+1层与之重叠的表
+        std::vector<std::shared_ptr<FileMeta>> inputs[2];
+        // 输出层以下没有与输入范围重叠的数据时可以丢弃删除标记
+        bool drop_tombstones;
+    };
+
+    explicit LsmStore(const LsmOptions& options);
+
+    std::string TablePath(uint64_t number) const;
+    std::string WalPath(uint64_t number) const;
+    std::string ManifestPath() const;
+    Status Recover();
+    Status ReadManifest(Version* version, bool* exists);
+    // 回放一个预写日志并刷成L0表，日志为空时不产生表
+    Status RecoverWal(uint64_t number, std::vector<std::shared_ptr<FileMeta>>* outputs);
+    Status Write(const std::string& key, const std::string* value);
+    // 以下函数要求持有mutex_
+    Status NewMemTableLocked(std::shared_ptr<MemTable>* mem);
+    Status WriteManifestLocked(const Version& version);
+    Status MakeRoomForWrite(std::unique_lock<std::mutex>& lock, bool force);
+    // 等待后台刷盘和合并全部结束
+    Status WaitForBackgroundLocked(std::unique_lock<std::mutex>& lock);
+    void ScheduleWorkLocked();
+    bool PickCompactionLocked(Compaction* c);
+    double LevelScore(const Version& version, int level) const;
+    size_t LevelMaxBytes(int level) const;
+
+    // 后台任务
+    void BackgroundFlush();
+    void BackgroundCompaction(std::shared_ptr<Compaction> c);
+    // 把迭代器中的条目写成若干个表，每个表约target_file_bytes
+    Status WriteTables(InternalIterator* input, bool drop_tombstones, bool split,
+                       std::vector<std::shared_ptr<FileMeta>>* outputs, uint64_t* bytes_written);
+
+    LsmOptions options_;
+
+    mutable std::mutex mutex_;
+    // 后台任务完成、写入可以继续时通知
+    std::condition_variable cv_;
+    std::shared_ptr<MemTable> mem_;
+    std::shared_ptr<MemTable> imm_;
+    std::shared_ptr<const Version> current_;
+    uint64_t next_file_number_;
+    // 编号小于它的预写日志中的数据都已经刷成表
+    uint64_t log_number_;
+    bool flush_scheduled_;
+    size_t running_compactions_;
+    bool level_busy_[kNumLevels];
+    // 每层下一次合并从哪个key之后开始，让合并轮流覆盖整层
+    std::string compact_pointer_[kNumLevels];
+    Status bg_error_;
+    // 为true时不再调度新的后台任务
+    bool shutting_down_;
+    bool clearing_;
+
+    std::atomic<uint64_t> user_bytes_written_;
+    std::atomic<uint64_t> wal_bytes_written_;
+    std::atomic<uint64_t> flush_bytes_written_;
+    std::atomic<uint64_t> compaction_bytes_read_;
+    std::atomic<uint64_t> compaction_bytes_written_;
+    std::atomic<uint64_t> compactions_;
+    std::atomic<uint64_t> gets_;
+    std::atomic<uint64_t> block_reads_;
+
+    // 最后声明、最先析构：析构时先等后台任务全部结束
+    std::unique_ptr<ThreadPool> pool_;
+};
+
+#endif // LSM_STORE_H
@@ -0,0 +1,359 @@
+// src/storage/snapshot.cc
+#include "snapshot.h"
+#include "coding.h"
+#include "durable_store.h"
+#include "../common/logger.h"
+#include "../common/utils.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const size_t SnapshotWriter::kBlockSize;
+
+using coding::GetFixed32;
+using coding::GetFixed64;
+using coding::PutFixed32;
+using coding::PutFixed64;
+
+namespace {
+
+const char kSnapshotMagic[8] = {'K', 'V', 'S', 'N', 'A', 'P', '0', '1'};
+const uint32_t kSnapshotVersion = 1;
+const size_t kSnapshotHeaderSize = 64;
+// 块头：payload长度(4) | 条目数(4) | crc32c(4)
+const size_t kBlockPrefix = 12;
+// 条目头：key长度(4) | value长度(4) | expire_at_ms(8)
+const size_t kEntryPrefix = 16;
+// 加载时每处理这么多字节就释放已解析部分的映射页，大快照不会把整个文件留在内存里
+const size_t kReleaseStride = 64 * 1024 * 1024;
+
+std::string ErrnoMessage(const std::string& what, const std::string& path) {
+    return what + " " + path + ": " + std::strerror(errno);
+}
+
+Status WriteAll(int fd, const char* data, size_t len, const std::string& path) {
+    while (len > 0) {
+        ssize_t n = ::write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return Status::Error(ErrnoMessage("Failed to write", path));
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return Status::OK_STATUS();
+}
+
+}  // namespace
+
+SnapshotWriter::SnapshotWriter()
+    : fd_(-1), block_entries_(0), entries_(0), blocks_(0), data_bytes_(0) {}
+
+SnapshotWriter::~SnapshotWriter() {
+    Abort();
+}
+
+Status SnapshotWriter::Open(const std::string& path) {
+    path_ = path;
+    tmp_path_ = path + ".tmp";
+    fd_ = ::open(tmp_path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        return Status::Error(ErrnoMessage("Failed to create", tmp_path_));
+    }
+    // 先占住头部的位置，条目数和块数在Finish时才知道
+    std::string placeholder(kSnapshotHeaderSize, '\0');
+    block_.reserve(kBlockSize + kBlockPrefix);
+    block_.assign(kBlockPrefix, '\0');
+    return WriteAll(fd_, placeholder.data(), placeholder.size(), tmp_path_);
+}
+
+Status SnapshotWriter::Add(const std::string& key, const std::string& value, int64_t expire_at_ms) {
+    PutFixed32(&block_, static_cast<uint32_t>(key.size()));
+    PutFixed32(&block_, static_cast<uint32_t>(value.size()));
+    PutFixed64(&block_, static_cast<uint64_t>(expire_at_ms));
+    block_.append(key);
+    block_.append(value);
+    block_entries_++;
+    entries_++;
+    return block_.size() >= kBlockSize ? FlushBlock() : Status::OK_STATUS();
+}
+
+Status SnapshotWriter::FlushBlock() {
+    if (block_entries_ == 0) {
+        return Status::OK_STATUS();
+    }
+    uint32_t payload_len = static_cast<uint32_t>(block_.size() - kBlockPrefix);
+    uint32_t crc = utils::Crc32c(block_.data() + kBlockPrefix, payload_len);
+    std::memcpy(&block_[0], &payload_len, 4);
+    std::memcpy(&block_[4], &block_entries_, 4);
+    std::memcpy(&block_[8], &crc, 4);
+
+    Status s = WriteAll(fd_, block_.data(), block_.size(), tmp_path_);
+    data_bytes_ += block_.size();
+    blocks_++;
+    block_entries_ = 0;
+    block_.assign(kBlockPrefix, '\0');
+    return s;
+}
+
+Status SnapshotWriter::Finish(uint64_t seq) {
+    Status s = FlushBlock();
+    if (!s.ok()) {
+        return s;
+    }
+
+    std::string header(kSnapshotMagic, sizeof(kSnapshotMagic));
+    PutFixed32(&header, kSnapshotVersion);
+    PutFixed32(&header, static_cast<uint32_t>(kBlockSize));
+    PutFixed64(&header, entries_);
+    PutFixed64(&header, blocks_);
+    PutFixed64(&header, seq);
+    PutFixed64(&header, static_cast<uint64_t>(utils::UnixTimeMs()));
+    PutFixed64(&header, data_bytes_);
+    PutFixed32(&header, 0);
+    PutFixed32(&header, utils::Crc32c(header.data(), header.size()));
+
+    if (::pwrite(fd_, header.data(), header.size(), 0) != static_cast<ssize_t>(header.size())) {
+        return Status::Error(ErrnoMessage("Failed to write header of", tmp_path_));
+    }
+    if (::fdatasync(fd_) != 0) {
+        return Status::Error(ErrnoMessage("Failed to sync", tmp_path_));
+    }
+    ::close(fd_);
+    fd_ = -1;
+    if (::rename(tmp_path_.c_str(), path_.c_str()) != 0) {
+        return Status::Error(ErrnoMessage("Failed to rename", tmp_path_));
+    }
+    if (!utils::SyncParentDirectory(path_)) {
+        LOG_WARNING(ErrnoMessage("Failed to sync directory of", path_));
+    }
+    return Status::OK_STATUS();
+}
+
+void SnapshotWriter::Abort() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+        ::unlink(tmp_path_.c_str());
+    }
+}
+
+SnapshotReader::SnapshotReader() : data_(nullptr), size_(0) {}
+
+SnapshotReader::~SnapshotReader() {
+    if (data_) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+}
+
+Status SnapshotReader::Open(const std::string& path) {
+    path_ = path;
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return Status::Error(ErrnoMessage("Failed to open snapshot", path));
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        return Status::Error(ErrnoMessage("Failed to stat snapshot", path));
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ < kSnapshotHeaderSize) {
+        ::close(fd);
+        return Status::Error("Snapshot is too short: " + path);
+    }
+    void* mem = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mem == MAP_FAILED) {
+        return Status::Error(ErrnoMessage("Failed to mmap snapshot", path));
+    }
+    data_ = static_cast<const char*>(mem);
+    // 解析是从头到尾的顺序扫描，让内核加大预读
+    ::madvise(mem, size_, MADV_SEQUENTIAL);
+
+    if (std::memcmp(data_, kSnapshotMagic, sizeof(kSnapshotMagic)) != 0 ||
+        GetFixed32(data_ + 60) != utils::Crc32c(data_, 60)) {
+        return Status::Error("Not a valid snapshot: " + path);
+    }
+    if (GetFixed32(data_ + 8) != kSnapshotVersion) {
+        return Status::Error("Unsupported snapshot version in " + path);
+    }
+    header_.entries = GetFixed64(data_ + 16);
+    header_.blocks = GetFixed64(data_ + 24);
+    header_.seq = GetFixed64(data_ + 32);
+    header_.created_ms = static_cast<int64_t>(GetFixed64(data_ + 40));
+    if (GetFixed64(data_ + 48) != size_ - kSnapshotHeaderSize) {
+        return Status::Error("Snapshot size does not match its header: " + path);
+    }
+    return Status::OK_STATUS();
+}
+
+Status SnapshotReader::ForEach(const EntryCallback& callback) {
+    Status corrupt = Status::Error("Corrupt snapshot block in " + path_);
+    size_t pos = kSnapshotHeaderSize;
+    size_t released = 0;
+    uint64_t entries = 0;
+    uint64_t blocks = 0;
+    std::string key;
+    std::string value;
+
+    while (pos < size_) {
+        if (size_ - pos < kBlockPrefix) {
+            return corrupt;
+        }
+        uint32_t payload_len = GetFixed32(data_ + pos);
+        uint32_t block_entries = GetFixed32(data_ + pos + 4);
+        uint32_t crc = GetFixed32(data_ + pos + 8);
+        const char* p = data_ + pos + kBlockPrefix;
+        if (payload_len > size_ - pos - kBlockPrefix || utils::Crc32c(p, payload_len) != crc) {
+            return corrupt;
+        }
+
+        const char* end = p + payload_len;
+        for (uint32_t i = 0; i < block_entries; ++i) {
+            if (static_cast<size_t>(end - p) < kEntryPrefix) {
+                return corrupt;
+            }
+            uint32_t key_len = GetFixed32(p);
+            uint32_t value_len = GetFixed32(p + 4);
+            int64_t expire_at_ms = static_cast<int64_t>(GetFixed64(p + 8));
+            p += kEntryPrefix;
+            if (static_cast<size_t>(end - p) < static_cast<size_t>(key_len) + value_len) {
+                return corrupt;
+            }
+            key.assign(p, key_len);
+            value.assign(p + key_len, value_len);
+            p += key_len + value_len;
+            callback(key, value, expire_at_ms);
+        }
+        if (p != end) {
+            return corrupt;
+        }
+
+        entries += block_entries;
+        blocks++;
+        pos += kBlockPrefix + payload_len;
+
+        if (pos - released >= kReleaseStride) {
+            size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+            size_t upto = pos / page * page;
+            ::madvise(const_cast<char*>(data_) + released, upto - released, MADV_DONTNEED);
+            released = upto;
+        }
+    }
+
+    if (entries != header_.entries || blocks != header_.blocks) {
+        return Status::Error("Snapshot entry count does not match its header: " + path_);
+    }
+    return Status::OK_STATUS();
+}
+
+Status SaveSnapshot(KVStore* store, const std::string& path, uint64_t seq) {
+    SnapshotWriter writer;
+    Status s = writer.Open(path);
+    if (!s.ok()) {
+        return s;
+    }
+
+    Status write_status;
+    int64_t now = utils::UnixTimeMs();
+    s = store->ForEach([&](const std::string& key, const std::string& value, int64_t ttl_ms) {
+        if (write_status.ok()) {
+            write_status = writer.Add(key, value, ttl_ms < 0 ? 0 : now + std::max<int64_t>(ttl_ms, 1));
+        }
+    });
+    if (s.ok()) {
+        s = write_status;
+    }
+    if (s.ok()) {
+        s = writer.Finish(seq);
+    }
+    if (s.ok()) {
+        LOG_INFO("Saved snapshot " + path + " with " + std::to_string(writer.entries()) + " keys");
+    }
+    return s;
+}
+
+Status LoadSnapshot(const std::string& path, KVStore* store, SnapshotHeader* header) {
+    SnapshotReader reader;
+    Status s = reader.Open(path);
+    if (!s.ok()) {
+        return s;
+    }
+    *header = reader.header();
+    store->Reserve(header->entries);
+
+    Status put_status;
+    size_t expired = 0;
+    int64_t now = utils::UnixTimeMs();
+    s = reader.ForEach([&](const std::string& key, const std::string& value, int64_t expire_at_ms) {
+        Status ps;
+        if (expire_at_ms == 0) {
+            ps = store->Put(key, value);
+        } else if (expire_at_ms > now) {
+            ps = store->PutWithTtl(key, value, expire_at_ms - now);
+        } else {
+            expired++;
+        }
+        if (!ps.ok() && put_status.ok()) {
+            put_status = ps;
+        }
+    });
+    if (s.ok()) {
+        s = put_status;
+    }
+    if (s.ok()) {
+        LOG_INFO("Loaded snapshot " + path + ": " + std::to_string(header->entries - expired) + " keys, " +
+                 std::to_string(expired) + " already expired");
+    }
+    return s;
+}
+
+SnapshotManager::SnapshotManager(KVStore* store, DurableStore* durable, const std::string& dir)
+    : store_(store), durable_(durable), path_(SnapshotPath(dir)), in_progress_(false) {}
+
+SnapshotManager::~SnapshotManager() {
+    std::lock_guard<std::mutex> lock(thread_mutex_);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+std::string SnapshotManager::SnapshotPath(const std::string& dir) {
+    return dir + "/dump.kvs";
+}
+
+Status SnapshotManager::Save() {
+    if (in_progress_.exchange(true)) {
+        return Status::Error("Snapshot already in progress");
+    }
+    Status s = durable_ ? durable_->SaveSnapshot(path_) : SaveSnapshot(store_, path_, 0);
+    in_progress_ = false;
+    return s;
+}
+
+Status SnapshotManager::StartBackgroundSave() {
+    std::lock_guard<std::mutex> lock(thread_mutex_);
+    if (in_progress_.exchange(true)) {
+        return Status::Error("Snapshot already in progress");
+    }
+    // 上一次后台保存已经结束，join不会阻塞
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    thread_ = std::thread([this]() {
+        Status s = durable_ ? durable_->SaveSnapshot(path_) : SaveSnapshot(store_, path_, 0);
+        if (!s.ok()) {
+            LOG_ERROR("Background snapshot failed: " + s.message);
+        }
+        in_progress_ = false;
+    });
+    return Status::OK_STATUS();
+}
@@ -0,0 +1,119 @@
+// src/storage/snapshot.h
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "../core/kv_store.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class DurableStore;
+
+// 快照文件格式
+//
+//   头部(64字节): 魔数 | 版本 | 条目数 | 块数 | 日志序列号 | 创建时间 | 数据字节数 | crc32c
+//   数据块:       payload长度(4) | 条目数(4) | crc32c(4) | payload
+//   条目:         key长度(4) | value长度(4) | expire_at_ms(8) | key | value
+//
+// 条目按块写入，每块约kBlockSize字节并带独立校验；头部中的条目数用于加载前预分配哈希表。
+// 加载时整个文件mmap进来顺序解析，接近顺序读带宽。文件先写到临时文件，落盘后rename替换。
+struct SnapshotHeader {
+    uint64_t entries = 0;
+    uint64_t blocks = 0;
+    // 快照对应的日志序列号，回放日志时跳过不大于它的记录；没有日志时为0
+    uint64_t seq = 0;
+    int64_t created_ms = 0;
+};
+
+class SnapshotWriter {
+public:
+    static const size_t kBlockSize = 64 * 1024;
+
+    SnapshotWriter();
+    ~SnapshotWriter();
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    // 在path + ".tmp"上开始写入
+    Status Open(const std::string& path);
+    // expire_at_ms为Unix毫秒时间，0表示没有过期时间
+    Status Add(const std::string& key, const std::string& value, int64_t expire_at_ms);
+    // 写入头部并落盘，然后原子替换path
+    Status Finish(uint64_t seq);
+    // 删除临时文件
+    void Abort();
+
+    uint64_t entries() const { return entries_; }
+
+private:
+    Status FlushBlock();
+
+    std::string path_;
+    std::string tmp_path_;
+    int fd_;
+    std::string block_;
+    uint32_t block_entries_;
+    uint64_t entries_;
+    uint64_t blocks_;
+    uint64_t data_bytes_;
+};
+
+class SnapshotReader {
+public:
+    using EntryCallback =
+        std::function<void(const std::string& key, const std::string& value, int64_t expire_at_ms)>;
+
+    SnapshotReader();
+    ~SnapshotReader();
+    SnapshotReader(const SnapshotReader&) = delete;
+    SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+    // mmap文件并校验头部
+    Status Open(const std::string& path);
+    const SnapshotHeader& header() const { return header_; }
+    // 按写入顺序遍历所有条目，任何一个块校验失败都返回错误
+    Status ForEach(const EntryCallback& callback);
+
+private:
+    std::string path_;
+    const char* data_;
+    size_t size_;
+    SnapshotHeader header_;
+};
+
+// 把store的当前数据导出为快照。导出通过KVStore::ForEach分批进行，不会在整个过程中阻塞读写，
+// 因此快照是弱一致的：seq之后的修改可能部分包含在内，回放seq之后的日志即可得到准确状态
+Status SaveSnapshot(KVStore* store, const std::string& path, uint64_t seq);
+
+// 把快照加载到store中：先按条目数预分配，再逐条写入，已过期的条目被跳过
+Status LoadSnapshot(const std::string& path, KVStore* store, SnapshotHeader* header);
+
+// 数据目录中的快照：服务器启动时加载，BGSAVE命令和正常退出时保存
+class SnapshotManager {
+public:
+    // durable非空时store应为它本身，快照会记录日志序列号
+    SnapshotManager(KVStore* store, DurableStore* durable, const std::string& dir);
+    ~SnapshotManager();
+
+    // 数据目录中快照文件的路径
+    static std::string SnapshotPath(const std::string& dir);
+
+    // 在调用线程中保存快照
+    Status Save();
+    // 在后台线程中保存快照，已有保存在进行时返回错误
+    Status StartBackgroundSave();
+    bool InProgress() const { return in_progress_.load(); }
+
+private:
+    KVStore* store_;
+    DurableStore* durable_;
+    std::string path_;
+    std::atomic<bool> in_progress_;
+    std::mutex thread_mutex_;
+    std::thread thread_;
+};
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,366 @@
+// src/storage/sstable.cc
+#include "sstable.h"
+#include "bloom_filter.h"
+#include "coding.h"
+#include "../common/utils.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+const size_t SSTable::kBlockSize;
+const uint64_t SSTable::kMagic;
+
+using coding::GetFixed32;
+using coding::GetFixed64;
+using coding::PutFixed32;
+using coding::PutFixed64;
+
+namespace {
+
+const size_t kFooterSize = 48;
+// 条目头：key长度(4) | value长度(4) | 类型(1)
+const size_t kEntryHeader = 9;
+const char kTypeValue = 0;
+const char kTypeDeletion = 1;
+
+std::string ErrnoMessage(const std::string& what, const std::string& path) {
+    return what + " " + path + ": " + std::strerror(errno);
+}
+
+// 解析块内从pos开始的一个条目，块损坏时返回false
+bool ParseEntry(const std::string& block, size_t* pos, std::string* key, std::string* value, bool* deleted) {
+    if (block.size() - *pos < kEntryHeader) {
+        return false;
+    }
+    const char* p = block.data() + *pos;
+    uint32_t key_len = GetFixed32(p);
+    uint32_t value_len = GetFixed32(p + 4);
+    if (block.size() - *pos - kEntryHeader < static_cast<size_t>(key_len) + value_len) {
+        return false;
+    }
+    *deleted = p[8] == kTypeDeletion;
+    key->assign(p + kEntryHeader, key_len);
+    value->assign(p + kEntryHeader + key_len, value_len);
+    *pos += kEntryHeader + key_len + value_len;
+    return true;
+}
+
+}  // namespace
+
+class SSTable::Iterator : public InternalIterator {
+public:
+    explicit Iterator(std::shared_ptr<SSTable> table)
+        : table_(std::move(table)), block_index_(0), pos_(0), valid_(false), deleted_(false) {}
+
+    bool Valid() const override { return valid_; }
+
+    void Seek(const std::string& target) override {
+        block_index_ = table_->FindBlock(target);
+        if (!LoadBlock()) {
+            return;
+        }
+        while (valid_ && key_ < target) {
+            Next();
+        }
+    }
+
+    void Next() override {
+        if (pos_ >= block_.size()) {
+            block_index_++;
+            if (!LoadBlock()) {
+                return;
+            }
+        } else {
+            ParseCurrent();
+        }
+    }
+
+    const std::string& key() const override { return key_; }
+    const std::string& value() const override { return value_; }
+    bool deleted() const override { return deleted_; }
+    Status status() const override { return status_; }
+
+private:
+    // 读入block_index_处的块并定位到第一个条目
+    bool LoadBlock() {
+        valid_ = false;
+        if (block_index_ >= table_->index_.size()) {
+            return false;
+        }
+        const IndexEntry& entry = table_->index_[block_index_];
+        table_->CountBlockRead();
+        status_ = table_->ReadBlock(entry.offset, entry.size, &block_);
+        if (!status_.ok()) {
+            return false;
+        }
+        pos_ = 0;
+        ParseCurrent();
+        return valid_;
+    }
+
+    void ParseCurrent() {
+        valid_ = ParseEntry(block_, &pos_, &key_, &value_, &deleted_);
+        if (!valid_) {
+            status_ = Status::Error("Corrupt block in " + table_->path_);
+        }
+    }
+
+    std::shared_ptr<SSTable> table_;
+    size_t block_index_;
+    std::string block_;
+    size_t pos_;
+    bool valid_;
+    std::string key_;
+    std::string value_;
+    bool deleted_;
+    Status status_;
+};
+
+SSTable::SSTable(const std::string& path, int fd, std::atomic<uint64_t>* block_reads)
+    : path_(path), fd_(fd), block_reads_(block_reads), entries_(0), obsolete_(false) {}
+
+SSTable::~SSTable() {
+    ::close(fd_);
+    if (obsolete_.load()) {
+        ::unlink(path_.c_str());
+    }
+}
+
+Status SSTable::Open(const std::string& path, uint64_t file_size, std::atomic<uint64_t>* block_reads,
+                     std::shared_ptr<SSTable>* table) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return Status::Error(ErrnoMessage("Failed to open table", path));
+    }
+    std::shared_ptr<SSTable> t(new SSTable(path, fd, block_reads));
+
+    char footer[kFooterSize];
+    if (file_size < kFooterSize ||
+        ::pread(fd, footer, kFooterSize, static_cast<off_t>(file_size - kFooterSize)) !=
+            static_cast<ssize_t>(kFooterSize) ||
+        GetFixed64(footer + 40) != kMagic) {
+        return Status::Error("Not a valid table: " + path);
+    }
+    uint64_t index_offset = GetFixed64(footer);
+    uint64_t index_size = GetFixed64(footer + 8);
+    uint64_t filter_offset = GetFixed64(footer + 16);
+    uint64_t filter_size = GetFixed64(footer + 24);
+    t->entries_ = GetFixed64(footer + 32);
+
+    Status s = t->ReadBlock(filter_offset, static_cast<uint32_t>(filter_size), &t->filter_);
+    std::string index;
+    if (s.ok()) {
+        s = t->ReadBlock(index_offset, static_cast<uint32_t>(index_size), &index);
+    }
+    if (!s.ok()) {
+        return s;
+    }
+
+    size_t pos = 0;
+    while (pos < index.size()) {
+        if (index.size() - pos < 4) {
+            return Status::Error("Corrupt index in " + path);
+        }
+        uint32_t key_len = GetFixed32(index.data() + pos);
+        if (index.size() - pos - 4 < static_cast<size_t>(key_len) + 12) {
+            return Status::Error("Corrupt index in " + path);
+        }
+        IndexEntry entry;
+        entry.last_key.assign(index.data() + pos + 4, key_len);
+        entry.offset = GetFixed64(index.data() + pos + 4 + key_len);
+        entry.size = GetFixed32(index.data() + pos + 12 + key_len);
+        t->index_.push_back(std::move(entry));
+        pos += 16 + key_len;
+    }
+    *table = std::move(t);
+    return Status::OK_STATUS();
+}
+
+Status SSTable::ReadBlock(uint64_t offset, uint32_t size, std::string* contents) const {
+    contents->resize(size + 4);
+    ssize_t n = ::pread(fd_, &(*contents)[0], size + 4, static_cast<off_t>(offset));
+    if (n != static_cast<ssize_t>(size + 4)) {
+        return Status::Error(ErrnoMessage("Failed to read block from", path_));
+    }
+    uint32_t crc = GetFixed32(contents->data() + size);
+    contents->resize(size);
+    if (utils::Crc32c(contents->data(), size) != crc) {
+        return Status::Error("Checksum mismatch in " + path_);
+    }
+    return Status::OK_STATUS();
+}
+
+size_t SSTable::FindBlock(const std::string& key) const {
+    size_t lo = 0;
+    size_t hi = index_.size();
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (index_[mid].last_key < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+bool SSTable::Get(const std::string& key, uint32_t key_hash, std::string* value, bool* deleted, Status* status) {
+    if (!BloomFilter::MayContain(filter_, key_hash)) {
+        return false;
+    }
+    size_t block_index = FindBlock(key);
+    if (block_index == index_.size()) {
+        return false;
+    }
+
+    std::string block;
+    CountBlockRead();
+    *status = ReadBlock(index_[block_index].offset, index_[block_index].size, &block);
+    if (!status->ok()) {
+        return false;
+    }
+    std::string entry_key;
+    std::string entry_value;
+    bool entry_deleted;
+    size_t pos = 0;
+    while (pos < block.size()) {
+        if (!ParseEntry(block, &pos, &entry_key, &entry_value, &entry_deleted)) {
+            *status = Status::Error("Corrupt block in " + path_);
+            return false;
+        }
+        int cmp = entry_key.compare(key);
+        if (cmp == 0) {
+            value->swap(entry_value);
+            *deleted = entry_deleted;
+            return true;
+        }
+        if (cmp > 0) {
+            break;
+        }
+    }
+    return false;
+}
+
+std::unique_ptr<InternalIterator> SSTable::NewIterator() {
+    return std::unique_ptr<InternalIterator>(new Iterator(shared_from_this()));
+}
+
+SSTableBuilder::SSTableBuilder(const std::string& path, int bloom_bits_per_key)
+    : path_(path), bloom_bits_per_key_(bloom_bits_per_key), fd_(-1), offset_(0), entries_(0) {}
+
+SSTableBuilder::~SSTableBuilder() {
+    if (fd_ >= 0) {
+        Abandon();
+    }
+}
+
+Status SSTableBuilder::Open() {
+    fd_ = ::open(path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        return Status::Error(ErrnoMessage("Failed to create table", path_));
+    }
+    block_.reserve(SSTable::kBlockSize * 2);
+    return Status::OK_STATUS();
+}
+
+Status SSTableBuilder::Add(const std::string& key, const std::string& value, bool deleted) {
+    if (entries_ == 0) {
+        smallest_ = key;
+    }
+    largest_ = key;
+    entries_++;
+    key_hashes_.push_back(BloomFilter::Hash(key.data(), key.size()));
+
+    PutFixed32(&block_, static_cast<uint32_t>(key.size()));
+    PutFixed32(&block_, static_cast<uint32_t>(value.size()));
+    block_.push_back(deleted ? kTypeDeletion : kTypeValue);
+    block_.append(key);
+    block_.append(value);
+    return block_.size() >= SSTable::kBlockSize ? FlushBlock() : Status::OK_STATUS();
+}
+
+Status SSTableBuilder::WriteWithCrc(const std::string& contents, uint64_t* offset, uint32_t* size) {
+    std::string data = contents;
+    PutFixed32(&data, utils::Crc32c(contents.data(), contents.size()));
+    const char* p = data.data();
+    size_t left = data.size();
+    while (left > 0) {
+        ssize_t n = ::write(fd_, p, left);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return Status::Error(ErrnoMessage("Failed to write table", path_));
+        }
+        p += n;
+        left -= static_cast<size_t>(n);
+    }
+    *offset = offset_;
+    *size = static_cast<uint32_t>(contents.size());
+    offset_ += data.size();
+    return Status::OK_STATUS();
+}
+
+Status SSTableBuilder::FlushBlock() {
+    if (block_.empty()) {
+        return Status::OK_STATUS();
+    }
+    uint64_t offset;
+    uint32_t size;
+    Status s = WriteWithCrc(block_, &offset, &size);
+    block_.clear();
+    if (!s.ok()) {
+        return s;
+    }
+    PutFixed32(&index_, static_cast<uint32_t>(largest_.size()));
+    index_.append(largest_);
+    PutFixed64(&index_, offset);
+    PutFixed32(&index_, size);
+    return Status::OK_STATUS();
+}
+
+Status SSTableBuilder::Finish() {
+    Status s = FlushBlock();
+    std::string filter;
+    BloomFilter::Build(key_hashes_, bloom_bits_per_key_, &filter);
+    uint64_t filter_offset = 0;
+    uint32_t filter_size = 0;
+    uint64_t index_offset = 0;
+    uint32_t index_size = 0;
+    if (s.ok()) {
+        s = WriteWithCrc(filter, &filter_offset, &filter_size);
+    }
+    if (s.ok()) {
+        s = WriteWithCrc(index_, &index_offset, &index_size);
+    }
+    if (!s.ok()) {
+        return s;
+    }
+
+    std::string footer;
+    PutFixed64(&footer, index_offset);
+    PutFixed64(&footer, index_size);
+    PutFixed64(&footer, filter_offset);
+    PutFixed64(&footer, filter_size);
+    PutFixed64(&footer, entries_);
+    PutFixed64(&footer, SSTable::kMagic);
+    if (::write(fd_, footer.data(), footer.size()) != static_cast<ssize_t>(footer.size())) {
+        return Status::Error(ErrnoMessage("Failed to write table", path_));
+    }
+    offset_ += footer.size();
+    if (::fdatasync(fd_) != 0) {
+        return Status::Error(ErrnoMessage("Failed to sync table", path_));
+    }
+    ::close(fd_);
+    fd_ = -1;
+    return Status::OK_STATUS();
+}
+
+void SSTableBuilder::Abandon() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    ::unlink(path_.c_str());
+}
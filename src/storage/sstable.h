@@ -0,0 +1,123 @@
+// src/storage/sstable.h
+#ifndef SSTABLE_H
+#define SSTABLE_H
+
+#include "../core/kv_store.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// LSM内部使用的迭代器：按key升序，删除标记(tombstone)也作为条目返回
+class InternalIterator {
+public:
+    virtual ~InternalIterator() = default;
+    virtual bool Valid() const = 0;
+    // 定位到第一个不小于target的条目
+    virtual void Seek(const std::string& target) = 0;
+    virtual void Next() = 0;
+    virtual const std::string& key() const = 0;
+    virtual const std::string& value() const = 0;
+    virtual bool deleted() const = 0;
+    // 读文件或校验失败时返回错误，此时Valid()为false
+    virtual Status status() const { return Status::OK_STATUS(); }
+};
+
+// 不可变的有序表文件（SSTable）
+//
+//   数据块*:   { key长度(4) | value长度(4) | 类型(1) | key | value }* | crc32c(4)
+//   过滤器块:  布隆过滤器 | crc32c(4)
+//   索引块:    { key长度(4) | 块内最后一个key | 块偏移(8) | 块大小(4) }* | crc32c(4)
+//   尾部(48):  索引偏移(8) | 索引大小(8) | 过滤器偏移(8) | 过滤器大小(8) | 条目数(8) | 魔数(8)
+//
+// 打开时把索引和布隆过滤器读入内存，点查最多读一个数据块；
+// 数据块大小约kBlockSize，通过pread读取，依赖操作系统页缓存。
+class SSTable : public std::enable_shared_from_this<SSTable> {
+public:
+    static const size_t kBlockSize = 4096;
+    static const uint64_t kMagic = 0x4b56535354424c31ull;  // "KVSSTBL1"
+
+    // block_reads非空时每读一个数据块加一（不含打开时读取的索引和过滤器），用于统计读放大
+    static Status Open(const std::string& path, uint64_t file_size, std::atomic<uint64_t>* block_reads,
+                       std::shared_ptr<SSTable>* table);
+    ~SSTable();
+    SSTable(const SSTable&) = delete;
+    SSTable& operator=(const SSTable&) = delete;
+
+    // 找到key时返回true，key被删除时deleted为true
+    bool Get(const std::string& key, uint32_t key_hash, std::string* value, bool* deleted, Status* status);
+
+    std::unique_ptr<InternalIterator> NewIterator();
+
+    uint64_t entries() const { return entries_; }
+    // 表被合并掉以后调用，最后一个引用释放时删除文件
+    void MarkObsolete() { obsolete_.store(true); }
+
+private:
+    class Iterator;
+
+    struct IndexEntry {
+        std::string last_key;
+        uint64_t offset;
+        uint32_t size;
+    };
+
+    SSTable(const std::string& path, int fd, std::atomic<uint64_t>* block_reads);
+
+    // 读取一个块（含crc）并校验，contents为去掉crc的块内容
+    Status ReadBlock(uint64_t offset, uint32_t size, std::string* contents) const;
+    void CountBlockRead() const {
+        if (block_reads_) {
+            block_reads_->fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    // 第一个最后key不小于key的数据块下标，没有时返回index_.size()
+    size_t FindBlock(const std::string& key) const;
+
+    std::string path_;
+    int fd_;
+    std::atomic<uint64_t>* block_reads_;
+    std::vector<IndexEntry> index_;
+    std::string filter_;
+    uint64_t entries_;
+    std::atomic<bool> obsolete_;
+};
+
+// 按key严格递增的顺序写入SSTable，Finish后文件已落盘
+class SSTableBuilder {
+public:
+    SSTableBuilder(const std::string& path, int bloom_bits_per_key);
+    ~SSTableBuilder();
+    SSTableBuilder(const SSTableBuilder&) = delete;
+    SSTableBuilder& operator=(const SSTableBuilder&) = delete;
+
+    Status Open();
+    Status Add(const std::string& key, const std::string& value, bool deleted);
+    Status Finish();
+    // 放弃并删除文件
+    void Abandon();
+
+    uint64_t entries() const { return entries_; }
+    // 已写入和缓冲中的字节数
+    uint64_t FileSize() const { return offset_ + block_.size(); }
+    const std::string& smallest() const { return smallest_; }
+    const std::string& largest() const { return largest_; }
+
+private:
+    Status FlushBlock();
+    Status WriteWithCrc(const std::string& contents, uint64_t* offset, uint32_t* size);
+
+    std::string path_;
+    int bloom_bits_per_key_;
+    int fd_;
+    uint64_t offset_;
+    std::string block_;
+    std::string index_;
+    std::vector<uint32_t> key_hashes_;
+    uint64_t entries_;
+    std::string smallest_;
+    std::string largest_;
+};
+
+#endif // SSTABLE_H
@@ -0,0 +1,397 @@
+// src/storage/tiered_store.cc
+#include "tiered_store.h"
+#include "coding.h"
+#include "../common/logger.h"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <utility>
+#include <vector>
+
+const uint32_t TieredStore::kPromoteWindowMinutes;
+const int TieredStore::kReclaimIntervalMs;
+const size_t TieredStore::kScanBatchSlots;
+
+using coding::GetFixed32;
+using coding::PutFixed32;
+
+namespace {
+
+size_t RoundUpToPowerOfTwo(size_t n) {
+    size_t result = 1;
+    while (result < n) {
+        result <<= 1;
+    }
+    return result;
+}
+
+// 一次demote最多搬出的条目数，避免一次超大写入让单次Put搬空整个分片
+const size_t kMaxDemotionsPerWrite = 64;
+
+}  // namespace
+
+TieredStore::TieredStore(const TieredOptions& options)
+    : options_(options), log_(options.dir, options.segment_bytes), hits_(0), misses_(0), cold_reads_(0),
+      demotions_(0), promotions_(0), reclaimed_bytes_(0), stopping_(false) {
+    size_t num_shards = RoundUpToPowerOfTwo(options.num_shards == 0 ? 1 : options.num_shards);
+    shards_.reset(new Shard[num_shards]);
+    shard_mask_ = num_shards - 1;
+    hot_bytes_per_shard_ = options.hot_bytes / num_shards;
+    for (size_t i = 0; i < num_shards; ++i) {
+        shards_[i].policy = EvictionPolicy::Create("lfu");
+        shards_[i].hot.SetEvictionPolicy(shards_[i].policy.get());
+    }
+}
+
+TieredStore::~TieredStore() {
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex_);
+        stopping_ = true;
+    }
+    stop_cv_.notify_all();
+    if (reclaimer_.joinable()) {
+        reclaimer_.join();
+    }
+}
+
+Status TieredStore::Open(const TieredOptions& options, std::unique_ptr<TieredStore>* store) {
+    if (options.dir.empty()) {
+        return Status(INVALID_ARGUMENT, "Tiered store needs a directory for the value log");
+    }
+    std::unique_ptr<TieredStore> tiered(new TieredStore(options));
+    Status s = tiered->log_.Open();
+    if (!s.ok()) {
+        return s;
+    }
+    tiered->reclaimer_ = std::thread(&TieredStore::ReclaimLoop, tiered.get());
+    *store = std::move(tiered);
+    return Status::OK_STATUS();
+}
+
+TieredStore::Shard& TieredStore::ShardFor(const std::string& key) const {
+    size_t h = std::hash<std::string>()(key);
+    return shards_[(h ^ (h >> 32)) & shard_mask_];
+}
+
+// 段号(4) | 偏移(4) | 记录大小(4) | 窗口内读取次数(2) | 窗口开始时间(2)
+std::string TieredStore::EncodeCold(const ColdEntry& entry) {
+    std::string data;
+    data.reserve(16);
+    PutFixed32(&data, entry.location.segment);
+    PutFixed32(&data, entry.location.offset);
+    PutFixed32(&data, entry.location.size);
+    PutFixed32(&data, static_cast<uint32_t>(entry.reads) | (static_cast<uint32_t>(entry.window_minutes) << 16));
+    return data;
+}
+
+TieredStore::ColdEntry TieredStore::DecodeCold(const std::string& data) {
+    ColdEntry entry;
+    entry.location.segment = GetFixed32(data.data());
+    entry.location.offset = GetFixed32(data.data() + 4);
+    entry.location.size = GetFixed32(data.data() + 8);
+    uint32_t reads = GetFixed32(data.data() + 12);
+    entry.reads = static_cast<uint16_t>(reads & 0xffff);
+    entry.window_minutes = static_cast<uint16_t>(reads >> 16);
+    return entry;
+}
+
+uint16_t TieredStore::NowMinutes() {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<uint16_t>(std::chrono::duration_cast<std::chrono::minutes>(now).count());
+}
+
+void TieredStore::DemoteLocked(Shard& shard) {
+    std::string value;
+    for (size_t n = 0; n < kMaxDemotionsPerWrite && shard.hot.UsedBytes() > hot_bytes_per_shard_; ++n) {
+        size_t pos = shard.policy->SelectVictim(shard.hot);
+        if (pos == FlatHashTable::kNoSlot) {
+            break;
+        }
+        std::string key = shard.hot.KeyAt(pos);
+        shard.hot.Find(key, &value);
+        ColdEntry entry;
+        Status s = log_.Append(key, value, &entry.location);
+        if (!s.ok()) {
+            // 写不进值日志时留在内存里，内存暂时超出预算
+            LOG_ERROR("Failed to demote value: " + s.message);
+            break;
+        }
+        entry.window_minutes = NowMinutes();
+        shard.cold.Insert(key, EncodeCold(entry));
+        shard.hot.Erase(key);
+        demotions_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void TieredStore::EraseColdLocked(Shard& shard, const std::string& key) {
+    std::string data;
+    if (shard.cold.Find(key, &data)) {
+        log_.MarkGarbage(DecodeCold(data).location);
+        shard.cold.Erase(key);
+    }
+}
+
+Status TieredStore::Put(const std::string& key, const std::string& value) {
+    if (key.empty()) {
+        return Status::Error("Key cannot be empty");
+    }
+    Shard& shard = ShardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    EraseColdLocked(shard, key);
+    shard.hot.Insert(key, value);
+    DemoteLocked(shard);
+    return Status::OK_STATUS();
+}
+
+Status TieredStore::Get(const std::string& key, std::string& value) {
+    Shard& shard = ShardFor(key);
+    ColdEntry entry;
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            if (shard.hot.Find(key, &value)) {
+                hits_.fetch_add(1, std::memory_order_relaxed);
+                return Status::OK_STATUS();
+            }
+            std::string data;
+            if (!shard.cold.Find(key, &data)) {
+                misses_.fetch_add(1, std::memory_order_relaxed);
+                return Status::KeyNotFound(key);
+            }
+            entry = DecodeCold(data);
+            uint16_t now = NowMinutes();
+            if (static_cast<uint16_t>(now - entry.window_minutes) >= kPromoteWindowMinutes) {
+                entry.window_minutes = now;
+                entry.reads = 0;
+            }
+            if (entry.reads < 0xffff) {
+                entry.reads++;
+            }
+            shard.cold.Insert(key, EncodeCold(entry));
+        }
+
+        // pread在锁外进行；已经开始的读取不受回收影响，旧段在读完之前不会关闭。
+        // 读取前记录就被搬走、旧段已删除时，按索引中的新位置重读
+        Status s = log_.Read(entry.location, key, &value);
+        if (s.ok()) {
+            break;
+        }
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        std::string data;
+        if (shard.cold.Find(key, &data)) {
+            ColdEntry current = DecodeCold(data);
+            if (current.location.segment == entry.location.segment &&
+                current.location.offset == entry.location.offset) {
+                return s;
+            }
+        }
+    }
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    cold_reads_.fetch_add(1, std::memory_order_relaxed);
+
+    if (entry.reads >= options_.promote_reads) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        // 读取期间key可能被覆盖、删除或搬走，只在位置不变时提升
+        std::string data;
+        if (shard.cold.Find(key, &data)) {
+            ColdEntry current = DecodeCold(data);
+            if (current.location.segment == entry.location.segment &&
+                current.location.offset == entry.location.offset) {
+                EraseColdLocked(shard, key);
+                shard.hot.Insert(key, value);
+                promotions_.fetch_add(1, std::memory_order_relaxed);
+                DemoteLocked(shard);
+            }
+        }
+    }
+    return Status::OK_STATUS();
+}
+
+Status TieredStore::Delete(const std::string& key) {
+    Shard& shard = ShardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.hot.Erase(key)) {
+        return Status::OK_STATUS();
+    }
+    if (!shard.cold.Contains(key)) {
+        return Status::KeyNotFound(key);
+    }
+    EraseColdLocked(shard, key);
+    return Status::OK_STATUS();
+}
+
+Status TieredStore::Contains(const std::string& key) {
+    Shard& shard = ShardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.hot.Contains(key) || shard.cold.Contains(key) ? Status::OK_STATUS() : Status::KeyNotFound(key);
+}
+
+size_t TieredStore::Size() const {
+    size_t total = 0;
+    for (size_t i = 0; i <= shard_mask_; ++i) {
+        std::lock_guard<std::mutex> lock(shards_[i].mutex);
+        total += shards_[i].hot.size() + shards_[i].cold.size();
+    }
+    return total;
+}
+
+void TieredStore::Clear() {
+    // 回收线程搬记录时会回写索引，清空期间不能进行
+    std::lock_guard<std::mutex> reclaim_lock(reclaim_mutex_);
+    for (size_t i = 0; i <= shard_mask_; ++i) {
+        shards_[i].mutex.lock();
+    }
+    for (size_t i = 0; i <= shard_mask_; ++i) {
+        shards_[i].hot.Clear();
+        shards_[i].cold.Clear();
+    }
+    Status s = log_.Clear();
+    for (size_t i = 0; i <= shard_mask_; ++i) {
+        shards_[i].mutex.unlock();
+    }
+    if (!s.ok()) {
+        LOG_ERROR("Failed to reset value log: " + s.message);
+    }
+    LOG_INFO("Tiered store cleared");
+}
+
+StoreStats TieredStore::GetStats() const {
+    TieredStats tiered = GetTieredStats();
+    StoreStats stats;
+    stats.keys = tiered.hot_keys + tiered.cold_keys;
+    stats.used_bytes = tiered.hot_bytes + tiered.index_bytes;
+    for (size_t i = 0; i <= shard_mask_; ++i) {
+        std::lock_guard<std::mutex> lock(shards_[i].mutex);
+        stats.logical_bytes += shards_[i].hot.LogicalBytes();
+        stats.allocator_bytes += shards_[i].hot.MemoryUsage() + shards_[i].cold.MemoryUsage();
+    }
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+TieredStats TieredStore::GetTieredStats() const {
+    TieredStats stats;
+    for (size_t i = 0; i <= shard_mask_; ++i) {
+        std::lock_guard<std::mutex> lock(shards_[i].mutex);
+        stats.hot_keys += shards_[i].hot.size();
+        stats.cold_keys += shards_[i].cold.size();
+        stats.hot_bytes += shards_[i].hot.UsedBytes();
+        stats.index_bytes += shards_[i].cold.UsedBytes();
+    }
+    stats.log_bytes = log_.TotalBytes();
+    stats.garbage_bytes = log_.GarbageBytes();
+    stats.cold_reads = cold_reads_.load(std::memory_order_relaxed);
+    stats.demotions = demotions_.load(std::memory_order_relaxed);
+    stats.promotions = promotions_.load(std::memory_order_relaxed);
+    stats.reclaimed_bytes = reclaimed_bytes_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+Status TieredStore::ForEach(const ForEachCallback& callback) {
+    std::vector<std::pair<std::string, std::string>> batch;
+    std::vector<std::pair<std::string, ValueLocation>> cold_batch;
+    std::string value;
+    for (size_t i = 0; i <= shard_mask_; ++i) {
+        Shard& shard = shards_[i];
+        FlatHashTable::ScanCursor hot_cursor;
+        FlatHashTable::ScanCursor cold_cursor;
+        while (!hot_cursor.done || !cold_cursor.done) {
+            {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                if (!hot_cursor.done) {
+                    shard.hot.Scan(&hot_cursor, kScanBatchSlots, [&](const char* key, size_t key_len,
+                                                                     const char* v, size_t value_len) {
+                        batch.emplace_back(std::string(key, key_len), std::string(v, value_len));
+                    });
+                } else {
+                    shard.cold.Scan(&cold_cursor, kScanBatchSlots, [&](const char* key, size_t key_len,
+                                                                       const char* v, size_t value_len) {
+                        cold_batch.emplace_back(std::string(key, key_len),
+                                                DecodeCold(std::string(v, value_len)).location);
+                    });
+                }
+            }
+            for (const auto& kv : batch) {
+                callback(kv.first, kv.second, -1);
+            }
+            batch.clear();
+            for (const auto& kv : cold_batch) {
+                // 记录可能在锁外被回收搬走，旧段在读完前不会删除；段已经删除说明期间key被修改过
+                if (log_.Read(kv.second, kv.first, &value).ok()) {
+                    callback(kv.first, value, -1);
+                } else {
+                    Status s = Get(kv.first, value);
+                    if (s.ok()) {
+                        callback(kv.first, value, -1);
+                    }
+                }
+            }
+            cold_batch.clear();
+        }
+    }
+    return Status::OK_STATUS();
+}
+
+bool TieredStore::ReclaimSpace() {
+    std::lock_guard<std::mutex> reclaim_lock(reclaim_mutex_);
+    uint32_t segment;
+    if (!log_.PickSegmentToReclaim(options_.reclaim_garbage_ratio, &segment)) {
+        return false;
+    }
+
+    // 段中仍被索引引用的记录搬到当前段，其余都是垃圾
+    Status write_status;
+    uint64_t moved = 0;
+    Status s = log_.ScanSegment(segment, [&](const std::string& key, const std::string& value,
+                                             const ValueLocation& location) {
+        Shard& shard = ShardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        std::string data;
+        if (!write_status.ok() || !shard.cold.Find(key, &data)) {
+            return;
+        }
+        ColdEntry entry = DecodeCold(data);
+        if (entry.location.segment != location.segment || entry.location.offset != location.offset) {
+            return;
+        }
+        write_status = log_.Append(key, value, &entry.location);
+        if (write_status.ok()) {
+            shard.cold.Insert(key, EncodeCold(entry));
+            moved += location.size;
+        }
+    });
+    if (s.ok()) {
+        s = write_status;
+    }
+    if (!s.ok()) {
+        LOG_ERROR("Value log reclaim failed: " + s.message);
+        return false;
+    }
+
+    uint64_t before = log_.TotalBytes();
+    log_.DropSegment(segment);
+    uint64_t freed = before - log_.TotalBytes();
+    reclaimed_bytes_.fetch_add(freed - std::min(freed, moved), std::memory_order_relaxed);
+    LOG_DEBUG("Reclaimed value log segment " + std::to_string(segment) + ", moved " + std::to_string(moved) +
+              " live bytes");
+    return true;
+}
+
+void TieredStore::ReclaimLoop() {
+    std::unique_lock<std::mutex> lock(stop_mutex_);
+    while (!stopping_) {
+        stop_cv_.wait_for(lock, std::chrono::milliseconds(kReclaimIntervalMs));
+        if (stopping_) {
+            break;
+        }
+        lock.unlock();
+        while (ReclaimSpace()) {
+            std::lock_guard<std::mutex> stop_lock(stop_mutex_);
+            if (stopping_) {
+                break;
+            }
+        }
+        lock.lock();
+    }
+}
@@ -0,0 +1,127 @@
+// src/storage/tiered_store.h
+#ifndef TIERED_STORE_H
+#define TIERED_STORE_H
+
+#include "../core/kv_store.h"
+#include "../core/eviction_policy.h"
+#include "../core/flat_hash_table.h"
+#include "value_log.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+struct TieredOptions {
+    // 值日志所在的目录
+    std::string dir;
+    // 热数据（key和value都在内存）占用字节数的上限，超出后按LFU把冷的value移到值日志
+    size_t hot_bytes = 64 * 1024 * 1024;
+    size_t segment_bytes = 64 * 1024 * 1024;
+    // 冷value在kPromoteWindowMinutes分钟内被读取这么多次后移回内存
+    uint32_t promote_reads = 2;
+    // 已写满的段中垃圾比例达到该值时由后台线程回收
+    double reclaim_garbage_ratio = 0.5;
+    size_t num_shards = 64;
+};
+
+struct TieredStats {
+    size_t hot_keys = 0;
+    size_t cold_keys = 0;
+    size_t hot_bytes = 0;      // 热数据表占用的字节数
+    size_t index_bytes = 0;    // 冷数据索引占用的字节数
+    uint64_t log_bytes = 0;    // 值日志段文件总大小
+    uint64_t garbage_bytes = 0;
+    uint64_t cold_reads = 0;
+    uint64_t demotions = 0;
+    uint64_t promotions = 0;
+    uint64_t reclaimed_bytes = 0;
+};
+
+// 冷热分层存储：热的key和value放在内存，冷的value放在SSD上只追加的值日志里
+//
+// 每个分片有两张FlatHashTable：热数据表保存key和value，槽位元数据是LFU访问计数；
+// 冷数据索引只保存key和值日志中的位置（16字节），每个冷key的内存开销约等于索引本身。
+// 一个key只在其中一张表里。写入总是先进热数据表，分片超出热数据预算时按LFU抽样选出
+// 最冷的条目，把value追加到值日志后移入冷数据索引。读冷value是一次pread，在短时间内被
+// 重复读取的冷value移回热数据表。
+//
+// 覆盖写和删除使值日志中的旧记录成为垃圾，后台线程把垃圾比例高的段中仍被引用的记录
+// 搬到当前段后删除整个段。值日志不负责持久化，需要持久化时像其他引擎一样包一层DurableStore。
+class TieredStore : public KVStore {
+public:
+    static const uint32_t kPromoteWindowMinutes = 1;
+    // 后台回收线程的检查间隔
+    static const int kReclaimIntervalMs = 1000;
+    // ForEach每批在锁内检查的槽位数
+    static const size_t kScanBatchSlots = 1024;
+
+    static Status Open(const TieredOptions& options, std::unique_ptr<TieredStore>* store);
+    ~TieredStore() override;
+
+    Status Put(const std::string& key, const std::string& value) override;
+    Status Get(const std::string& key, std::string& value) override;
+    Status Delete(const std::string& key) override;
+    Status Contains(const std::string& key) override;
+    size_t Size() const override;
+    void Clear() override;
+    StoreStats GetStats() const override;
+    Status ForEach(const ForEachCallback& callback) override;
+
+    TieredStats GetTieredStats() const;
+    // 回收一个垃圾比例达到阈值的段，没有可回收的段时返回false
+    bool ReclaimSpace();
+
+private:
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        FlatHashTable hot;
+        std::unique_ptr<EvictionPolicy> policy;
+        // key -> 编码后的ColdEntry
+        FlatHashTable cold;
+    };
+
+    // 冷数据索引中的value，编码为16字节
+    struct ColdEntry {
+        ValueLocation location;
+        // 窗口内的读取次数和窗口开始的时间（分钟）
+        uint16_t reads = 0;
+        uint16_t window_minutes = 0;
+    };
+
+    explicit TieredStore(const TieredOptions& options);
+
+    Shard& ShardFor(const std::string& key) const;
+    static std::string EncodeCold(const ColdEntry& entry);
+    static ColdEntry DecodeCold(const std::string& data);
+    static uint16_t NowMinutes();
+
+    // 以下函数要求持有shard.mutex
+    void DemoteLocked(Shard& shard);
+    void EraseColdLocked(Shard& shard, const std::string& key);
+
+    void ReclaimLoop();
+
+    TieredOptions options_;
+    size_t hot_bytes_per_shard_;
+    std::unique_ptr<Shard[]> shards_;
+    size_t shard_mask_;
+    ValueLog log_;
+
+    std::atomic<uint64_t> hits_;
+    std::atomic<uint64_t> misses_;
+    std::atomic<uint64_t> cold_reads_;
+    std::atomic<uint64_t> demotions_;
+    std::atomic<uint64_t> promotions_;
+    std::atomic<uint64_t> reclaimed_bytes_;
+
+    // 同一时间只有一个回收在进行
+    std::mutex reclaim_mutex_;
+    std::thread reclaimer_;
+    std::mutex stop_mutex_;
+    std::condition_variable stop_cv_;
+    bool stopping_;
+};
+
+#endif // TIERED_STORE_H
@@ -0,0 +1,268 @@
+// src/storage/value_log.cc
+#include "value_log.h"
+#include "coding.h"
+#include "../common/utils.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+const size_t ValueLog::kHeaderSize;
+
+using coding::GetFixed32;
+using coding::PutFixed32;
+
+namespace {
+
+// 回收时顺序读取段文件的缓冲大小
+const size_t kScanBufferSize = 1 << 20;
+
+std::string ErrnoMessage(const std::string& what, const std::string& path) {
+    return what + " " + path + ": " + std::strerror(errno);
+}
+
+}  // namespace
+
+ValueLog::Segment::~Segment() {
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+ValueLog::ValueLog(const std::string& dir, size_t segment_bytes)
+    : dir_(dir), segment_bytes_(segment_bytes), next_segment_(1) {}
+
+ValueLog::~ValueLog() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& kv : segments_) {
+        ::unlink(kv.second->path.c_str());
+    }
+}
+
+std::string ValueLog::SegmentPath(uint32_t id) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "/%06u.vlog", id);
+    return dir_ + name;
+}
+
+Status ValueLog::Open() {
+    if (::mkdir(dir_.c_str(), 0755) != 0 && errno != EEXIST) {
+        return Status::Error(ErrnoMessage("Failed to create", dir_));
+    }
+    // 上次运行留下的段已经没有索引指向它们
+    DIR* dir = ::opendir(dir_.c_str());
+    if (!dir) {
+        return Status::Error(ErrnoMessage("Failed to open", dir_));
+    }
+    std::vector<std::string> stale;
+    while (struct dirent* entry = ::readdir(dir)) {
+        size_t len = std::strlen(entry->d_name);
+        if (len > 5 && std::strcmp(entry->d_name + len - 5, ".vlog") == 0) {
+            stale.push_back(dir_ + "/" + entry->d_name);
+        }
+    }
+    ::closedir(dir);
+    for (const auto& path : stale) {
+        ::unlink(path.c_str());
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    return NewSegmentLocked();
+}
+
+Status ValueLog::NewSegmentLocked() {
+    auto segment = std::make_shared<Segment>();
+    segment->id = next_segment_++;
+    segment->path = SegmentPath(segment->id);
+    segment->fd = ::open(segment->path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (segment->fd < 0) {
+        return Status::Error(ErrnoMessage("Failed to create", segment->path));
+    }
+    segments_[segment->id] = segment;
+    active_ = std::move(segment);
+    return Status::OK_STATUS();
+}
+
+std::shared_ptr<ValueLog::Segment> ValueLog::FindSegment(uint32_t id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = segments_.find(id);
+    return it == segments_.end() ? nullptr : it->second;
+}
+
+Status ValueLog::Append(const std::string& key, const std::string& value, ValueLocation* location) {
+    std::string record;
+    record.reserve(kHeaderSize + key.size() + value.size());
+    PutFixed32(&record, 0);
+    PutFixed32(&record, static_cast<uint32_t>(key.size()));
+    PutFixed32(&record, static_cast<uint32_t>(value.size()));
+    record.append(key);
+    record.append(value);
+    uint32_t crc = utils::Crc32c(record.data() + 4, record.size() - 4);
+    std::memcpy(&record[0], &crc, 4);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (active_->size > 0 && active_->size + record.size() > segment_bytes_) {
+        Status s = NewSegmentLocked();
+        if (!s.ok()) {
+            return s;
+        }
+    }
+    ssize_t n = ::pwrite(active_->fd, record.data(), record.size(), static_cast<off_t>(active_->size));
+    if (n != static_cast<ssize_t>(record.size())) {
+        return Status::Error(ErrnoMessage("Failed to write", active_->path));
+    }
+    location->segment = active_->id;
+    location->offset = static_cast<uint32_t>(active_->size);
+    location->size = static_cast<uint32_t>(record.size());
+    active_->size += record.size();
+    return Status::OK_STATUS();
+}
+
+Status ValueLog::Read(const ValueLocation& location, const std::string& key, std::string* value) const {
+    std::shared_ptr<Segment> segment = FindSegment(location.segment);
+    if (!segment) {
+        return Status::Error("Value log segment " + std::to_string(location.segment) + " is gone");
+    }
+    std::string record(location.size, '\0');
+    ssize_t n = ::pread(segment->fd, &record[0], record.size(), static_cast<off_t>(location.offset));
+    if (n != static_cast<ssize_t>(record.size())) {
+        return Status::Error(ErrnoMessage("Failed to read", segment->path));
+    }
+    uint32_t key_len = GetFixed32(record.data() + 4);
+    uint32_t value_len = GetFixed32(record.data() + 8);
+    if (kHeaderSize + key_len + value_len != record.size() ||
+        utils::Crc32c(record.data() + 4, record.size() - 4) != GetFixed32(record.data()) ||
+        record.compare(kHeaderSize, key_len, key) != 0) {
+        return Status::Error("Corrupt value log record in " + segment->path);
+    }
+    value->assign(record, kHeaderSize + key_len, value_len);
+    return Status::OK_STATUS();
+}
+
+void ValueLog::MarkGarbage(const ValueLocation& location) {
+    std::shared_ptr<Segment> segment = FindSegment(location.segment);
+    if (segment) {
+        segment->garbage.fetch_add(location.size, std::memory_order_relaxed);
+    }
+}
+
+bool ValueLog::PickSegmentToReclaim(double min_garbage_ratio, uint32_t* segment) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    double best_ratio = min_garbage_ratio;
+    bool found = false;
+    for (const auto& kv : segments_) {
+        const Segment& s = *kv.second;
+        if (kv.second == active_ || s.size == 0) {
+            continue;
+        }
+        double ratio = static_cast<double>(s.garbage.load(std::memory_order_relaxed)) / s.size;
+        if (ratio >= best_ratio) {
+            best_ratio = ratio;
+            *segment = s.id;
+            found = true;
+        }
+    }
+    return found;
+}
+
+Status ValueLog::ScanSegment(uint32_t id, const ScanCallback& callback) const {
+    std::shared_ptr<Segment> segment = FindSegment(id);
+    if (!segment) {
+        return Status::Error("Value log segment " + std::to_string(id) + " is gone");
+    }
+    // 段已写满，不会再变化，无需加锁
+    std::string buffer;
+    std::string key;
+    std::string value;
+    uint64_t offset = 0;
+    size_t want = kScanBufferSize;
+    while (offset < segment->size) {
+        size_t len = static_cast<size_t>(std::min<uint64_t>(want, segment->size - offset));
+        buffer.resize(len);
+        if (::pread(segment->fd, &buffer[0], len, static_cast<off_t>(offset)) != static_cast<ssize_t>(len)) {
+            return Status::Error(ErrnoMessage("Failed to read", segment->path));
+        }
+        size_t pos = 0;
+        while (len - pos >= kHeaderSize) {
+            const char* p = buffer.data() + pos;
+            uint32_t key_len = GetFixed32(p + 4);
+            size_t record_size = kHeaderSize + key_len + GetFixed32(p + 8);
+            if (len - pos < record_size) {
+                break;
+            }
+            if (utils::Crc32c(p + 4, record_size - 4) != GetFixed32(p)) {
+                return Status::Error("Corrupt value log record in " + segment->path);
+            }
+            key.assign(p + kHeaderSize, key_len);
+            value.assign(p + kHeaderSize + key_len, record_size - kHeaderSize - key_len);
+            ValueLocation location;
+            location.segment = id;
+            location.offset = static_cast<uint32_t>(offset + pos);
+            location.size = static_cast<uint32_t>(record_size);
+            callback(key, value, location);
+            pos += record_size;
+        }
+        if (pos == 0) {
+            // 单条记录比缓冲还大，下一轮按记录大小读取
+            size_t record_size = len < kHeaderSize ? 0 :
+                kHeaderSize + GetFixed32(buffer.data() + 4) + GetFixed32(buffer.data() + 8);
+            if (record_size <= len || record_size > segment->size - offset) {
+                return Status::Error("Truncated value log record in " + segment->path);
+            }
+            want = record_size;
+            continue;
+        }
+        want = kScanBufferSize;
+        offset += pos;
+    }
+    return Status::OK_STATUS();
+}
+
+void ValueLog::DropSegment(uint32_t id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = segments_.find(id);
+    if (it == segments_.end() || it->second == active_) {
+        return;
+    }
+    // 正在读取该段的读者持有shared_ptr，文件描述符在它们结束后才关闭
+    ::unlink(it->second->path.c_str());
+    segments_.erase(it);
+}
+
+Status ValueLog::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& kv : segments_) {
+        ::unlink(kv.second->path.c_str());
+    }
+    segments_.clear();
+    active_.reset();
+    return NewSegmentLocked();
+}
+
+uint64_t ValueLog::TotalBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t bytes = 0;
+    for (const auto& kv : segments_) {
+        bytes += kv.second->size;
+    }
+    return bytes;
+}
+
+uint64_t ValueLog::GarbageBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t bytes = 0;
+    for (const auto& kv : segments_) {
+        bytes += kv.second->garbage.load(std::memory_order_relaxed);
+    }
+    return bytes;
+}
+
+size_t ValueLog::SegmentCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return segments_.size();
+}
@@ -0,0 +1,85 @@
+// src/storage/value_log.h
+#ifndef VALUE_LOG_H
+#define VALUE_LOG_H
+
+#include "../core/kv_store.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// 值在值日志中的位置
+struct ValueLocation {
+    uint32_t segment = 0;
+    uint32_t offset = 0;
+    // 整条记录（含头部和key）的字节数
+    uint32_t size = 0;
+};
+
+// 只追加的值日志，由若干个段文件（NNNNNN.vlog）组成
+//
+//   记录: crc32c(4) | key长度(4) | value长度(4) | key | value
+//
+// 追加只写当前段，写满segment_bytes后换新段。每条记录带着key，回收时据此判断它是否
+// 仍被索引引用。读取是一次pread；被回收的段在最后一个读者释放后才关闭文件。
+// 值日志只是内存的延伸，不负责崩溃恢复：打开时清空目录中已有的段。
+class ValueLog {
+public:
+    static const size_t kHeaderSize = 12;
+
+    ValueLog(const std::string& dir, size_t segment_bytes);
+    ~ValueLog();
+    ValueLog(const ValueLog&) = delete;
+    ValueLog& operator=(const ValueLog&) = delete;
+
+    Status Open();
+
+    Status Append(const std::string& key, const std::string& value, ValueLocation* location);
+    // 读取location处的记录并校验crc和key
+    Status Read(const ValueLocation& location, const std::string& key, std::string* value) const;
+    // location处的记录不再被引用
+    void MarkGarbage(const ValueLocation& location);
+
+    // 选出垃圾比例不低于min_garbage_ratio且最高的已写满段，没有时返回false
+    bool PickSegmentToReclaim(double min_garbage_ratio, uint32_t* segment) const;
+    using ScanCallback = std::function<void(const std::string& key, const std::string& value,
+                                            const ValueLocation& location)>;
+    // 顺序读取段中的全部记录
+    Status ScanSegment(uint32_t segment, const ScanCallback& callback) const;
+    // 删除段文件，调用前其中仍被引用的记录必须都已搬走
+    void DropSegment(uint32_t segment);
+    // 删除全部段并重新开始
+    Status Clear();
+
+    // 所有段文件的总大小，以及其中已不被引用的字节数
+    uint64_t TotalBytes() const;
+    uint64_t GarbageBytes() const;
+    size_t SegmentCount() const;
+
+private:
+    struct Segment {
+        ~Segment();
+        uint32_t id = 0;
+        int fd = -1;
+        std::string path;
+        uint64_t size = 0;
+        std::atomic<uint64_t> garbage{0};
+    };
+
+    std::string SegmentPath(uint32_t id) const;
+    // 要求持有mutex_
+    Status NewSegmentLocked();
+    std::shared_ptr<Segment> FindSegment(uint32_t id) const;
+
+    std::string dir_;
+    size_t segment_bytes_;
+    mutable std::mutex mutex_;
+    std::map<uint32_t, std::shared_ptr<Segment>> segments_;
+    std::shared_ptr<Segment> active_;
+    uint32_t next_segment_;
+};
+
+#endif // VALUE_LOG_H
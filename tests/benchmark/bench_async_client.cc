@@ -0,0 +1,180 @@
+// tests/benchmark/bench_async_client.cc
+// 单个调用线程能驱动的吞吐：同步KVClient逐条请求，对比AsyncClient在每个节点一条连接上流水线发送
+//
+// 服务器在子进程中运行（每个节点一个进程，epoll模式）。AsyncClient分两种用法测量：
+//   futures    环形保存window个future，复用槽位前先get()最老的结果
+//   callbacks  回调里计数，在途请求达到window时调用线程让出CPU等待
+// 客户端每条同步命令都向stdout输出日志，测量期间stdout重定向到/dev/null，结果写到原来的stdout。
+//
+// 用法: bench_async_client [ops] [window] [nodes]
+#include "src/client/async_client.h"
+#include "src/client/kv_client.h"
+#include "src/core/kv_store.h"
+#include "src/network/simple_server.h"
+#include "src/common/logger.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+FILE* report = nullptr;
+
+pid_t StartServer(int port) {
+    pid_t pid = fork();
+    if (pid != 0) {
+        return pid;
+    }
+    Logger::instance().set_level(ERROR);
+    ServerOptions options;
+    options.io_model = IO_EPOLL;
+    options.reactor_threads = 1;
+    SimpleServer server(port, KVStore::CreateMemoryStore(), options);
+    if (!server.Start()) {
+        _exit(1);
+    }
+    for (;;) {
+        pause();
+    }
+}
+
+bool WaitForServer(int port) {
+    for (int i = 0; i < 200; ++i) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        struct sockaddr_in addr;
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bool connected = connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0;
+        close(fd);
+        if (connected) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+
+void Report(const char* name, long ops, long failed, Clock::time_point begin) {
+    double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+    std::fprintf(report, "%-22s %10ld %12.0f %8ld\n", name, ops, ops / seconds, failed);
+    std::fflush(report);
+}
+
+std::string Key(long i) {
+    return "key:" + std::to_string(i % 100000);
+}
+
+// 同一个线程里始终保持最多window个在途请求
+void RunFutures(const char* name, long ops, size_t window,
+                const std::function<std::future<RespReply>(long)>& issue, RespReply::Type expected) {
+    std::vector<std::future<RespReply>> ring(window);
+    long failed = 0;
+    auto begin = Clock::now();
+    for (long i = 0; i < ops + static_cast<long>(window); ++i) {
+        std::future<RespReply>& slot = ring[static_cast<size_t>(i) % window];
+        if (slot.valid() && slot.get().type != expected) {
+            failed++;
+        }
+        if (i < ops) {
+            slot = issue(i);
+        }
+    }
+    Report(name, ops, failed, begin);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    long ops = argc > 1 ? std::atol(argv[1]) : 2000000;
+    size_t window = argc > 2 ? static_cast<size_t>(std::atol(argv[2])) : 1024;
+    int nodes = argc > 3 ? std::atoi(argv[3]) : 1;
+    signal(SIGPIPE, SIG_IGN);
+    Logger::instance().set_level(ERROR);
+
+    int base_port = 30000 + getpid() % 20000;
+    std::vector<pid_t> servers;
+    std::string json = "{\"nodes\": [";
+    for (int i = 0; i < nodes; ++i) {
+        servers.push_back(StartServer(base_port + i));
+        json += std::string(i ? ", " : "") + "{\"port\": " + std::to_string(base_port + i) + "}";
+    }
+    json += "]}";
+    bool started = true;
+    for (int i = 0; i < nodes; ++i) {
+        started = started && WaitForServer(base_port + i);
+    }
+
+    report = fdopen(dup(STDOUT_FILENO), "w");
+    if (!started || !report || !std::freopen("/dev/null", "w", stdout)) {
+        std::fprintf(stderr, "setup failed\n");
+        for (pid_t pid : servers) {
+            kill(pid, SIGKILL);
+            waitpid(pid, nullptr, 0);
+        }
+        return 1;
+    }
+    ClusterConfig::getInstance().loadFromJson(json);
+
+    std::fprintf(report, "%d node(s), window %zu, %u CPUs online\n", nodes, window,
+                 std::thread::hardware_concurrency());
+    std::fprintf(report, "%-22s %10s %12s %8s\n", "mode", "ops", "ops/s", "failed");
+    {
+        KVClient client;
+        long sync_ops = std::min(ops, 20000L);
+        long failed = 0;
+        auto begin = Clock::now();
+        for (long i = 0; i < sync_ops; ++i) {
+            failed += client.put(Key(i), "value") ? 0 : 1;
+        }
+        Report("sync put", sync_ops, failed, begin);
+    }
+    {
+        AsyncClient client;
+        std::string value(16, 'v');
+        RunFutures("async put (futures)", ops, window,
+                   [&](long i) { return client.putAsync(Key(i), value); }, RespReply::STATUS);
+        RunFutures("async get (futures)", ops, window,
+                   [&](long i) { return client.getAsync(Key(i)); }, RespReply::BULK);
+
+        std::atomic<long> done{0};
+        std::atomic<long> failed{0};
+        AsyncClient::Callback callback = [&](const RespReply& reply) {
+            if (reply.type != RespReply::BULK) {
+                failed.fetch_add(1, std::memory_order_relaxed);
+            }
+            done.fetch_add(1, std::memory_order_release);
+        };
+        auto begin = Clock::now();
+        for (long i = 0; i < ops; ++i) {
+            while (i - done.load(std::memory_order_acquire) >= static_cast<long>(window)) {
+                std::this_thread::yield();
+            }
+            client.getAsync(Key(i), callback);
+        }
+        while (done.load(std::memory_order_acquire) < ops) {
+            std::this_thread::yield();
+        }
+        Report("async get (callbacks)", ops, failed.load(), begin);
+    }
+
+    for (pid_t pid : servers) {
+        kill(pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+    }
+    return 0;
+}
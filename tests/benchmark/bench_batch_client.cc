@@ -0,0 +1,154 @@
+// tests/benchmark/bench_batch_client.cc
+// 批量读写的延迟：逐个key调用get/put（每个key一次往返）对比按节点分组的batchGet/batchPut
+//
+// 每个节点一个子进程服务器（epoll模式）。先测一次PING的往返时间作为参照，
+// 再对batch个随机key分别逐个和批量执行rounds轮，报告每批的平均耗时。
+// 客户端每条命令都向stdout输出日志，测量期间stdout重定向到/dev/null，结果写到原来的stdout。
+//
+// 用法: bench_batch_client [batch] [nodes] [rounds]
+#include "src/client/kv_client.h"
+#include "src/core/kv_store.h"
+#include "src/network/simple_server.h"
+#include "src/common/logger.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+FILE* report = nullptr;
+
+pid_t StartServer(int port) {
+    pid_t pid = fork();
+    if (pid != 0) {
+        return pid;
+    }
+    Logger::instance().set_level(ERROR);
+    ServerOptions options;
+    options.io_model = IO_EPOLL;
+    options.reactor_threads = 1;
+    SimpleServer server(port, KVStore::CreateMemoryStore(), options);
+    if (!server.Start()) {
+        _exit(1);
+    }
+    for (;;) {
+        pause();
+    }
+}
+
+bool WaitForServer(int port) {
+    for (int i = 0; i < 200; ++i) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        struct sockaddr_in addr;
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bool connected = connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0;
+        close(fd);
+        if (connected) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+
+// 执行rounds轮，输出每轮平均耗时，返回该值（微秒）
+double Measure(const char* name, int rounds, const std::function<bool()>& run) {
+    int failed = 0;
+    auto begin = Clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        failed += run() ? 0 : 1;
+    }
+    double us = std::chrono::duration<double, std::micro>(Clock::now() - begin).count() / rounds;
+    std::fprintf(report, "%-16s %12.1f %8d\n", name, us, failed);
+    std::fflush(report);
+    return us;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t batch = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 1000;
+    int nodes = argc > 2 ? std::atoi(argv[2]) : 3;
+    int rounds = argc > 3 ? std::atoi(argv[3]) : 50;
+    signal(SIGPIPE, SIG_IGN);
+    Logger::instance().set_level(ERROR);
+
+    int base_port = 30000 + getpid() % 20000;
+    std::vector<pid_t> servers;
+    std::string json = "{\"nodes\": [";
+    bool started = true;
+    for (int i = 0; i < nodes; ++i) {
+        servers.push_back(StartServer(base_port + i));
+        json += std::string(i ? ", " : "") + "{\"port\": " + std::to_string(base_port + i) + "}";
+    }
+    for (int i = 0; i < nodes; ++i) {
+        started = started && WaitForServer(base_port + i);
+    }
+    report = fdopen(dup(STDOUT_FILENO), "w");
+    if (!started || !report || !std::freopen("/dev/null", "w", stdout)) {
+        std::fprintf(stderr, "setup failed\n");
+        for (pid_t pid : servers) {
+            kill(pid, SIGKILL);
+            waitpid(pid, nullptr, 0);
+        }
+        return 1;
+    }
+    ClusterConfig::getInstance().loadFromJson(json + "]}");
+
+    std::vector<std::pair<std::string, std::string>> kvs;
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < batch; ++i) {
+        keys.push_back("key:" + std::to_string(i * 7919 % 1000003));
+        kvs.emplace_back(keys.back(), "value" + std::to_string(i));
+    }
+
+    KVClient client;
+    std::fprintf(report, "%zu keys per batch, %d node(s), %d rounds\n", batch, nodes, rounds);
+    std::fprintf(report, "%-16s %12s %8s\n", "mode", "us/batch", "failed");
+    double rtt = Measure("ping (1 RTT)", rounds * 10, [&]() { return client.ping(); });
+    double loop_put = Measure("loop put", rounds, [&]() {
+        bool ok = true;
+        for (const auto& kv : kvs) {
+            ok = client.put(kv.first, kv.second) && ok;
+        }
+        return ok;
+    });
+    double batch_put = Measure("batchPut", rounds, [&]() { return client.batchPut(kvs); });
+    double loop_get = Measure("loop get", rounds, [&]() {
+        bool ok = true;
+        for (const std::string& key : keys) {
+            ok = !client.get(key).empty() && ok;
+        }
+        return ok;
+    });
+    double batch_get = Measure("batchGet", rounds, [&]() {
+        bool ok = true;
+        for (const KeyResult& result : client.batchGet(keys)) {
+            ok = ok && result.found;
+        }
+        return ok;
+    });
+    std::fprintf(report, "put speedup %.1fx, get speedup %.1fx, batchGet = %.1f RTT\n", loop_put / batch_put,
+                 loop_get / batch_get, batch_get / rtt);
+
+    for (pid_t pid : servers) {
+        kill(pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+    }
+    return 0;
+}
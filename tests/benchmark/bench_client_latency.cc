@@ -0,0 +1,142 @@
+// tests/benchmark/bench_client_latency.cc
+// 客户端单key命令的延迟：每条命令新建连接（原来KVClient的做法）对比从连接池复用连接
+//
+// 进程内启动一个epoll服务器，依次测量：
+//   reconnect    每条命令新建Connection、握手、执行、关闭
+//   pooled       从ConnectionPool借连接执行，用完归还
+//   KVClient     经过路由和重试的put/get（多个线程共享一个连接池）
+// 客户端每条命令都向stdout输出日志，测量期间stdout重定向到/dev/null，结果写到原来的stdout。
+//
+// 用法: bench_client_latency [ops] [threads]
+#include "src/client/connection_pool.h"
+#include "src/client/kv_client.h"
+#include "src/core/kv_store.h"
+#include "src/network/simple_server.h"
+#include "src/common/logger.h"
+#include <signal.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+FILE* report = nullptr;
+
+// threads个线程各执行ops次op(thread, i)，输出平均、p50、p99延迟
+void Measure(const char* name, int ops, int threads, const std::function<bool(int, int)>& op) {
+    std::vector<std::vector<double>> latencies(threads);
+    std::vector<int> failures(threads, 0);
+    std::vector<std::thread> workers;
+    auto begin = Clock::now();
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            latencies[t].reserve(ops);
+            for (int i = 0; i < ops; ++i) {
+                auto start = Clock::now();
+                if (!op(t, i)) {
+                    failures[t]++;
+                }
+                latencies[t].push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - begin).count();
+    std::vector<double> all;
+    int failed = 0;
+    for (int t = 0; t < threads; ++t) {
+        all.insert(all.end(), latencies[t].begin(), latencies[t].end());
+        failed += failures[t];
+    }
+    std::sort(all.begin(), all.end());
+    double sum = 0;
+    for (double us : all) {
+        sum += us;
+    }
+    std::fprintf(report, "%-22s %8.1f %8.1f %8.1f %12.0f %8d\n", name, sum / all.size(), all[all.size() / 2],
+                 all[all.size() * 99 / 100], all.size() / elapsed, failed);
+    std::fflush(report);
+}
+
+bool Execute(Connection* connection, const std::vector<std::string>& args) {
+    RespReply reply;
+    return connection->sendCommand(args) && connection->receiveReply(&reply) && reply.type != RespReply::ERROR;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int ops = argc > 1 ? std::atoi(argv[1]) : 5000;
+    int threads = argc > 2 ? std::atoi(argv[2]) : 4;
+    signal(SIGPIPE, SIG_IGN);
+    Logger::instance().set_level(ERROR);
+
+    ServerOptions options;
+    options.io_model = IO_EPOLL;
+    options.reactor_threads = 1;
+    std::shared_ptr<KVStore> store = KVStore::CreateMemoryStore();
+    int port = 30000 + getpid() % 20000;
+    std::unique_ptr<SimpleServer> server;
+    for (int attempt = 0; attempt < 10 && !server; ++attempt, ++port) {
+        server.reset(new SimpleServer(port, store, options));
+        if (!server->Start()) {
+            server.reset();
+        }
+    }
+    if (!server) {
+        std::fprintf(stderr, "server did not start\n");
+        return 1;
+    }
+    port--;
+
+    report = fdopen(dup(STDOUT_FILENO), "w");
+    if (!report || !std::freopen("/dev/null", "w", stdout)) {
+        std::fprintf(stderr, "cannot redirect stdout\n");
+        return 1;
+    }
+
+    NodeInfo node;
+    node.id = "server-1";
+    node.host = "127.0.0.1";
+    node.port = port;
+    ClusterConfig::getInstance().loadFromJson("{\"nodes\": [{\"id\": \"server-1\", \"port\": " +
+                                              std::to_string(port) + "}]}");
+    store->Put("key", "value");
+
+    std::fprintf(report, "%d ops per thread\n", ops);
+    std::fprintf(report, "%-22s %8s %8s %8s %12s %8s\n", "mode", "avg us", "p50 us", "p99 us", "ops/s", "failed");
+    Measure("reconnect GET", ops, 1, [&](int, int) {
+        Connection connection(node.host, node.port);
+        return connection.connect() && Execute(&connection, {"GET", "key"});
+    });
+    ConnectionPool pool;
+    Measure("pooled GET", ops, 1, [&](int, int) {
+        ConnectionPool::Lease connection = pool.acquire(node);
+        return connection && Execute(connection.get(), {"GET", "key"});
+    });
+
+    auto shared = std::make_shared<ConnectionPool>();
+    KVClient client(shared);
+    Measure("KVClient put", ops, 1, [&](int, int i) { return client.put("key" + std::to_string(i), "value"); });
+    Measure("KVClient get", ops, 1, [&](int, int i) { return !client.get("key" + std::to_string(i)).empty(); });
+    if (threads > 1) {
+        std::string name = "KVClient get x" + std::to_string(threads);
+        Measure(name.c_str(), ops, threads, [&](int, int i) { return !client.get("key" + std::to_string(i)).empty(); });
+    }
+    PoolStats stats = shared->getStats();
+    std::fprintf(report, "KVClient pool: %zu connections created, %zu reuses\n", stats.created, stats.reused);
+
+    server->Stop();
+    return 0;
+}
@@ -0,0 +1,269 @@
+// tests/benchmark/bench_connections.cc
+// 大量空闲连接加少量活跃连接时，比较每连接一个线程、epoll事件循环和io_uring事件循环三种模式
+//
+// 服务器在子进程中运行（两端的fd分属不同进程，不会一起撞上RLIMIT_NOFILE）。先建立idle个
+// 只连接不发请求的空闲连接，再由若干客户端线程驱动active个活跃连接：每轮在各自的每个连接上
+// 发一条GET，再依次读回响应。报告建连耗时、吞吐、请求延迟、服务器进程的线程数和RSS，
+// 以及压测期间平均每个请求的系统调用数（服务器自己统计，由压测前后的INFO相减得到）。
+//
+// 用法: bench_connections [idle] [active] [seconds] [reactors]
+#include "src/core/kv_store.h"
+#include "src/network/simple_server.h"
+#include "src/common/logger.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int kClientThreads = 4;
+
+using Clock = std::chrono::steady_clock;
+
+void RaiseFdLimit() {
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+int Connect(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    struct sockaddr_in addr;
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+// 读一行响应，连接出错时返回false
+bool ReadLine(int fd) {
+    char buffer[256];
+    for (;;) {
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0) {
+            return false;
+        }
+        if (buffer[n - 1] == '\n') {
+            return true;
+        }
+    }
+}
+
+// 发送INFO并取出io_requests和io_syscalls
+bool QueryIoCounters(int fd, double* requests, double* syscalls) {
+    const std::string info = "INFO\n";
+    send(fd, info.data(), info.size(), MSG_NOSIGNAL);
+    std::string line;
+    char buffer[1024];
+    while (line.empty() || line.back() != '\n') {
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0) {
+            return false;
+        }
+        line.append(buffer, static_cast<size_t>(n));
+    }
+    size_t r = line.find("io_requests=");
+    size_t s = line.find("io_syscalls=");
+    if (r == std::string::npos || s == std::string::npos) {
+        return false;
+    }
+    *requests = std::atof(line.c_str() + r + 12);
+    *syscalls = std::atof(line.c_str() + s + 12);
+    return true;
+}
+
+// 读取/proc/<pid>/status中的一个数值字段
+long ReadProcStatus(pid_t pid, const std::string& field) {
+    std::ifstream in("/proc/" + std::to_string(pid) + "/status");
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.compare(0, field.size() + 1, field + ":") == 0) {
+            return std::atol(line.c_str() + field.size() + 1);
+        }
+    }
+    return -1;
+}
+
+pid_t StartServer(IoModel model, int port, size_t reactors) {
+    pid_t pid = fork();
+    if (pid != 0) {
+        return pid;
+    }
+    RaiseFdLimit();
+    Logger::instance().set_level(ERROR);
+    ServerOptions options;
+    options.io_model = model;
+    options.reactor_threads = reactors;
+    SimpleServer server(port, KVStore::CreateMemoryStore(), options);
+    if (!server.Start()) {
+        _exit(1);
+    }
+    for (;;) {
+        pause();
+    }
+}
+
+struct Result {
+    double connect_seconds = 0;
+    int failed_connections = 0;
+    double requests_per_second = 0;
+    double p50_us = 0;
+    double p99_us = 0;
+    long server_threads = 0;
+    long server_rss_kb = 0;
+    double syscalls_per_request = 0;
+};
+
+Result Run(IoModel model, int port, int idle, int active, double seconds, size_t reactors) {
+    Result result;
+    pid_t pid = StartServer(model, port, reactors);
+    // 等服务器开始监听
+    int probe = -1;
+    for (int i = 0; i < 200 && (probe = Connect(port)) < 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    if (probe < 0) {
+        std::fprintf(stderr, "server did not start\n");
+        kill(pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+        return result;
+    }
+    const std::string set = "SET bench_key bench_value\n";
+    send(probe, set.data(), set.size(), MSG_NOSIGNAL);
+    ReadLine(probe);
+
+    std::vector<int> fds;
+    auto begin = Clock::now();
+    for (int i = 0; i < idle + active; ++i) {
+        int fd = Connect(port);
+        if (fd < 0) {
+            result.failed_connections++;
+        } else {
+            fds.push_back(fd);
+        }
+    }
+    result.connect_seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+    std::vector<int> active_fds(fds.end() - std::min<size_t>(fds.size(), active), fds.end());
+
+    std::atomic<bool> stop{false};
+    std::vector<std::vector<double>> latencies(kClientThreads);
+    std::vector<long> done(kClientThreads, 0);
+    std::vector<std::thread> threads;
+    const std::string get = "GET bench_key\n";
+    for (int t = 0; t < kClientThreads; ++t) {
+        threads.emplace_back([&, t]() {
+            std::vector<int> mine;
+            for (size_t i = t; i < active_fds.size(); i += kClientThreads) {
+                mine.push_back(active_fds[i]);
+            }
+            std::vector<Clock::time_point> sent(mine.size());
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (size_t i = 0; i < mine.size(); ++i) {
+                    sent[i] = Clock::now();
+                    send(mine[i], get.data(), get.size(), MSG_NOSIGNAL);
+                }
+                for (size_t i = 0; i < mine.size(); ++i) {
+                    if (!ReadLine(mine[i])) {
+                        return;
+                    }
+                    latencies[t].push_back(
+                        std::chrono::duration<double, std::micro>(Clock::now() - sent[i]).count());
+                }
+                done[t] += static_cast<long>(mine.size());
+            }
+        });
+    }
+    double requests_before = 0;
+    double syscalls_before = 0;
+    QueryIoCounters(probe, &requests_before, &syscalls_before);
+    auto load_begin = Clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds / 2));
+    result.server_threads = ReadProcStatus(pid, "Threads");
+    result.server_rss_kb = ReadProcStatus(pid, "VmRSS");
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds / 2));
+    stop = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - load_begin).count();
+    double requests_after = 0;
+    double syscalls_after = 0;
+    if (QueryIoCounters(probe, &requests_after, &syscalls_after) && requests_after > requests_before) {
+        result.syscalls_per_request = (syscalls_after - syscalls_before) / (requests_after - requests_before);
+    }
+
+    long total = 0;
+    std::vector<double> all;
+    for (int t = 0; t < kClientThreads; ++t) {
+        total += done[t];
+        all.insert(all.end(), latencies[t].begin(), latencies[t].end());
+    }
+    result.requests_per_second = total / elapsed;
+    if (!all.empty()) {
+        std::sort(all.begin(), all.end());
+        result.p50_us = all[all.size() / 2];
+        result.p99_us = all[all.size() * 99 / 100];
+    }
+
+    for (int fd : fds) {
+        close(fd);
+    }
+    close(probe);
+    kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+    return result;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int idle = argc > 1 ? std::atoi(argv[1]) : 10000;
+    int active = argc > 2 ? std::atoi(argv[2]) : 1000;
+    double seconds = argc > 3 ? std::atof(argv[3]) : 4.0;
+    size_t reactors = argc > 4 ? static_cast<size_t>(std::atoi(argv[4])) : 0;
+    RaiseFdLimit();
+    Logger::instance().set_level(ERROR);
+    int port = 30000 + getpid() % 20000;
+
+    std::printf("%d idle + %d active connections, %.1fs per run\n", idle, active, seconds);
+    std::printf("%-8s %10s %8s %12s %10s %10s %9s %10s %13s\n", "mode", "connect_s", "failed", "requests/s",
+                "p50_us", "p99_us", "threads", "rss_mb", "syscalls/req");
+    struct Mode {
+        const char* name;
+        IoModel model;
+    };
+    for (const Mode& mode : {Mode{"threads", IO_THREAD_PER_CONNECTION}, Mode{"epoll", IO_EPOLL},
+                             Mode{"io_uring", IO_URING}}) {
+        Result r = Run(mode.model, port++, idle, active, seconds, reactors);
+        std::printf("%-8s %10.2f %8d %12.0f %10.0f %10.0f %9ld %10.1f %13.3f\n", mode.name, r.connect_seconds,
+                    r.failed_connections, r.requests_per_second, r.p50_us, r.p99_us, r.server_threads,
+                    r.server_rss_kb / 1024.0, r.syscalls_per_request);
+    }
+    return 0;
+}
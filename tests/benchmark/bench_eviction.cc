@@ -0,0 +1,107 @@
+// tests/benchmark/bench_eviction.cc
+// 在Zipfian分布的缓存负载下比较各淘汰策略的命中率和吞吐
+//
+// 模拟旁路缓存：GET未命中时从"数据库"取回并SET进缓存，缓存上限只能容纳部分key。
+// 用法: bench_eviction [num_keys] [num_ops] [cache_percent] [theta]
+//       (默认100万个key、500万次请求、缓存10%的key、theta=0.99)
+#include "src/core/kv_store.h"
+#include "src/core/flat_hash_table.h"
+#include "src/common/logger.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+
+namespace {
+
+const size_t kValueSize = 100;
+
+// YCSB的Zipfian生成器（Gray等人的方法），返回[0, n)，0最热
+class ZipfianGenerator {
+public:
+    ZipfianGenerator(size_t n, double theta) : n_(n), theta_(theta), rng_(42), uniform_(0.0, 1.0) {
+        double zeta2 = 0;
+        for (size_t i = 1; i <= 2; ++i) {
+            zeta2 += 1.0 / std::pow(static_cast<double>(i), theta);
+        }
+        zetan_ = 0;
+        for (size_t i = 1; i <= n; ++i) {
+            zetan_ += 1.0 / std::pow(static_cast<double>(i), theta);
+        }
+        alpha_ = 1.0 / (1.0 - theta);
+        eta_ = (1.0 - std::pow(2.0 / n, 1.0 - theta)) / (1.0 - zeta2 / zetan_);
+    }
+
+    size_t Next() {
+        double u = uniform_(rng_);
+        double uz = u * zetan_;
+        if (uz < 1.0) {
+            return 0;
+        }
+        if (uz < 1.0 + std::pow(0.5, theta_)) {
+            return 1;
+        }
+        size_t v = static_cast<size_t>(n_ * std::pow(eta_ * u - eta_ + 1.0, alpha_));
+        return v < n_ ? v : n_ - 1;
+    }
+
+private:
+    size_t n_;
+    double theta_;
+    double zetan_;
+    double alpha_;
+    double eta_;
+    std::mt19937_64 rng_;
+    std::uniform_real_distribution<double> uniform_;
+};
+
+std::string Key(size_t i) {
+    // 打散热点key的编号，避免热度与插入顺序相关
+    return "key:" + std::to_string(i * 0x9e3779b97f4a7c15ull % 1000000007ull);
+}
+
+void Run(const char* policy, size_t num_keys, size_t num_ops, size_t maxmemory, double theta) {
+    auto store = KVStore::CreateMemoryStore(maxmemory, policy);
+    ZipfianGenerator zipf(num_keys, theta);
+    std::string value;
+    const std::string fetched(kValueSize, 'v');
+
+    auto begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < num_ops; ++i) {
+        std::string key = Key(zipf.Next());
+        if (!store->Get(key, value).ok()) {
+            store->Put(key, fetched);
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    StoreStats stats = store->GetStats();
+    double hit_ratio = static_cast<double>(stats.hits) / (stats.hits + stats.misses);
+    std::printf("%-8s %10.2f%% %14.0f %12zu %12zu\n", policy, hit_ratio * 100, num_ops / seconds,
+                stats.evictions, stats.keys);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    Logger::instance().set_level(ERROR);
+
+    size_t num_keys = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    size_t num_ops = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 5000000;
+    double cache_percent = argc > 3 ? std::atof(argv[3]) : 10.0;
+    double theta = argc > 4 ? std::atof(argv[4]) : 0.99;
+
+    size_t record_bytes = FlatHashTable::RecordBytes(Key(num_keys).size(), kValueSize);
+    size_t maxmemory = static_cast<size_t>(num_keys * cache_percent / 100 * record_bytes);
+
+    std::printf("%zu keys, %zu ops, zipf theta=%.2f, maxmemory=%zu (~%.0f%% of keys)\n", num_keys, num_ops,
+                theta, maxmemory, cache_percent);
+    std::printf("%-8s %11s %14s %12s %12s\n", "policy", "hit ratio", "ops/s", "evictions", "keys");
+    Run("lru", num_keys, num_ops, maxmemory, theta);
+    Run("lfu", num_keys, num_ops, maxmemory, theta);
+    Run("clock", num_keys, num_ops, maxmemory, theta);
+    return 0;
+}
@@ -0,0 +1,90 @@
+// tests/benchmark/bench_flat_table.cc
+// 对比 FlatHashTable 与 unordered_map<string,string> 的每条目内存和读写延迟
+//
+// 用法: bench_flat_table [num_keys]    (默认1000万个小key)
+#include "src/core/flat_hash_table.h"
+#include <malloc.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+size_t HeapInUse() {
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+double NsPerOp(std::chrono::steady_clock::time_point begin, size_t ops) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count() / ops;
+}
+
+std::string Key(size_t i) {
+    return "key:" + std::to_string(i);
+}
+
+template <typename InsertFn, typename FindFn>
+void Run(const char* name, size_t num_keys, const std::vector<size_t>& lookup_order,
+         InsertFn insert, FindFn find) {
+    size_t heap_before = HeapInUse();
+
+    auto begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < num_keys; ++i) {
+        insert(Key(i), "val" + std::to_string(i % 100000));
+    }
+    double insert_ns = NsPerOp(begin, num_keys);
+    size_t heap_after = HeapInUse();
+
+    std::string value;
+    size_t hits = 0;
+    begin = std::chrono::steady_clock::now();
+    for (size_t i : lookup_order) {
+        hits += find(Key(i), &value);
+    }
+    double find_ns = NsPerOp(begin, lookup_order.size());
+
+    std::printf("%-16s %10.1f %14.1f %14.1f   (hits=%zu)\n", name,
+                static_cast<double>(heap_after - heap_before) / num_keys, insert_ns, find_ns, hits);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t num_keys = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+
+    std::vector<size_t> lookup_order(num_keys);
+    for (size_t i = 0; i < num_keys; ++i) {
+        lookup_order[i] = i;
+    }
+    std::shuffle(lookup_order.begin(), lookup_order.end(), std::mt19937_64(1));
+
+    std::printf("%zu keys (key ~12B, value ~8B)\n", num_keys);
+    std::printf("%-16s %10s %14s %14s\n", "table", "bytes/key", "insert ns/op", "lookup ns/op");
+
+    {
+        std::unordered_map<std::string, std::string> map;
+        Run("unordered_map", num_keys, lookup_order,
+            [&](const std::string& k, const std::string& v) { map[k] = v; },
+            [&](const std::string& k, std::string* v) {
+                auto it = map.find(k);
+                if (it == map.end()) {
+                    return false;
+                }
+                *v = it->second;
+                return true;
+            });
+    }
+    malloc_trim(0);
+    {
+        FlatHashTable table;
+        Run("FlatHashTable", num_keys, lookup_order,
+            [&](const std::string& k, const std::string& v) { table.Insert(k, v); },
+            [&](const std::string& k, std::string* v) { return table.Find(k, v); });
+    }
+    return 0;
+}
@@ -0,0 +1,116 @@
+// tests/benchmark/bench_hash_ring.cc
+// 比较哈希取模与一致性哈希在扩缩容时的key迁移量和负载均衡程度
+//
+// 对keys个key，分别用哈希取模和不同虚拟节点数的一致性哈希：
+//   imbalance  nodes个节点时负载最大的节点相对平均值的比例（1.00为完全均衡）
+//   add        增加一个节点后改变归属的key比例（理想值1/(nodes+1)）
+//   remove     去掉一个节点后改变归属的key比例（理想值1/nodes）
+//   lookup     每次查找的耗时
+//
+// 用法: bench_hash_ring [keys] [nodes]
+#include "src/client/hash_ring.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Members = std::vector<std::pair<std::string, int>>;
+// 返回key归属的节点id
+using Locator = std::function<std::string(const std::string&)>;
+
+Members MakeMembers(int count) {
+    Members members;
+    for (int i = 1; i <= count; ++i) {
+        members.emplace_back("server-" + std::to_string(i), 1);
+    }
+    return members;
+}
+
+Locator Modulo(const Members& members) {
+    return [members](const std::string& key) {
+        return members[HashRing::hash(key) % members.size()].first;
+    };
+}
+
+Locator Ring(const Members& members, int virtual_nodes) {
+    auto ring = std::make_shared<HashRing>();
+    ring->build(members, virtual_nodes);
+    return [members, ring](const std::string& key) { return members[ring->nodeIndex(key)].first; };
+}
+
+double MovedFraction(const std::vector<std::string>& keys, const Locator& before, const Locator& after) {
+    size_t moved = 0;
+    for (const std::string& key : keys) {
+        moved += before(key) != after(key) ? 1 : 0;
+    }
+    return static_cast<double>(moved) / keys.size();
+}
+
+double Imbalance(const std::vector<std::string>& keys, const Members& members, const Locator& locate) {
+    std::vector<size_t> load(members.size(), 0);
+    for (const std::string& key : keys) {
+        std::string owner = locate(key);
+        for (size_t n = 0; n < members.size(); ++n) {
+            if (members[n].first == owner) {
+                load[n]++;
+                break;
+            }
+        }
+    }
+    double average = static_cast<double>(keys.size()) / members.size();
+    return *std::max_element(load.begin(), load.end()) / average;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 1000000;
+    int nodes = argc > 2 ? std::atoi(argv[2]) : 3;
+    std::vector<std::string> keys;
+    keys.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        keys.push_back("user:" + std::to_string(i));
+    }
+
+    Members base = MakeMembers(nodes);
+    Members grown = MakeMembers(nodes + 1);
+    Members shrunk = base;
+    shrunk.erase(shrunk.begin());
+
+    std::printf("%zu keys, %d nodes (+1: ideal %.1f%% moved, -1: ideal %.1f%% moved)\n", count, nodes,
+                100.0 / (nodes + 1), 100.0 / nodes);
+    std::printf("%-18s %10s %10s %10s %12s\n", "strategy", "imbalance", "add %", "remove %", "lookup ns");
+    // virtual_nodes为0表示哈希取模
+    for (int virtual_nodes : {0, 10, 40, 160, 640}) {
+        auto make = [virtual_nodes](const Members& members) {
+            return virtual_nodes == 0 ? Modulo(members) : Ring(members, virtual_nodes);
+        };
+        Locator locate = make(base);
+        double imbalance = Imbalance(keys, base, locate);
+        double added = MovedFraction(keys, locate, make(grown));
+        double removed = MovedFraction(keys, locate, make(shrunk));
+
+        // 只计查找本身，不经过Locator的std::function和字符串复制
+        HashRing ring;
+        ring.build(base, virtual_nodes);
+        // volatile防止编译器省掉查找
+        volatile size_t sink = 0;
+        auto begin = Clock::now();
+        for (const std::string& key : keys) {
+            sink = sink + (virtual_nodes == 0 ? HashRing::hash(key) % base.size() : ring.nodeIndex(key));
+        }
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / keys.size();
+
+        std::string name = virtual_nodes == 0 ? "simple_hash" : "consistent x" + std::to_string(virtual_nodes);
+        std::printf("%-18s %10.3f %10.1f %10.1f %12.1f\n", name.c_str(), imbalance, added * 100, removed * 100, ns);
+    }
+    return 0;
+}
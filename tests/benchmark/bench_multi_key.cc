@@ -0,0 +1,213 @@
+// tests/benchmark/bench_multi_key.cc
+// 比较批量读取（MultiGet / MGET）与逐个GET的每秒key数
+//
+// 存储层：在MemoryStore和ShardedMemoryStore上，每批随机取batch个key，分别用循环Get和一次MultiGet读取，
+// 多个线程同时读取时还能看到每批一次加锁减少的锁竞争。
+// 网络层：进程内的epoll服务器，同一个连接上每次往返发送一条GET，或一条带batch个key的MGET。
+//
+// 用法: bench_multi_key [num_keys] [batch] [threads] [seconds]
+#include "src/core/kv_store.h"
+#include "src/network/simple_server.h"
+#include "src/common/protocol.h"
+#include "src/common/logger.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::string Key(size_t i) {
+    return "key:" + std::to_string(i);
+}
+
+// threads个线程各自随机读取seconds秒，返回每秒读取的key数
+double StoreKeysPerSecond(KVStore* store, size_t num_keys, size_t batch, int threads, double seconds, bool multi) {
+    std::atomic<bool> stop{false};
+    std::vector<long> done(threads, 0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            std::mt19937_64 rng(static_cast<unsigned>(t + 1));
+            std::uniform_int_distribution<size_t> dist(0, num_keys - 1);
+            std::vector<std::string> keys(batch);
+            std::vector<std::string> values;
+            std::vector<char> found;
+            std::string value;
+            long reads = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (size_t i = 0; i < batch; ++i) {
+                    keys[i] = Key(dist(rng));
+                }
+                if (multi) {
+                    store->MultiGet(keys, &values, &found);
+                } else {
+                    for (const std::string& key : keys) {
+                        store->Get(key, value);
+                    }
+                }
+                reads += static_cast<long>(batch);
+            }
+            done[t] = reads;
+        });
+    }
+    auto begin = Clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop = true;
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - begin).count();
+    long total = 0;
+    for (long n : done) {
+        total += n;
+    }
+    return total / elapsed;
+}
+
+int Connect(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    struct sockaddr_in addr;
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+bool SendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// 读到一个完整的RESP响应为止
+bool ReadReply(int fd, std::string* buffer) {
+    char chunk[64 * 1024];
+    for (;;) {
+        RespReply reply;
+        size_t consumed = 0;
+        int ret = ProtocolParser::ParseRespReply(buffer->data(), buffer->size(), &reply, &consumed);
+        if (ret < 0) {
+            return false;
+        }
+        if (ret > 0) {
+            buffer->erase(0, consumed);
+            return true;
+        }
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            return false;
+        }
+        buffer->append(chunk, static_cast<size_t>(n));
+    }
+}
+
+// 每次往返一条命令：multi为false时是一条GET，否则是一条带batch个key的MGET
+double NetworkKeysPerSecond(int port, size_t num_keys, size_t batch, double seconds, bool multi) {
+    int fd = Connect(port);
+    if (fd < 0) {
+        return 0;
+    }
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<size_t> dist(0, num_keys - 1);
+    std::string buffer;
+    std::vector<std::string> args;
+    long reads = 0;
+    auto begin = Clock::now();
+    auto deadline = begin + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    while (Clock::now() < deadline) {
+        args.assign(1, multi ? "MGET" : "GET");
+        for (size_t i = 0; i < (multi ? batch : 1); ++i) {
+            args.push_back(Key(dist(rng)));
+        }
+        if (!SendAll(fd, ProtocolParser::EncodeRespCommand(args)) || !ReadReply(fd, &buffer)) {
+            break;
+        }
+        reads += static_cast<long>(args.size() - 1);
+    }
+    close(fd);
+    return reads / std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t num_keys = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 1000000;
+    size_t batch = argc > 2 ? static_cast<size_t>(std::atol(argv[2])) : 100;
+    int threads = argc > 3 ? std::atoi(argv[3]) : 4;
+    double seconds = argc > 4 ? std::atof(argv[4]) : 2.0;
+    signal(SIGPIPE, SIG_IGN);
+    Logger::instance().set_level(ERROR);
+
+    std::printf("%zu keys, batches of %zu, %u CPUs online\n", num_keys, batch, std::thread::hardware_concurrency());
+    std::printf("%-28s %8s %14s %14s %9s\n", "store", "threads", "GET keys/s", "MGET keys/s", "speedup");
+    struct Engine {
+        const char* name;
+        std::shared_ptr<KVStore> store;
+    };
+    std::vector<Engine> engines = {{"MemoryStore", KVStore::CreateMemoryStore()},
+                                   {"ShardedMemoryStore", KVStore::CreateShardedMemoryStore()}};
+    for (Engine& engine : engines) {
+        engine.store->Reserve(num_keys);
+        for (size_t i = 0; i < num_keys; ++i) {
+            engine.store->Put(Key(i), "value" + std::to_string(i));
+        }
+        for (int t : {1, threads}) {
+            double single = StoreKeysPerSecond(engine.store.get(), num_keys, batch, t, seconds, false);
+            double multi = StoreKeysPerSecond(engine.store.get(), num_keys, batch, t, seconds, true);
+            std::printf("%-28s %8d %14.0f %14.0f %8.2fx\n", engine.name, t, single, multi, multi / single);
+            if (threads == 1) {
+                break;
+            }
+        }
+    }
+
+    ServerOptions options;
+    options.io_model = IO_EPOLL;
+    options.reactor_threads = 1;
+    int port = 30000 + getpid() % 20000;
+    std::unique_ptr<SimpleServer> server;
+    for (int attempt = 0; attempt < 10 && !server; ++attempt, ++port) {
+        server.reset(new SimpleServer(port, engines[0].store, options));
+        if (!server->Start()) {
+            server.reset();
+        }
+    }
+    if (!server) {
+        std::fprintf(stderr, "server did not start\n");
+        return 1;
+    }
+    double single = NetworkKeysPerSecond(port - 1, num_keys, batch, seconds, false);
+    double multi = NetworkKeysPerSecond(port - 1, num_keys, batch, seconds, true);
+    std::printf("%-28s %8d %14.0f %14.0f %8.2fx\n", "epoll server, 1 connection", 1, single, multi, multi / single);
+    server->Stop();
+    return 0;
+}
@@ -0,0 +1,187 @@
+// tests/benchmark/bench_protocol.cc
+// 测量服务器处理一条命中的GET时，协议层（读入、解析、分发、格式化、写出）每条命令的堆分配次数和耗时
+//
+// 服务器和客户端在同一进程中运行：服务器用一个epoll事件循环，客户端预先构造好一批流水线GET
+// （全部命中），反复发送并读回响应，期间客户端本身不分配内存。替换全局operator new统计进程内的
+// 分配次数，除以命令数即为每条命令的分配次数。分别测量内联文本协议和RESP协议。
+//
+// 用法: bench_protocol [rounds] [pipeline] [value_size]
+#include "src/core/kv_store.h"
+#include "src/network/simple_server.h"
+#include "src/common/protocol.h"
+#include "src/common/logger.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+
+namespace {
+
+std::atomic<uint64_t> g_allocations{0};
+
+}  // namespace
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+const int kKeys = 1000;
+
+int Connect(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    struct sockaddr_in addr;
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+bool SendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// 读回恰好bytes字节，不保存内容
+bool Drain(int fd, size_t bytes) {
+    char buffer[64 * 1024];
+    while (bytes > 0) {
+        ssize_t n = recv(fd, buffer, std::min(sizeof(buffer), bytes), 0);
+        if (n <= 0) {
+            return false;
+        }
+        bytes -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// 返回批量响应的总字节数
+size_t ResponseBytes(bool resp, size_t value_size, int pipeline) {
+    std::string value(value_size, 'v');
+    std::string one = resp ? "$" + std::to_string(value_size) + "\r\n" + value + "\r\n" : "OK " + value + "\n";
+    return one.size() * static_cast<size_t>(pipeline);
+}
+
+void Run(const char* name, int fd, bool resp, int rounds, int pipeline, size_t value_size) {
+    std::string batch;
+    for (int i = 0; i < pipeline; ++i) {
+        std::string key = "key:" + std::to_string(i % kKeys);
+        batch += resp ? ProtocolParser::EncodeRespCommand({"GET", key}) : "GET " + key + "\n";
+    }
+    size_t expected = ResponseBytes(resp, value_size, pipeline);
+
+    // 预热，让连接缓冲等扩到稳定大小
+    for (int i = 0; i < 10; ++i) {
+        if (!SendAll(fd, batch) || !Drain(fd, expected)) {
+            std::fprintf(stderr, "%s: connection failed\n", name);
+            return;
+        }
+    }
+    uint64_t before = g_allocations.load();
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        if (!SendAll(fd, batch) || !Drain(fd, expected)) {
+            std::fprintf(stderr, "%s: connection failed\n", name);
+            return;
+        }
+    }
+    double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    uint64_t allocations = g_allocations.load() - before;
+    double ops = static_cast<double>(rounds) * pipeline;
+    std::printf("%-8s %14.2f %10.0f\n", name, allocations / ops, elapsed / ops);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int rounds = argc > 1 ? std::atoi(argv[1]) : 2000;
+    int pipeline = argc > 2 ? std::atoi(argv[2]) : 64;
+    size_t value_size = argc > 3 ? static_cast<size_t>(std::atoi(argv[3])) : 64;
+    signal(SIGPIPE, SIG_IGN);
+    Logger::instance().set_level(ERROR);
+
+    std::shared_ptr<KVStore> store = KVStore::CreateMemoryStore();
+    for (int i = 0; i < kKeys; ++i) {
+        store->Put("key:" + std::to_string(i), std::string(value_size, 'v'));
+    }
+    ServerOptions options;
+    options.io_model = IO_EPOLL;
+    options.reactor_threads = 1;
+    int port = 30000 + getpid() % 20000;
+    std::unique_ptr<SimpleServer> server;
+    for (int attempt = 0; attempt < 10 && !server; ++attempt, ++port) {
+        server.reset(new SimpleServer(port, store, options));
+        if (!server->Start()) {
+            server.reset();
+        }
+    }
+    if (!server) {
+        std::fprintf(stderr, "server did not start\n");
+        return 1;
+    }
+    int fd = Connect(port - 1);
+    if (fd < 0) {
+        std::fprintf(stderr, "connect failed\n");
+        return 1;
+    }
+
+    std::printf("GET hits, %d rounds x %d pipelined, %zu-byte values\n", rounds, pipeline, value_size);
+    std::printf("%-8s %14s %10s\n", "protocol", "allocs/op", "ns/op");
+    Run("inline", fd, false, rounds, pipeline, value_size);
+    Run("resp", fd, true, rounds, pipeline, value_size);
+    close(fd);
+    server->Stop();
+    return 0;
+}
@@ -0,0 +1,119 @@
+// tests/benchmark/bench_read_scaling.cc
+// 读线程数从1扩展到CPU核数，比较各存储实现的GET吞吐
+//
+// 用法: bench_read_scaling [seconds_per_run] [write_percent]
+#include "src/core/kv_store.h"
+#include "src/common/logger.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int kKeySpace = 100000;
+
+double RunReaders(KVStore* store, int num_threads, double seconds, int write_percent) {
+    std::atomic<bool> start{false};
+    std::atomic<bool> stop{false};
+    std::vector<long> ops(num_threads, 0);
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t]() {
+            std::string value;
+            unsigned int seed = 7u + t * 7919u;
+            long done = 0;
+            while (!start.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (int i = 0; i < 256; ++i) {
+                    seed = seed * 1103515245u + 12345u;
+                    std::string key = "key" + std::to_string((seed >> 8) % kKeySpace);
+                    if (static_cast<int>(seed % 100) < write_percent) {
+                        store->Put(key, "updated-value");
+                    } else {
+                        store->Get(key, value);
+                    }
+                }
+                done += 256;
+            }
+            ops[t] = done;
+        });
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    start.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop.store(true);
+    for (auto& th : threads) {
+        th.join();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    long total = 0;
+    for (long n : ops) {
+        total += n;
+    }
+    return total / elapsed;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    double seconds = argc > 1 ? std::atof(argv[1]) : 1.0;
+    int write_percent = argc > 2 ? std::atoi(argv[2]) : 5;
+    Logger::instance().set_level(WARNING);
+
+    struct Engine {
+        const char* name;
+        std::function<std::unique_ptr<KVStore>()> create;
+    };
+    std::vector<Engine> engines = {
+        {"memory", [] { return KVStore::CreateMemoryStore(); }},
+        {"sharded", [] { return KVStore::CreateShardedMemoryStore(); }},
+        {"rcu", [] { return KVStore::CreateRcuMemoryStore(); }},
+    };
+
+    unsigned int max_threads = std::thread::hardware_concurrency();
+    if (max_threads == 0) {
+        max_threads = 1;
+    }
+
+    std::printf("read scaling: %d%% writes, %.1fs per run, %d keys\n", write_percent, seconds, kKeySpace);
+    std::printf("%-8s", "threads");
+    for (const auto& e : engines) {
+        std::printf("%16s", e.name);
+    }
+    std::printf("   (ops/s)\n");
+
+    std::vector<std::unique_ptr<KVStore>> stores;
+    for (const auto& e : engines) {
+        stores.push_back(e.create());
+        for (int i = 0; i < kKeySpace; ++i) {
+            stores.back()->Put("key" + std::to_string(i), "value" + std::to_string(i));
+        }
+    }
+
+    // 1, 2, 4, ... 直到核数
+    std::vector<unsigned int> thread_counts;
+    for (unsigned int n = 1; n < max_threads; n *= 2) {
+        thread_counts.push_back(n);
+    }
+    thread_counts.push_back(max_threads);
+
+    for (unsigned int threads : thread_counts) {
+        std::printf("%-8u", threads);
+        for (auto& store : stores) {
+            std::printf("%16.0f", RunReaders(store.get(), threads, seconds, write_percent));
+        }
+        std::printf("\n");
+    }
+    return 0;
+}
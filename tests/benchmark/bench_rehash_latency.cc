@@ -0,0 +1,85 @@
+// tests/benchmark/bench_rehash_latency.cc
+// 持续插入时统计单次操作延迟分布，对比 unordered_map 一次性rehash 与 FlatHashTable 渐进扩容
+//
+// 用法: bench_rehash_latency [num_keys]    (默认5000万个key，需要数GB内存)
+#include "src/core/flat_hash_table.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// 以微秒为单位的对数直方图，避免保存每次操作的耗时
+class LatencyHistogram {
+public:
+    void Add(long ns) {
+        worst_ns_ = std::max(worst_ns_, ns);
+        size_t bucket = 0;
+        while ((1L << bucket) * 100 < ns && bucket + 1 < kBuckets) {
+            bucket++;
+        }
+        counts_[bucket]++;
+        total_++;
+    }
+
+    // 返回分位点所在桶的上界（纳秒）
+    long Percentile(double p) const {
+        size_t target = static_cast<size_t>(total_ * p);
+        size_t seen = 0;
+        for (size_t i = 0; i < kBuckets; ++i) {
+            seen += counts_[i];
+            if (seen > target) {
+                return (1L << i) * 100;
+            }
+        }
+        return worst_ns_;
+    }
+
+    long worst_ns() const { return worst_ns_; }
+
+private:
+    static const size_t kBuckets = 40;
+    size_t counts_[kBuckets] = {};
+    size_t total_ = 0;
+    long worst_ns_ = 0;
+};
+
+template <typename InsertFn>
+void Run(const char* name, size_t num_keys, InsertFn insert) {
+    LatencyHistogram histogram;
+    char key[32];
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < num_keys; ++i) {
+        int len = std::snprintf(key, sizeof(key), "key:%zu", i);
+        std::string k(key, len);
+        auto begin = std::chrono::steady_clock::now();
+        insert(k);
+        histogram.Add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now() - begin).count());
+    }
+    double total_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%-16s %10.2f %12ld %12ld %14.3f\n", name, total_s, histogram.Percentile(0.999) / 1000,
+                histogram.Percentile(0.99999) / 1000, histogram.worst_ns() / 1e6);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t num_keys = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 50000000;
+
+    std::printf("%zu inserts, value 8B\n", num_keys);
+    std::printf("%-16s %10s %12s %12s %14s\n", "table", "total s", "p99.9 us<=", "p99.999 us<=", "worst op ms");
+    {
+        std::unordered_map<std::string, std::string> map;
+        Run("unordered_map", num_keys, [&](const std::string& k) { map[k] = "value123"; });
+    }
+    {
+        FlatHashTable table;
+        Run("FlatHashTable", num_keys, [&](const std::string& k) { table.Insert(k, "value123"); });
+    }
+    return 0;
+}
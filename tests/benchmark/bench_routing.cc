@@ -0,0 +1,128 @@
+// tests/benchmark/bench_routing.cc
+// 客户端路由热路径的吞吐和堆分配：每秒能把多少个key路由到节点，每次路由分配几次内存
+//
+// 分别在哈希取模和一致性哈希两种策略下，对keys个key测量：
+//   route      Router::route，得到目标节点信息
+//   nodeIndex  Router::nodeIndex，只得到节点下标（批量操作分组用）
+// 之后比较std::hash与utils::KeyHash（XXH64）在不同key长度下的耗时。
+// 替换全局operator new统计分配次数。路由器初始化会向stdout输出日志，
+// 测量期间stdout重定向到/dev/null，结果写到原来的stdout。
+//
+// 用法: bench_routing [keys] [nodes]
+#include "src/client/router.h"
+#include "src/common/utils.h"
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::atomic<uint64_t> g_allocations{0};
+
+}  // namespace
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+FILE* report = nullptr;
+// volatile防止编译器省掉被测的调用
+volatile size_t sink = 0;
+
+// 对每个key执行一次run，输出每次的耗时、每秒次数和分配次数
+void Measure(const char* name, const std::vector<std::string>& keys,
+             const std::function<size_t(const std::string&)>& run) {
+    uint64_t allocations = g_allocations.load(std::memory_order_relaxed);
+    auto begin = Clock::now();
+    for (const std::string& key : keys) {
+        sink = sink + run(key);
+    }
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / keys.size();
+    double allocs = static_cast<double>(g_allocations.load(std::memory_order_relaxed) - allocations) / keys.size();
+    std::fprintf(report, "%-28s %10.1f %14.0f %10.2f\n", name, ns, 1e9 / ns, allocs);
+    std::fflush(report);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 1000000;
+    int nodes = argc > 2 ? std::atoi(argv[2]) : 3;
+    report = fdopen(dup(STDOUT_FILENO), "w");
+    if (!report || !std::freopen("/dev/null", "w", stdout)) {
+        std::fprintf(stderr, "setup failed\n");
+        return 1;
+    }
+
+    std::vector<std::string> keys;
+    keys.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        keys.push_back("user:" + std::to_string(i * 7919 % 1000003));
+    }
+    std::string members;
+    for (int i = 0; i < nodes; ++i) {
+        members += std::string(i ? ", " : "") + "{\"port\": " + std::to_string(7001 + i) + "}";
+    }
+
+    Router router;
+    std::fprintf(report, "%zu keys, %d nodes\n", count, nodes);
+    std::fprintf(report, "%-28s %10s %14s %10s\n", "operation", "ns/op", "ops/s", "allocs/op");
+    for (const char* strategy : {"simple_hash", "consistent_hash"}) {
+        ClusterConfig::getInstance().loadFromJson("{\"nodes\": [" + members + "], \"hash_strategy\": \"" +
+                                                  strategy + "\"}");
+        Measure((std::string(strategy) + " route").c_str(), keys,
+                [&](const std::string& key) { return static_cast<size_t>(router.route(key)->port); });
+        Measure((std::string(strategy) + " nodeIndex").c_str(), keys,
+                [&](const std::string& key) { return router.nodeIndex(key); });
+    }
+
+    // 哈希函数本身，key用固定内容填充到指定长度
+    for (size_t length : {8, 16, 32, 64, 256}) {
+        std::vector<std::string> sized(keys.begin(), keys.begin() + std::min<size_t>(keys.size(), 100000));
+        for (std::string& key : sized) {
+            key.resize(length, 'x');
+        }
+        std::string suffix = " " + std::to_string(length) + "B";
+        Measure(("std::hash" + suffix).c_str(), sized,
+                [](const std::string& key) { return std::hash<std::string>()(key); });
+        Measure(("utils::KeyHash" + suffix).c_str(), sized,
+                [](const std::string& key) { return static_cast<size_t>(utils::KeyHash(key)); });
+    }
+    return 0;
+}
@@ -0,0 +1,242 @@
+// tests/benchmark/bench_shard_scaling.cc
+// 比较共享存储的epoll模式与分片模式（每核一个线程）随CPU核数增加的吞吐扩展性
+//
+// 对每个核数n，服务器在子进程中运行：epoll模式用n个事件循环共享一个MemoryStore，分片模式用n个
+// 绑核的worker各自独占一个MemoryStore分片。客户端开n个线程，每个线程若干连接，每轮在每个连接上
+// 流水线发送pipeline条命令（90% GET、10% SET，key随机分布），再读回全部响应。报告吞吐、
+// 相对1核的加速比，以及分片模式中转交给其他分片的命令比例。客户端与服务器共用本机CPU，
+// 要观察服务器的扩展性，机器的核数应明显多于max_cores。
+//
+// 用法: bench_shard_scaling [max_cores] [seconds] [pipeline] [connections_per_core]
+#include "src/core/kv_store.h"
+#include "src/network/simple_server.h"
+#include "src/common/logger.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int kKeySpace = 100000;
+
+using Clock = std::chrono::steady_clock;
+
+int Connect(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    struct sockaddr_in addr;
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+bool SendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// 读到count个换行为止；last_line不为空时保存最后一行
+bool ReadResponses(int fd, size_t count, std::string* last_line = nullptr) {
+    char buffer[64 * 1024];
+    std::string line;
+    while (count > 0) {
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0) {
+            return false;
+        }
+        for (ssize_t i = 0; i < n; ++i) {
+            if (buffer[i] == '\n') {
+                count--;
+            } else if (last_line && count == 1) {
+                line += buffer[i];
+            }
+        }
+    }
+    if (last_line) {
+        *last_line = line;
+    }
+    return true;
+}
+
+double InfoField(const std::string& info, const std::string& field) {
+    size_t pos = info.find(field + "=");
+    return pos == std::string::npos ? 0 : std::atof(info.c_str() + pos + field.size() + 1);
+}
+
+pid_t StartServer(IoModel model, int port, size_t cores) {
+    pid_t pid = fork();
+    if (pid != 0) {
+        return pid;
+    }
+    Logger::instance().set_level(ERROR);
+    ServerOptions options;
+    options.io_model = model;
+    options.reactor_threads = cores;
+    std::unique_ptr<SimpleServer> server;
+    if (model == IO_SHARD_PER_CORE) {
+        std::vector<std::shared_ptr<KVStore>> shards;
+        for (size_t i = 0; i < cores; ++i) {
+            shards.push_back(KVStore::CreateMemoryStore());
+        }
+        server.reset(new SimpleServer(port, shards, options));
+    } else {
+        server.reset(new SimpleServer(port, KVStore::CreateMemoryStore(), options));
+    }
+    if (!server->Start()) {
+        _exit(1);
+    }
+    for (;;) {
+        pause();
+    }
+}
+
+struct Result {
+    double requests_per_second = 0;
+    double forwarded_ratio = 0;
+};
+
+Result Run(IoModel model, int port, size_t cores, double seconds, int pipeline, int connections_per_core) {
+    Result result;
+    pid_t pid = StartServer(model, port, cores);
+    int probe = -1;
+    for (int i = 0; i < 200 && (probe = Connect(port)) < 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    if (probe < 0) {
+        std::fprintf(stderr, "server did not start\n");
+        kill(pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+        return result;
+    }
+
+    std::atomic<bool> stop{false};
+    std::vector<long> done(cores, 0);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < cores; ++t) {
+        threads.emplace_back([&, t]() {
+            std::vector<int> fds;
+            for (int i = 0; i < connections_per_core; ++i) {
+                int fd = Connect(port);
+                if (fd >= 0) {
+                    fds.push_back(fd);
+                }
+            }
+            std::mt19937 rng(static_cast<unsigned>(t + 1));
+            std::uniform_int_distribution<int> key_dist(0, kKeySpace - 1);
+            std::uniform_int_distribution<int> op_dist(0, 9);
+            std::string batch;
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (int fd : fds) {
+                    batch.clear();
+                    for (int i = 0; i < pipeline; ++i) {
+                        std::string key = "key" + std::to_string(key_dist(rng));
+                        batch += op_dist(rng) == 0 ? "SET " + key + " value\n" : "GET " + key + "\n";
+                    }
+                    if (!SendAll(fd, batch)) {
+                        return;
+                    }
+                }
+                for (int fd : fds) {
+                    if (!ReadResponses(fd, static_cast<size_t>(pipeline))) {
+                        return;
+                    }
+                }
+                done[t] += static_cast<long>(fds.size()) * pipeline;
+            }
+            for (int fd : fds) {
+                close(fd);
+            }
+        });
+    }
+    auto begin = Clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - begin).count();
+    long total = 0;
+    for (long n : done) {
+        total += n;
+    }
+    result.requests_per_second = total / elapsed;
+
+    std::string info;
+    if (SendAll(probe, "INFO\n") && ReadResponses(probe, 1, &info)) {
+        double requests = InfoField(info, "io_requests");
+        result.forwarded_ratio = requests > 0 ? InfoField(info, "io_forwarded") / requests : 0;
+    }
+    close(probe);
+    kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+    return result;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t max_cores = argc > 1 ? static_cast<size_t>(std::atoi(argv[1]))
+                                : std::max(1u, std::thread::hardware_concurrency());
+    double seconds = argc > 2 ? std::atof(argv[2]) : 3.0;
+    int pipeline = argc > 3 ? std::atoi(argv[3]) : 32;
+    int connections_per_core = argc > 4 ? std::atoi(argv[4]) : 4;
+    signal(SIGPIPE, SIG_IGN);
+    Logger::instance().set_level(ERROR);
+    int port = 30000 + getpid() % 20000;
+
+    std::vector<size_t> core_counts;
+    for (size_t n = 1; n < max_cores; n *= 2) {
+        core_counts.push_back(n);
+    }
+    core_counts.push_back(max_cores);
+
+    std::printf("%u CPUs online, pipeline %d, %d connections per core, %.1fs per run\n",
+                std::thread::hardware_concurrency(), pipeline, connections_per_core, seconds);
+    std::printf("%-8s %6s %12s %9s %10s\n", "mode", "cores", "requests/s", "speedup", "forwarded");
+    struct Mode {
+        const char* name;
+        IoModel model;
+    };
+    for (const Mode& mode : {Mode{"epoll", IO_EPOLL}, Mode{"shards", IO_SHARD_PER_CORE}}) {
+        double base = 0;
+        for (size_t cores : core_counts) {
+            Result r = Run(mode.model, port++, cores, seconds, pipeline, connections_per_core);
+            if (base == 0) {
+                base = r.requests_per_second;
+            }
+            std::printf("%-8s %6zu %12.0f %8.2fx %9.1f%%\n", mode.name, cores, r.requests_per_second,
+                        base > 0 ? r.requests_per_second / base : 0.0, r.forwarded_ratio * 100);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,263 @@
+// tests/unit/test_append_log.cc
+#include "src/core/kv_store.h"
+#include "src/storage/append_log.h"
+#include "src/storage/durable_store.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+class AppendLogTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char dir[] = "/tmp/kv_aof_XXXXXX";
+        ASSERT_NE(mkdtemp(dir), nullptr);
+        dir_ = dir;
+        options.path = dir_ + "/appendonly.aof";
+        options.fsync = FSYNC_NO;
+    }
+
+    void TearDown() override {
+        std::remove(options.path.c_str());
+        std::remove((options.path + ".rewrite").c_str());
+        rmdir(dir_.c_str());
+    }
+
+    std::unique_ptr<DurableStore> OpenStore() {
+        std::unique_ptr<DurableStore> store;
+        Status s = DurableStore::Open(KVStore::CreateMemoryStore(), options, &store);
+        EXPECT_TRUE(s.ok()) << s.message;
+        return store;
+    }
+
+    size_t LogFileSize() const {
+        struct stat st;
+        return stat(options.path.c_str(), &st) == 0 ? static_cast<size_t>(st.st_size) : 0;
+    }
+
+    std::string dir_;
+    AppendLogOptions options;
+};
+
+TEST_F(AppendLogTest, ReopenRestoresData) {
+    {
+        auto store = OpenStore();
+        ASSERT_TRUE(store);
+        store->Put("a", "1");
+        store->Put("b", "2");
+        store->Put("a", "3");
+        store->Delete("b");
+        store->Put(std::string("bin\0key", 7), std::string("v\0\n", 3));
+    }
+
+    auto store = OpenStore();
+    ASSERT_TRUE(store);
+    std::string value;
+    EXPECT_EQ(store->Size(), 2u);
+    ASSERT_TRUE(store->Get("a", value).ok());
+    EXPECT_EQ(value, "3");
+    EXPECT_TRUE(store->Get("b", value).is_key_not_found());
+    ASSERT_TRUE(store->Get(std::string("bin\0key", 7), value).ok());
+    EXPECT_EQ(value, std::string("v\0\n", 3));
+
+    store->Clear();
+    store.reset();
+    EXPECT_EQ(OpenStore()->Size(), 0u);
+}
+
+// 崩溃时最后一条记录只写了一半：回放到最后一条完整记录，并截掉损坏的尾部
+TEST_F(AppendLogTest, TruncatedTailIsDiscarded) {
+    {
+        auto store = OpenStore();
+        for (int i = 0; i < 100; ++i) {
+            store->Put("key" + std::to_string(i), "value");
+        }
+    }
+    size_t full_size = LogFileSize();
+    ASSERT_EQ(truncate(options.path.c_str(), static_cast<off_t>(full_size - 3)), 0);
+
+    {
+        auto store = OpenStore();
+        ASSERT_TRUE(store);
+        EXPECT_EQ(store->Size(), 99u);
+        EXPECT_TRUE(store->Contains("key98").ok());
+        EXPECT_TRUE(store->Contains("key99").is_key_not_found());
+        // 新记录接在最后一条完整记录之后
+        store->Put("after", "crash");
+    }
+
+    auto store = OpenStore();
+    EXPECT_EQ(store->Size(), 100u);
+    EXPECT_TRUE(store->Contains("after").ok());
+}
+
+TEST_F(AppendLogTest, CorruptRecordStopsReplay) {
+    {
+        auto store = OpenStore();
+        store->Put("first", std::string(100, 'x'));
+        store->Put("second", std::string(100, 'y'));
+    }
+    // 翻转第二条记录value中的一个字节
+    int fd = open(options.path.c_str(), O_WRONLY);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(pwrite(fd, "z", 1, static_cast<off_t>(LogFileSize() - 10)), 1);
+    close(fd);
+
+    auto store = OpenStore();
+    EXPECT_TRUE(store->Contains("first").ok());
+    EXPECT_TRUE(store->Contains("second").is_key_not_found());
+}
+
+TEST_F(AppendLogTest, RejectsForeignFile) {
+    FILE* f = std::fopen(options.path.c_str(), "w");
+    std::fputs("this is not an append log at all", f);
+    std::fclose(f);
+
+    std::unique_ptr<DurableStore> store;
+    EXPECT_FALSE(DurableStore::Open(KVStore::CreateMemoryStore(), options, &store).ok());
+}
+
+// 过期时间按绝对时间记录：重启后剩余时间继续计算，已过期的key不会复活
+TEST_F(AppendLogTest, ExpiryIsPersisted) {
+    {
+        auto store = OpenStore();
+        store->PutWithTtl("short", "v", 50);
+        store->PutWithTtl("long", "v", 100000);
+        store->Put("persist", "v");
+        store->Expire("persist", 100000);
+        store->Put("plain", "v");
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    auto store = OpenStore();
+    int64_t ttl = 0;
+    EXPECT_TRUE(store->Contains("short").is_key_not_found());
+    ASSERT_TRUE(store->Ttl("long", &ttl).ok());
+    EXPECT_GT(ttl, 90000);
+    EXPECT_LE(ttl, 100000);
+    ASSERT_TRUE(store->Ttl("persist", &ttl).ok());
+    EXPECT_GT(ttl, 90000);
+    ASSERT_TRUE(store->Ttl("plain", &ttl).ok());
+    EXPECT_EQ(ttl, -1);
+}
+
+// 重写后日志只包含当前数据，重写期间并发的修改不会丢失
+TEST_F(AppendLogTest, RewriteCompactsAndKeepsConcurrentWrites) {
+    auto store = OpenStore();
+    for (int round = 0; round < 20; ++round) {
+        for (int i = 0; i < 1000; ++i) {
+            store->Put("key" + std::to_string(i), "round" + std::to_string(round));
+        }
+    }
+    size_t before = store->log().FileSize();
+
+    std::map<std::string, std::string> expected;
+    std::atomic<bool> stop{false};
+    std::thread writer([&]() {
+        std::mt19937 rng(5);
+        int n = 0;
+        while (!stop.load()) {
+            std::string key = "w" + std::to_string(rng() % 2000);
+            if (rng() % 3 == 0) {
+                if (store->Delete(key).ok()) {
+                    expected.erase(key);
+                }
+            } else {
+                std::string value = std::to_string(n++);
+                store->Put(key, value);
+                expected[key] = value;
+            }
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    Status s = store->RewriteLog();
+    stop = true;
+    writer.join();
+    ASSERT_TRUE(s.ok()) << s.message;
+    EXPECT_LT(store->log().FileSize(), before);
+    EXPECT_EQ(store->log().FileSize(), LogFileSize());
+
+    store->Put("after", "rewrite");
+    store.reset();
+
+    store = OpenStore();
+    std::string value;
+    EXPECT_EQ(store->Size(), 1000 + expected.size() + 1);
+    ASSERT_TRUE(store->Get("key7", value).ok());
+    EXPECT_EQ(value, "round19");
+    for (const auto& kv : expected) {
+        ASSERT_TRUE(store->Get(kv.first, value).ok()) << kv.first;
+        ASSERT_EQ(value, kv.second);
+    }
+    EXPECT_TRUE(store->Contains("after").ok());
+}
+
+TEST_F(AppendLogTest, AutomaticRewrite) {
+    options.auto_rewrite_min_bytes = 64 * 1024;
+    {
+        auto store = OpenStore();
+        for (int i = 0; i < 20000; ++i) {
+            store->Put("key" + std::to_string(i % 100), std::string(50, 'v'));
+        }
+    }
+    // 100个key的数据远小于写入总量，日志至少被重写过一次
+    EXPECT_LT(LogFileSize(), 20000u * 50);
+    EXPECT_EQ(OpenStore()->Size(), 100u);
+}
+
+// FSYNC_ALWAYS下并发写者合并fdatasync：每次写入都已落盘，但fdatasync次数少于写入次数
+TEST_F(AppendLogTest, GroupCommitSharesSyncs) {
+    options.fsync = FSYNC_ALWAYS;
+    auto store = OpenStore();
+    const int kThreads = 8;
+    const int kWritesPerThread = 200;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < kWritesPerThread; ++i) {
+                EXPECT_TRUE(store->Put("t" + std::to_string(t) + ":" + std::to_string(i), "v").ok());
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    uint64_t writes = kThreads * kWritesPerThread;
+    EXPECT_EQ(store->log().LastSequence(), writes);
+    EXPECT_GT(store->log().SyncCount(), 0u);
+    EXPECT_LT(store->log().SyncCount(), writes);
+    store.reset();
+    EXPECT_EQ(OpenStore()->Size(), writes);
+}
+
+TEST_F(AppendLogTest, IntervalModeSyncsInBackground) {
+    options.fsync = FSYNC_INTERVAL;
+    options.fsync_interval_ms = 10;
+    auto store = OpenStore();
+    store->Put("key", "value");
+    for (int i = 0; i < 200 && store->log().SyncCount() == 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_GT(store->log().SyncCount(), 0u);
+}
+
+TEST(FsyncPolicyTest, ParsesNames) {
+    FsyncPolicy policy;
+    EXPECT_TRUE(ParseFsyncPolicy("always", &policy));
+    EXPECT_EQ(policy, FSYNC_ALWAYS);
+    EXPECT_TRUE(ParseFsyncPolicy("interval", &policy));
+    EXPECT_EQ(policy, FSYNC_INTERVAL);
+    EXPECT_TRUE(ParseFsyncPolicy("no", &policy));
+    EXPECT_EQ(policy, FSYNC_NO);
+    EXPECT_FALSE(ParseFsyncPolicy("sometimes", &policy));
+}
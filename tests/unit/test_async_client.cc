@@ -0,0 +1,303 @@
+// tests/unit/test_async_client.cc
+#include "src/client/async_client.h"
+#include "src/core/kv_store.h"
+#include "src/network/simple_server.h"
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+int NextPort() {
+    static int port = 45000 + getpid() % 15000;
+    return port++;
+}
+
+void UseSingleNode(int port) {
+    ASSERT_TRUE(ClusterConfig::getInstance().loadFromJson(
+        "{\"nodes\": [{\"id\": \"server-1\", \"port\": " + std::to_string(port) + "}]}"));
+}
+
+}  // namespace
+
+class AsyncClientTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        store = KVStore::CreateMemoryStore();
+        for (int attempt = 0; attempt < 10 && !server; ++attempt) {
+            port = NextPort();
+            StartServer();
+        }
+        ASSERT_TRUE(server);
+        UseSingleNode(port);
+    }
+
+    void TearDown() override {
+        if (server) {
+            server->Stop();
+        }
+    }
+
+    void StartServer() {
+        ServerOptions options;
+        options.io_model = IO_EPOLL;
+        options.reactor_threads = 1;
+        server.reset(new SimpleServer(port, store, options));
+        if (!server->Start()) {
+            server.reset();
+        }
+    }
+
+    std::shared_ptr<KVStore> store;
+    std::unique_ptr<SimpleServer> server;
+    int port = 0;
+};
+
+TEST_F(AsyncClientTest, PipelinesRequestsInOrder) {
+    AsyncClient client;
+    const int kCount = 2000;
+    std::vector<std::future<RespReply>> puts;
+    for (int i = 0; i < kCount; ++i) {
+        puts.push_back(client.putAsync("key" + std::to_string(i), "value " + std::to_string(i)));
+    }
+    std::vector<std::future<RespReply>> gets;
+    for (int i = 0; i < kCount; ++i) {
+        gets.push_back(client.getAsync("key" + std::to_string(i)));
+    }
+    for (int i = 0; i < kCount; ++i) {
+        EXPECT_EQ(puts[i].get().type, RespReply::STATUS);
+        RespReply reply = gets[i].get();
+        ASSERT_EQ(reply.type, RespReply::BULK);
+        EXPECT_EQ(reply.str, "value " + std::to_string(i));
+    }
+
+    RespReply deleted = client.delAsync("key0").get();
+    EXPECT_EQ(deleted.type, RespReply::INTEGER);
+    EXPECT_EQ(deleted.integer, 1);
+    EXPECT_EQ(client.getAsync("key0").get().type, RespReply::NIL);
+}
+
+TEST_F(AsyncClientTest, CallbacksAndFuturesShareOneQueue) {
+    store->Put("a", "1");
+    store->Put("b", "2");
+    AsyncClient client;
+    std::promise<std::string> first;
+    std::promise<std::string> third;
+    client.getAsync("a", [&first](const RespReply& reply) { first.set_value(reply.str); });
+    std::future<RespReply> second = client.getAsync("b");
+    client.getAsync("missing", [&third](const RespReply& reply) {
+        third.set_value(reply.type == RespReply::NIL ? "nil" : reply.str);
+    });
+    EXPECT_EQ(first.get_future().get(), "1");
+    EXPECT_EQ(second.get().str, "2");
+    EXPECT_EQ(third.get_future().get(), "nil");
+}
+
+TEST_F(AsyncClientTest, ManyThreadsShareConnection) {
+    AsyncClient client;
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t]() {
+            std::vector<std::future<RespReply>> replies;
+            for (int i = 0; i < 500; ++i) {
+                std::string key = "t" + std::to_string(t) + ":" + std::to_string(i);
+                client.putAsync(key, key);
+                replies.push_back(client.getAsync(key));
+            }
+            for (int i = 0; i < 500; ++i) {
+                if (replies[i].get().str != "t" + std::to_string(t) + ":" + std::to_string(i)) {
+                    mismatches++;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(mismatches.load(), 0);
+}
+
+TEST_F(AsyncClientTest, FailsPendingRequestsAndReconnects) {
+    AsyncClient client;
+    EXPECT_EQ(client.putAsync("k", "v").get().type, RespReply::STATUS);
+
+    server->Stop();
+    server.reset();
+    // 服务器关闭后，断开被发现之前或之后提交的请求都以错误结束
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    RespReply failed = client.getAsync("k").get();
+    EXPECT_EQ(failed.type, RespReply::ERROR);
+
+    // 服务器恢复后，下一次提交重新建立连接
+    StartServer();
+    ASSERT_TRUE(server);
+    RespReply reply = client.getAsync("k").get();
+    ASSERT_EQ(reply.type, RespReply::BULK);
+    EXPECT_EQ(reply.str, "v");
+}
+
+// 连不上的节点不能卡住事件循环，其他节点的请求照常完成
+TEST_F(AsyncClientTest, UnreachableNodeDoesNotStallOthers) {
+    // 从不accept且全连接队列已满的监听socket：新的SYN被丢弃，连接一直挂起
+    int stuck_fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(bind(stuck_fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)), 0);
+    ASSERT_EQ(listen(stuck_fd, 0), 0);
+    socklen_t len = sizeof(addr);
+    getsockname(stuck_fd, reinterpret_cast<struct sockaddr*>(&addr), &len);
+    std::vector<int> fillers;
+    for (int i = 0; i < 4; ++i) {
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+        fillers.push_back(fd);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    ASSERT_TRUE(ClusterConfig::getInstance().loadFromJson(
+        "{\"nodes\": [{\"id\": \"server-1\", \"port\": " + std::to_string(port) +
+        "}, {\"id\": \"stuck\", \"port\": " + std::to_string(ntohs(addr.sin_port)) + "}]}"));
+    ClusterConfig& config = ClusterConfig::getInstance();
+    std::string live_key;
+    std::string dead_key;
+    for (int i = 0; live_key.empty() || dead_key.empty(); ++i) {
+        std::string key = "key" + std::to_string(i);
+        (config.getNodeIndex(key) == 0 ? live_key : dead_key) = key;
+    }
+
+    AsyncClient client;
+    std::future<RespReply> dead = client.getAsync(dead_key);
+    auto start = std::chrono::steady_clock::now();
+    std::future<RespReply> live = client.putAsync(live_key, "v");
+    ASSERT_EQ(live.wait_for(std::chrono::seconds(2)), std::future_status::ready);
+    EXPECT_EQ(live.get().type, RespReply::STATUS);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+
+    // 挂起的连接到期后，等待它的请求以错误结束
+    ASSERT_EQ(dead.wait_for(std::chrono::milliseconds(AsyncClient::kConnectTimeoutMs + 2000)),
+              std::future_status::ready);
+    EXPECT_EQ(dead.get().type, RespReply::ERROR);
+    for (int fd : fillers) {
+        close(fd);
+    }
+    close(stuck_fd);
+}
+
+class AsyncClientRawServerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+        ASSERT_GE(listen_fd, 0);
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ASSERT_EQ(bind(listen_fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)), 0);
+        ASSERT_EQ(listen(listen_fd, 4), 0);
+        socklen_t len = sizeof(addr);
+        getsockname(listen_fd, reinterpret_cast<struct sockaddr*>(&addr), &len);
+        UseSingleNode(ntohs(addr.sin_port));
+    }
+
+    void TearDown() override {
+        if (server_thread.joinable()) {
+            server_thread.join();
+        }
+        close(listen_fd);
+    }
+
+    // 接受一个连接，读满request_bytes字节的请求后写出response，再按close_after决定是否关闭
+    void Serve(size_t request_bytes, std::string response, bool close_after) {
+        server_thread = std::thread([=]() {
+            int fd = accept(listen_fd, nullptr, nullptr);
+            if (fd < 0) {
+                return;
+            }
+            std::string received;
+            char chunk[4096];
+            while (received.size() < request_bytes) {
+                ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+                if (n <= 0) {
+                    break;
+                }
+                received.append(chunk, static_cast<size_t>(n));
+            }
+            size_t sent = 0;
+            while (sent < response.size()) {
+                ssize_t n = send(fd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+                if (n <= 0) {
+                    break;
+                }
+                sent += static_cast<size_t>(n);
+            }
+            if (close_after) {
+                close(fd);
+            } else {
+                served_fd = fd;
+            }
+        });
+    }
+
+    int listen_fd = -1;
+    int served_fd = -1;
+    std::thread server_thread;
+};
+
+// 对端写完响应立即关闭：先交付已收到的响应，即使它们恰好填满了读缓冲
+TEST_F(AsyncClientRawServerTest, DeliversRepliesReceivedBeforeClose) {
+    // 每个响应正好64KB，两个响应填满两次读取，第三次读到EOF
+    const size_t kValueSize = 64 * 1024 - 10;
+    std::string value(kValueSize, 'x');
+    std::string response;
+    for (int i = 0; i < 2; ++i) {
+        response += "$" + std::to_string(kValueSize) + "\r\n" + value + "\r\n";
+    }
+    size_t request_bytes = ProtocolParser::EncodeRespCommand({"GET", "a"}).size() +
+                           ProtocolParser::EncodeRespCommand({"GET", "b"}).size();
+    Serve(request_bytes, response, true);
+
+    AsyncClient client;
+    std::future<RespReply> a = client.getAsync("a");
+    std::future<RespReply> b = client.getAsync("b");
+    RespReply first = a.get();
+    RespReply second = b.get();
+    ASSERT_EQ(first.type, RespReply::BULK);
+    ASSERT_EQ(second.type, RespReply::BULK);
+    EXPECT_EQ(first.str.size(), kValueSize);
+    EXPECT_EQ(second.str.size(), kValueSize);
+}
+
+// 析构时等待中的请求以错误结束，回调里再提交的请求也不会无人完成
+TEST_F(AsyncClientRawServerTest, SubmitDuringShutdownIsRejected) {
+    size_t request_bytes = ProtocolParser::EncodeRespCommand({"GET", "a"}).size();
+    Serve(request_bytes, std::string(), false);
+
+    std::promise<RespReply> resubmitted;
+    std::future<RespReply> resubmitted_future = resubmitted.get_future();
+    {
+        AsyncClient client;
+        client.getAsync("a", [&](const RespReply& reply) {
+            EXPECT_EQ(reply.type, RespReply::ERROR);
+            client.getAsync("b", [&](const RespReply& retry) { resubmitted.set_value(retry); });
+        });
+        server_thread.join();
+    }
+    ASSERT_EQ(resubmitted_future.wait_for(std::chrono::seconds(2)), std::future_status::ready);
+    RespReply reply = resubmitted_future.get();
+    EXPECT_EQ(reply.type, RespReply::ERROR);
+    EXPECT_EQ(reply.str, "Client closed");
+    close(served_fd);
+}
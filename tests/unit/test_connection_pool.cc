@@ -0,0 +1,155 @@
+// tests/unit/test_connection_pool.cc
+#include "src/client/connection_pool.h"
+#include "src/client/kv_client.h"
+#include "src/core/kv_store.h"
+#include "src/network/simple_server.h"
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace {
+
+int NextPort() {
+    static int port = 40000 + getpid() % 20000;
+    return port++;
+}
+
+}  // namespace
+
+class ConnectionPoolTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ServerOptions options;
+        options.io_model = IO_EPOLL;
+        options.reactor_threads = 1;
+        store = KVStore::CreateMemoryStore();
+        for (int attempt = 0; attempt < 10 && !server; ++attempt) {
+            node.port = NextPort();
+            server.reset(new SimpleServer(node.port, store, options));
+            if (!server->Start()) {
+                server.reset();
+            }
+        }
+        ASSERT_TRUE(server);
+        node.id = "server-1";
+        node.host = "127.0.0.1";
+    }
+
+    void TearDown() override {
+        if (server) {
+            server->Stop();
+        }
+    }
+
+    static bool Ping(Connection* connection) {
+        RespReply reply;
+        return connection->sendCommand({"PING"}) && connection->receiveReply(&reply) &&
+               reply.type == RespReply::STATUS && reply.str == "PONG";
+    }
+
+    std::shared_ptr<KVStore> store;
+    std::unique_ptr<SimpleServer> server;
+    NodeInfo node;
+};
+
+TEST_F(ConnectionPoolTest, ReusesReleasedConnection) {
+    ConnectionPool pool;
+    for (int i = 0; i < 5; ++i) {
+        ConnectionPool::Lease connection = pool.acquire(node);
+        ASSERT_TRUE(connection);
+        EXPECT_TRUE(Ping(connection.get()));
+    }
+    PoolStats stats = pool.getStats();
+    EXPECT_EQ(stats.created, 1u);
+    EXPECT_EQ(stats.reused, 4u);
+    EXPECT_EQ(pool.idleCount(node.address()), 1u);
+
+    // 执行失败的连接不放回连接池
+    {
+        ConnectionPool::Lease connection = pool.acquire(node);
+        ASSERT_TRUE(connection);
+        connection.invalidate();
+    }
+    EXPECT_EQ(pool.idleCount(node.address()), 0u);
+}
+
+TEST_F(ConnectionPoolTest, LimitsConnectionsPerNode) {
+    PoolOptions options;
+    options.max_per_node = 2;
+    options.acquire_timeout_ms = 300;
+    ConnectionPool pool(options);
+
+    ConnectionPool::Lease first = pool.acquire(node);
+    ConnectionPool::Lease second = pool.acquire(node);
+    ASSERT_TRUE(first);
+    ASSERT_TRUE(second);
+    EXPECT_FALSE(pool.acquire(node));
+
+    // 等待中的调用者拿到另一个线程归还的连接
+    Connection* returned = second.get();
+    std::thread releaser([&second]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        second = ConnectionPool::Lease();
+    });
+    ConnectionPool::Lease third = pool.acquire(node);
+    releaser.join();
+    ASSERT_TRUE(third);
+    EXPECT_EQ(third.get(), returned);
+    EXPECT_EQ(pool.getStats().created, 2u);
+}
+
+TEST_F(ConnectionPoolTest, DropsIdleAndDeadConnections) {
+    PoolOptions options;
+    options.idle_timeout_ms = 0;
+    ConnectionPool expiring(options);
+    { ConnectionPool::Lease connection = expiring.acquire(node); }
+    { ConnectionPool::Lease connection = expiring.acquire(node); }
+    EXPECT_EQ(expiring.getStats().created, 2u);
+    EXPECT_EQ(expiring.getStats().reused, 0u);
+
+    // 服务器关闭后空闲连接在健康检查时被发现并丢弃
+    ConnectionPool pool;
+    { ConnectionPool::Lease connection = pool.acquire(node); }
+    ASSERT_EQ(pool.idleCount(node.address()), 1u);
+    server->Stop();
+    server.reset();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(pool.acquire(node));
+    EXPECT_EQ(pool.getStats().dropped, 1u);
+}
+
+// 长期持有的连接被服务器关闭后，再写入只返回失败，不会因SIGPIPE终止进程
+TEST_F(ConnectionPoolTest, SendOnClosedConnectionDoesNotRaiseSigpipe) {
+    Connection connection(node.host, node.port);
+    ASSERT_TRUE(connection.connect());
+    ASSERT_TRUE(Ping(&connection));
+    server->Stop();
+    server.reset();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    bool sent = true;
+    for (int i = 0; i < 10 && sent; ++i) {
+        sent = connection.sendCommand({"PING"});
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_FALSE(sent);
+    EXPECT_FALSE(connection.isConnected());
+}
+
+TEST_F(ConnectionPoolTest, ClientKeepsConnectionAcrossCommands) {
+    ASSERT_TRUE(ClusterConfig::getInstance().loadFromJson(
+        "{\"nodes\": [{\"id\": \"server-1\", \"port\": " + std::to_string(node.port) + "}]}"));
+    auto pool = std::make_shared<ConnectionPool>();
+    KVClient client(pool);
+    for (int i = 0; i < 10; ++i) {
+        std::string key = "key" + std::to_string(i);
+        ASSERT_TRUE(client.put(key, "value with spaces " + std::to_string(i)));
+        EXPECT_EQ(client.get(key), "value with spaces " + std::to_string(i));
+    }
+    EXPECT_TRUE(client.del("key0"));
+    EXPECT_TRUE(client.ping());
+    EXPECT_EQ(pool->getStats().created, 1u);
+}
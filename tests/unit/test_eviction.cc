@@ -0,0 +1,88 @@
+// tests/unit/test_eviction.cc
+#include "src/core/kv_store.h"
+#include "src/core/flat_hash_table.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+
+namespace {
+
+const size_t kLimit = 256 * 1024;
+
+std::string Key(int i) {
+    return "key" + std::to_string(i);
+}
+
+}  // namespace
+
+class EvictionTest : public ::testing::TestWithParam<std::string> {};
+
+// 超过上限后写入不再失败，占用始终不超过上限
+TEST_P(EvictionTest, KeepsUsedBytesUnderLimit) {
+    auto store = KVStore::CreateMemoryStore(kLimit, GetParam());
+    std::string value(100, 'v');
+    const int kKeys = 20000;
+    for (int i = 0; i < kKeys; ++i) {
+        ASSERT_TRUE(store->Put(Key(i), value).ok()) << i;
+        ASSERT_LE(store->GetStats().used_bytes, kLimit);
+    }
+
+    StoreStats stats = store->GetStats();
+    EXPECT_GT(stats.evictions, 0u);
+    EXPECT_EQ(stats.keys + stats.evictions, static_cast<size_t>(kKeys));
+    // 上限内的条目数接近 kLimit / 每条占用
+    EXPECT_GT(stats.keys, kLimit / FlatHashTable::RecordBytes(8, 100) * 9 / 10);
+
+    // 最近写入的条目还在
+    std::string out;
+    EXPECT_TRUE(store->Get(Key(kKeys - 1), out).ok());
+    EXPECT_EQ(out, value);
+}
+
+// 反复访问的热点key在写入大量新key后基本都能保留
+TEST_P(EvictionTest, KeepsHotKeys) {
+    auto store = KVStore::CreateMemoryStore(kLimit, GetParam());
+    std::string value(100, 'v');
+    const int kHot = 100;
+    for (int i = 0; i < kHot; ++i) {
+        ASSERT_TRUE(store->Put("hot" + std::to_string(i), value).ok());
+    }
+
+    std::string out;
+    for (int i = 0; i < 10000; ++i) {
+        ASSERT_TRUE(store->Put(Key(i), value).ok());
+        store->Get("hot" + std::to_string(i % kHot), out);
+    }
+
+    int survived = 0;
+    for (int i = 0; i < kHot; ++i) {
+        survived += store->Contains("hot" + std::to_string(i)).ok();
+    }
+    EXPECT_GE(survived, kHot * 9 / 10) << GetParam();
+    EXPECT_GT(store->GetStats().evictions, 0u);
+}
+
+INSTANTIATE_TEST_CASE_P(Policies, EvictionTest, ::testing::Values("lru", "lfu", "clock"));
+
+TEST(EvictionStatsTest, CountsHitsAndMisses) {
+    auto store = KVStore::CreateMemoryStore();
+    std::string out;
+    store->Put("a", "1");
+    store->Get("a", out);
+    store->Get("a", out);
+    store->Get("b", out);
+
+    StoreStats stats = store->GetStats();
+    EXPECT_EQ(stats.hits, 2u);
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.evictions, 0u);
+}
+
+// 单条记录本身超过上限时即使开启淘汰也拒绝写入，已有条目不受影响
+TEST(EvictionStatsTest, RecordLargerThanLimitIsRejected) {
+    auto store = KVStore::CreateMemoryStore(kLimit, "lru");
+    ASSERT_TRUE(store->Put("small", "v").ok());
+    EXPECT_TRUE(store->Put("huge", std::string(kLimit, 'x')).is_out_of_memory());
+    EXPECT_TRUE(store->Contains("small").ok());
+    EXPECT_EQ(store->GetStats().evictions, 0u);
+}
@@ -0,0 +1,219 @@
+// tests/unit/test_flat_hash_table.cc
+#include "src/core/flat_hash_table.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+TEST(FlatHashTableTest, InlineAndArenaRecords) {
+    FlatHashTable table;
+    std::string value;
+
+    // key+value不超过20字节时内联存放
+    EXPECT_TRUE(table.Insert("short", "v"));
+    // 超长记录放在Arena中
+    std::string long_value(100, 'x');
+    std::string huge_value(10000, 'y');
+    EXPECT_TRUE(table.Insert("long", long_value));
+    EXPECT_TRUE(table.Insert("huge", huge_value));
+
+    EXPECT_TRUE(table.Find("short", &value));
+    EXPECT_EQ(value, "v");
+    EXPECT_TRUE(table.Find("long", &value));
+    EXPECT_EQ(value, long_value);
+    EXPECT_TRUE(table.Find("huge", &value));
+    EXPECT_EQ(value, huge_value);
+
+    // 覆盖时在内联和Arena之间切换
+    EXPECT_FALSE(table.Insert("short", long_value));
+    EXPECT_FALSE(table.Insert("long", "v2"));
+    EXPECT_TRUE(table.Find("short", &value));
+    EXPECT_EQ(value, long_value);
+    EXPECT_TRUE(table.Find("long", &value));
+    EXPECT_EQ(value, "v2");
+    EXPECT_EQ(table.size(), 3u);
+}
+
+TEST(FlatHashTableTest, EmptyKeyAndValue) {
+    FlatHashTable table;
+    std::string value = "unchanged";
+    EXPECT_TRUE(table.Insert("k", ""));
+    EXPECT_TRUE(table.Find("k", &value));
+    EXPECT_EQ(value, "");
+    EXPECT_FALSE(table.Find("missing", &value));
+}
+
+TEST(FlatHashTableTest, GrowAndErase) {
+    FlatHashTable table;
+    const int kKeys = 100000;
+    for (int i = 0; i < kKeys; ++i) {
+        table.Insert("key" + std::to_string(i), "value" + std::to_string(i));
+    }
+    EXPECT_EQ(table.size(), static_cast<size_t>(kKeys));
+    EXPECT_GE(table.capacity() * 7 / 8, table.size());
+
+    for (int i = 0; i < kKeys; i += 2) {
+        EXPECT_TRUE(table.Erase("key" + std::to_string(i)));
+    }
+    EXPECT_FALSE(table.Erase("key0"));
+    EXPECT_EQ(table.size(), static_cast<size_t>(kKeys / 2));
+
+    std::string value;
+    for (int i = 0; i < kKeys; ++i) {
+        bool found = table.Find("key" + std::to_string(i), &value);
+        ASSERT_EQ(found, i % 2 == 1);
+        if (found) {
+            ASSERT_EQ(value, "value" + std::to_string(i));
+        }
+    }
+
+    table.Clear();
+    EXPECT_EQ(table.size(), 0u);
+    EXPECT_FALSE(table.Contains("key1"));
+}
+
+// 随机插入/覆盖/删除，与unordered_map的结果逐一比对（同时覆盖墓碑复用和原地重建）
+TEST(FlatHashTableTest, RandomOpsMatchUnorderedMap) {
+    FlatHashTable table;
+    std::unordered_map<std::string, std::string> reference;
+    std::mt19937 rng(42);
+
+    for (int i = 0; i < 200000; ++i) {
+        std::string key = "k" + std::to_string(rng() % 5000);
+        switch (rng() % 3) {
+            case 0:
+            case 1: {
+                std::string value(rng() % 64, static_cast<char>('a' + rng() % 26));
+                EXPECT_EQ(table.Insert(key, value), reference.count(key) == 0);
+                reference[key] = value;
+                break;
+            }
+            default:
+                EXPECT_EQ(table.Erase(key), reference.erase(key) == 1);
+                break;
+        }
+    }
+
+    ASSERT_EQ(table.size(), reference.size());
+    std::string value;
+    for (const auto& kv : reference) {
+        ASSERT_TRUE(table.Find(kv.first, &value));
+        ASSERT_EQ(value, kv.second);
+    }
+}
+
+// 扩容期间新旧两张表同时可用：查找、覆盖、删除都能看到两张表里的条目
+TEST(FlatHashTableTest, IncrementalRehashKeepsBothTablesLive) {
+    FlatHashTable table;
+    int inserted = 0;
+    while (!table.IsRehashing()) {
+        table.Insert("key" + std::to_string(inserted), "v" + std::to_string(inserted));
+        inserted++;
+    }
+    // 刚触发扩容时旧表里的条目还没搬走
+    size_t capacity = table.capacity();
+    EXPECT_GT(capacity, static_cast<size_t>(inserted));
+
+    // 用纯查找确认所有条目都可见，查找不推动搬迁
+    std::string value;
+    for (int i = 0; i < inserted; ++i) {
+        ASSERT_TRUE(table.Find("key" + std::to_string(i), &value));
+    }
+    EXPECT_TRUE(table.IsRehashing());
+
+    // 搬迁期间覆盖和删除旧表中的条目
+    EXPECT_FALSE(table.Insert("key0", "updated"));
+    EXPECT_TRUE(table.Erase("key1"));
+    EXPECT_TRUE(table.Find("key0", &value));
+    EXPECT_EQ(value, "updated");
+    EXPECT_FALSE(table.Contains("key1"));
+    EXPECT_EQ(table.size(), static_cast<size_t>(inserted - 1));
+
+    while (table.IsRehashing()) {
+        table.RehashStep();
+    }
+    EXPECT_EQ(table.size(), static_cast<size_t>(inserted - 1));
+    for (int i = 2; i < inserted; ++i) {
+        ASSERT_TRUE(table.Find("key" + std::to_string(i), &value));
+        ASSERT_EQ(value, "v" + std::to_string(i));
+    }
+}
+
+// 持续插入时记录单次操作的最长耗时，并验证每次写入搬迁的条目数有上界
+TEST(FlatHashTableTest, WorstInsertLatencyDuringGrowth) {
+    const size_t kKeys = 2000000;
+    FlatHashTable table;
+    std::chrono::nanoseconds worst(0);
+    size_t growths = 0;
+    bool was_rehashing = false;
+
+    for (size_t i = 0; i < kKeys; ++i) {
+        std::string key = "key" + std::to_string(i);
+        auto begin = std::chrono::steady_clock::now();
+        table.Insert(key, "value");
+        auto elapsed = std::chrono::steady_clock::now() - begin;
+        if (elapsed > worst) {
+            worst = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed);
+        }
+        if (table.IsRehashing() && !was_rehashing) {
+            growths++;
+        }
+        was_rehashing = table.IsRehashing();
+    }
+
+    std::cout << "[Latency] " << kKeys << " inserts, " << growths << " incremental growths, worst op "
+              << worst.count() / 1000 << " us" << std::endl;
+    EXPECT_EQ(table.size(), kKeys);
+    EXPECT_GT(growths, 10u);
+    // 每组最多kGroupSize个条目，单次写入搬迁的条目数因此不超过 kRehashGroupsPerOp * kGroupSize
+    while (table.IsRehashing()) {
+        ASSERT_LE(table.RehashStep(1), FlatHashTable::kGroupSize);
+    }
+}
+
+// 按位置访问的接口在搬迁期间覆盖新旧两张表，EraseAt之后条目数和内存统计同步更新
+TEST(FlatHashTableTest, SlotPositionsCoverBothTables) {
+    FlatHashTable table;
+    int inserted = 0;
+    while (!table.IsRehashing()) {
+        table.Insert("key" + std::to_string(inserted), std::string(inserted % 50, 'v'));
+        inserted++;
+    }
+
+    size_t visited = 0;
+    for (size_t pos = 0; pos < table.SlotCount(); ++pos) {
+        if (table.NextOccupied(pos, 1) == pos) {
+            ASSERT_TRUE(table.Contains(table.KeyAt(pos)));
+            visited++;
+        }
+    }
+    EXPECT_EQ(visited, table.size());
+
+    size_t used = table.UsedBytes();
+    size_t pos = table.NextOccupied(table.SlotCount() - 1, table.SlotCount());
+    ASSERT_NE(pos, FlatHashTable::kNoSlot);
+    std::string key = table.KeyAt(pos);
+    table.EraseAt(pos);
+    EXPECT_FALSE(table.Contains(key));
+    EXPECT_EQ(table.size(), static_cast<size_t>(inserted - 1));
+    EXPECT_LT(table.UsedBytes(), used);
+
+    table.Clear();
+    EXPECT_EQ(table.NextOccupied(0, table.SlotCount()), FlatHashTable::kNoSlot);
+}
+
+// 预分配后批量插入不再触发扩容
+TEST(FlatHashTableTest, ReserveAvoidsGrowth) {
+    FlatHashTable table;
+    table.Reserve(100000);
+    size_t capacity = table.capacity();
+    EXPECT_GE(capacity * 7 / 8, 100000u);
+    for (int i = 0; i < 100000; ++i) {
+        table.Insert("key" + std::to_string(i), "v");
+        ASSERT_FALSE(table.IsRehashing());
+    }
+    EXPECT_EQ(table.capacity(), capacity);
+    EXPECT_EQ(table.size(), 100000u);
+}
@@ -0,0 +1,264 @@
+// tests/unit/test_hash_ring.cc
+#include "src/client/hash_ring.h"
+#include "src/client/cluster_config.h"
+#include "src/client/router.h"
+#include "src/common/utils.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+const int kKeys = 100000;
+
+std::vector<std::pair<std::string, int>> Members(int count) {
+    std::vector<std::pair<std::string, int>> members;
+    for (int i = 1; i <= count; ++i) {
+        members.emplace_back("server-" + std::to_string(i), 1);
+    }
+    return members;
+}
+
+// 每个key归属的节点id
+std::vector<std::string> Owners(const HashRing& ring, const std::vector<std::pair<std::string, int>>& members) {
+    std::vector<std::string> owners;
+    for (int i = 0; i < kKeys; ++i) {
+        owners.push_back(members[ring.nodeIndex("key:" + std::to_string(i))].first);
+    }
+    return owners;
+}
+
+}  // namespace
+
+TEST(HashRingTest, KeyHashMatchesXXH64Reference) {
+    // xxHash参考实现的输出，哈希值是客户端与服务器之间的约定，不能随实现变化
+    EXPECT_EQ(utils::XXHash64("", 0), 0xEF46DB3751D8E999ULL);
+    EXPECT_EQ(utils::XXHash64("a", 1), 0xD24EC4F1A98C6E5BULL);
+    EXPECT_EQ(utils::XXHash64("abc", 3), 0x44BC2CF5AD770999ULL);
+    // 超过32字节，经过四路累加的分支
+    std::string text = "Nobody inspects the spammish repetition";
+    EXPECT_EQ(utils::XXHash64(text.data(), text.size()), 0xFBCEA83C8A378BF1ULL);
+    EXPECT_EQ(utils::KeyHash(text), utils::XXHash64(text.data(), text.size(), utils::kKeyHashSeed));
+    EXPECT_EQ(HashRing::hash("abc"), utils::KeyHash("abc"));
+}
+
+TEST(HashRingTest, IndependentOfMemberOrder) {
+    auto members = Members(3);
+    HashRing ring;
+    ring.build(members, 160);
+    EXPECT_EQ(ring.pointCount(), 480u);
+
+    auto reversed = std::vector<std::pair<std::string, int>>(members.rbegin(), members.rend());
+    HashRing other;
+    other.build(reversed, 160);
+    EXPECT_EQ(Owners(ring, members), Owners(other, reversed));
+}
+
+TEST(HashRingTest, AddingNodeOnlyMovesKeysToIt) {
+    auto before_members = Members(3);
+    auto after_members = Members(4);
+    HashRing before;
+    HashRing after;
+    before.build(before_members, 160);
+    after.build(after_members, 160);
+    std::vector<std::string> old_owners = Owners(before, before_members);
+    std::vector<std::string> new_owners = Owners(after, after_members);
+
+    int moved = 0;
+    for (int i = 0; i < kKeys; ++i) {
+        if (old_owners[i] != new_owners[i]) {
+            EXPECT_EQ(new_owners[i], "server-4");
+            moved++;
+        }
+    }
+    // 理想值是1/4
+    EXPECT_GT(moved, kKeys * 15 / 100);
+    EXPECT_LT(moved, kKeys * 35 / 100);
+}
+
+TEST(HashRingTest, RemovingNodeOnlyMovesItsKeys) {
+    auto before_members = Members(4);
+    auto after_members = before_members;
+    after_members.erase(after_members.begin() + 1);
+    HashRing before;
+    HashRing after;
+    before.build(before_members, 160);
+    after.build(after_members, 160);
+    std::vector<std::string> old_owners = Owners(before, before_members);
+    std::vector<std::string> new_owners = Owners(after, after_members);
+    for (int i = 0; i < kKeys; ++i) {
+        if (old_owners[i] != "server-2") {
+            EXPECT_EQ(old_owners[i], new_owners[i]);
+        }
+    }
+}
+
+TEST(HashRingTest, LoadFollowsWeights) {
+    auto members = Members(3);
+    members[0].second = 2;
+    HashRing ring;
+    ring.build(members, 160);
+    std::vector<int> load(members.size(), 0);
+    for (int i = 0; i < kKeys; ++i) {
+        load[ring.nodeIndex("key:" + std::to_string(i))]++;
+    }
+    // 权重2的节点理想上承担一半
+    EXPECT_GT(load[0], kKeys * 40 / 100);
+    EXPECT_LT(load[0], kKeys * 60 / 100);
+    for (size_t n = 1; n < load.size(); ++n) {
+        EXPECT_GT(load[n], kKeys * 18 / 100);
+        EXPECT_LT(load[n], kKeys * 32 / 100);
+    }
+}
+
+TEST(HashRingTest, ClusterConfigSelectsStrategy) {
+    ClusterConfig& config = ClusterConfig::getInstance();
+    ASSERT_TRUE(config.loadFromJson(
+        "{\"cluster\": {\"nodes\": [{\"id\": \"a\", \"port\": 1, \"weight\": 3}, {\"id\": \"b\", \"port\": 2}],"
+        " \"hash_strategy\": \"consistent_hash\", \"virtual_nodes\": 50}}"));
+    EXPECT_EQ(config.getHashStrategy(), ClusterConfig::HASH_CONSISTENT);
+    std::vector<NodeInfo> nodes = config.getAllNodes();
+    ASSERT_EQ(nodes.size(), 2u);
+    EXPECT_EQ(nodes[0].id, "a");
+    EXPECT_EQ(nodes[0].weight, 3);
+    EXPECT_EQ(nodes[1].weight, 1);
+
+    HashRing ring;
+    ring.build({{"a", 3}, {"b", 1}}, 50);
+    for (int i = 0; i < 1000; ++i) {
+        std::string key = "key:" + std::to_string(i);
+        EXPECT_EQ(config.getNodeIndex(key), ring.nodeIndex(key));
+    }
+
+    ASSERT_TRUE(config.loadFromJson("{\"nodes\": [{\"port\": 1}, {\"port\": 2}], \"hash_strategy\": \"simple_hash\"}"));
+    EXPECT_EQ(config.getHashStrategy(), ClusterConfig::HASH_MODULO);
+    EXPECT_EQ(config.getAllNodes()[1].id, "server-2");
+    for (int i = 0; i < 1000; ++i) {
+        std::string key = "key:" + std::to_string(i);
+        size_t index = config.getNodeIndex(key);
+        EXPECT_EQ(index, utils::KeyHash(key) % 2);
+        EXPECT_EQ(config.getNodeByKey(key).port, static_cast<int>(index) + 1);
+    }
+}
+
+TEST(HashRingTest, RouteSkipsUnhealthyNode) {
+    ClusterConfig& config = ClusterConfig::getInstance();
+    for (const char* strategy : {"simple_hash", "consistent_hash"}) {
+        ASSERT_TRUE(config.loadFromJson(std::string("{\"nodes\": [{\"port\": 1}, {\"port\": 2}, {\"port\": 3}],"
+                                                    " \"hash_strategy\": \"") + strategy + "\"}"));
+        std::string key;
+        for (int i = 0; config.getNodeIndex(key = "key:" + std::to_string(i)) != 1; ++i) {
+        }
+        EXPECT_EQ(config.getNodeByKey(key).id, "server-2");
+
+        // 重试不再回到被标记的节点，所属节点不变
+        config.markNodeUnhealthy("server-2");
+        NodeInfo node = config.getNodeByKey(key);
+        EXPECT_NE(node.id, "server-2");
+        EXPECT_TRUE(node.is_healthy);
+        EXPECT_EQ(config.getNodeIndex(key), 1u);
+        EXPECT_FALSE(config.getAllNodes()[1].is_healthy);
+
+        // 所有节点都不健康时仍然路由到所属节点
+        config.markNodeUnhealthy("server-1");
+        config.markNodeUnhealthy("server-3");
+        EXPECT_EQ(config.getNodeByKey(key).id, "server-2");
+
+        for (const char* id : {"server-1", "server-2", "server-3"}) {
+            config.markNodeHealthy(id);
+        }
+        EXPECT_EQ(config.getNodeByKey(key).id, "server-2");
+    }
+}
+
+TEST(HashRingTest, ReloadPublishesNewTable) {
+    ClusterConfig& config = ClusterConfig::getInstance();
+    ASSERT_TRUE(config.loadFromJson("{\"nodes\": [{\"port\": 1}, {\"port\": 2}]}"));
+    std::shared_ptr<const ClusterConfig::Table> old = config.snapshot();
+    config.markNodeUnhealthy("server-2");
+
+    ASSERT_TRUE(config.loadFromJson("{\"nodes\": [{\"port\": 11}, {\"port\": 12}, {\"port\": 13}]}"));
+    // 旧表不受重新加载影响，健康状态按节点id保留
+    ASSERT_EQ(old->nodes.size(), 2u);
+    EXPECT_EQ(old->nodes[1].port, 2);
+    EXPECT_EQ(config.getNodeCount(), 3u);
+    EXPECT_FALSE(config.getAllNodes()[1].is_healthy);
+    EXPECT_FALSE(old->isHealthy(1));
+
+    // 加载失败时保留当前的表
+    EXPECT_FALSE(config.loadFromJson("{\"nodes\": []}"));
+    EXPECT_EQ(config.getNodeCount(), 3u);
+    config.markNodeHealthy("server-2");
+    EXPECT_TRUE(old->isHealthy(1));
+}
+
+TEST(HashRingTest, RoutingConcurrentWithReloadAndHealthChanges) {
+    ClusterConfig& config = ClusterConfig::getInstance();
+    ASSERT_TRUE(config.loadFromJson("{\"nodes\": [{\"port\": 1}, {\"port\": 2}]}"));
+    std::atomic<bool> stop(false);
+    std::thread writer([&] {
+        for (int i = 0; i < 200; ++i) {
+            std::string json = i % 2 ? "{\"nodes\": [{\"port\": 1}, {\"port\": 2}]}"
+                                     : "{\"nodes\": [{\"port\": 1}, {\"port\": 2}, {\"port\": 3}], "
+                                       "\"hash_strategy\": \"consistent_hash\", \"virtual_nodes\": 8}";
+            config.loadFromJson(json);
+            config.markNodeUnhealthy("server-1");
+            config.markNodeHealthy("server-1");
+        }
+        stop = true;
+    });
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&config, &stop, t] {
+            for (int i = 0; !stop; ++i) {
+                std::string key = "key:" + std::to_string(t) + ":" + std::to_string(i);
+                NodeInfo node = config.getNodeByKey(key);
+                EXPECT_GE(node.port, 1);
+                EXPECT_LE(node.port, 3);
+                std::shared_ptr<const ClusterConfig::Table> table = config.snapshot();
+                EXPECT_LT(table->routeIndex(key), table->nodes.size());
+            }
+        });
+    }
+    writer.join();
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+}
+
+TEST(HashRingTest, RouteOutlivesReload) {
+    ClusterConfig& config = ClusterConfig::getInstance();
+    ASSERT_TRUE(config.loadFromJson("{\"nodes\": [{\"port\": 1}, {\"port\": 2}]}"));
+    Router router;
+    std::shared_ptr<const NodeInfo> node = router.route("key");
+    int port = node->port;
+    EXPECT_EQ(static_cast<size_t>(port), config.getNodeIndex("key") + 1);
+
+    // 节点指向发布时的节点表，重新加载后仍可使用
+    ASSERT_TRUE(config.loadFromJson("{\"nodes\": [{\"port\": 11}, {\"port\": 12}, {\"port\": 13}]}"));
+    EXPECT_EQ(node->port, port);
+    EXPECT_GT(router.route("key")->port, 10);
+}
+
+TEST(HashRingTest, RejectsBadNumbersInConfig) {
+    ClusterConfig& config = ClusterConfig::getInstance();
+    ASSERT_TRUE(config.loadFromJson("{\"nodes\": [{\"port\": 1}, {\"port\": 2}]}"));
+    for (const char* json : {"{\"nodes\": [{\"port\": 99999999999}]}", "{\"nodes\": [{\"port\": \"abc\"}]}",
+                             "{\"nodes\": [{\"port\": 70000}]}", "{\"nodes\": [{\"port\": 1, \"weight\": 1e9}]}",
+                             "{\"nodes\": [{\"port\": 1, \"shard_id\": 99999999999}]}",
+                             "{\"nodes\": [{\"port\": 1}], \"virtual_nodes\": 99999999999}"}) {
+        EXPECT_FALSE(config.loadFromJson(json)) << json;
+        EXPECT_EQ(config.getNodeCount(), 2u) << json;
+    }
+
+    // weight和virtual_nodes超过上限时按上限构建哈希环
+    ASSERT_TRUE(config.loadFromJson("{\"nodes\": [{\"port\": 1, \"weight\": 2000000000}, {\"port\": 2}],"
+                                    " \"hash_strategy\": \"consistent_hash\", \"virtual_nodes\": 2000000000}"));
+    std::shared_ptr<const ClusterConfig::Table> table = config.snapshot();
+    EXPECT_EQ(table->nodes[0].weight, ClusterConfig::kMaxNodeWeight);
+    EXPECT_EQ(table->ring.pointCount(),
+              static_cast<size_t>(ClusterConfig::kMaxVirtualNodes) * (ClusterConfig::kMaxNodeWeight + 1));
+}
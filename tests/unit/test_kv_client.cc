@@ -0,0 +1,164 @@
+// tests/unit/test_kv_client.cc
+#include "src/client/kv_client.h"
+#include "src/core/kv_store.h"
+#include "src/network/simple_server.h"
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+int NextPort() {
+    static int port = 25000 + getpid() % 15000;
+    return port++;
+}
+
+}  // namespace
+
+// 三个节点：前两个是普通服务器，第三个是不支持多key命令的分片模式服务器
+class BatchClientTest : public ::testing::Test {
+protected:
+    static const size_t kNodes = 3;
+
+    void SetUp() override {
+        std::string json = "{\"nodes\": [";
+        for (size_t n = 0; n < kNodes; ++n) {
+            stores.push_back(KVStore::CreateMemoryStore());
+            std::unique_ptr<SimpleServer> server;
+            int port = 0;
+            for (int attempt = 0; attempt < 10 && !server; ++attempt) {
+                port = NextPort();
+                if (n + 1 < kNodes) {
+                    server.reset(new SimpleServer(port, stores.back(), ServerOptions()));
+                } else {
+                    server.reset(new SimpleServer(port, std::vector<std::shared_ptr<KVStore>>{stores.back()},
+                                                  ServerOptions()));
+                }
+                if (!server->Start()) {
+                    server.reset();
+                }
+            }
+            ASSERT_TRUE(server);
+            servers.push_back(std::move(server));
+            json += std::string(n ? ", " : "") + "{\"port\": " + std::to_string(port) + "}";
+        }
+        ASSERT_TRUE(ClusterConfig::getInstance().loadFromJson(json + "]}"));
+        // 健康状态按节点id保留，清掉前一个测试留下的标记
+        for (const NodeInfo& node : ClusterConfig::getInstance().getAllNodes()) {
+            ClusterConfig::getInstance().markNodeHealthy(node.id);
+        }
+    }
+
+    void TearDown() override {
+        for (auto& server : servers) {
+            if (server) {
+                server->Stop();
+            }
+        }
+    }
+
+    std::vector<std::shared_ptr<KVStore>> stores;
+    std::vector<std::unique_ptr<SimpleServer>> servers;
+};
+
+const size_t BatchClientTest::kNodes;
+
+TEST_F(BatchClientTest, SpreadsKeysAndKeepsCallerOrder) {
+    KVClient client;
+    std::vector<std::pair<std::string, std::string>> kvs;
+    for (int i = 0; i < 1000; ++i) {
+        kvs.emplace_back("key" + std::to_string(i), "value " + std::to_string(i));
+    }
+    std::vector<KeyResult> put_results;
+    ASSERT_TRUE(client.batchPut(kvs, &put_results));
+    ASSERT_EQ(put_results.size(), kvs.size());
+
+    size_t total = 0;
+    for (size_t n = 0; n < kNodes; ++n) {
+        EXPECT_GT(stores[n]->Size(), 0u);
+        total += stores[n]->Size();
+    }
+    EXPECT_EQ(total, kvs.size());
+    for (const auto& kv : kvs) {
+        size_t node = ClusterConfig::getInstance().getNodeIndex(kv.first);
+        EXPECT_TRUE(stores[node]->Contains(kv.first).ok());
+    }
+
+    // 打乱顺序并混入不存在的key，结果仍与参数一一对应
+    std::vector<std::string> keys;
+    for (int i = 999; i >= 0; i -= 3) {
+        keys.push_back("key" + std::to_string(i));
+        keys.push_back("missing" + std::to_string(i));
+    }
+    std::vector<KeyResult> results = client.batchGet(keys);
+    ASSERT_EQ(results.size(), keys.size());
+    for (size_t j = 0; j < keys.size(); ++j) {
+        EXPECT_TRUE(results[j].ok) << keys[j] << ": " << results[j].error;
+        if (j % 2 == 0) {
+            EXPECT_TRUE(results[j].found);
+            EXPECT_EQ(results[j].value, "value " + keys[j].substr(3));
+        } else {
+            EXPECT_FALSE(results[j].found);
+        }
+    }
+}
+
+TEST_F(BatchClientTest, ReportsFailuresPerKey) {
+    KVClient client;
+    std::vector<std::string> keys;
+    for (int i = 0; i < 300; ++i) {
+        keys.push_back("key" + std::to_string(i));
+        stores[ClusterConfig::getInstance().getNodeIndex(keys.back())]->Put(keys.back(), "v");
+    }
+    servers[1]->Stop();
+    servers[1].reset();
+
+    std::vector<KeyResult> results = client.batchGet(keys);
+    size_t failed = 0;
+    for (size_t j = 0; j < keys.size(); ++j) {
+        if (ClusterConfig::getInstance().getNodeIndex(keys[j]) == 1) {
+            EXPECT_FALSE(results[j].ok);
+            EXPECT_FALSE(results[j].error.empty());
+            failed++;
+        } else {
+            EXPECT_TRUE(results[j].ok) << results[j].error;
+            EXPECT_EQ(results[j].value, "v");
+        }
+    }
+    EXPECT_GT(failed, 0u);
+
+    // 连接失败后节点被标记为不健康，之后的批量写与单key写一样改发到下一个健康节点
+    std::vector<std::pair<std::string, std::string>> kvs;
+    for (const std::string& key : keys) {
+        kvs.emplace_back(key, "new");
+    }
+    std::vector<KeyResult> put_results;
+    EXPECT_TRUE(client.batchPut(kvs, &put_results));
+    results = client.batchGet(keys);
+    for (size_t j = 0; j < keys.size(); ++j) {
+        EXPECT_TRUE(put_results[j].ok) << put_results[j].error;
+        EXPECT_EQ(results[j].value, "new") << keys[j];
+    }
+}
+
+TEST_F(BatchClientTest, BatchRoutesLikeSingleKeyCalls) {
+    KVClient client;
+    std::string key;
+    for (int i = 0; ClusterConfig::getInstance().getNodeIndex(key = "key" + std::to_string(i)) != 0; ++i) {
+    }
+    ClusterConfig::getInstance().markNodeUnhealthy("server-1");
+
+    // 单key写入改发到其他节点，批量读取必须读同一个节点
+    ASSERT_TRUE(client.put(key, "fallback"));
+    EXPECT_FALSE(stores[0]->Contains(key).ok());
+    std::vector<KeyResult> results = client.batchGet({key});
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_TRUE(results[0].found);
+    EXPECT_EQ(results[0].value, "fallback");
+
+    ASSERT_TRUE(client.batchPut({{key, "batch"}}));
+    EXPECT_EQ(client.get(key), "batch");
+}
@@ -2,6 +2,8 @@
 #include "src/core/kv_store.h"
 #include <gtest/gtest.h>
 #include <memory>
+#include <string>
+#include <vector>
 
 class MemoryStoreTest : public ::testing::Test {
 protected:
@@ -57,6 +59,77 @@ TEST_F(MemoryStoreTest, Size) {
     EXPECT_EQ(store->Size(), 1);
 }
 
+TEST_F(MemoryStoreTest, StatsTrackLogicalBytes) {
+    store->Put("key1", "value1");
+    store->Put("key2", std::string(1000, 'x'));
+    StoreStats stats = store->GetStats();
+    EXPECT_EQ(stats.keys, 2u);
+    EXPECT_EQ(stats.logical_bytes, 4u + 6u + 4u + 1000u);
+    EXPECT_GE(stats.used_bytes, stats.logical_bytes);
+    EXPECT_GE(stats.allocator_bytes, stats.used_bytes);
+
+    store->Put("key2", "v");
+    store->Delete("key1");
+    stats = store->GetStats();
+    EXPECT_EQ(stats.logical_bytes, 4u + 1u);
+}
+
+// 批量接口与逐个调用单key接口结果一致，同一批中重复的key按顺序生效
+TEST_F(MemoryStoreTest, MultiKeyOperations) {
+    std::vector<std::string> keys;
+    std::vector<std::string> values;
+    for (int i = 0; i < 100; ++i) {
+        keys.push_back("key" + std::to_string(i));
+        values.push_back("value" + std::to_string(i));
+    }
+    keys.push_back("key0");
+    values.push_back("latest");
+    ASSERT_TRUE(store->MultiPut(keys, values).ok());
+    EXPECT_EQ(store->Size(), 100u);
+
+    std::vector<std::string> found_values;
+    std::vector<char> found;
+    store->MultiGet({"key5", "missing", "key0", "key99"}, &found_values, &found);
+    EXPECT_EQ(found, (std::vector<char>{1, 0, 1, 1}));
+    EXPECT_EQ(found_values[0], "value5");
+    EXPECT_EQ(found_values[2], "latest");
+    EXPECT_EQ(found_values[3], "value99");
+    EXPECT_EQ(store->GetStats().hits, 3u);
+    EXPECT_EQ(store->GetStats().misses, 1u);
+
+    EXPECT_EQ(store->MultiDelete({"key1", "key2", "missing", "key1"}), 2u);
+    EXPECT_EQ(store->Size(), 98u);
+    EXPECT_TRUE(store->Contains("key3").ok());
+    EXPECT_TRUE(store->Contains("key2").is_key_not_found());
+}
+
+TEST(MemoryStoreLimitTest, MaxMemoryRejectsPuts) {
+    const size_t kLimit = 1024 * 1024;
+    auto store = KVStore::CreateMemoryStore(kLimit);
+    std::string value(100, 'v');
+
+    Status status;
+    int stored = 0;
+    for (int i = 0; i < 100000; ++i) {
+        status = store->Put("key" + std::to_string(i), value);
+        if (!status.ok()) {
+            break;
+        }
+        stored++;
+    }
+    EXPECT_GT(stored, 0);
+    EXPECT_TRUE(status.is_out_of_memory());
+    EXPECT_EQ(store->Size(), static_cast<size_t>(stored));
+    EXPECT_LE(store->GetStats().used_bytes, kLimit);
+    EXPECT_EQ(store->GetStats().evictions, 0u);
+
+    // 删除不受限制，读取照常
+    std::string out;
+    EXPECT_TRUE(store->Get("key0", out).ok());
+    EXPECT_TRUE(store->Delete("key0").ok());
+    EXPECT_EQ(store->GetStats().maxmemory, kLimit);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,250 @@
+// tests/unit/test_lsm_store.cc
+#include "src/core/kv_store.h"
+#include "src/storage/bloom_filter.h"
+#include "src/storage/lsm_store.h"
+#include "src/storage/sstable.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+class LsmStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char dir[] = "/tmp/kv_lsm_XXXXXX";
+        ASSERT_NE(mkdtemp(dir), nullptr);
+        options.dir = dir;
+        // 用很小的内存表和层大小，让少量数据也能触发刷盘和多层合并
+        options.memtable_bytes = 64 * 1024;
+        options.target_file_bytes = 32 * 1024;
+        options.level1_bytes = 128 * 1024;
+        options.l0_compaction_trigger = 2;
+    }
+
+    void TearDown() override {
+        store.reset();
+        std::string command = "rm -rf " + options.dir;
+        ASSERT_EQ(std::system(command.c_str()), 0);
+    }
+
+    void Reopen() {
+        store.reset();
+        Status s = LsmStore::Open(options, &store);
+        ASSERT_TRUE(s.ok()) << s.message;
+    }
+
+    static std::string Key(int i) {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "key%08d", i);
+        return buf;
+    }
+
+    LsmOptions options;
+    std::unique_ptr<LsmStore> store;
+};
+
+TEST_F(LsmStoreTest, SSTableRoundTrip) {
+    std::string path = options.dir + "/table.sst";
+    SSTableBuilder builder(path, 10);
+    ASSERT_TRUE(builder.Open().ok());
+    for (int i = 0; i < 5000; ++i) {
+        ASSERT_TRUE(builder.Add(Key(i * 2), i % 10 == 0 ? std::string() : "value" + std::to_string(i), i % 10 == 0)
+                        .ok());
+    }
+    ASSERT_TRUE(builder.Finish().ok());
+
+    std::atomic<uint64_t> block_reads{0};
+    std::shared_ptr<SSTable> table;
+    Status s = SSTable::Open(path, builder.FileSize(), &block_reads, &table);
+    ASSERT_TRUE(s.ok()) << s.message;
+    EXPECT_EQ(table->entries(), 5000u);
+
+    std::string value;
+    bool deleted = false;
+    std::string key = Key(22);
+    ASSERT_TRUE(table->Get(key, BloomFilter::Hash(key.data(), key.size()), &value, &deleted, &s));
+    EXPECT_FALSE(deleted);
+    EXPECT_EQ(value, "value11");
+    key = Key(20);
+    ASSERT_TRUE(table->Get(key, BloomFilter::Hash(key.data(), key.size()), &value, &deleted, &s));
+    EXPECT_TRUE(deleted);
+    key = Key(23);
+    EXPECT_FALSE(table->Get(key, BloomFilter::Hash(key.data(), key.size()), &value, &deleted, &s));
+    EXPECT_TRUE(s.ok());
+
+    auto it = table->NewIterator();
+    it->Seek(Key(3));
+    ASSERT_TRUE(it->Valid());
+    EXPECT_EQ(it->key(), Key(4));
+    int count = 0;
+    for (it->Seek(std::string()); it->Valid(); it->Next()) {
+        EXPECT_EQ(it->deleted(), count % 10 == 0);
+        count++;
+    }
+    EXPECT_TRUE(it->status().ok());
+    EXPECT_EQ(count, 5000);
+    EXPECT_GT(block_reads.load(), 1u);
+}
+
+TEST_F(LsmStoreTest, BasicOperations) {
+    Reopen();
+    std::string value;
+    EXPECT_TRUE(store->Get("missing", value).is_key_not_found());
+    ASSERT_TRUE(store->Put("a", "1").ok());
+    ASSERT_TRUE(store->Put("a", "2").ok());
+    ASSERT_TRUE(store->Get("a", value).ok());
+    EXPECT_EQ(value, "2");
+    EXPECT_TRUE(store->Contains("a").ok());
+    ASSERT_TRUE(store->Delete("a").ok());
+    EXPECT_TRUE(store->Delete("a").is_key_not_found());
+    EXPECT_TRUE(store->Get("a", value).is_key_not_found());
+    EXPECT_FALSE(store->Put("", "v").ok());
+}
+
+// 数据远大于内存表，读写穿过多层表；覆盖写和删除要遮住更旧的版本
+TEST_F(LsmStoreTest, FlushAndCompactAcrossLevels) {
+    Reopen();
+    std::map<std::string, std::string> expected;
+    std::mt19937 rng(7);
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 8000; ++i) {
+            std::string value = "v" + std::to_string(round) + "-" + std::string(rng() % 40, 'x');
+            ASSERT_TRUE(store->Put(Key(i), value).ok());
+            expected[Key(i)] = value;
+        }
+        for (int i = round; i < 8000; i += 7) {
+            if (expected.erase(Key(i))) {
+                ASSERT_TRUE(store->Delete(Key(i)).ok());
+            }
+        }
+    }
+    ASSERT_TRUE(store->Flush().ok());
+
+    LsmStats stats = store->GetLsmStats();
+    EXPECT_GT(stats.compactions, 0u);
+    size_t deeper_files = 0;
+    for (size_t level = 1; level < stats.files_per_level.size(); ++level) {
+        deeper_files += stats.files_per_level[level];
+    }
+    EXPECT_GT(deeper_files, 0u);
+    EXPECT_LT(stats.files_per_level[0], options.l0_compaction_trigger);
+
+    std::string value;
+    for (int i = 0; i < 8000; ++i) {
+        auto it = expected.find(Key(i));
+        if (it == expected.end()) {
+            ASSERT_TRUE(store->Get(Key(i), value).is_key_not_found()) << Key(i);
+        } else {
+            ASSERT_TRUE(store->Get(Key(i), value).ok()) << Key(i);
+            ASSERT_EQ(value, it->second);
+        }
+    }
+
+    // 有序遍历与期望完全一致，删除标记不出现
+    auto expect_it = expected.begin();
+    auto it = store->NewIterator();
+    for (it->Seek(std::string()); it->Valid(); it->Next(), ++expect_it) {
+        ASSERT_NE(expect_it, expected.end());
+        ASSERT_EQ(it->key(), expect_it->first);
+        ASSERT_EQ(it->value(), expect_it->second);
+    }
+    EXPECT_EQ(expect_it, expected.end());
+}
+
+// 布隆过滤器让不存在的key几乎不读数据块
+TEST_F(LsmStoreTest, BloomFilterAvoidsBlockReads) {
+    Reopen();
+    for (int i = 0; i < 5000; ++i) {
+        store->Put(Key(i * 2), std::string(50, 'v'));
+    }
+    ASSERT_TRUE(store->Flush().ok());
+    uint64_t before = store->GetLsmStats().block_reads;
+    std::string value;
+    for (int i = 0; i < 5000; ++i) {
+        ASSERT_TRUE(store->Get(Key(i * 2 + 1), value).is_key_not_found());
+    }
+    EXPECT_LT(store->GetLsmStats().block_reads - before, 250u);
+}
+
+// 未刷盘的写入在重启后从预写日志恢复，已刷盘的从MANIFEST恢复
+TEST_F(LsmStoreTest, RecoversAfterReopen) {
+    Reopen();
+    for (int i = 0; i < 6000; ++i) {
+        store->Put(Key(i), "value" + std::to_string(i));
+    }
+    store->Delete(Key(5));
+    store->Put("last", "unflushed");
+    Reopen();
+
+    std::string value;
+    ASSERT_TRUE(store->Get("last", value).ok());
+    EXPECT_EQ(value, "unflushed");
+    EXPECT_TRUE(store->Contains(Key(5)).is_key_not_found());
+    for (int i = 0; i < 6000; i += 97) {
+        if (i == 5) {
+            continue;
+        }
+        ASSERT_TRUE(store->Get(Key(i), value).ok()) << Key(i);
+        EXPECT_EQ(value, "value" + std::to_string(i));
+    }
+}
+
+TEST_F(LsmStoreTest, ClearDropsEverything) {
+    Reopen();
+    for (int i = 0; i < 5000; ++i) {
+        store->Put(Key(i), std::string(40, 'v'));
+    }
+    ASSERT_TRUE(store->Flush().ok());
+    store->Put("memtable", "v");
+    store->Clear();
+    EXPECT_EQ(store->Size(), 0u);
+    EXPECT_TRUE(store->Contains(Key(1)).is_key_not_found());
+    store->Put("after", "v");
+
+    Reopen();
+    EXPECT_TRUE(store->Contains(Key(1)).is_key_not_found());
+    EXPECT_TRUE(store->Contains("memtable").is_key_not_found());
+    EXPECT_TRUE(store->Contains("after").ok());
+}
+
+// 后台刷盘和合并期间的并发读写
+TEST_F(LsmStoreTest, ConcurrentReadersAndWriters) {
+    Reopen();
+    const int kThreads = 4;
+    const int kKeysPerThread = 4000;
+    std::atomic<bool> failed{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t]() {
+            std::string value;
+            for (int i = 0; i < kKeysPerThread; ++i) {
+                std::string key = Key(t * kKeysPerThread + i);
+                if (!store->Put(key, key).ok()) {
+                    failed = true;
+                }
+                // 读自己已经写过的key，一定能读到
+                std::string old_key = Key(t * kKeysPerThread + i / 2);
+                if (!store->Get(old_key, value).ok() || value != old_key) {
+                    failed = true;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_FALSE(failed.load());
+    ASSERT_TRUE(store->Flush().ok());
+
+    size_t count = 0;
+    auto it = store->NewIterator();
+    for (it->Seek(std::string()); it->Valid(); it->Next()) {
+        count++;
+    }
+    EXPECT_EQ(count, static_cast<size_t>(kThreads * kKeysPerThread));
+}
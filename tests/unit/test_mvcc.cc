@@ -0,0 +1,233 @@
+// tests/unit/test_mvcc.cc
+#include "src/core/kv_store.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+class MvccTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        store = KVStore::CreateMemoryStore();
+    }
+
+    std::unique_ptr<KVStore> store;
+};
+
+TEST_F(MvccTest, SnapshotSeesPointInTime) {
+    ASSERT_TRUE(store->Put("a", "1").ok());
+    ASSERT_TRUE(store->Put("b", "1").ok());
+    auto snapshot = store->GetSnapshot();
+    ASSERT_NE(snapshot, nullptr);
+
+    store->Put("a", "2");
+    store->Delete("b");
+    store->Put("c", "3");
+
+    std::string value;
+    ASSERT_TRUE(store->Get(*snapshot, "a", value).ok());
+    EXPECT_EQ(value, "1");
+    ASSERT_TRUE(store->Get(*snapshot, "b", value).ok());
+    EXPECT_EQ(value, "1");
+    EXPECT_TRUE(store->Get(*snapshot, "c", value).is_key_not_found());
+
+    // 普通读取看到最新数据
+    ASSERT_TRUE(store->Get("a", value).ok());
+    EXPECT_EQ(value, "2");
+    EXPECT_TRUE(store->Get("b", value).is_key_not_found());
+    ASSERT_TRUE(store->Get("c", value).ok());
+}
+
+TEST_F(MvccTest, EachSnapshotSeesItsOwnVersion) {
+    std::vector<std::shared_ptr<const KVSnapshot>> snapshots;
+    for (int i = 0; i < 10; ++i) {
+        store->Put("k", std::to_string(i));
+        // 中间的快照之间有多次写入
+        store->Put("other", std::to_string(i));
+        snapshots.push_back(store->GetSnapshot());
+    }
+    store->Delete("k");
+    std::string value;
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(store->Get(*snapshots[i], "k", value).ok());
+        EXPECT_EQ(value, std::to_string(i));
+    }
+    EXPECT_TRUE(store->Get("k", value).is_key_not_found());
+}
+
+TEST_F(MvccTest, ClearKeepsSnapshotView) {
+    store->Put("a", "1");
+    auto snapshot = store->GetSnapshot();
+    store->Clear();
+    std::string value;
+    ASSERT_TRUE(store->Get(*snapshot, "a", value).ok());
+    EXPECT_EQ(value, "1");
+    EXPECT_EQ(store->Size(), 0u);
+}
+
+// 旧版本只在有快照可能看到它时保留，最老的快照释放后被回收
+TEST_F(MvccTest, OldVersionsReclaimedWithSnapshots) {
+    for (int i = 0; i < 100; ++i) {
+        store->Put("k" + std::to_string(i), "v0");
+    }
+    store->Put("k0", "v1");
+    EXPECT_EQ(store->GetStats().versions, 0u);
+
+    auto first = store->GetSnapshot();
+    for (int i = 0; i < 100; ++i) {
+        store->Put("k" + std::to_string(i), "v1");
+    }
+    // 快照之后同一个key的再次修改不需要新的版本
+    store->Put("k0", "v2");
+    EXPECT_EQ(store->GetStats().versions, 100u);
+
+    auto second = store->GetSnapshot();
+    store->Put("k0", "v3");
+    StoreStats stats = store->GetStats();
+    EXPECT_EQ(stats.snapshots, 2u);
+    EXPECT_EQ(stats.versions, 101u);
+    std::string value;
+    ASSERT_TRUE(store->Get(*second, "k0", value).ok());
+    EXPECT_EQ(value, "v2");
+
+    // 释放较新的快照不回收任何版本
+    second.reset();
+    EXPECT_EQ(store->GetStats().versions, 101u);
+    ASSERT_TRUE(store->Get(*first, "k0", value).ok());
+    EXPECT_EQ(value, "v1");
+    ASSERT_TRUE(store->Get(*first, "k1", value).ok());
+    EXPECT_EQ(value, "v0");
+
+    first.reset();
+    stats = store->GetStats();
+    EXPECT_EQ(stats.snapshots, 0u);
+    EXPECT_EQ(stats.versions, 0u);
+}
+
+TEST_F(MvccTest, OldestSnapshotReleasePrunesPartially) {
+    store->Put("k", "v0");
+    auto first = store->GetSnapshot();
+    store->Put("k", "v1");
+    auto second = store->GetSnapshot();
+    store->Put("k", "v2");
+    EXPECT_EQ(store->GetStats().versions, 2u);
+
+    first.reset();
+    EXPECT_EQ(store->GetStats().versions, 1u);
+    std::string value;
+    ASSERT_TRUE(store->Get(*second, "k", value).ok());
+    EXPECT_EQ(value, "v1");
+}
+
+TEST_F(MvccTest, ExpiredKeyStaysInSnapshotTakenWhileLive) {
+    ASSERT_TRUE(store->PutWithTtl("k", "v", 50).ok());
+    auto live = store->GetSnapshot();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    auto after = store->GetSnapshot();
+
+    // 到期之后的快照看不到key
+    std::string value;
+    EXPECT_TRUE(store->Get(*after, "k", value).is_key_not_found());
+
+    // 惰性过期删除key之后再覆盖写入，到期前的快照仍能读到原值
+    EXPECT_TRUE(store->Get("k", value).is_key_not_found());
+    ASSERT_TRUE(store->Put("k", "new").ok());
+    ASSERT_TRUE(store->Get(*live, "k", value).ok());
+    EXPECT_EQ(value, "v");
+    EXPECT_TRUE(store->Get(*after, "k", value).is_key_not_found());
+}
+
+TEST_F(MvccTest, ExpireChangeDoesNotLeakIntoSnapshot) {
+    ASSERT_TRUE(store->Put("k", "v").ok());
+    auto snapshot = store->GetSnapshot();
+    ASSERT_TRUE(store->Expire("k", 30).ok());
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+
+    std::string value;
+    ASSERT_TRUE(store->Get(*snapshot, "k", value).ok());
+    EXPECT_EQ(value, "v");
+}
+
+TEST(MvccEvictionTest, EvictedKeyStaysInSnapshot) {
+    auto store = KVStore::CreateMemoryStore(16 * 1024, "lru");
+    const std::string payload(200, 'x');
+    std::vector<std::string> live;
+    for (int i = 0; i < 20; ++i) {
+        std::string key = "k" + std::to_string(i);
+        ASSERT_TRUE(store->Put(key, payload + key).ok());
+    }
+    for (int i = 0; i < 20; ++i) {
+        std::string key = "k" + std::to_string(i);
+        if (store->Contains(key).ok()) {
+            live.push_back(key);
+        }
+    }
+    ASSERT_FALSE(live.empty());
+
+    auto snapshot = store->GetSnapshot();
+    size_t evictions = store->GetStats().evictions;
+    for (int i = 0; i < 200; ++i) {
+        ASSERT_TRUE(store->Put("fill" + std::to_string(i), payload).ok());
+    }
+    ASSERT_GT(store->GetStats().evictions, evictions);
+
+    std::string value;
+    for (const std::string& key : live) {
+        ASSERT_TRUE(store->Get(*snapshot, key, value).ok()) << key;
+        EXPECT_EQ(value, payload + key);
+    }
+}
+
+TEST_F(MvccTest, DeleteOfMissingKeyKeepsNoVersion) {
+    auto snapshot = store->GetSnapshot();
+    EXPECT_TRUE(store->Delete("missing").is_key_not_found());
+    EXPECT_EQ(store->MultiDelete({"missing", "absent"}), 0u);
+    EXPECT_EQ(store->GetStats().versions, 0u);
+}
+
+TEST_F(MvccTest, RejectsForeignSnapshot) {
+    auto other = KVStore::CreateMemoryStore();
+    auto snapshot = other->GetSnapshot();
+    std::string value;
+    Status s = store->Get(*snapshot, "a", value);
+    EXPECT_EQ(s.code, INVALID_ARGUMENT);
+}
+
+TEST(MvccUnsupportedTest, OtherEnginesReturnNull) {
+    auto store = KVStore::CreateShardedMemoryStore();
+    EXPECT_EQ(store->GetSnapshot(), nullptr);
+}
+
+// 写线程依次把a、b改成同一个递增的值，快照中总有b <= a <= b + 1；
+// 不用快照时两次读取之间可能发生多次写入，读到b > a
+TEST_F(MvccTest, MultiKeyReadsAreConsistentUnderWrites) {
+    store->Put("a", "0");
+    store->Put("b", "0");
+    std::atomic<bool> stop{false};
+    std::thread writer([&]() {
+        for (int n = 1; n <= 50000; ++n) {
+            store->Put("a", std::to_string(n));
+            store->Put("b", std::to_string(n));
+        }
+        stop = true;
+    });
+
+    int reads = 0;
+    std::string a;
+    std::string b;
+    while (!stop.load() || reads == 0) {
+        auto snapshot = store->GetSnapshot();
+        ASSERT_TRUE(store->Get(*snapshot, "a", a).ok());
+        std::this_thread::yield();
+        ASSERT_TRUE(store->Get(*snapshot, "b", b).ok());
+        int x = std::stoi(a);
+        int y = std::stoi(b);
+        ASSERT_TRUE(y == x || y + 1 == x) << "a=" << a << " b=" << b;
+        reads++;
+    }
+    writer.join();
+    EXPECT_EQ(store->GetStats().versions, 0u);
+}
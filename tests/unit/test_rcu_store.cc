@@ -0,0 +1,185 @@
+// tests/unit/test_rcu_store.cc
+#include "src/core/kv_store.h"
+#include "src/core/epoch_manager.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+class RcuMemoryStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        store = KVStore::CreateRcuMemoryStore();
+    }
+
+    std::unique_ptr<KVStore> store;
+};
+
+TEST_F(RcuMemoryStoreTest, BasicPutGetDelete) {
+    std::string value;
+
+    EXPECT_TRUE(store->Put("key1", "value1").ok());
+    EXPECT_TRUE(store->Put("key1", "value2").ok());
+    EXPECT_TRUE(store->Get("key1", value).ok());
+    EXPECT_EQ(value, "value2");
+    EXPECT_EQ(store->Size(), 1u);
+
+    EXPECT_TRUE(store->Delete("key1").ok());
+    EXPECT_TRUE(store->Get("key1", value).is_key_not_found());
+    EXPECT_TRUE(store->Contains("key1").is_key_not_found());
+    EXPECT_TRUE(store->Delete("key1").is_key_not_found());
+    EXPECT_EQ(store->Size(), 0u);
+}
+
+TEST_F(RcuMemoryStoreTest, GrowKeepsAllKeys) {
+    const int kKeys = 20000;
+    for (int i = 0; i < kKeys; ++i) {
+        store->Put("key" + std::to_string(i), "value" + std::to_string(i));
+    }
+    EXPECT_EQ(store->Size(), static_cast<size_t>(kKeys));
+
+    std::string value;
+    for (int i = 0; i < kKeys; ++i) {
+        ASSERT_TRUE(store->Get("key" + std::to_string(i), value).ok());
+        ASSERT_EQ(value, "value" + std::to_string(i));
+    }
+
+    store->Clear();
+    EXPECT_EQ(store->Size(), 0u);
+    EXPECT_TRUE(store->Get("key0", value).is_key_not_found());
+}
+
+// 读者与写者（包括扩容和删除）并发执行，读者只能看到完整写入的值
+TEST_F(RcuMemoryStoreTest, ConcurrentReadersSeeConsistentValues) {
+    const int kKeys = 256;
+    for (int i = 0; i < kKeys; ++i) {
+        store->Put("key" + std::to_string(i), "key" + std::to_string(i) + ":0");
+    }
+
+    std::atomic<bool> stop{false};
+    std::atomic<long> bad_reads{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&, t]() {
+            std::string value;
+            int i = t;
+            while (!stop.load()) {
+                std::string key = "key" + std::to_string(i++ % kKeys);
+                if (store->Get(key, value).ok() && value.compare(0, key.size() + 1, key + ":") != 0) {
+                    bad_reads++;
+                }
+            }
+        });
+    }
+
+    std::thread writer([&]() {
+        for (int round = 1; round <= 200; ++round) {
+            for (int i = 0; i < kKeys; ++i) {
+                std::string key = "key" + std::to_string(i);
+                if (i % 7 == round % 7) {
+                    store->Delete(key);
+                } else {
+                    store->Put(key, key + ":" + std::to_string(round));
+                }
+            }
+            // 插入额外的key触发扩容
+            store->Put("extra" + std::to_string(round), "x");
+        }
+    });
+
+    writer.join();
+    stop.store(true);
+    for (auto& th : readers) {
+        th.join();
+    }
+
+    EXPECT_EQ(bad_reads.load(), 0);
+    EpochManager::instance().Reclaim();
+}
+
+TEST(EpochManagerTest, RetiredObjectFreedOnlyAfterReadersLeave) {
+    struct Tracked {
+        explicit Tracked(std::atomic<int>* c) : counter(c) {}
+        ~Tracked() { counter->fetch_add(1); }
+        std::atomic<int>* counter;
+    };
+
+    EpochManager& em = EpochManager::instance();
+    em.Reclaim();
+
+    std::atomic<int> freed{0};
+    std::atomic<bool> entered{false};
+    std::atomic<bool> release{false};
+
+    std::thread reader([&]() {
+        EpochManager::Guard guard;
+        entered.store(true);
+        while (!release.load()) {
+            std::this_thread::yield();
+        }
+    });
+    while (!entered.load()) {
+        std::this_thread::yield();
+    }
+
+    em.Retire(new Tracked(&freed));
+    em.Reclaim();
+    EXPECT_EQ(freed.load(), 0);
+
+    release.store(true);
+    reader.join();
+    em.Reclaim();
+    EXPECT_EQ(freed.load(), 1);
+}
+
+TEST(EpochManagerTest, SlotsRecycledAcrossThreadChurn) {
+    // 远超单个槽位块的线程先后进出临界区，退出的线程归还槽位
+    for (int i = 0; i < 5000; ++i) {
+        std::thread th([]() { EpochManager::Guard guard; });
+        th.join();
+    }
+    SUCCEED();
+}
+
+TEST(EpochManagerTest, ManyConcurrentReadersProtectRetiredObject) {
+    struct Tracked {
+        explicit Tracked(std::atomic<int>* c) : counter(c) {}
+        ~Tracked() { counter->fetch_add(1); }
+        std::atomic<int>* counter;
+    };
+
+    EpochManager& em = EpochManager::instance();
+    em.Reclaim();
+
+    // 同时在临界区内的线程数超过一个槽位块，最后进入的读者落在追加的块里
+    const int kReaders = 200;
+    std::atomic<int> entered{0};
+    std::atomic<bool> release{false};
+    std::vector<std::thread> readers;
+    for (int i = 0; i < kReaders; ++i) {
+        readers.emplace_back([&]() {
+            EpochManager::Guard guard;
+            entered.fetch_add(1);
+            while (!release.load()) {
+                std::this_thread::yield();
+            }
+        });
+    }
+    while (entered.load() < kReaders) {
+        std::this_thread::yield();
+    }
+
+    std::atomic<int> freed{0};
+    em.Retire(new Tracked(&freed));
+    em.Reclaim();
+    EXPECT_EQ(freed.load(), 0);
+
+    release.store(true);
+    for (auto& th : readers) {
+        th.join();
+    }
+    em.Reclaim();
+    EXPECT_EQ(freed.load(), 1);
+}
@@ -0,0 +1,626 @@
+// tests/unit/test_server.cc
+#include "src/core/kv_store.h"
+#include "src/network/simple_server.h"
+#include "src/network/framing.h"
+#include "src/common/protocol.h"
+#include "src/network/shard_worker.h"
+#include "src/network/uring_loop.h"
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+int NextPort() {
+    static int port = 20000 + getpid() % 20000;
+    return port++;
+}
+
+int Connect(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+void SendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        ASSERT_GT(n, 0);
+        sent += static_cast<size_t>(n);
+    }
+}
+
+// 读到count行响应为止
+std::vector<std::string> ReadLines(int fd, size_t count) {
+    std::vector<std::string> lines;
+    std::string buffer;
+    char chunk[4096];
+    while (lines.size() < count) {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            break;
+        }
+        buffer.append(chunk, static_cast<size_t>(n));
+        size_t pos;
+        while ((pos = buffer.find('\n')) != std::string::npos) {
+            lines.push_back(buffer.substr(0, pos));
+            buffer.erase(0, pos + 1);
+        }
+    }
+    return lines;
+}
+
+}  // namespace
+
+class ServerTest : public ::testing::TestWithParam<IoModel> {
+protected:
+    void SetUp() override {
+        if (GetParam() == IO_URING && !UringLoop::Supported()) {
+            GTEST_SKIP() << "io_uring with multishot recv and buffer rings is not available";
+        }
+        ServerOptions options;
+        options.io_model = GetParam();
+        options.reactor_threads = 2;
+        store = KVStore::CreateMemoryStore();
+        for (int attempt = 0; attempt < 10 && !server; ++attempt) {
+            port = NextPort();
+            server.reset(new SimpleServer(port, store, options));
+            if (!server->Start()) {
+                server.reset();
+            }
+        }
+        ASSERT_TRUE(server);
+    }
+
+    void TearDown() override {
+        server.reset();
+    }
+
+    std::shared_ptr<KVStore> store;
+    std::unique_ptr<SimpleServer> server;
+    int port = 0;
+};
+
+TEST_P(ServerTest, RequestResponse) {
+    int fd = Connect(port);
+    ASSERT_GE(fd, 0);
+    SendAll(fd, "SET a 1\n");
+    EXPECT_EQ(ReadLines(fd, 1), std::vector<std::string>{"OK"});
+    SendAll(fd, "GET a\n");
+    EXPECT_EQ(ReadLines(fd, 1), std::vector<std::string>{"OK 1"});
+    SendAll(fd, "PING\n");
+    EXPECT_EQ(ReadLines(fd, 1), std::vector<std::string>{"OK PONG"});
+    close(fd);
+}
+
+TEST_P(ServerTest, ManyConcurrentClients) {
+    const int kClients = 50;
+    const int kRequests = 50;
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+    for (int c = 0; c < kClients; ++c) {
+        threads.emplace_back([&, c]() {
+            int fd = Connect(port);
+            if (fd < 0) {
+                failures++;
+                return;
+            }
+            for (int i = 0; i < kRequests; ++i) {
+                std::string key = "k" + std::to_string(c) + "_" + std::to_string(i);
+                SendAll(fd, "SET " + key + " v" + std::to_string(i) + "\n");
+                std::vector<std::string> set = ReadLines(fd, 1);
+                SendAll(fd, "GET " + key + "\n");
+                std::vector<std::string> get = ReadLines(fd, 1);
+                if (set != std::vector<std::string>{"OK"} ||
+                    get != std::vector<std::string>{"OK v" + std::to_string(i)}) {
+                    failures++;
+                }
+            }
+            close(fd);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(failures.load(), 0);
+    EXPECT_EQ(store->Size(), static_cast<size_t>(kClients * kRequests));
+}
+
+// 一次写入多条命令、一条命令分多次写入都能正确处理
+TEST_P(ServerTest, PipelinedAndSplitCommands) {
+    int fd = Connect(port);
+    ASSERT_GE(fd, 0);
+    SendAll(fd, "SET a 1\nSET b 2\r\nGET a\nGET b\n");
+    std::vector<std::string> expected{"OK", "OK", "OK 1", "OK 2"};
+    EXPECT_EQ(ReadLines(fd, 4), expected);
+
+    SendAll(fd, "GE");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    SendAll(fd, "T ");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    SendAll(fd, "b\nGET");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    SendAll(fd, " a\n");
+    expected = {"OK 2", "OK 1"};
+    EXPECT_EQ(ReadLines(fd, 2), expected);
+
+    // 大量流水线命令的响应可能超过socket发送缓冲
+    std::string batch;
+    const int kBatch = 20000;
+    for (int i = 0; i < kBatch; ++i) {
+        batch += "SET key" + std::to_string(i) + " value" + std::to_string(i) + "\n";
+    }
+    std::thread writer([&]() { SendAll(fd, batch); });
+    std::vector<std::string> lines = ReadLines(fd, kBatch);
+    writer.join();
+    EXPECT_EQ(lines.size(), static_cast<size_t>(kBatch));
+    EXPECT_EQ(store->Size(), static_cast<size_t>(kBatch + 2));
+    close(fd);
+}
+
+// value远大于单次读取的缓冲
+TEST_P(ServerTest, LargeValue) {
+    int fd = Connect(port);
+    ASSERT_GE(fd, 0);
+    std::string value(1 << 20, 'x');
+    SendAll(fd, "SET big " + value + "\nGET big\n");
+    std::vector<std::string> lines = ReadLines(fd, 2);
+    ASSERT_EQ(lines.size(), 2u);
+    EXPECT_EQ(lines[0], "OK");
+    EXPECT_EQ(lines[1], "OK " + value);
+    close(fd);
+}
+
+// RESP请求得到RESP响应，同一连接上的内联命令仍用文本响应
+TEST_P(ServerTest, RespProtocol) {
+    int fd = Connect(port);
+    ASSERT_GE(fd, 0);
+    std::string value = "hello world\r\nsecond line";
+    SendAll(fd, ProtocolParser::EncodeRespCommand({"SET", "k", value}) +
+                ProtocolParser::EncodeRespCommand({"GET", "k"}) +
+                ProtocolParser::EncodeRespCommand({"GET", "missing"}) +
+                ProtocolParser::EncodeRespCommand({"EXISTS", "k"}) +
+                ProtocolParser::EncodeRespCommand({"DEL", "k"}) +
+                ProtocolParser::EncodeRespCommand({"DEL", "k"}) +
+                ProtocolParser::EncodeRespCommand({"NOPE"}) + "PING\n");
+    std::string expected = "+OK\r\n$" + std::to_string(value.size()) + "\r\n" + value + "\r\n" +
+                           "$-1\r\n:1\r\n:1\r\n:0\r\n-ERR Unknown command\r\nOK PONG\n";
+    std::string received;
+    char chunk[4096];
+    while (received.size() < expected.size()) {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        ASSERT_GT(n, 0);
+        received.append(chunk, static_cast<size_t>(n));
+    }
+    EXPECT_EQ(received, expected);
+    close(fd);
+}
+
+// 多key命令的结果作为一个响应返回
+TEST_P(ServerTest, MultiKeyCommands) {
+    int fd = Connect(port);
+    ASSERT_GE(fd, 0);
+    SendAll(fd, "MSET a 1 b 2 c 3\nMGET a missing c\nMDEL a b missing\nMGET a b c\nMSET a\n");
+    std::vector<std::string> lines = ReadLines(fd, 5);
+    ASSERT_EQ(lines.size(), 5u);
+    EXPECT_EQ(lines[0], "OK");
+    EXPECT_EQ(lines[1], "OK 3 1 (nil) 3");
+    EXPECT_EQ(lines[2], "OK 2");
+    EXPECT_EQ(lines[3], "OK 3 (nil) (nil) 3");
+    EXPECT_EQ(lines[4].compare(0, 5, "ERROR"), 0);
+
+    SendAll(fd, ProtocolParser::EncodeRespCommand({"MSET", "x", "hello world", "y", ""}) +
+                ProtocolParser::EncodeRespCommand({"MGET", "x", "nope", "y"}) +
+                ProtocolParser::EncodeRespCommand({"MDEL", "x", "y"}));
+    std::string expected = "+OK\r\n*3\r\n$11\r\nhello world\r\n$-1\r\n$0\r\n\r\n:2\r\n";
+    std::string received;
+    char chunk[4096];
+    while (received.size() < expected.size()) {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        ASSERT_GT(n, 0);
+        received.append(chunk, static_cast<size_t>(n));
+    }
+    EXPECT_EQ(received, expected);
+    EXPECT_EQ(store->Size(), 1u);
+    close(fd);
+}
+
+// 客户端发完命令后只关闭写端，随FIN到达的命令仍要收到完整响应，之后服务器关闭连接
+TEST_P(ServerTest, HalfCloseStillGetsReplies) {
+    std::string value(4 << 20, 'v');
+    std::string expected = "OK\nOK 1\nOK\nOK " + value + "\n";
+    int fd = Connect(port);
+    ASSERT_GE(fd, 0);
+    // 大响应写不进一次发送缓冲，需要在半关闭之后继续写
+    SendAll(fd, "SET a 1\r\nGET a\r\nSET big " + value + "\r\nGET big\r\n");
+    ASSERT_EQ(shutdown(fd, SHUT_WR), 0);
+
+    std::string received;
+    char chunk[65536];
+    for (;;) {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            break;
+        }
+        received.append(chunk, static_cast<size_t>(n));
+    }
+    EXPECT_EQ(received.size(), expected.size());
+    EXPECT_TRUE(received == expected);
+    close(fd);
+}
+
+INSTANTIATE_TEST_CASE_P(IoModels, ServerTest, ::testing::Values(IO_THREAD_PER_CONNECTION, IO_EPOLL, IO_URING));
+
+class ShardServerTest : public ::testing::Test {
+protected:
+    static const size_t kShards = 4;
+
+    void SetUp() override {
+        for (size_t i = 0; i < kShards; ++i) {
+            shards.push_back(KVStore::CreateMemoryStore());
+        }
+        for (int attempt = 0; attempt < 10 && !server; ++attempt) {
+            port = NextPort();
+            server.reset(new SimpleServer(port, shards, ServerOptions()));
+            if (!server->Start()) {
+                server.reset();
+            }
+        }
+        ASSERT_TRUE(server);
+    }
+
+    void TearDown() override {
+        server.reset();
+    }
+
+    std::vector<std::shared_ptr<KVStore>> shards;
+    std::unique_ptr<SimpleServer> server;
+    int port = 0;
+};
+
+const size_t ShardServerTest::kShards;
+
+// 任意连接都能读写任意key，每个key只存放在所属分片
+TEST_F(ShardServerTest, KeysLiveInOwningShard) {
+    const int kKeys = 400;
+    std::vector<int> fds;
+    for (int i = 0; i < 8; ++i) {
+        fds.push_back(Connect(port));
+        ASSERT_GE(fds.back(), 0);
+    }
+    for (int i = 0; i < kKeys; ++i) {
+        int fd = fds[i % fds.size()];
+        SendAll(fd, "SET key" + std::to_string(i) + " v" + std::to_string(i) + "\n");
+        EXPECT_EQ(ReadLines(fd, 1), std::vector<std::string>{"OK"});
+    }
+    for (int i = 0; i < kKeys; ++i) {
+        int fd = fds[(i + 3) % fds.size()];
+        SendAll(fd, "GET key" + std::to_string(i) + "\n");
+        EXPECT_EQ(ReadLines(fd, 1), std::vector<std::string>{"OK v" + std::to_string(i)});
+    }
+    size_t total = 0;
+    for (size_t s = 0; s < kShards; ++s) {
+        EXPECT_GT(shards[s]->Size(), 0u);
+        total += shards[s]->Size();
+    }
+    EXPECT_EQ(total, static_cast<size_t>(kKeys));
+    for (int i = 0; i < kKeys; ++i) {
+        std::string key = "key" + std::to_string(i);
+        EXPECT_TRUE(shards[ShardWorker::ShardForKey(key, kShards)]->Contains(key).ok());
+    }
+    for (int fd : fds) {
+        close(fd);
+    }
+}
+
+// 本地执行和转交给其他分片的命令混在一起时，响应仍按请求顺序返回
+TEST_F(ShardServerTest, PipelinedResponsesKeepOrder) {
+    int fd = Connect(port);
+    ASSERT_GE(fd, 0);
+    const int kBatch = 10000;
+    std::string batch;
+    std::vector<std::string> expected;
+    for (int i = 0; i < kBatch; ++i) {
+        std::string key = "key" + std::to_string(i);
+        batch += "SET " + key + " v" + std::to_string(i) + "\nGET " + key + "\nPING\n";
+        expected.push_back("OK");
+        expected.push_back("OK v" + std::to_string(i));
+        expected.push_back("OK PONG");
+    }
+    std::thread writer([&]() { SendAll(fd, batch); });
+    std::vector<std::string> lines = ReadLines(fd, expected.size());
+    writer.join();
+    EXPECT_EQ(lines, expected);
+    close(fd);
+}
+
+// 半关闭后仍要收到全部响应，包括转交给其他分片、在FIN之后才返回的响应
+TEST_F(ShardServerTest, HalfCloseWaitsForForwardedReplies) {
+    int fd = Connect(port);
+    ASSERT_GE(fd, 0);
+    std::string batch;
+    std::string expected;
+    for (int i = 0; i < 200; ++i) {
+        std::string key = "key" + std::to_string(i);
+        batch += "SET " + key + " v" + std::to_string(i) + "\nGET " + key + "\n";
+        expected += "OK\nOK v" + std::to_string(i) + "\n";
+    }
+    SendAll(fd, batch);
+    ASSERT_EQ(shutdown(fd, SHUT_WR), 0);
+
+    std::string received;
+    char chunk[4096];
+    for (;;) {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            break;
+        }
+        received.append(chunk, static_cast<size_t>(n));
+    }
+    EXPECT_EQ(received, expected);
+    close(fd);
+}
+
+TEST_F(ShardServerTest, InfoAggregatesShardsAndRangeIsRejected) {
+    int fd = Connect(port);
+    ASSERT_GE(fd, 0);
+    for (int i = 0; i < 20; ++i) {
+        SendAll(fd, "SET key" + std::to_string(i) + " v\n");
+        ReadLines(fd, 1);
+    }
+    SendAll(fd, "INFO\n");
+    std::vector<std::string> info = ReadLines(fd, 1);
+    ASSERT_EQ(info.size(), 1u);
+    EXPECT_NE(info[0].find("keys=20 "), std::string::npos);
+    SendAll(fd, "RANGE a z\n");
+    std::vector<std::string> range = ReadLines(fd, 1);
+    ASSERT_EQ(range.size(), 1u);
+    EXPECT_EQ(range[0].compare(0, 5, "ERROR"), 0);
+    close(fd);
+}
+
+TEST(RequestFramerTest, SplitsCommands) {
+    RequestFramer framer;
+    Request request;
+    EXPECT_FALSE(framer.Next(&request));
+    std::string data = "PING\nGET a\r\nSET";
+    framer.Append(data.data(), data.size());
+    ASSERT_TRUE(framer.Next(&request));
+    EXPECT_EQ(request.type, CMD_PING);
+    ASSERT_TRUE(framer.Next(&request));
+    EXPECT_EQ(request.type, CMD_GET);
+    EXPECT_EQ(request.args, std::vector<std::string_view>{"a"});
+    EXPECT_FALSE(request.resp);
+    EXPECT_FALSE(framer.Next(&request));
+    EXPECT_EQ(framer.pending(), 3u);
+    data = " b c\n";
+    framer.Append(data.data(), data.size());
+    ASSERT_TRUE(framer.Next(&request));
+    EXPECT_EQ(request.type, CMD_SET);
+    EXPECT_EQ(request.args, (std::vector<std::string_view>{"b", "c"}));
+    EXPECT_FALSE(framer.Next(&request));
+    EXPECT_EQ(framer.pending(), 0u);
+}
+
+// RESP请求可以被任意切分，参数可以包含任意字节，并且可以与内联命令混用
+TEST(RequestFramerTest, ParsesRespRequests) {
+    std::string value("a b\r\nc\0d", 9);
+    std::string data = ProtocolParser::EncodeRespCommand({"SET", "key", value}) + "PING\n" +
+                       ProtocolParser::EncodeRespCommand({"get", "key"});
+    RequestFramer framer;
+    Request request;
+    // 参数只在下一次Append之前有效，先复制出来
+    std::vector<Request> requests;
+    std::vector<std::vector<std::string>> args;
+    for (char c : data) {
+        framer.Append(&c, 1);
+        while (framer.Next(&request)) {
+            requests.push_back(request);
+            args.emplace_back(request.args.begin(), request.args.end());
+        }
+    }
+    EXPECT_FALSE(framer.broken());
+    ASSERT_EQ(requests.size(), 3u);
+    EXPECT_EQ(requests[0].type, CMD_SET);
+    EXPECT_TRUE(requests[0].resp);
+    EXPECT_EQ(args[0], (std::vector<std::string>{"key", value}));
+    EXPECT_EQ(requests[1].type, CMD_PING);
+    EXPECT_FALSE(requests[1].resp);
+    EXPECT_EQ(requests[2].type, CMD_GET);
+    EXPECT_TRUE(requests[2].resp);
+    EXPECT_EQ(framer.pending(), 0u);
+
+    RequestFramer bad;
+    data = "*1\r\n$3\r\nGETX\r\n";
+    bad.Append(data.data(), data.size());
+    EXPECT_FALSE(bad.Next(&request));
+    EXPECT_TRUE(bad.broken());
+}
+
+TEST(RespTest, ParsesReplies) {
+    std::string data = "+OK\r\n-ERR bad\r\n:42\r\n$-1\r\n$4\r\na\r\nb\r\n*2\r\n$1\r\nk\r\n$1\r\nv\r\n";
+    std::vector<RespReply> replies;
+    size_t pos = 0;
+    while (pos < data.size()) {
+        RespReply reply;
+        size_t consumed = 0;
+        ASSERT_EQ(ProtocolParser::ParseRespReply(data.data() + pos, data.size() - pos, &reply, &consumed), 1);
+        // 不完整的数据要等待更多输入
+        if (consumed > 1) {
+            RespReply partial;
+            size_t ignored;
+            EXPECT_EQ(ProtocolParser::ParseRespReply(data.data() + pos, consumed - 1, &partial, &ignored), 0);
+        }
+        replies.push_back(reply);
+        pos += consumed;
+    }
+    ASSERT_EQ(replies.size(), 6u);
+    EXPECT_EQ(replies[0].type, RespReply::STATUS);
+    EXPECT_EQ(replies[0].str, "OK");
+    EXPECT_EQ(replies[1].type, RespReply::ERROR);
+    EXPECT_EQ(replies[1].str, "ERR bad");
+    EXPECT_EQ(replies[2].type, RespReply::INTEGER);
+    EXPECT_EQ(replies[2].integer, 42);
+    EXPECT_EQ(replies[3].type, RespReply::NIL);
+    EXPECT_EQ(replies[4].type, RespReply::BULK);
+    EXPECT_EQ(replies[4].str, "a\r\nb");
+    ASSERT_EQ(replies[5].type, RespReply::ARRAY);
+    ASSERT_EQ(replies[5].elements.size(), 2u);
+    EXPECT_EQ(replies[5].elements[1].str, "v");
+
+    Response scan;
+    scan.items = {"k", "v"};
+    std::string out = "+OK\r\n";
+    ProtocolParser::FormatRespResponse(CMD_RANGE, scan, &out);
+    EXPECT_EQ(out, "+OK\r\n*2\r\n$1\r\nk\r\n$1\r\nv\r\n");
+}
+
+TEST(RespTest, RejectsOutOfRangeIntegers) {
+    RespReply reply;
+    size_t consumed = 0;
+    std::string data = ":9223372036854775807\r\n";
+    ASSERT_EQ(ProtocolParser::ParseRespReply(data.data(), data.size(), &reply, &consumed), 1);
+    EXPECT_EQ(reply.integer, INT64_MAX);
+    data = ":-9223372036854775808\r\n";
+    ASSERT_EQ(ProtocolParser::ParseRespReply(data.data(), data.size(), &reply, &consumed), 1);
+    EXPECT_EQ(reply.integer, INT64_MIN);
+    for (std::string bad : {":9999999999999999999\r\n", "$9999999999999999999\r\n", "*-9999999999999999999\r\n",
+                            ":+1\r\n", ":1x\r\n", ":-\r\n"}) {
+        EXPECT_EQ(ProtocolParser::ParseRespReply(bad.data(), bad.size(), &reply, &consumed), -1) << bad;
+    }
+}
+
+TEST(RespTest, LargeArrayHeaderDoesNotPreallocate) {
+    // 只收到头部时不按声明的元素个数分配
+    std::string data = "*1000000\r\n$1\r\na\r\n";
+    RespReply reply;
+    size_t consumed = 0;
+    EXPECT_EQ(ProtocolParser::ParseRespReply(data.data(), data.size(), &reply, &consumed), 0);
+    EXPECT_LE(reply.elements.capacity(), 1024u);
+
+    data = "*3\r\n:1\r\n:2\r\n:3\r\n";
+    ASSERT_EQ(ProtocolParser::ParseRespReply(data.data(), data.size(), &reply, &consumed), 1);
+    ASSERT_EQ(reply.elements.size(), 3u);
+    EXPECT_EQ(reply.elements[2].integer, 3);
+}
+
+TEST(RespTest, ScannerResumesAcrossChunks) {
+    std::string data = "*3\r\n$5\r\nhello\r\n*2\r\n:1\r\n$-1\r\n+OK\r\n";
+    size_t total = data.size();
+    data += ":7\r\n";
+    RespScanner scanner;
+    size_t length = 0;
+    // 逐字节追加，收全之前一直返回0
+    for (size_t size = 0; size < total; ++size) {
+        ASSERT_EQ(scanner.Scan(data.data(), size, &length), 0) << size;
+    }
+    ASSERT_EQ(scanner.Scan(data.data(), data.size(), &length), 1);
+    EXPECT_EQ(length, total);
+    RespReply reply;
+    size_t consumed = 0;
+    ASSERT_EQ(ProtocolParser::ParseRespReply(data.data(), length, &reply, &consumed), 1);
+    EXPECT_EQ(reply.elements.size(), 3u);
+
+    // 下一次调用从新的响应开始
+    data.erase(0, length);
+    ASSERT_EQ(scanner.Scan(data.data(), data.size(), &length), 1);
+    EXPECT_EQ(length, data.size());
+
+    data = "*1\r\n!x\r\n";
+    EXPECT_EQ(scanner.Scan(data.data(), data.size(), &length), -1);
+}
+
+TEST(ProtocolTest, ParsesCommandsCaseInsensitively) {
+    const std::vector<std::pair<std::string, CommandType>> commands = {
+        {"SET", CMD_SET}, {"get", CMD_GET}, {"Del", CMD_DEL}, {"delete", CMD_DEL}, {"EXISTS", CMD_EXISTS},
+        {"ping", CMD_PING}, {"QUIT", CMD_QUIT}, {"exit", CMD_QUIT}, {"INFO", CMD_INFO}, {"expire", CMD_EXPIRE},
+        {"ttl", CMD_TTL}, {"RANGE", CMD_RANGE}, {"prefix", CMD_PREFIX}, {"BGSAVE", CMD_BGSAVE},
+        {"", CMD_UNKNOWN}, {"GE", CMD_UNKNOWN}, {"GETS", CMD_UNKNOWN}, {"SEt ", CMD_UNKNOWN},
+        {"mget", CMD_MGET}, {"MSET", CMD_MSET}, {"MDel", CMD_MDEL}, {"MPUT", CMD_UNKNOWN},
+        {"EXPIRY", CMD_UNKNOWN}, {std::string("gEt\0", 4), CMD_UNKNOWN}, {"[ET", CMD_UNKNOWN}};
+    for (const auto& command : commands) {
+        EXPECT_EQ(ProtocolParser::ParseCommand(command.first), command.second) << command.first;
+    }
+
+    Request request;
+    ProtocolParser::ParseRequest("  get   key  ", &request);
+    EXPECT_EQ(request.type, CMD_GET);
+    EXPECT_EQ(request.args, std::vector<std::string_view>{"key"});
+}
+
+TEST(ResponseQueueTest, KeepsUnsentBytesOnFullSocket) {
+    int fds[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    ResponseQueue queue;
+    std::string expected;
+    for (int i = 0; i < 5000; ++i) {
+        std::string response = "OK " + std::string(100, static_cast<char>('a' + i % 26)) + "\n";
+        expected += response;
+        queue.Push(response);
+    }
+    // 对端不读取时写满缓冲后停下，剩余数据留在队列中
+    ASSERT_TRUE(queue.WriteTo(fds[0]));
+    EXPECT_FALSE(queue.empty());
+
+    std::string received;
+    char chunk[65536];
+    while (received.size() < expected.size()) {
+        ssize_t n = recv(fds[1], chunk, sizeof(chunk), 0);
+        ASSERT_GT(n, 0);
+        received.append(chunk, static_cast<size_t>(n));
+        ASSERT_TRUE(queue.WriteTo(fds[0]));
+    }
+    EXPECT_TRUE(queue.empty());
+    EXPECT_EQ(queue.bytes(), 0u);
+    EXPECT_EQ(received, expected);
+
+    close(fds[1]);
+    queue.Push("OK\n");
+    EXPECT_FALSE(queue.WriteTo(fds[0]));
+    close(fds[0]);
+}
+
+// 异步发送期间追加的响应不影响已交给发送的数据
+TEST(ResponseQueueTest, AppendsDuringAsyncSend) {
+    ResponseQueue queue;
+    struct iovec iov;
+    EXPECT_FALSE(queue.FillIov(&iov));
+    queue.buffer()->append("first\n");
+    ASSERT_TRUE(queue.FillIov(&iov));
+    const char* base = static_cast<const char*>(iov.iov_base);
+    for (int i = 0; i < 1000; ++i) {
+        queue.Push(std::string(100, 'x'));
+    }
+    EXPECT_EQ(std::string(base, iov.iov_len), "first\n");
+    EXPECT_EQ(queue.bytes(), 6u + 100000u);
+
+    queue.Consume(2);
+    ASSERT_TRUE(queue.FillIov(&iov));
+    EXPECT_EQ(std::string(static_cast<const char*>(iov.iov_base), iov.iov_len), "rst\n");
+    queue.Consume(4);
+    ASSERT_TRUE(queue.FillIov(&iov));
+    EXPECT_EQ(iov.iov_len, 100000u);
+    queue.Consume(iov.iov_len);
+    EXPECT_TRUE(queue.empty());
+    EXPECT_FALSE(queue.FillIov(&iov));
+}
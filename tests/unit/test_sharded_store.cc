@@ -0,0 +1,150 @@
+// tests/unit/test_sharded_store.cc
+#include "src/core/kv_store.h"
+#include "src/core/sharded_memory_store.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+class ShardedMemoryStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        store = KVStore::CreateShardedMemoryStore();
+    }
+
+    std::unique_ptr<KVStore> store;
+};
+
+TEST_F(ShardedMemoryStoreTest, BasicPutGetDelete) {
+    std::string value;
+
+    EXPECT_TRUE(store->Put("key1", "value1").ok());
+    EXPECT_TRUE(store->Put("key2", "value2").ok());
+    EXPECT_TRUE(store->Put("key1", "value1b").ok());
+
+    EXPECT_TRUE(store->Get("key1", value).ok());
+    EXPECT_EQ(value, "value1b");
+    EXPECT_TRUE(store->Contains("key2").ok());
+
+    EXPECT_TRUE(store->Delete("key2").ok());
+    EXPECT_TRUE(store->Get("key2", value).is_key_not_found());
+    EXPECT_TRUE(store->Delete("key2").is_key_not_found());
+    EXPECT_FALSE(store->Put("", "value").ok());
+}
+
+TEST_F(ShardedMemoryStoreTest, SizeAggregatesShards) {
+    for (int i = 0; i < 1000; ++i) {
+        store->Put("key" + std::to_string(i), "v");
+    }
+    EXPECT_EQ(store->Size(), 1000u);
+
+    for (int i = 0; i < 500; ++i) {
+        store->Delete("key" + std::to_string(i));
+    }
+    EXPECT_EQ(store->Size(), 500u);
+
+    store->Clear();
+    EXPECT_EQ(store->Size(), 0u);
+}
+
+// 一批key分散在各个分片，结果按原顺序返回
+TEST_F(ShardedMemoryStoreTest, MultiKeyOperations) {
+    std::vector<std::string> keys;
+    std::vector<std::string> values;
+    for (int i = 0; i < 1000; ++i) {
+        keys.push_back("key" + std::to_string(i));
+        values.push_back("value" + std::to_string(i));
+    }
+    keys.push_back("key7");
+    values.push_back("latest");
+    ASSERT_TRUE(store->MultiPut(keys, values).ok());
+    EXPECT_EQ(store->Size(), 1000u);
+    EXPECT_FALSE(store->MultiPut({"a", ""}, {"1", "2"}).ok());
+
+    keys.pop_back();
+    keys.push_back("missing");
+    std::vector<std::string> found_values;
+    std::vector<char> found;
+    store->MultiGet(keys, &found_values, &found);
+    ASSERT_EQ(found.size(), keys.size());
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(found[i]);
+        EXPECT_EQ(found_values[i], i == 7 ? "latest" : "value" + std::to_string(i));
+    }
+    EXPECT_FALSE(found.back());
+
+    EXPECT_EQ(store->MultiDelete(keys), 1000u);
+    EXPECT_EQ(store->Size(), 0u);
+}
+
+TEST(ShardedMemoryStoreConfigTest, ShardCountRoundsUpToPowerOfTwo) {
+    ShardedMemoryStore store(10);
+    EXPECT_EQ(store.ShardCount(), 16u);
+}
+
+namespace {
+
+// 多线程混合负载（80% GET / 20% SET），返回每秒操作数
+double RunMixedWorkload(KVStore* store, int num_threads, int ops_per_thread) {
+    const int kKeySpace = 10000;
+    for (int i = 0; i < kKeySpace; ++i) {
+        store->Put("key" + std::to_string(i), "value" + std::to_string(i));
+    }
+
+    std::atomic<bool> start{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t]() {
+            while (!start.load()) {
+                std::this_thread::yield();
+            }
+            std::string value;
+            unsigned int seed = 12345u + t;
+            for (int i = 0; i < ops_per_thread; ++i) {
+                seed = seed * 1103515245u + 12345u;
+                std::string key = "key" + std::to_string((seed >> 8) % kKeySpace);
+                if (seed % 5 == 0) {
+                    store->Put(key, "updated");
+                } else {
+                    store->Get(key, value);
+                }
+            }
+        });
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    start.store(true);
+    for (auto& th : threads) {
+        th.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return num_threads * ops_per_thread / seconds;
+}
+
+}  // namespace
+
+TEST(ShardedMemoryStoreThroughputTest, CompareWithMemoryStore) {
+    unsigned int hw = std::thread::hardware_concurrency();
+    int num_threads = static_cast<int>(hw < 4 ? 4 : hw);
+    const int kOpsPerThread = 200000;
+
+    auto single = KVStore::CreateMemoryStore();
+    auto sharded = KVStore::CreateShardedMemoryStore();
+
+    double single_ops = RunMixedWorkload(single.get(), num_threads, kOpsPerThread);
+    double sharded_ops = RunMixedWorkload(sharded.get(), num_threads, kOpsPerThread);
+
+    std::cout << "[Throughput] threads=" << num_threads
+              << " MemoryStore=" << static_cast<long>(single_ops) << " ops/s"
+              << " ShardedMemoryStore=" << static_cast<long>(sharded_ops) << " ops/s"
+              << " (x" << sharded_ops / single_ops << ")" << std::endl;
+
+    // 吞吐量取决于机器核数，这里只校验并发写入后数据一致
+    EXPECT_EQ(single->Size(), sharded->Size());
+    std::string value;
+    EXPECT_TRUE(sharded->Get("key0", value).ok());
+}
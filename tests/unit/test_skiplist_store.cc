@@ -0,0 +1,161 @@
+// tests/unit/test_skiplist_store.cc
+#include "src/core/kv_store.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+class SkipListStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        store = KVStore::CreateSkipListStore();
+    }
+
+    std::unique_ptr<KVStore> store;
+};
+
+namespace {
+
+std::string PaddedKey(int i) {
+    char buf[16];
+    std::snprintf(buf, sizeof(buf), "key%06d", i);
+    return buf;
+}
+
+}  // namespace
+
+TEST_F(SkipListStoreTest, BasicPutGetDelete) {
+    std::string value;
+    EXPECT_TRUE(store->Put("key1", "value1").ok());
+    EXPECT_TRUE(store->Put("key1", "value2").ok());
+    EXPECT_TRUE(store->Get("key1", value).ok());
+    EXPECT_EQ(value, "value2");
+    EXPECT_EQ(store->Size(), 1u);
+
+    EXPECT_TRUE(store->Delete("key1").ok());
+    EXPECT_TRUE(store->Get("key1", value).is_key_not_found());
+    EXPECT_TRUE(store->Contains("key1").is_key_not_found());
+    EXPECT_TRUE(store->Delete("key1").is_key_not_found());
+    EXPECT_FALSE(store->Put("", "v").ok());
+    EXPECT_EQ(store->Size(), 0u);
+}
+
+// 随机写入和删除后，迭代顺序和内容与std::map一致
+TEST_F(SkipListStoreTest, IterationMatchesStdMap) {
+    std::map<std::string, std::string> reference;
+    std::mt19937 rng(3);
+    for (int i = 0; i < 50000; ++i) {
+        std::string key = PaddedKey(rng() % 10000);
+        if (rng() % 4 == 0) {
+            EXPECT_EQ(store->Delete(key).ok(), reference.erase(key) == 1);
+        } else {
+            std::string value = "v" + std::to_string(i);
+            store->Put(key, value);
+            reference[key] = value;
+        }
+    }
+    ASSERT_EQ(store->Size(), reference.size());
+
+    auto it = store->NewIterator();
+    ASSERT_TRUE(it);
+    it->Seek("");
+    auto expected = reference.begin();
+    for (; it->Valid(); it->Next(), ++expected) {
+        ASSERT_NE(expected, reference.end());
+        ASSERT_EQ(it->key(), expected->first);
+        ASSERT_EQ(it->value(), expected->second);
+    }
+    EXPECT_EQ(expected, reference.end());
+
+    // Seek到不存在的key时停在下一个key上
+    it->Seek("key005000x");
+    ASSERT_TRUE(it->Valid());
+    EXPECT_EQ(it->key(), reference.upper_bound("key005000x")->first);
+    it->Seek("zzz");
+    EXPECT_FALSE(it->Valid());
+}
+
+TEST_F(SkipListStoreTest, PrefixScan) {
+    store->Put("user:1:name", "a");
+    store->Put("user:12:name", "b");
+    store->Put("user:123:age", "1");
+    store->Put("user:123:name", "c");
+    store->Put("user:124:name", "d");
+
+    std::vector<std::string> keys;
+    auto it = store->NewIterator();
+    const std::string prefix = "user:123:";
+    for (it->Seek(prefix); it->Valid() && it->key().compare(0, prefix.size(), prefix) == 0; it->Next()) {
+        keys.push_back(it->key());
+    }
+    ASSERT_EQ(keys.size(), 2u);
+    EXPECT_EQ(keys[0], "user:123:age");
+    EXPECT_EQ(keys[1], "user:123:name");
+}
+
+// 长扫描与写者并发：扫描期间写入照常完成，扫描结果保持有序，
+// 且扫描全程未被删除的key一定能看到
+TEST_F(SkipListStoreTest, ScanConcurrentWithWriters) {
+    const int kKeys = 20000;
+    for (int i = 0; i < kKeys; ++i) {
+        store->Put(PaddedKey(i), "stable");
+    }
+
+    std::atomic<bool> stop{false};
+    std::atomic<long> writes{0};
+    std::thread writer([&]() {
+        std::mt19937 rng(11);
+        while (!stop.load()) {
+            // 只改动奇数key，偶数key在扫描期间保持存在
+            std::string key = PaddedKey((rng() % (kKeys / 2)) * 2 + 1);
+            if (rng() % 2) {
+                store->Put(key, "updated");
+            } else {
+                store->Delete(key);
+            }
+            writes++;
+        }
+    });
+
+    for (int round = 0; round < 5; ++round) {
+        auto it = store->NewIterator();
+        std::string prev;
+        int even_seen = 0;
+        for (it->Seek(""); it->Valid(); it->Next()) {
+            ASSERT_LT(prev, it->key());
+            prev = it->key();
+            int index = std::stoi(prev.substr(3));
+            if (index % 2 == 0) {
+                ASSERT_EQ(it->value(), "stable");
+                even_seen++;
+            }
+        }
+        EXPECT_EQ(even_seen, kKeys / 2);
+    }
+
+    stop = true;
+    writer.join();
+    EXPECT_GT(writes.load(), 0);
+}
+
+TEST_F(SkipListStoreTest, ClearRemovesEverything) {
+    for (int i = 0; i < 1000; ++i) {
+        store->Put(PaddedKey(i), "v");
+    }
+    store->Clear();
+    EXPECT_EQ(store->Size(), 0u);
+    auto it = store->NewIterator();
+    it->Seek("");
+    EXPECT_FALSE(it->Valid());
+    EXPECT_TRUE(store->Put("after", "clear").ok());
+    EXPECT_TRUE(store->Contains("after").ok());
+}
+
+TEST(OtherEnginesTest, NoIteratorForHashEngines) {
+    EXPECT_FALSE(KVStore::CreateMemoryStore()->NewIterator());
+}
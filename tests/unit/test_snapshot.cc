@@ -0,0 +1,219 @@
+// tests/unit/test_snapshot.cc
+#include "src/core/kv_store.h"
+#include "src/storage/durable_store.h"
+#include "src/storage/snapshot.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+class SnapshotTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char dir[] = "/tmp/kv_snapshot_XXXXXX";
+        ASSERT_NE(mkdtemp(dir), nullptr);
+        dir_ = dir;
+        path = SnapshotManager::SnapshotPath(dir_);
+        options.path = dir_ + "/appendonly.aof";
+        options.fsync = FSYNC_NO;
+    }
+
+    void TearDown() override {
+        std::remove(path.c_str());
+        std::remove((path + ".tmp").c_str());
+        std::remove(options.path.c_str());
+        rmdir(dir_.c_str());
+    }
+
+    std::unique_ptr<DurableStore> OpenDurable() {
+        std::unique_ptr<DurableStore> store;
+        Status s = DurableStore::Open(KVStore::CreateMemoryStore(), options, &store, path);
+        EXPECT_TRUE(s.ok()) << s.message;
+        return store;
+    }
+
+    std::string dir_;
+    std::string path;
+    AppendLogOptions options;
+};
+
+TEST_F(SnapshotTest, RoundTrip) {
+    auto store = KVStore::CreateShardedMemoryStore();
+    std::map<std::string, std::string> expected;
+    std::mt19937 rng(1);
+    for (int i = 0; i < 20000; ++i) {
+        std::string key = "key" + std::to_string(i);
+        // 混入跨越多个块的大value和含0字节的value
+        std::string value = i % 1000 == 0 ? std::string(200000, 'L') : std::string(rng() % 64, 'a' + i % 26);
+        if (i % 7 == 0) {
+            value.push_back('\0');
+        }
+        store->Put(key, value);
+        expected[key] = value;
+    }
+    ASSERT_TRUE(SaveSnapshot(store.get(), path, 42).ok());
+
+    auto loaded = KVStore::CreateShardedMemoryStore();
+    SnapshotHeader header;
+    Status s = LoadSnapshot(path, loaded.get(), &header);
+    ASSERT_TRUE(s.ok()) << s.message;
+    EXPECT_EQ(header.entries, expected.size());
+    EXPECT_EQ(header.seq, 42u);
+    EXPECT_GT(header.blocks, 1u);
+    ASSERT_EQ(loaded->Size(), expected.size());
+    std::string value;
+    for (const auto& kv : expected) {
+        ASSERT_TRUE(loaded->Get(kv.first, value).ok());
+        ASSERT_EQ(value, kv.second);
+    }
+}
+
+TEST_F(SnapshotTest, ExpiryIsKept) {
+    auto store = KVStore::CreateMemoryStore();
+    store->PutWithTtl("short", "v", 30);
+    store->PutWithTtl("long", "v", 100000);
+    store->Put("plain", "v");
+    ASSERT_TRUE(SaveSnapshot(store.get(), path, 0).ok());
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+
+    auto loaded = KVStore::CreateMemoryStore();
+    SnapshotHeader header;
+    ASSERT_TRUE(LoadSnapshot(path, loaded.get(), &header).ok());
+    int64_t ttl = 0;
+    EXPECT_TRUE(loaded->Contains("short").is_key_not_found());
+    ASSERT_TRUE(loaded->Ttl("long", &ttl).ok());
+    EXPECT_GT(ttl, 90000);
+    ASSERT_TRUE(loaded->Ttl("plain", &ttl).ok());
+    EXPECT_EQ(ttl, -1);
+}
+
+TEST_F(SnapshotTest, CorruptionIsDetected) {
+    auto store = KVStore::CreateMemoryStore();
+    for (int i = 0; i < 10000; ++i) {
+        store->Put("key" + std::to_string(i), std::string(50, 'v'));
+    }
+    ASSERT_TRUE(SaveSnapshot(store.get(), path, 0).ok());
+    struct stat st;
+    ASSERT_EQ(stat(path.c_str(), &st), 0);
+
+    // 翻转中间某个块里的一个字节
+    int fd = open(path.c_str(), O_WRONLY);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(pwrite(fd, "X", 1, st.st_size / 2), 1);
+    close(fd);
+    SnapshotHeader header;
+    EXPECT_FALSE(LoadSnapshot(path, KVStore::CreateMemoryStore().get(), &header).ok());
+
+    // 截断的文件与头部记录的大小不符
+    ASSERT_EQ(truncate(path.c_str(), st.st_size - 100), 0);
+    EXPECT_FALSE(LoadSnapshot(path, KVStore::CreateMemoryStore().get(), &header).ok());
+}
+
+// 快照之后的修改（包括删除）由日志补上，重启后只回放快照之后的记录
+TEST_F(SnapshotTest, CombinesWithAppendLog) {
+    {
+        auto store = OpenDurable();
+        for (int i = 0; i < 1000; ++i) {
+            store->Put("key" + std::to_string(i), "before");
+        }
+        ASSERT_TRUE(store->SaveSnapshot(path).ok());
+        store->Put("key1", "after");
+        store->Delete("key2");
+        store->Put("new", "after");
+    }
+
+    auto store = OpenDurable();
+    std::string value;
+    EXPECT_EQ(store->Size(), 1000u);
+    ASSERT_TRUE(store->Get("key1", value).ok());
+    EXPECT_EQ(value, "after");
+    EXPECT_TRUE(store->Contains("key2").is_key_not_found());
+    ASSERT_TRUE(store->Get("key3", value).ok());
+    EXPECT_EQ(value, "before");
+    EXPECT_TRUE(store->Contains("new").ok());
+}
+
+// 快照之后日志又被重写：重写后的日志包含全部数据，旧快照被忽略，
+// 否则快照中在重写前被删除的key会复活
+TEST_F(SnapshotTest, IgnoresSnapshotOlderThanRewrittenLog) {
+    {
+        auto store = OpenDurable();
+        store->Put("deleted", "v");
+        store->Put("kept", "v");
+        ASSERT_TRUE(store->SaveSnapshot(path).ok());
+        store->Delete("deleted");
+        ASSERT_TRUE(store->RewriteLog().ok());
+    }
+
+    auto store = OpenDurable();
+    EXPECT_EQ(store->Size(), 1u);
+    EXPECT_TRUE(store->Contains("deleted").is_key_not_found());
+    EXPECT_TRUE(store->Contains("kept").ok());
+}
+
+// 日志文件丢失时从快照恢复，新日志的序列号接在快照之后
+TEST_F(SnapshotTest, NewLogContinuesAfterSnapshot) {
+    {
+        auto store = OpenDurable();
+        for (int i = 0; i < 100; ++i) {
+            store->Put("key" + std::to_string(i), "v");
+        }
+        ASSERT_TRUE(store->SaveSnapshot(path).ok());
+    }
+    std::remove(options.path.c_str());
+    {
+        auto store = OpenDurable();
+        EXPECT_EQ(store->Size(), 100u);
+        EXPECT_GE(store->log().LastSequence(), 100u);
+        store->Put("after", "v");
+    }
+    auto store = OpenDurable();
+    EXPECT_EQ(store->Size(), 101u);
+}
+
+// 保存快照期间写入照常进行，快照加上日志得到最终状态
+TEST_F(SnapshotTest, BackgroundSaveWithConcurrentWriters) {
+    auto store = OpenDurable();
+    for (int i = 0; i < 50000; ++i) {
+        store->Put("key" + std::to_string(i), "v0");
+    }
+
+    std::atomic<bool> stop{false};
+    std::atomic<long> writes{0};
+    std::thread writer([&]() {
+        std::mt19937 rng(9);
+        while (!stop.load()) {
+            store->Put("key" + std::to_string(rng() % 50000), "v" + std::to_string(writes.load()));
+            writes++;
+        }
+    });
+
+    SnapshotManager snapshots(store.get(), store.get(), dir_);
+    ASSERT_TRUE(snapshots.StartBackgroundSave().ok());
+    while (snapshots.InProgress()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    stop = true;
+    writer.join();
+    EXPECT_GT(writes.load(), 0);
+
+    std::map<std::string, std::string> expected;
+    store->ForEach([&](const std::string& key, const std::string& value, int64_t) { expected[key] = value; });
+    store.reset();
+
+    store = OpenDurable();
+    ASSERT_EQ(store->Size(), expected.size());
+    std::string value;
+    for (const auto& kv : expected) {
+        ASSERT_TRUE(store->Get(kv.first, value).ok());
+        ASSERT_EQ(value, kv.second);
+    }
+}
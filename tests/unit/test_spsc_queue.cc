@@ -0,0 +1,47 @@
+// tests/unit/test_spsc_queue.cc
+#include "src/common/spsc_queue.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+
+TEST(SpscQueueTest, BoundedFifo) {
+    SpscQueue<int> queue(3);
+    EXPECT_EQ(queue.capacity(), 4u);
+    for (int i = 0; i < 4; ++i) {
+        int value = i;
+        EXPECT_TRUE(queue.TryPush(std::move(value)));
+    }
+    int extra = 99;
+    EXPECT_FALSE(queue.TryPush(std::move(extra)));
+    EXPECT_EQ(extra, 99);
+
+    int value = -1;
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(queue.TryPop(&value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(queue.TryPop(&value));
+}
+
+// 两个线程并发入队出队，元素不丢、不重、保持顺序
+TEST(SpscQueueTest, ConcurrentProducerConsumer) {
+    const int kCount = 200000;
+    SpscQueue<std::string> queue(64);
+    std::thread producer([&]() {
+        for (int i = 0; i < kCount; ++i) {
+            std::string value = std::to_string(i);
+            while (!queue.TryPush(std::move(value))) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    std::string value;
+    for (int i = 0; i < kCount; ++i) {
+        while (!queue.TryPop(&value)) {
+            std::this_thread::yield();
+        }
+        ASSERT_EQ(value, std::to_string(i));
+    }
+    producer.join();
+    EXPECT_FALSE(queue.TryPop(&value));
+}
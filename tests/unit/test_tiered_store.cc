@@ -0,0 +1,187 @@
+// tests/unit/test_tiered_store.cc
+#include "src/core/kv_store.h"
+#include "src/storage/tiered_store.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+class TieredStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char dir[] = "/tmp/kv_tiered_XXXXXX";
+        ASSERT_NE(mkdtemp(dir), nullptr);
+        options.dir = dir;
+        options.hot_bytes = 256 * 1024;
+        options.segment_bytes = 256 * 1024;
+        options.num_shards = 4;
+        Status s = TieredStore::Open(options, &store);
+        ASSERT_TRUE(s.ok()) << s.message;
+    }
+
+    void TearDown() override {
+        store.reset();
+        std::string command = "rm -rf " + options.dir;
+        ASSERT_EQ(std::system(command.c_str()), 0);
+    }
+
+    static std::string Key(int i) { return "key" + std::to_string(i); }
+    static std::string Value(int i, int version = 0) {
+        return std::string(200, static_cast<char>('a' + i % 26)) + std::to_string(i) + "/" + std::to_string(version);
+    }
+
+    TieredOptions options;
+    std::unique_ptr<TieredStore> store;
+};
+
+TEST_F(TieredStoreTest, BasicOperations) {
+    std::string value;
+    EXPECT_TRUE(store->Get("missing", value).is_key_not_found());
+    ASSERT_TRUE(store->Put("a", "1").ok());
+    ASSERT_TRUE(store->Get("a", value).ok());
+    EXPECT_EQ(value, "1");
+    ASSERT_TRUE(store->Delete("a").ok());
+    EXPECT_TRUE(store->Delete("a").is_key_not_found());
+    EXPECT_FALSE(store->Put("", "v").ok());
+}
+
+// 数据远超热数据预算时大部分value进入值日志，内存只剩索引，读取结果不变
+TEST_F(TieredStoreTest, ColdValuesSpillToLog) {
+    const int kKeys = 20000;
+    for (int i = 0; i < kKeys; ++i) {
+        ASSERT_TRUE(store->Put(Key(i), Value(i)).ok());
+    }
+    TieredStats stats = store->GetTieredStats();
+    EXPECT_EQ(stats.hot_keys + stats.cold_keys, static_cast<size_t>(kKeys));
+    EXPECT_GT(stats.cold_keys, static_cast<size_t>(kKeys) * 3 / 4);
+    EXPECT_LE(stats.hot_bytes, options.hot_bytes + 4096);
+    // 冷key的内存开销只有索引，远小于value本身
+    EXPECT_LT(stats.index_bytes / stats.cold_keys, 100u);
+    EXPECT_GT(stats.log_bytes, stats.cold_keys * 200);
+
+    std::string value;
+    for (int i = 0; i < kKeys; ++i) {
+        ASSERT_TRUE(store->Get(Key(i), value).ok()) << Key(i);
+        ASSERT_EQ(value, Value(i));
+    }
+    EXPECT_GT(store->GetTieredStats().cold_reads, 0u);
+    EXPECT_EQ(store->Size(), static_cast<size_t>(kKeys));
+}
+
+TEST_F(TieredStoreTest, RepeatedReadsPromote) {
+    for (int i = 0; i < 5000; ++i) {
+        store->Put(Key(i), Value(i));
+    }
+    // Key(0)最早写入，已经被移到值日志
+    ASSERT_GT(store->GetTieredStats().cold_keys, 0u);
+    std::string value;
+    int cold = -1;
+    for (int i = 0; i < 5000 && cold < 0; ++i) {
+        uint64_t before = store->GetTieredStats().cold_reads;
+        store->Get(Key(i), value);
+        if (store->GetTieredStats().cold_reads > before) {
+            cold = i;
+        }
+    }
+    ASSERT_GE(cold, 0);
+    uint64_t promotions = store->GetTieredStats().promotions;
+    ASSERT_TRUE(store->Get(Key(cold), value).ok());
+    EXPECT_EQ(value, Value(cold));
+    EXPECT_EQ(store->GetTieredStats().promotions, promotions + 1);
+
+    // 提升后从内存读取
+    uint64_t cold_reads = store->GetTieredStats().cold_reads;
+    ASSERT_TRUE(store->Get(Key(cold), value).ok());
+    EXPECT_EQ(store->GetTieredStats().cold_reads, cold_reads);
+}
+
+// 覆盖写让值日志中的旧记录成为垃圾，回收后数据不变、日志变小
+TEST_F(TieredStoreTest, ReclaimKeepsLiveValues) {
+    const int kKeys = 5000;
+    for (int version = 0; version < 4; ++version) {
+        for (int i = 0; i < kKeys; ++i) {
+            store->Put(Key(i), Value(i, version));
+        }
+    }
+    for (int i = 0; i < kKeys; i += 3) {
+        store->Delete(Key(i));
+    }
+    TieredStats before = store->GetTieredStats();
+    EXPECT_GT(before.garbage_bytes, 0u);
+    while (store->ReclaimSpace()) {
+    }
+    TieredStats after = store->GetTieredStats();
+    EXPECT_LT(after.log_bytes, before.log_bytes);
+    EXPECT_GT(after.reclaimed_bytes, 0u);
+
+    std::string value;
+    for (int i = 0; i < kKeys; ++i) {
+        if (i % 3 == 0) {
+            ASSERT_TRUE(store->Get(Key(i), value).is_key_not_found());
+        } else {
+            ASSERT_TRUE(store->Get(Key(i), value).ok()) << Key(i);
+            ASSERT_EQ(value, Value(i, 3));
+        }
+    }
+}
+
+TEST_F(TieredStoreTest, ForEachReadsColdValues) {
+    std::map<std::string, std::string> expected;
+    for (int i = 0; i < 5000; ++i) {
+        store->Put(Key(i), Value(i));
+        expected[Key(i)] = Value(i);
+    }
+    std::map<std::string, std::string> seen;
+    ASSERT_TRUE(store->ForEach([&](const std::string& key, const std::string& value, int64_t) {
+        seen[key] = value;
+    }).ok());
+    EXPECT_EQ(seen, expected);
+
+    store->Clear();
+    EXPECT_EQ(store->Size(), 0u);
+    EXPECT_EQ(store->GetTieredStats().cold_keys, 0u);
+}
+
+// 回收与读写并发进行
+TEST_F(TieredStoreTest, ConcurrentAccessDuringReclaim) {
+    const int kKeys = 4000;
+    for (int i = 0; i < kKeys; ++i) {
+        store->Put(Key(i), Value(i));
+    }
+    std::atomic<bool> stop{false};
+    std::atomic<bool> failed{false};
+    std::thread reclaimer([&]() {
+        while (!stop.load()) {
+            store->ReclaimSpace();
+        }
+    });
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t]() {
+            std::mt19937 rng(t);
+            std::string value;
+            for (int n = 0; n < 20000; ++n) {
+                int i = static_cast<int>(rng() % kKeys);
+                if (n % 2 == 0) {
+                    // 每个线程只改写自己负责的key，其余key的value保持不变
+                    int own = i - i % 4 + t;
+                    store->Put(Key(own), Value(own, 1));
+                } else if (!store->Get(Key(i), value).ok() || (value != Value(i) && value != Value(i, 1))) {
+                    failed = true;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    stop = true;
+    reclaimer.join();
+    EXPECT_FALSE(failed.load());
+    EXPECT_EQ(store->Size(), static_cast<size_t>(kKeys));
+}
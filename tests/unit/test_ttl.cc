@@ -0,0 +1,166 @@
+// tests/unit/test_ttl.cc
+#include "src/core/kv_store.h"
+#include "src/core/timing_wheel.h"
+#include "src/common/protocol.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 各层的到期时间都在准确的tick上触发，不早也不晚
+TEST(TimingWheelTest, FiresAtExactDeadlineOnEveryLevel) {
+    TimingWheel wheel(1000);
+    std::map<std::string, uint64_t> deadlines;
+    std::mt19937_64 rng(7);
+    for (int i = 0; i < 2000; ++i) {
+        // 覆盖第0层到最高层以及超出总跨度的到期时间
+        uint64_t delta = 1 + rng() % (uint64_t(1) << (4 + i % 30));
+        std::string key = "k" + std::to_string(i);
+        deadlines[key] = 1000 + delta;
+        wheel.Schedule(key, 1000 + delta);
+    }
+
+    std::map<std::string, uint64_t> fired;
+    uint64_t now = 1000;
+    auto record = [&](const std::string& key, uint64_t deadline) {
+        EXPECT_EQ(deadline, deadlines[key]);
+        EXPECT_LE(deadline, now);
+        fired[key] = now;
+    };
+    // 以不同步长推进，第0层按1ms一步，之后逐渐加大步长
+    while (wheel.size() > 0) {
+        now += now < 5000 ? 1 : (now - 1000) / 4;
+        ASSERT_TRUE(wheel.Advance(now, static_cast<size_t>(-1), record));
+    }
+
+    ASSERT_EQ(fired.size(), deadlines.size());
+    for (const auto& kv : deadlines) {
+        if (kv.second < 5000) {
+            EXPECT_EQ(fired[kv.first], kv.second) << kv.first;
+        }
+    }
+}
+
+TEST(TimingWheelTest, AdvanceRespectsWorkLimit) {
+    TimingWheel wheel(0);
+    for (int i = 0; i < 1000; ++i) {
+        wheel.Schedule("k" + std::to_string(i), 500);
+    }
+
+    size_t fired = 0;
+    auto count = [&](const std::string&, uint64_t) { fired++; };
+    int calls = 0;
+    while (!wheel.Advance(1000, 100, count)) {
+        calls++;
+        EXPECT_LE(fired, static_cast<size_t>(calls) * 100);
+    }
+    EXPECT_EQ(fired, 1000u);
+    EXPECT_GE(calls, 9);
+    EXPECT_EQ(wheel.size(), 0u);
+}
+
+TEST(TimingWheelTest, PastDeadlineFiresOnNextAdvance) {
+    TimingWheel wheel(100);
+    wheel.Schedule("past", 50);
+    std::vector<std::string> fired;
+    wheel.Advance(100, 10, [&](const std::string& key, uint64_t) { fired.push_back(key); });
+    ASSERT_EQ(fired.size(), 1u);
+    EXPECT_EQ(fired[0], "past");
+}
+
+class TtlTest : public ::testing::Test {
+protected:
+    void SetUp() override { store = KVStore::CreateMemoryStore(); }
+    std::unique_ptr<KVStore> store;
+};
+
+TEST_F(TtlTest, ExpiredKeyIsInvisible) {
+    ASSERT_TRUE(store->PutWithTtl("k", "v", 50).ok());
+    std::string value;
+    EXPECT_TRUE(store->Get("k", value).ok());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(80));
+    EXPECT_TRUE(store->Get("k", value).is_key_not_found());
+    EXPECT_TRUE(store->Contains("k").is_key_not_found());
+    EXPECT_EQ(store->GetStats().expired, 1u);
+}
+
+TEST_F(TtlTest, TtlExpireAndOverwrite) {
+    int64_t ttl;
+    EXPECT_TRUE(store->Ttl("missing", &ttl).is_key_not_found());
+    EXPECT_TRUE(store->Expire("missing", 1000).is_key_not_found());
+
+    store->Put("k", "v");
+    ASSERT_TRUE(store->Ttl("k", &ttl).ok());
+    EXPECT_EQ(ttl, -1);
+
+    ASSERT_TRUE(store->Expire("k", 10000).ok());
+    ASSERT_TRUE(store->Ttl("k", &ttl).ok());
+    EXPECT_GT(ttl, 9000);
+    EXPECT_LE(ttl, 10000);
+    EXPECT_EQ(store->GetStats().expires, 1u);
+
+    // 普通写入清除过期时间
+    store->Put("k", "v2");
+    ASSERT_TRUE(store->Ttl("k", &ttl).ok());
+    EXPECT_EQ(ttl, -1);
+    EXPECT_EQ(store->GetStats().expires, 0u);
+
+    // 非正的过期时间直接删除
+    EXPECT_TRUE(store->Expire("k", 0).ok());
+    EXPECT_TRUE(store->Contains("k").is_key_not_found());
+    EXPECT_FALSE(store->PutWithTtl("k", "v", 0).ok());
+}
+
+// 不访问的key也会被后台线程删除；过期时间被延长的key不受旧条目影响
+TEST_F(TtlTest, ReaperRemovesKeysWithoutAccess) {
+    const int kKeys = 5000;
+    // 先延长key0，批量写入在负载高时可能超过它原来的过期时间
+    ASSERT_TRUE(store->PutWithTtl("key0", "v", 20).ok());
+    ASSERT_TRUE(store->Expire("key0", 60000).ok());
+    for (int i = 1; i < kKeys; ++i) {
+        store->PutWithTtl("key" + std::to_string(i), "v", 20 + i % 50);
+    }
+    store->Put("plain", "v");
+
+    for (int i = 0; i < 100 && store->Size() > 2; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    EXPECT_EQ(store->Size(), 2u);
+    EXPECT_TRUE(store->Contains("key0").ok());
+    EXPECT_TRUE(store->Contains("plain").ok());
+    EXPECT_EQ(store->GetStats().expired, static_cast<size_t>(kKeys - 1));
+}
+
+TEST(TtlProtocolTest, ParseSetOptions) {
+    int64_t ttl_ms;
+    EXPECT_TRUE(ProtocolParser::ParseSetOptions({"k", "v"}, &ttl_ms));
+    EXPECT_EQ(ttl_ms, -1);
+    EXPECT_TRUE(ProtocolParser::ParseSetOptions({"k", "v", "ex", "10"}, &ttl_ms));
+    EXPECT_EQ(ttl_ms, 10000);
+    EXPECT_TRUE(ProtocolParser::ParseSetOptions({"k", "v", "PX", "250"}, &ttl_ms));
+    EXPECT_EQ(ttl_ms, 250);
+    EXPECT_FALSE(ProtocolParser::ParseSetOptions({"k", "v", "EX"}, &ttl_ms));
+    EXPECT_FALSE(ProtocolParser::ParseSetOptions({"k", "v", "EX", "0"}, &ttl_ms));
+    EXPECT_FALSE(ProtocolParser::ParseSetOptions({"k", "v", "EX", "1s"}, &ttl_ms));
+    EXPECT_FALSE(ProtocolParser::ParseSetOptions({"k", "v", "KEEP", "1"}, &ttl_ms));
+    EXPECT_EQ(ttl_ms, -1);
+}
+
+TEST(TtlProtocolTest, ParseSetOptionsRejectsOutOfRangeTtl) {
+    // 换算成毫秒会溢出int64的数值按无效过期时间拒绝，而不是得到负数或乱码
+    int64_t ttl_ms;
+    EXPECT_FALSE(ProtocolParser::ParseSetOptions({"k", "v", "EX", "9999999999999999"}, &ttl_ms));
+    EXPECT_EQ(ttl_ms, 0);
+    EXPECT_FALSE(ProtocolParser::ParseSetOptions({"k", "v", "EX", "0"}, &ttl_ms));
+    EXPECT_EQ(ttl_ms, 0);
+
+    int64_t max_seconds = ProtocolParser::kMaxTtlMs / 1000;
+    EXPECT_TRUE(ProtocolParser::ParseSetOptions({"k", "v", "EX", std::to_string(max_seconds)}, &ttl_ms));
+    EXPECT_EQ(ttl_ms, max_seconds * 1000);
+    EXPECT_FALSE(ProtocolParser::ParseSetOptions({"k", "v", "EX", std::to_string(max_seconds + 1)}, &ttl_ms));
+    EXPECT_EQ(ttl_ms, 0);
+}